@@ -0,0 +1,140 @@
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "arena.hpp"
+#include "bench_util.hpp"
+#include "memory_resource.hpp"
+#include "pool_allocator.hpp"
+#include "ring.hpp"
+#include "vector.hpp"
+
+namespace {
+
+struct node {
+  node* next;
+  size_t payload[3];
+};
+
+// allocation churn of a node based container, a window of live nodes is freed in
+// allocation order while new ones keep coming
+template <typename Alloc>
+void BM_alloc_churn(benchmark::State& state) {
+  typedef std::allocator_traits<Alloc> traits;
+  const auto live = static_cast<size_t>(state.range(0));
+  Alloc alloc;
+  std::vector<node*> window(live, nullptr);
+
+  size_t i = 0;
+  for (auto _ : state) {
+    auto& slot = window[i++ % live];
+    if (slot != nullptr) traits::deallocate(alloc, slot, 1);
+    slot = traits::allocate(alloc, 1);
+    benchmark::DoNotOptimize(slot);
+  }
+  for (auto p : window) {
+    if (p != nullptr) traits::deallocate(alloc, p, 1);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// blocks allocated on the benchmark thread are freed on a second one, as in a producer /
+// consumer pipeline. allocs counts the global operator new calls per block, for the pool
+// that is how often it had to carve a new slab because the freed blocks were not reused
+template <typename Alloc>
+void BM_alloc_cross_thread(benchmark::State& state) {
+  typedef std::allocator_traits<Alloc> traits;
+  hf::spsc_ring<node*> queue(static_cast<size_t>(state.range(0)));
+
+  std::thread consumer([&] {
+    Alloc alloc;
+    for (node* p;;) {
+      queue.pop(p);
+      if (p == nullptr) break;
+      traits::deallocate(alloc, p, 1);
+    }
+  });
+
+  Alloc alloc;
+  auto before = hf_bench::allocations();
+  for (auto _ : state) queue.push(traits::allocate(alloc, 1));
+  queue.push(nullptr);
+  consumer.join();
+  hf_bench::report_allocations(state, before);
+  state.SetItemsProcessed(state.iterations());
+}
+
+// many short-lived small vectors, the arena variant releases everything with one reset
+template <typename Alloc>
+void BM_alloc_small_vectors(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < count; ++i) {
+      hf::vector<int, Alloc> v;
+      for (int j = 0; j < 12; ++j) v.push_back(j);
+      benchmark::DoNotOptimize(v.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+void BM_alloc_small_vectors_arena(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  hf::arena arena;
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < count; ++i) {
+      hf::vector<int, hf::arena_alloc<int>> v{hf::arena_alloc<int>(arena)};
+      for (int j = 0; j < 12; ++j) v.push_back(j);
+      benchmark::DoNotOptimize(v.data());
+    }
+    arena.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+void BM_alloc_small_vectors_pmr_pool(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  hf::polymorphic_allocator<int> alloc(hf::pool_resource());
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < count; ++i) {
+      hf::vector<int, hf::polymorphic_allocator<int>> v(alloc);
+      for (int j = 0; j < 12; ++j) v.push_back(j);
+      benchmark::DoNotOptimize(v.data());
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+/* ------------------------------------------------------------------------- */
+
+BENCHMARK_TEMPLATE(BM_alloc_churn, std::allocator<node>)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_alloc_churn, hf::allocator<node>)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_alloc_churn, hf::pool_allocator<node>)->Range(64, 1 << 16);
+
+// the same churn on several threads at once, each with its own window
+BENCHMARK_TEMPLATE(BM_alloc_churn, std::allocator<node>)
+    ->Arg(4096)
+    ->ThreadRange(2, 16)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_alloc_churn, hf::allocator<node>)
+    ->Arg(4096)
+    ->ThreadRange(2, 16)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_alloc_churn, hf::pool_allocator<node>)
+    ->Arg(4096)
+    ->ThreadRange(2, 16)
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_alloc_cross_thread, std::allocator<node>)->Arg(1024)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_alloc_cross_thread, hf::allocator<node>)->Arg(1024)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_alloc_cross_thread, hf::pool_allocator<node>)->Arg(1024)->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_alloc_small_vectors, hf::allocator<int>)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_alloc_small_vectors, hf::pool_allocator<int>)->Arg(1024);
+BENCHMARK(BM_alloc_small_vectors_arena)->Arg(1024);
+BENCHMARK(BM_alloc_small_vectors_pmr_pool)->Arg(1024);
+
+}  // namespace
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <random>
+#include <string>
+
+namespace hf_bench {
+
+// number of global operator new calls so far, counted by the replacement in bench_util.cpp
+size_t allocations() noexcept;
+
+// records the heap allocations made per iteration since `before` as the "allocs" counter
+inline void report_allocations(benchmark::State& state, size_t before) {
+  state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocations() - before),
+                                                benchmark::Counter::kAvgIterations);
+}
+
+// deterministic text over a small alphabet so searches have realistic partial matches
+template <typename CharType>
+std::basic_string<CharType> random_text(size_t n, unsigned seed = 42) {
+  std::mt19937 gen(seed);
+  std::basic_string<CharType> s(n, CharType());
+  for (auto& c : s) c = static_cast<CharType>('a' + gen() % 16);
+  return s;
+}
+
+}  // namespace hf_bench
@@ -0,0 +1,164 @@
+#include <cstdint>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "btree_map.hpp"
+#include "btree_set.hpp"
+#include "vector.hpp"
+
+namespace {
+
+// present keys are even, missing keys odd, both in random order
+std::vector<uint64_t> make_keys(size_t n, bool present, unsigned seed = 42) {
+  std::mt19937_64 gen(seed);
+  std::vector<uint64_t> keys(n);
+  for (auto& k : keys) k = (gen() & ~uint64_t(1)) | (present ? 0 : 1);
+  return keys;
+}
+
+template <typename Map>
+Map make_map(const std::vector<uint64_t>& keys) {
+  Map map;
+  for (auto k : keys) map[k] = k;
+  return map;
+}
+
+template <typename Map>
+void BM_ordered_map_insert(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto keys = make_keys(n, true);
+
+  for (auto _ : state) {
+    Map map;
+    for (auto k : keys) map[k] = k;
+    benchmark::DoNotOptimize(map.size());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// keys arriving in order, as when loading a sorted dump
+template <typename Map>
+void BM_ordered_map_insert_sorted(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    Map map;
+    for (size_t i = 0; i < n; ++i) map.emplace(i, i);
+    benchmark::DoNotOptimize(map.size());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+void BM_btree_map_assign_sorted(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  hf::vector<hf::pair<uint64_t, uint64_t>> sorted;
+  sorted.reserve(n);
+  for (size_t i = 0; i < n; ++i) sorted.emplace_back(i, i);
+
+  for (auto _ : state) {
+    hf::btree_map<uint64_t, uint64_t> map;
+    map.assign_sorted(sorted.begin(), sorted.end());
+    benchmark::DoNotOptimize(map.size());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Map>
+void BM_ordered_map_lookup_hit(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto keys = make_keys(n, true);
+  const auto map = make_map<Map>(keys);
+
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.find(keys[i]));
+    if (++i == n) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// a short range query, the first key at or after a random point and the 64 that follow
+template <typename Map>
+void BM_ordered_map_range_scan(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto map = make_map<Map>(make_keys(n, true));
+  const auto from = make_keys(n, false, 7);
+
+  size_t i = 0;
+  for (auto _ : state) {
+    uint64_t sum = 0;
+    auto it = map.lower_bound(from[i]);
+    for (int j = 0; j < 64 && it != map.end(); ++j, ++it) sum += it->second;
+    benchmark::DoNotOptimize(sum);
+    if (++i == n) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations() * 64);
+}
+
+template <typename Map>
+void BM_ordered_map_full_scan(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto map = make_map<Map>(make_keys(n, true));
+
+  for (auto _ : state) {
+    uint64_t sum = 0;
+    for (auto& kv : map) sum += kv.second;
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// the set keeps its keys contiguous in the node, which is what the AVX2 node search needs
+template <typename Set>
+void BM_ordered_set_lookup_hit(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto keys = make_keys(n, true);
+  Set set;
+  for (auto k : keys) set.insert(k);
+
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(set.find(keys[i]));
+    if (++i == n) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/* ------------------------------------------------------------------------- */
+
+#ifdef HF_BENCH_LARGE
+constexpr int64_t MAX_ENTRIES = 100000000;
+#else
+constexpr int64_t MAX_ENTRIES = 10000000;
+#endif
+
+#define HF_ORDERED_BENCH(func, std_type, hf_type, unit)                                  \
+  BENCHMARK_TEMPLATE(func, std_type)                                                      \
+      ->RangeMultiplier(10)                                                               \
+      ->Range(1000000, MAX_ENTRIES)                                                       \
+      ->Unit(benchmark::unit);                                                            \
+  BENCHMARK_TEMPLATE(func, hf_type)                                                       \
+      ->RangeMultiplier(10)                                                               \
+      ->Range(1000000, MAX_ENTRIES)                                                       \
+      ->Unit(benchmark::unit)
+
+typedef std::map<uint64_t, uint64_t> std_map;
+typedef hf::btree_map<uint64_t, uint64_t> hf_map;
+
+HF_ORDERED_BENCH(BM_ordered_map_insert, std_map, hf_map, kMillisecond);
+HF_ORDERED_BENCH(BM_ordered_map_insert_sorted, std_map, hf_map, kMillisecond);
+BENCHMARK(BM_btree_map_assign_sorted)
+    ->RangeMultiplier(10)
+    ->Range(1000000, MAX_ENTRIES)
+    ->Unit(benchmark::kMillisecond);
+
+HF_ORDERED_BENCH(BM_ordered_map_lookup_hit, std_map, hf_map, kNanosecond);
+HF_ORDERED_BENCH(BM_ordered_map_range_scan, std_map, hf_map, kNanosecond);
+HF_ORDERED_BENCH(BM_ordered_map_full_scan, std_map, hf_map, kMillisecond);
+HF_ORDERED_BENCH(BM_ordered_set_lookup_hit, std::set<uint64_t>, hf::btree_set<uint64_t>,
+                 kNanosecond);
+
+}  // namespace
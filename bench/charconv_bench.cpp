@@ -0,0 +1,177 @@
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "charconv.hpp"
+#include "string.hpp"
+
+namespace {
+
+constexpr size_t VALUES = 1024;
+
+// magnitudes spread over the whole range so every digit count shows up
+std::vector<int64_t> random_ints() {
+  std::mt19937_64 gen(42);
+  std::vector<int64_t> v(VALUES);
+  for (auto& x : v) x = static_cast<int64_t>(gen() >> (gen() % 64)) * (gen() % 2 ? 1 : -1);
+  return v;
+}
+
+// latencies and ratios as a metrics exporter formats them, plus counters that are whole
+std::vector<double> random_doubles() {
+  std::mt19937_64 gen(42);
+  std::uniform_real_distribution<double> dist(0.0, 1000.0);
+  std::vector<double> v(VALUES);
+  for (size_t i = 0; i < VALUES; ++i) v[i] = i % 4 == 0 ? static_cast<double>(i) : dist(gen);
+  return v;
+}
+
+struct snprintf_conv {
+  static char* format(char* first, char* last, int64_t x) {
+    return first + std::snprintf(first, static_cast<size_t>(last - first), "%lld",
+                                 static_cast<long long>(x));
+  }
+
+  static char* format(char* first, char* last, double x) {
+    return first + std::snprintf(first, static_cast<size_t>(last - first), "%.17g", x);
+  }
+};
+
+struct std_conv {
+  template <typename T>
+  static char* format(char* first, char* last, T x) {
+    return std::to_chars(first, last, x).ptr;
+  }
+};
+
+struct hf_conv {
+  template <typename T>
+  static char* format(char* first, char* last, T x) {
+    return hf::to_chars(first, last, x).ptr;
+  }
+};
+
+template <typename Conv>
+void BM_format_int(benchmark::State& state) {
+  const auto values = random_ints();
+  char buf[32];
+  size_t i = 0;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Conv::format(buf, buf + sizeof(buf), values[i++ % VALUES]));
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Conv>
+void BM_format_double(benchmark::State& state) {
+  const auto values = random_doubles();
+  char buf[32];
+  size_t i = 0;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Conv::format(buf, buf + sizeof(buf), values[i++ % VALUES]));
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// a line of a text exposition format, name, value and timestamp
+void BM_string_append_metric(benchmark::State& state) {
+  const auto values = random_doubles();
+  const auto stamps = random_ints();
+  size_t i = 0;
+
+  for (auto _ : state) {
+    hf::string s;
+    s.reserve(64);
+    s.append("http_request_duration_seconds ");
+    s.append_double(values[i % VALUES]).append(1, ' ').append_int(stamps[i % VALUES]);
+    s.append(1, '\n');
+    ++i;
+    benchmark::DoNotOptimize(s.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/* ------------------------------------------------------------------------- */
+
+template <typename T>
+std::vector<hf::string> formatted(const std::vector<T>& values) {
+  std::vector<hf::string> v;
+  for (auto x : values) {
+    hf::string s;
+    if constexpr (std::is_integral<T>::value) {
+      s.append_int(x);
+    } else {
+      s.append_double(x);
+    }
+    v.push_back(std::move(s));
+  }
+  return v;
+}
+
+void BM_parse_int_strtoll(benchmark::State& state) {
+  const auto text = formatted(random_ints());
+  size_t i = 0;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::strtoll(text[i++ % VALUES].c_str(), nullptr, 10));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_parse_int_hf(benchmark::State& state) {
+  const auto text = formatted(random_ints());
+  size_t i = 0;
+  int64_t x = 0;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(text[i++ % VALUES].parse(x));
+    benchmark::DoNotOptimize(x);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_parse_double_strtod(benchmark::State& state) {
+  const auto text = formatted(random_doubles());
+  size_t i = 0;
+
+  for (auto _ : state) benchmark::DoNotOptimize(std::strtod(text[i++ % VALUES].c_str(), nullptr));
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_parse_double_hf(benchmark::State& state) {
+  const auto text = formatted(random_doubles());
+  size_t i = 0;
+  double x = 0;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(text[i++ % VALUES].parse(x));
+    benchmark::DoNotOptimize(x);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/* ------------------------------------------------------------------------- */
+
+BENCHMARK_TEMPLATE(BM_format_int, snprintf_conv);
+BENCHMARK_TEMPLATE(BM_format_int, std_conv);
+BENCHMARK_TEMPLATE(BM_format_int, hf_conv);
+
+BENCHMARK_TEMPLATE(BM_format_double, snprintf_conv);
+BENCHMARK_TEMPLATE(BM_format_double, std_conv);
+BENCHMARK_TEMPLATE(BM_format_double, hf_conv);
+
+BENCHMARK(BM_string_append_metric);
+
+BENCHMARK(BM_parse_int_strtoll);
+BENCHMARK(BM_parse_int_hf);
+BENCHMARK(BM_parse_double_strtod);
+BENCHMARK(BM_parse_double_hf);
+
+}  // namespace
@@ -0,0 +1,121 @@
+#include <deque>
+
+#include "bench_util.hpp"
+#include "deque.hpp"
+
+namespace {
+
+// a queue that holds about n items in steady state, one push at the back and one pop at the
+// front per item
+template <typename Deque>
+void BM_deque_fifo(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  Deque q;
+  for (size_t i = 0; i < n; ++i) q.push_back(static_cast<int>(i));
+
+  int i = 0;
+  for (auto _ : state) {
+    q.push_back(i++);
+    benchmark::DoNotOptimize(q.front());
+    q.pop_front();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// filled and drained as a whole, the map grows and the blocks come and go every round
+template <typename Deque>
+void BM_deque_fill_drain(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    Deque q;
+    for (size_t i = 0; i < n; ++i) q.push_back(static_cast<int>(i));
+    while (!q.empty()) {
+      benchmark::DoNotOptimize(q.front());
+      q.pop_front();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Deque>
+void BM_deque_push_front(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    Deque q;
+    for (size_t i = 0; i < n; ++i) q.push_front(static_cast<int>(i));
+    benchmark::DoNotOptimize(q.front());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// work stealing style, the owner works the back while others take from the front
+template <typename Deque>
+void BM_deque_both_ends(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  Deque q;
+  for (size_t i = 0; i < n; ++i) q.push_back(static_cast<int>(i));
+
+  int i = 0;
+  for (auto _ : state) {
+    q.push_back(i);
+    q.push_back(i + 1);
+    q.pop_back();
+    q.pop_front();
+    q.push_front(i);
+    q.pop_back();
+    ++i;
+  }
+  state.SetItemsProcessed(state.iterations() * 6);
+}
+
+template <typename Deque>
+void BM_deque_iterate(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  Deque q;
+  for (size_t i = 0; i < n; ++i) q.push_back(static_cast<int>(i));
+
+  for (auto _ : state) {
+    long sum = 0;
+    for (auto x : q) sum += x;
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Deque>
+void BM_deque_random_access(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  Deque q;
+  for (size_t i = 0; i < n; ++i) q.push_front(static_cast<int>(i));
+
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(q[i]);
+    i = (i + 7919) % n;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/* ------------------------------------------------------------------------- */
+
+BENCHMARK_TEMPLATE(BM_deque_fifo, std::deque<int>)->Range(16, 1 << 16);
+BENCHMARK_TEMPLATE(BM_deque_fifo, hf::deque<int>)->Range(16, 1 << 16);
+
+BENCHMARK_TEMPLATE(BM_deque_fill_drain, std::deque<int>)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_deque_fill_drain, hf::deque<int>)->Range(64, 1 << 16);
+
+BENCHMARK_TEMPLATE(BM_deque_push_front, std::deque<int>)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_deque_push_front, hf::deque<int>)->Range(64, 1 << 16);
+
+BENCHMARK_TEMPLATE(BM_deque_both_ends, std::deque<int>)->Range(16, 1 << 12);
+BENCHMARK_TEMPLATE(BM_deque_both_ends, hf::deque<int>)->Range(16, 1 << 12);
+
+BENCHMARK_TEMPLATE(BM_deque_iterate, std::deque<int>)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_deque_iterate, hf::deque<int>)->Range(64, 1 << 16);
+
+BENCHMARK_TEMPLATE(BM_deque_random_access, std::deque<int>)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_deque_random_access, hf::deque<int>)->Range(64, 1 << 16);
+
+}  // namespace
@@ -0,0 +1,45 @@
+#include <string>
+#include <string_view>
+
+#include "bench_util.hpp"
+#include "hash.hpp"
+#include "string.hpp"
+
+namespace {
+
+template <typename Hasher, typename View>
+void BM_hash_string(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto text = hf_bench::random_text<char>(n);
+  const View sv(text.data(), n);
+  Hasher hasher;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sv);
+    benchmark::DoNotOptimize(hasher(sv));
+  }
+  state.SetBytesProcessed(state.iterations() * n);
+}
+
+template <typename Hasher, typename T>
+void BM_hash_int(benchmark::State& state) {
+  Hasher hasher;
+  T x = 0;
+
+  for (auto _ : state) benchmark::DoNotOptimize(hasher(x++));
+  state.SetItemsProcessed(state.iterations());
+}
+
+/* ------------------------------------------------------------------------- */
+
+BENCHMARK_TEMPLATE(BM_hash_string, std::hash<std::string_view>, std::string_view)
+    ->RangeMultiplier(4)
+    ->Range(4, 1 << 16);
+BENCHMARK_TEMPLATE(BM_hash_string, hf::hash<hf::string_view>, hf::string_view)
+    ->RangeMultiplier(4)
+    ->Range(4, 1 << 16);
+
+BENCHMARK_TEMPLATE(BM_hash_int, std::hash<uint64_t>, uint64_t);
+BENCHMARK_TEMPLATE(BM_hash_int, hf::hash<uint64_t>, uint64_t);
+
+}  // namespace
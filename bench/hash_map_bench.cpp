@@ -0,0 +1,152 @@
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "flat_hash_map.hpp"
+#include "hashed_string.hpp"
+#include "string.hpp"
+
+namespace {
+
+// present keys are even, missing keys odd, both in random order
+std::vector<uint64_t> make_keys(size_t n, bool present, unsigned seed = 42) {
+  std::mt19937_64 gen(seed);
+  std::vector<uint64_t> keys(n);
+  for (auto& k : keys) k = (gen() & ~uint64_t(1)) | (present ? 0 : 1);
+  return keys;
+}
+
+template <typename Map>
+Map make_map(const std::vector<uint64_t>& keys) {
+  Map map;
+  for (auto k : keys) map[k] = k;
+  return map;
+}
+
+template <typename Map>
+void BM_hash_map_insert(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto keys = make_keys(n, true);
+  auto before = hf_bench::allocations();
+
+  for (auto _ : state) {
+    Map map;
+    for (auto k : keys) map[k] = k;
+    benchmark::DoNotOptimize(map.size());
+  }
+  hf_bench::report_allocations(state, before);
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Map>
+void BM_hash_map_lookup_hit(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto keys = make_keys(n, true);
+  const auto map = make_map<Map>(keys);
+
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.find(keys[i]));
+    if (++i == n) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Map>
+void BM_hash_map_lookup_miss(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto map = make_map<Map>(make_keys(n, true));
+  const auto missing = make_keys(n, false, 7);
+
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.find(missing[i]));
+    if (++i == n) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// string keys looked up through a view, the std map has to build a key string first
+template <typename Map, typename Key>
+void BM_hash_map_lookup_string(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  std::vector<std::string> keys(n);
+  for (size_t i = 0; i < n; ++i) keys[i] = "key/" + std::to_string(i * 7919) + "/value";
+
+  Map map;
+  for (size_t i = 0; i < n; ++i) map[typename Map::key_type(keys[i].c_str())] = i;
+
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.find(Key(keys[i].data(), keys[i].size())));
+    if (++i == n) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// the same few keys looked up over and over, a hashed_string key carries its hash along
+template <typename Map, typename Key>
+void BM_hash_map_lookup_hashed(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  Map map;
+  for (size_t i = 0; i < n; ++i) {
+    auto s = "service/" + std::to_string(i) + "/requests_total{method=\"GET\",code=\"200\"}";
+    map.try_emplace(typename Map::key_type(hf::string(s.c_str())), i);
+  }
+
+  std::vector<Key> keys;
+  std::vector<std::string> text;
+  for (size_t i = 0; i < 16; ++i) {
+    text.push_back("service/" + std::to_string(i * 61 % n) +
+                   "/requests_total{method=\"GET\",code=\"200\"}");
+  }
+  for (auto& t : text) keys.emplace_back(hf::string_view(t.data(), t.size()));
+
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.find(keys[i++ & 15]));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/* ------------------------------------------------------------------------- */
+
+#ifdef HF_BENCH_LARGE
+constexpr int64_t MAX_ENTRIES = 100000000;
+#else
+constexpr int64_t MAX_ENTRIES = 10000000;
+#endif
+
+#define HF_HASH_MAP_BENCH(func)                                                           \
+  BENCHMARK_TEMPLATE(func, std::unordered_map<uint64_t, uint64_t>)                        \
+      ->RangeMultiplier(10)                                                               \
+      ->Range(1000, MAX_ENTRIES);                                                         \
+  BENCHMARK_TEMPLATE(func, hf::flat_hash_map<uint64_t, uint64_t>)                         \
+      ->RangeMultiplier(10)                                                               \
+      ->Range(1000, MAX_ENTRIES)
+
+HF_HASH_MAP_BENCH(BM_hash_map_insert);
+HF_HASH_MAP_BENCH(BM_hash_map_lookup_hit);
+HF_HASH_MAP_BENCH(BM_hash_map_lookup_miss);
+
+BENCHMARK_TEMPLATE(BM_hash_map_lookup_string, std::unordered_map<std::string, size_t>,
+                   std::string)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_hash_map_lookup_string, hf::flat_hash_map<hf::string, size_t>,
+                   hf::string_view)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_hash_map_lookup_hashed, hf::flat_hash_map<hf::string, size_t>,
+                   hf::string_view)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000);
+BENCHMARK_TEMPLATE(BM_hash_map_lookup_hashed, hf::flat_hash_map<hf::hashed_string, size_t>,
+                   hf::hashed_string)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000);
+
+}  // namespace
@@ -0,0 +1,72 @@
+#include <string>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "string.hpp"
+#include "string_interner.hpp"
+#include "vector.hpp"
+
+namespace {
+
+// label values with a duplication factor of 64, as in metric ingestion
+std::vector<std::string> make_labels(size_t n) {
+  std::vector<std::string> labels(n);
+  for (size_t i = 0; i < n; ++i) {
+    labels[i] = "host-" + std::to_string(i % (n / 64 + 1)) + ".dc1.example.com";
+  }
+  return labels;
+}
+
+// keeping a copy of every value, the baseline the interner is measured against
+void BM_intern_baseline_copy(benchmark::State& state) {
+  const auto labels = make_labels(static_cast<size_t>(state.range(0)));
+  auto before = hf_bench::allocations();
+
+  for (auto _ : state) {
+    hf::vector<hf::string> kept;
+    for (auto& l : labels) kept.emplace_back(l.c_str());
+    benchmark::DoNotOptimize(kept.data());
+  }
+  hf_bench::report_allocations(state, before);
+  state.SetItemsProcessed(state.iterations() * labels.size());
+}
+
+void BM_intern_fill(benchmark::State& state) {
+  const auto labels = make_labels(static_cast<size_t>(state.range(0)));
+  auto before = hf_bench::allocations();
+  size_t bytes = 0;
+
+  for (auto _ : state) {
+    hf::string_interner interner;
+    hf::vector<hf::string_interner::id_type> kept;
+    for (auto& l : labels) kept.push_back(interner.intern(hf::string_view(l.data(), l.size())));
+    benchmark::DoNotOptimize(kept.data());
+    bytes = interner.bytes();
+  }
+  hf_bench::report_allocations(state, before);
+  state.counters["bytes"] = static_cast<double>(bytes);
+  state.SetItemsProcessed(state.iterations() * labels.size());
+}
+
+// every value already interned, the lock free path
+void BM_intern_hit(benchmark::State& state) {
+  const auto labels = make_labels(static_cast<size_t>(state.range(0)));
+  static hf::string_interner interner;
+  for (auto& l : labels) interner.intern(hf::string_view(l.data(), l.size()));
+
+  size_t i = 0;
+  for (auto _ : state) {
+    auto& l = labels[i];
+    benchmark::DoNotOptimize(interner.intern(hf::string_view(l.data(), l.size())));
+    if (++i == labels.size()) i = 0;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+/* ------------------------------------------------------------------------- */
+
+BENCHMARK(BM_intern_baseline_copy)->Range(1 << 10, 1 << 18);
+BENCHMARK(BM_intern_fill)->Range(1 << 10, 1 << 18);
+BENCHMARK(BM_intern_hit)->Range(1 << 10, 1 << 18)->ThreadRange(1, 4);
+
+}  // namespace
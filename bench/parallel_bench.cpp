@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <thread>
+
+#include "bench_util.hpp"
+#include "parallel.hpp"
+#include "thread_pool.hpp"
+#include "vector.hpp"
+
+namespace {
+
+// the same keys for every run of a size, generated once
+const hf::vector<uint64_t>& random_keys(size_t n) {
+  static hf::vector<uint64_t> keys;
+  if (keys.size() != n) {
+    std::mt19937_64 gen(42);
+    keys.resize(n);
+    for (auto& k : keys) k = gen();
+  }
+  return keys;
+}
+
+/* ------------------------------------------------------------------------- */
+
+// single threaded baselines, range(0) elements
+
+void BM_sort_std(benchmark::State& state) {
+  const auto& keys = random_keys(static_cast<size_t>(state.range(0)));
+  hf::vector<uint64_t> v;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    v = keys;
+    state.ResumeTiming();
+    std::sort(v.begin(), v.end());
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_reduce_std(benchmark::State& state) {
+  const auto& keys = random_keys(static_cast<size_t>(state.range(0)));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::accumulate(keys.begin(), keys.end(), uint64_t(0)));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// on a pool of range(0) workers, range(1) elements
+
+void BM_parallel_sort(benchmark::State& state) {
+  hf::thread_pool pool(static_cast<size_t>(state.range(0)));
+  const auto& keys = random_keys(static_cast<size_t>(state.range(1)));
+  hf::vector<uint64_t> v;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    v = keys;
+    state.ResumeTiming();
+    hf::parallel_sort(v, std::less<>(), 0, pool);
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+void BM_parallel_reduce(benchmark::State& state) {
+  hf::thread_pool pool(static_cast<size_t>(state.range(0)));
+  const auto& keys = random_keys(static_cast<size_t>(state.range(1)));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hf::parallel_reduce(keys, uint64_t(0), std::plus<>(), 0, pool));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+void BM_parallel_for(benchmark::State& state) {
+  hf::thread_pool pool(static_cast<size_t>(state.range(0)));
+  hf::vector<uint64_t> v = random_keys(static_cast<size_t>(state.range(1)));
+
+  for (auto _ : state) {
+    hf::parallel_for(v, [](uint64_t& x) { x = x * 0x9e3779b97f4a7c15ull + 1; }, 0, pool);
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+
+/* ------------------------------------------------------------------------- */
+
+#ifdef HF_BENCH_LARGE
+constexpr int64_t MAX_ENTRIES = 100000000;
+#else
+constexpr int64_t MAX_ENTRIES = 10000000;
+#endif
+
+// 1, 2, 4, ... workers up to one per hardware thread, on 1M and MAX_ENTRIES elements
+void scaling_args(benchmark::internal::Benchmark* b) {
+  int64_t cores = std::max(1u, std::thread::hardware_concurrency());
+  for (int64_t n : {int64_t(1000000), MAX_ENTRIES}) {
+    for (int64_t threads = 1; threads < cores; threads *= 2) b->Args({threads, n});
+    b->Args({cores, n});
+  }
+}
+
+BENCHMARK(BM_sort_std)->Arg(1000000)->Arg(MAX_ENTRIES)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_parallel_sort)->Apply(scaling_args)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_reduce_std)->Arg(1000000)->Arg(MAX_ENTRIES)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_parallel_reduce)->Apply(scaling_args)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_parallel_for)->Apply(scaling_args)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+}  // namespace
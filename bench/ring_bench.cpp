@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "ring.hpp"
+#include "string.hpp"
+
+namespace {
+
+// the mutex guarded queue the rings replace, bounded like them
+template <typename T>
+class locked_queue {
+ public:
+  explicit locked_queue(size_t capacity) : _capacity(capacity) {}
+
+  bool try_push(T value) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_items.size() == _capacity) return false;
+    _items.push_back(std::move(value));
+    return true;
+  }
+
+  void push(T value) {
+    for (unsigned spins = 0; !try_push(std::move(value));) hf::detail::ring_backoff(spins);
+  }
+
+  template <typename Iter>
+  size_t try_push_n(Iter first, size_t n) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    n = std::min(n, _capacity - _items.size());
+    for (size_t i = 0; i < n; ++i, ++first) _items.push_back(*first);
+    return n;
+  }
+
+  bool try_pop(T& out) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_items.empty()) return false;
+    out = std::move(_items.front());
+    _items.pop_front();
+    return true;
+  }
+
+  void pop(T& out) {
+    for (unsigned spins = 0; !try_pop(out);) hf::detail::ring_backoff(spins);
+  }
+
+  template <typename OutIter>
+  size_t try_pop_n(OutIter out, size_t n) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    n = std::min(n, _items.size());
+    for (size_t i = 0; i < n; ++i, ++out) {
+      *out = std::move(_items.front());
+      _items.pop_front();
+    }
+    return n;
+  }
+
+ private:
+  std::mutex _mutex;
+  std::deque<T> _items;
+  size_t _capacity;
+};
+
+/* ------------------------------------------------------------------------- */
+
+// every benchmark thread pushes and pops on one shared queue, the cost of contention
+template <typename Queue>
+void BM_queue_shared(benchmark::State& state) {
+  static Queue* queue;
+  if (state.thread_index() == 0) queue = new Queue(1024);
+
+  uint64_t v = 0;
+  for (auto _ : state) {
+    queue->push(v);
+    queue->pop(v);
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  if (state.thread_index() == 0) delete queue;
+}
+
+// one producer thread feeds the benchmark thread in batches of range(0)
+template <typename Queue>
+void BM_queue_stream(benchmark::State& state) {
+  const auto batch = static_cast<size_t>(state.range(0));
+  Queue queue(1024);
+  std::atomic<bool> stop{false};
+
+  std::thread producer([&] {
+    std::vector<uint64_t> in(batch);
+    uint64_t next = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+      for (auto& x : in) x = next++;
+      unsigned spins = 0;
+      for (size_t done = 0; done < batch && !stop.load(std::memory_order_relaxed);) {
+        auto n = queue.try_push_n(in.begin() + static_cast<ptrdiff_t>(done), batch - done);
+        if (n == 0) hf::detail::ring_backoff(spins);
+        done += n;
+      }
+    }
+  });
+
+  std::vector<uint64_t> out(batch);
+  uint64_t expected = 0;
+  for (auto _ : state) {
+    size_t n;
+    for (unsigned spins = 0; (n = queue.try_pop_n(out.begin(), batch)) == 0;) {
+      hf::detail::ring_backoff(spins);
+    }
+    if (out[0] != expected) state.SkipWithError("elements out of order");
+    expected = out[n - 1] + 1;
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(expected));
+
+  stop = true;
+  producer.join();
+}
+
+// hf::string records, moved through the queue in batches as between pipeline stages
+template <typename Queue>
+void BM_queue_records(benchmark::State& state) {
+  const auto batch = static_cast<size_t>(state.range(0));
+  constexpr size_t RECORDS = 1 << 14;
+  std::vector<hf::string> records(RECORDS);
+  for (size_t i = 0; i < RECORDS; ++i) {
+    records[i] = "host-42.dc1.example.com cpu.user ";
+    records[i].append_int(i % 1000);
+  }
+
+  for (auto _ : state) {
+    Queue queue(1024);
+    std::thread producer([&] {
+      unsigned spins = 0;
+      for (size_t i = 0; i < RECORDS;) {
+        auto first = std::make_move_iterator(records.begin() + static_cast<ptrdiff_t>(i));
+        auto n = queue.try_push_n(first, std::min(batch, RECORDS - i));
+        if (n == 0) hf::detail::ring_backoff(spins);
+        i += n;
+      }
+    });
+
+    std::vector<hf::string> out(batch);
+    unsigned spins = 0;
+    for (size_t i = 0; i < RECORDS;) {
+      auto n = queue.try_pop_n(out.begin(), batch);
+      if (n == 0) hf::detail::ring_backoff(spins);
+      for (size_t j = 0; j < n; ++j) records[i + j] = std::move(out[j]);
+      i += n;
+    }
+    producer.join();
+  }
+  state.SetItemsProcessed(state.iterations() * RECORDS);
+}
+
+// a round trip to an echo thread and back over two queues, the hand-off latency
+template <typename Queue>
+void BM_queue_ping_pong(benchmark::State& state) {
+  Queue ping(64);
+  Queue pong(64);
+
+  std::thread echo([&] {
+    for (uint64_t v = 1; v != 0;) {
+      ping.pop(v);
+      pong.push(v);
+    }
+  });
+
+  uint64_t v = 1;
+  for (auto _ : state) {
+    ping.push(v);
+    pong.pop(v);
+  }
+  ping.push(0);
+  echo.join();
+  state.SetItemsProcessed(state.iterations());
+}
+
+/* ------------------------------------------------------------------------- */
+
+BENCHMARK_TEMPLATE(BM_queue_shared, locked_queue<uint64_t>)->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_queue_shared, hf::mpmc_ring<uint64_t>)->ThreadRange(1, 32)->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_queue_stream, locked_queue<uint64_t>)->Range(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_queue_stream, hf::spsc_ring<uint64_t>)->Range(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_queue_stream, hf::mpmc_ring<uint64_t>)->Range(1, 64)->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_queue_records, locked_queue<hf::string>)->Range(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_queue_records, hf::spsc_ring<hf::string>)->Range(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_queue_records, hf::mpmc_ring<hf::string>)->Range(1, 64)->UseRealTime();
+
+BENCHMARK_TEMPLATE(BM_queue_ping_pong, locked_queue<uint64_t>)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_queue_ping_pong, hf::spsc_ring<uint64_t>)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_queue_ping_pong, hf::mpmc_ring<uint64_t>)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+
+#include "bench_util.hpp"
+#include "sort.hpp"
+#include "utils.hpp"
+#include "vector.hpp"
+
+namespace {
+
+// uniformly random keys over the whole range of T, the same for every run of a size
+template <typename T>
+const hf::vector<T>& random_keys(size_t n) {
+  static hf::vector<T> keys;
+  if (keys.size() != n) {
+    std::mt19937_64 gen(42);
+    keys.resize(n);
+    for (auto& k : keys) {
+      if constexpr (std::is_floating_point<T>::value) {
+        k = static_cast<T>(static_cast<int64_t>(gen())) / static_cast<T>(1e9);
+      } else {
+        k = static_cast<T>(gen());
+      }
+    }
+  }
+  return keys;
+}
+
+template <typename T>
+void BM_sort_std_sort(benchmark::State& state) {
+  const auto& keys = random_keys<T>(static_cast<size_t>(state.range(0)));
+  hf::vector<T> v;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    v = keys;
+    state.ResumeTiming();
+    std::sort(v.begin(), v.end());
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T, hf::sort_mode Mode>
+void BM_sort_hf_sort(benchmark::State& state) {
+  const auto& keys = random_keys<T>(static_cast<size_t>(state.range(0)));
+  hf::vector<T> v;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    v = keys;
+    state.ResumeTiming();
+    hf::sort(v, Mode);
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// 32 bit keys with a 32 bit payload, as in the aggregation step
+template <typename V>
+const hf::vector<hf::pair<int32_t, V>>& random_pairs(size_t n) {
+  static hf::vector<hf::pair<int32_t, V>> pairs;
+  if (pairs.size() != n) {
+    const auto& keys = random_keys<int32_t>(n);
+    pairs.clear();
+    for (size_t i = 0; i < n; ++i) pairs.emplace_back(keys[i], static_cast<V>(i));
+  }
+  return pairs;
+}
+
+template <typename V>
+void BM_sort_pairs_std_sort(benchmark::State& state) {
+  const auto& pairs = random_pairs<V>(static_cast<size_t>(state.range(0)));
+  hf::vector<hf::pair<int32_t, V>> v;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    v = pairs;
+    state.ResumeTiming();
+    std::sort(v.begin(), v.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename V, hf::sort_mode Mode>
+void BM_sort_pairs_hf_sort_by_key(benchmark::State& state) {
+  const auto& pairs = random_pairs<V>(static_cast<size_t>(state.range(0)));
+  hf::vector<hf::pair<int32_t, V>> v;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    v = pairs;
+    state.ResumeTiming();
+    hf::sort_by_key(v, Mode);
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+/* ------------------------------------------------------------------------- */
+
+#ifdef HF_BENCH_LARGE
+constexpr int64_t MAX_ENTRIES = 100000000;
+#else
+constexpr int64_t MAX_ENTRIES = 10000000;
+#endif
+
+// 1K keys up to MAX_ENTRIES
+void sort_sizes(benchmark::internal::Benchmark* b) {
+  b->Range(1 << 10, MAX_ENTRIES)->Unit(benchmark::kMicrosecond);
+}
+
+constexpr auto QUICK = hf::sort_mode::quick;
+constexpr auto RADIX = hf::sort_mode::radix;
+
+BENCHMARK_TEMPLATE(BM_sort_std_sort, int32_t)->Apply(sort_sizes);
+BENCHMARK_TEMPLATE(BM_sort_hf_sort, int32_t, QUICK)->Apply(sort_sizes);
+BENCHMARK_TEMPLATE(BM_sort_hf_sort, int32_t, RADIX)->Apply(sort_sizes);
+
+BENCHMARK_TEMPLATE(BM_sort_std_sort, uint64_t)->Apply(sort_sizes);
+BENCHMARK_TEMPLATE(BM_sort_hf_sort, uint64_t, QUICK)->Apply(sort_sizes);
+BENCHMARK_TEMPLATE(BM_sort_hf_sort, uint64_t, RADIX)->Apply(sort_sizes);
+
+BENCHMARK_TEMPLATE(BM_sort_std_sort, float)->Apply(sort_sizes);
+BENCHMARK_TEMPLATE(BM_sort_hf_sort, float, QUICK)->Apply(sort_sizes);
+BENCHMARK_TEMPLATE(BM_sort_hf_sort, float, RADIX)->Apply(sort_sizes);
+
+BENCHMARK_TEMPLATE(BM_sort_pairs_std_sort, uint32_t)->Apply(sort_sizes);
+BENCHMARK_TEMPLATE(BM_sort_pairs_hf_sort_by_key, uint32_t, QUICK)->Apply(sort_sizes);
+BENCHMARK_TEMPLATE(BM_sort_pairs_hf_sort_by_key, uint32_t, RADIX)->Apply(sort_sizes);
+
+BENCHMARK_TEMPLATE(BM_sort_pairs_std_sort, uint64_t)->Apply(sort_sizes);
+BENCHMARK_TEMPLATE(BM_sort_pairs_hf_sort_by_key, uint64_t, QUICK)->Apply(sort_sizes);
+BENCHMARK_TEMPLATE(BM_sort_pairs_hf_sort_by_key, uint64_t, RADIX)->Apply(sort_sizes);
+
+}  // namespace
@@ -0,0 +1,284 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "bench_util.hpp"
+#include "string.hpp"
+#include "string_builder.hpp"
+
+namespace {
+
+template <typename Str>
+void BM_string_construct(benchmark::State& state) {
+  typedef typename Str::value_type char_type;
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto text = hf_bench::random_text<char_type>(n);
+  auto before = hf_bench::allocations();
+
+  for (auto _ : state) {
+    Str s(text.data(), n);
+    benchmark::DoNotOptimize(s.data());
+  }
+  hf_bench::report_allocations(state, before);
+  state.SetBytesProcessed(state.iterations() * n * sizeof(char_type));
+}
+
+template <typename Str>
+void BM_string_copy(benchmark::State& state) {
+  typedef typename Str::value_type char_type;
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto text = hf_bench::random_text<char_type>(n);
+  const Str src(text.data(), n);
+
+  for (auto _ : state) {
+    Str s(src);
+    benchmark::DoNotOptimize(s.data());
+  }
+  state.SetBytesProcessed(state.iterations() * n * sizeof(char_type));
+}
+
+template <typename Str>
+void BM_string_append_char(benchmark::State& state) {
+  typedef typename Str::value_type char_type;
+  const auto n = static_cast<size_t>(state.range(0));
+  auto before = hf_bench::allocations();
+
+  for (auto _ : state) {
+    Str s;
+    for (size_t i = 0; i < n; ++i) s.append(1, static_cast<char_type>('a' + i % 26));
+    benchmark::DoNotOptimize(s.data());
+  }
+  hf_bench::report_allocations(state, before);
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Str>
+void BM_string_append_chunk(benchmark::State& state) {
+  typedef typename Str::value_type char_type;
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto chunk = hf_bench::random_text<char_type>(16);
+
+  for (auto _ : state) {
+    Str s;
+    for (size_t i = 0; i < n; i += 16) s.append(chunk.data(), 16);
+    benchmark::DoNotOptimize(s.data());
+  }
+  state.SetBytesProcessed(state.iterations() * n * sizeof(char_type));
+}
+
+template <typename Str>
+void BM_string_compare(benchmark::State& state) {
+  typedef typename Str::value_type char_type;
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto text = hf_bench::random_text<char_type>(n);
+  const Str a(text.data(), n);
+  const Str b(text.data(), n);
+
+  for (auto _ : state) benchmark::DoNotOptimize(a.compare(b));
+  state.SetBytesProcessed(state.iterations() * n * sizeof(char_type));
+}
+
+// the needle never occurs, so the whole haystack is scanned
+template <typename Str>
+void BM_string_find(benchmark::State& state) {
+  typedef typename Str::value_type char_type;
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto text = hf_bench::random_text<char_type>(n);
+  const Str s(text.data(), n);
+  const char_type needle[] = {'a', 'b', 'c', 'z', 0};
+
+  for (auto _ : state) benchmark::DoNotOptimize(s.find(needle));
+  state.SetBytesProcessed(state.iterations() * n * sizeof(char_type));
+}
+
+template <typename Str>
+void BM_string_find_first_of(benchmark::State& state) {
+  typedef typename Str::value_type char_type;
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto text = hf_bench::random_text<char_type>(n);
+  const Str s(text.data(), n);
+  const char_type set[] = {' ', ',', ';', '\n', 0};
+
+  for (auto _ : state) benchmark::DoNotOptimize(s.find_first_of(set));
+  state.SetBytesProcessed(state.iterations() * n * sizeof(char_type));
+}
+
+// about n bytes of access log lines, one in 64 requests fails with a 503
+std::string log_text(size_t n) {
+  static const char* const levels[] = {"INFO ", "DEBUG", "WARN "};
+  static const char* const paths[] = {"/api/v1/users", "/api/v1/orders", "/static/app.js",
+                                      "/healthz"};
+  std::mt19937 gen(7);
+  std::string s;
+  char line[160];
+
+  for (unsigned i = 0; s.size() < n; ++i) {
+    bool failed = gen() % 64 == 0;
+    auto len = std::snprintf(line, sizeof(line),
+                             "2026-10-16T12:%02u:%02u.%03u %s [worker-%u] GET %s id=%08x "
+                             "status=%u latency=%ums\n",
+                             i / 60000 % 60, i / 1000 % 60, i % 1000,
+                             failed ? "ERROR" : levels[gen() % 3],
+                             static_cast<unsigned>(gen() % 16), paths[gen() % 4],
+                             static_cast<unsigned>(gen()), failed ? 503u : 200u,
+                             static_cast<unsigned>(gen() % 900));
+    s.append(line, static_cast<size_t>(len));
+  }
+  return s;
+}
+
+// every failed request in the log, a rare needle with many partial matches on "status="
+template <typename Str>
+void BM_log_find(benchmark::State& state) {
+  const auto text = log_text(static_cast<size_t>(state.range(0)));
+  const Str s(text.data(), text.size());
+
+  for (auto _ : state) {
+    size_t hits = 0;
+    for (auto pos = s.find("status=503"); pos != Str::npos; pos = s.find("status=503", pos + 1)) {
+      ++hits;
+    }
+    benchmark::DoNotOptimize(hits);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+// splits the log into lines with find(char)
+template <typename Str>
+void BM_log_find_char(benchmark::State& state) {
+  const auto text = log_text(static_cast<size_t>(state.range(0)));
+  const Str s(text.data(), text.size());
+
+  for (auto _ : state) {
+    size_t lines = 0;
+    for (auto pos = s.find('\n'); pos != Str::npos; pos = s.find('\n', pos + 1)) ++lines;
+    benchmark::DoNotOptimize(lines);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+// walks the log backwards from one ERROR line to the one before it
+template <typename Str>
+void BM_log_rfind(benchmark::State& state) {
+  const auto text = log_text(static_cast<size_t>(state.range(0)));
+  const Str s(text.data(), text.size());
+
+  for (auto _ : state) {
+    size_t hits = 0;
+    for (auto pos = s.rfind("ERROR"); pos != Str::npos && pos != 0;
+         pos = s.rfind("ERROR", pos - 1)) {
+      ++hits;
+    }
+    benchmark::DoNotOptimize(hits);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+// every key=value separator and field break of the log, from the back
+template <typename Str>
+void BM_log_find_last_of(benchmark::State& state) {
+  const auto text = log_text(static_cast<size_t>(state.range(0)));
+  const Str s(text.data(), text.size());
+
+  for (auto _ : state) {
+    size_t seps = 0;
+    for (auto pos = s.find_last_of("=["); pos != Str::npos && pos != 0;
+         pos = s.find_last_of("=[", pos - 1)) {
+      ++seps;
+    }
+    benchmark::DoNotOptimize(seps);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+// a large response assembled from many small pieces and flattened once at the end
+template <typename Builder>
+void BM_string_build_response(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto chunk = hf_bench::random_text<char>(48);
+  auto before = hf_bench::allocations();
+
+  for (auto _ : state) {
+    Builder b;
+    for (size_t i = 0; i < n; i += 48) b.append(chunk.data(), 48);
+    if constexpr (std::is_same<Builder, hf::string_builder>::value) {
+      auto s = b.to_string();
+      benchmark::DoNotOptimize(s.data());
+    } else {
+      benchmark::DoNotOptimize(b.data());
+    }
+  }
+  hf_bench::report_allocations(state, before);
+  state.SetBytesProcessed(state.iterations() * n);
+}
+
+// a whole file, from the page cache, into a fresh string
+template <typename Str>
+void BM_string_read_file(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto text = hf_bench::random_text<char>(n);
+  char path[] = "/tmp/hf_bench_XXXXXX";
+  auto fd = ::mkstemp(path);
+  if (fd < 0 || ::write(fd, text.data(), n) != static_cast<ssize_t>(n)) {
+    state.SkipWithError("cannot create the input file");
+    return;
+  }
+
+  for (auto _ : state) {
+    ::lseek(fd, 0, SEEK_SET);
+    Str s;
+    if constexpr (std::is_same<Str, hf::string>::value) {
+      s.read_from(fd, n);
+    } else {
+      s.resize(n);
+      s.resize(static_cast<size_t>(::read(fd, &s[0], n)));
+    }
+    benchmark::DoNotOptimize(s.data());
+  }
+  ::close(fd);
+  std::remove(path);
+  state.SetBytesProcessed(state.iterations() * n);
+}
+
+/* ------------------------------------------------------------------------- */
+
+#define HF_STRING_BENCH(func, ...)                           \
+  BENCHMARK_TEMPLATE(func, std::string)->__VA_ARGS__;        \
+  BENCHMARK_TEMPLATE(func, hf::string)->__VA_ARGS__;         \
+  BENCHMARK_TEMPLATE(func, std::wstring)->__VA_ARGS__;       \
+  BENCHMARK_TEMPLATE(func, hf::wstring)->__VA_ARGS__;        \
+  BENCHMARK_TEMPLATE(func, std::u16string)->__VA_ARGS__;     \
+  BENCHMARK_TEMPLATE(func, hf::u16string)->__VA_ARGS__;      \
+  BENCHMARK_TEMPLATE(func, std::u32string)->__VA_ARGS__;     \
+  BENCHMARK_TEMPLATE(func, hf::u32string)->__VA_ARGS__
+
+HF_STRING_BENCH(BM_string_construct, Arg(4)->Arg(16)->Arg(64)->Arg(1024));
+HF_STRING_BENCH(BM_string_copy, Arg(4)->Arg(16)->Arg(64)->Arg(1024));
+HF_STRING_BENCH(BM_string_append_char, Range(8, 1 << 14));
+HF_STRING_BENCH(BM_string_append_chunk, Range(64, 1 << 16));
+HF_STRING_BENCH(BM_string_compare, Range(16, 1 << 16));
+HF_STRING_BENCH(BM_string_find, Range(64, 1 << 20));
+HF_STRING_BENCH(BM_string_find_first_of, Range(64, 1 << 20));
+
+#define HF_LOG_BENCH(func)                                               \
+  BENCHMARK_TEMPLATE(func, std::string)->Range(1 << 12, 1 << 22);        \
+  BENCHMARK_TEMPLATE(func, std::string_view)->Range(1 << 12, 1 << 22);   \
+  BENCHMARK_TEMPLATE(func, hf::string)->Range(1 << 12, 1 << 22);         \
+  BENCHMARK_TEMPLATE(func, hf::string_view)->Range(1 << 12, 1 << 22)
+
+HF_LOG_BENCH(BM_log_find);
+HF_LOG_BENCH(BM_log_find_char);
+HF_LOG_BENCH(BM_log_rfind);
+HF_LOG_BENCH(BM_log_find_last_of);
+
+BENCHMARK_TEMPLATE(BM_string_build_response, std::string)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(BM_string_build_response, hf::string)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(BM_string_build_response, hf::string_builder)->Range(1 << 12, 1 << 24);
+
+BENCHMARK_TEMPLATE(BM_string_read_file, std::string)->Range(1 << 12, 1 << 24);
+BENCHMARK_TEMPLATE(BM_string_read_file, hf::string)->Range(1 << 12, 1 << 24);
+
+}  // namespace
@@ -0,0 +1,112 @@
+#include <random>
+
+#include "bench_util.hpp"
+#include "string.hpp"
+#include "utf.hpp"
+
+namespace {
+
+// UTF-16 as an upstream sends it, mostly ASCII with some Latin, CJK and emoji mixed in
+// when mixed is set
+hf::u16string make_utf16(size_t n, bool mixed) {
+  std::mt19937 gen(42);
+  hf::u16string s;
+  while (s.size() < n) {
+    auto r = gen() % 100;
+    if (!mixed || r < 80) {
+      s.append(1, static_cast<char16_t>('a' + gen() % 26));
+    } else if (r < 90) {
+      s.append(1, static_cast<char16_t>(0xE0 + gen() % 32));
+    } else if (r < 98) {
+      s.append(1, static_cast<char16_t>(0x4E00 + gen() % 0x5000));
+    } else {
+      s.append(1, u'\xD83D');
+      s.append(1, static_cast<char16_t>(0xDE00 + gen() % 0x40));
+    }
+  }
+  return s;
+}
+
+template <bool Mixed>
+void BM_utf16_to_utf8_scalar(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto in = make_utf16(n, Mixed);
+
+  for (auto _ : state) {
+    hf::string out;
+    if (hf::utf::detail::validate_utf16_scalar(in.data(), in.size())) {
+      auto len = hf::utf::detail::utf8_length_from_utf16_scalar(in.data(), in.size());
+      out.resize_and_overwrite(len, [&](char* buf, size_t) {
+        return hf::utf::detail::utf16_to_utf8_scalar(in.data(), in.size(), buf);
+      });
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetBytesProcessed(state.iterations() * in.size() * sizeof(char16_t));
+}
+
+template <bool Mixed>
+void BM_utf16_to_utf8(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto in = make_utf16(n, Mixed);
+
+  for (auto _ : state) {
+    hf::string out;
+    hf::append_utf8(out, in);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetBytesProcessed(state.iterations() * in.size() * sizeof(char16_t));
+}
+
+template <bool Mixed>
+void BM_utf8_to_utf16(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  hf::string in;
+  hf::append_utf8(in, make_utf16(n, Mixed));
+
+  for (auto _ : state) {
+    hf::u16string out;
+    hf::append_utf16(out, in);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetBytesProcessed(state.iterations() * in.size());
+}
+
+template <bool Mixed>
+void BM_utf8_validate_scalar(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  hf::string in;
+  hf::append_utf8(in, make_utf16(n, Mixed));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(hf::utf::detail::validate_utf8_scalar(in.data(), in.size()));
+  }
+  state.SetBytesProcessed(state.iterations() * in.size());
+}
+
+template <bool Mixed>
+void BM_utf8_validate(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  hf::string in;
+  hf::append_utf8(in, make_utf16(n, Mixed));
+
+  for (auto _ : state) benchmark::DoNotOptimize(hf::utf::validate_utf8(in.data(), in.size()));
+  state.SetBytesProcessed(state.iterations() * in.size());
+}
+
+/* ------------------------------------------------------------------------- */
+
+BENCHMARK_TEMPLATE(BM_utf16_to_utf8_scalar, false)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_utf16_to_utf8, false)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_utf16_to_utf8_scalar, true)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_utf16_to_utf8, true)->Range(64, 1 << 16);
+
+BENCHMARK_TEMPLATE(BM_utf8_to_utf16, false)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_utf8_to_utf16, true)->Range(64, 1 << 16);
+
+BENCHMARK_TEMPLATE(BM_utf8_validate_scalar, false)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_utf8_validate, false)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_utf8_validate_scalar, true)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_utf8_validate, true)->Range(64, 1 << 16);
+
+}  // namespace
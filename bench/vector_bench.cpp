@@ -0,0 +1,141 @@
+#include <string>
+#include <vector>
+
+#include "bench_util.hpp"
+#include "small_vector.hpp"
+#include "vector.hpp"
+
+namespace {
+
+template <typename T>
+T make_value(size_t i) {
+  if constexpr (std::is_same<T, std::string>::value) {
+    return std::string(24 + i % 8, static_cast<char>('a' + i % 26));
+  } else {
+    return static_cast<T>(i);
+  }
+}
+
+template <typename Vec>
+void BM_vector_push_back(benchmark::State& state) {
+  typedef typename std::decay<decltype(*std::declval<Vec>().begin())>::type value_type;
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto value = make_value<value_type>(0);
+  auto before = hf_bench::allocations();
+
+  for (auto _ : state) {
+    Vec v;
+    for (size_t i = 0; i < n; ++i) v.push_back(value);
+    benchmark::DoNotOptimize(v.data());
+  }
+  hf_bench::report_allocations(state, before);
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Vec>
+void BM_vector_push_back_reserved(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    Vec v;
+    v.reserve(n);
+    for (size_t i = 0; i < n; ++i) v.push_back(static_cast<int>(i));
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// inserts at the front, every insertion shifts the whole vector
+template <typename Vec>
+void BM_vector_insert_front(benchmark::State& state) {
+  typedef typename std::decay<decltype(*std::declval<Vec>().begin())>::type value_type;
+  const auto n = static_cast<size_t>(state.range(0));
+  const auto value = make_value<value_type>(1);
+
+  for (auto _ : state) {
+    Vec v;
+    for (size_t i = 0; i < n; ++i) v.insert(v.begin(), value);
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Vec>
+void BM_vector_erase_front(benchmark::State& state) {
+  typedef typename std::decay<decltype(*std::declval<Vec>().begin())>::type value_type;
+  const auto n = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    Vec v;
+    for (size_t i = 0; i < n; ++i) v.push_back(make_value<value_type>(i));
+    state.ResumeTiming();
+
+    while (!v.empty()) v.erase(v.begin());
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+template <typename Vec>
+void BM_vector_resize(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+
+  for (auto _ : state) {
+    Vec v;
+    v.resize(n);
+    v.resize(n / 2);
+    v.resize(n * 2);
+    benchmark::DoNotOptimize(v.data());
+  }
+  state.SetItemsProcessed(state.iterations() * n);
+}
+
+// the typical short-lived container, a handful of elements and then gone
+template <typename Vec>
+void BM_vector_small(benchmark::State& state) {
+  const auto n = static_cast<size_t>(state.range(0));
+  auto before = hf_bench::allocations();
+
+  for (auto _ : state) {
+    Vec v;
+    for (size_t i = 0; i < n; ++i) v.push_back(static_cast<int>(i));
+    benchmark::DoNotOptimize(v.data());
+  }
+  hf_bench::report_allocations(state, before);
+}
+
+/* ------------------------------------------------------------------------- */
+
+BENCHMARK_TEMPLATE(BM_vector_push_back, std::vector<int>)->Range(8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_vector_push_back, hf::vector<int>)->Range(8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_vector_push_back, std::vector<std::string>)->Range(8, 1 << 12);
+BENCHMARK_TEMPLATE(BM_vector_push_back, hf::vector<std::string>)->Range(8, 1 << 12);
+
+BENCHMARK_TEMPLATE(BM_vector_push_back, hf::vector<int, hf::allocator<int>, hf::growth_2x>)
+    ->Range(8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_vector_push_back,
+                   hf::vector<int, hf::allocator<int>, hf::size_class_growth<>>)
+    ->Range(8, 1 << 16);
+
+BENCHMARK_TEMPLATE(BM_vector_push_back_reserved, std::vector<int>)->Range(8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_vector_push_back_reserved, hf::vector<int>)->Range(8, 1 << 16);
+
+BENCHMARK_TEMPLATE(BM_vector_insert_front, std::vector<int>)->Range(8, 1 << 10);
+BENCHMARK_TEMPLATE(BM_vector_insert_front, hf::vector<int>)->Range(8, 1 << 10);
+BENCHMARK_TEMPLATE(BM_vector_insert_front, std::vector<std::string>)->Range(8, 1 << 10);
+BENCHMARK_TEMPLATE(BM_vector_insert_front, hf::vector<std::string>)->Range(8, 1 << 10);
+
+BENCHMARK_TEMPLATE(BM_vector_erase_front, std::vector<int>)->Range(8, 1 << 10);
+BENCHMARK_TEMPLATE(BM_vector_erase_front, hf::vector<int>)->Range(8, 1 << 10);
+BENCHMARK_TEMPLATE(BM_vector_erase_front, std::vector<std::string>)->Range(8, 1 << 10);
+BENCHMARK_TEMPLATE(BM_vector_erase_front, hf::vector<std::string>)->Range(8, 1 << 10);
+
+BENCHMARK_TEMPLATE(BM_vector_resize, std::vector<int>)->Range(8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_vector_resize, hf::vector<int>)->Range(8, 1 << 16);
+
+BENCHMARK_TEMPLATE(BM_vector_small, std::vector<int>)->DenseRange(0, 8, 2);
+BENCHMARK_TEMPLATE(BM_vector_small, hf::vector<int>)->DenseRange(0, 8, 2);
+BENCHMARK_TEMPLATE(BM_vector_small, hf::small_vector<int, 8>)->DenseRange(0, 8, 2);
+
+}  // namespace
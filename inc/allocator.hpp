@@ -4,12 +4,22 @@
 #include <cassert>
 #include <cstddef>
 #include <memory>
+#include <utility>
+
+#include "type_traits.hpp"
 
 namespace hf {
 
 template <typename T>
 class allocator {
  public:
+  typedef T value_type;
+
+  allocator() noexcept = default;
+
+  template <typename U>
+  allocator(const allocator<U>&) noexcept {}
+
   static T* allocate() noexcept;
   static T* allocate(size_t n) noexcept;
 
@@ -20,6 +30,9 @@ class allocator {
   static void construct(T* ptr, const T& value) noexcept;
   static void construct(T* ptr, T&& value) noexcept;
 
+  template <typename... Args>
+  static void construct(T* ptr, Args&&... args) noexcept;
+
   static void destroy(T* ptr) noexcept;
   static void destroy(T* first, T* last) noexcept;
 };
@@ -59,6 +72,12 @@ void allocator<T>::construct(T* ptr, T&& value) noexcept {
   ::new ((void*)ptr) T(std::move(value));
 };
 
+template <typename T>
+template <typename... Args>
+void allocator<T>::construct(T* ptr, Args&&... args) noexcept {
+  ::new ((void*)ptr) T(std::forward<Args>(args)...);
+};
+
 template <typename T>
 void allocator<T>::destroy(T* ptr) noexcept {
   if (ptr != nullptr) ptr->~T();
@@ -69,4 +88,149 @@ void allocator<T>::destroy(T* first, T* last) noexcept {
   while (first != last) destroy(first++);
 }
 
+template <typename T, typename U>
+bool operator==(const allocator<T>&, const allocator<U>&) noexcept {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const allocator<T>&, const allocator<U>&) noexcept {
+  return false;
+}
+
+/* ------------------------------------------------------------------------- */
+
+namespace detail {
+
+template <typename Alloc, typename = void>
+struct alloc_pocca : public false_type {};
+
+template <typename Alloc>
+struct alloc_pocca<Alloc, std::void_t<typename Alloc::propagate_on_container_copy_assignment>>
+    : public integral_constant<bool, Alloc::propagate_on_container_copy_assignment::value> {};
+
+template <typename Alloc, typename = void>
+struct alloc_pocma : public false_type {};
+
+template <typename Alloc>
+struct alloc_pocma<Alloc, std::void_t<typename Alloc::propagate_on_container_move_assignment>>
+    : public integral_constant<bool, Alloc::propagate_on_container_move_assignment::value> {};
+
+template <typename Alloc, typename = void>
+struct alloc_pocs : public false_type {};
+
+template <typename Alloc>
+struct alloc_pocs<Alloc, std::void_t<typename Alloc::propagate_on_container_swap>>
+    : public integral_constant<bool, Alloc::propagate_on_container_swap::value> {};
+
+template <typename Alloc, typename = void>
+struct alloc_always_equal : public integral_constant<bool, std::is_empty<Alloc>::value> {};
+
+template <typename Alloc>
+struct alloc_always_equal<Alloc, std::void_t<typename Alloc::is_always_equal>>
+    : public integral_constant<bool, Alloc::is_always_equal::value> {};
+
+template <typename Alloc, typename = void>
+struct alloc_has_soccc : public false_type {};
+
+template <typename Alloc>
+struct alloc_has_soccc<Alloc, std::void_t<decltype(std::declval<const Alloc&>()
+                                                       .select_on_container_copy_construction())>>
+    : public true_type {};
+
+template <typename Alloc, typename Ptr, typename = void, typename... Args>
+struct alloc_has_construct : public false_type {};
+
+template <typename Alloc, typename Ptr, typename... Args>
+struct alloc_has_construct<
+    Alloc, Ptr,
+    std::void_t<decltype(std::declval<Alloc&>().construct(std::declval<Ptr>(),
+                                                          std::declval<Args>()...))>,
+    Args...> : public true_type {};
+
+}  // namespace detail
+
+// uniform access to the allocator model used by the containers, an allocator only has to
+// provide allocate(n) and deallocate(p, n), everything else has a default
+template <typename Alloc>
+struct allocator_traits {
+  typedef Alloc allocator_type;
+  typedef typename Alloc::value_type value_type;
+  typedef value_type* pointer;
+
+  typedef detail::alloc_pocca<Alloc> propagate_on_container_copy_assignment;
+  typedef detail::alloc_pocma<Alloc> propagate_on_container_move_assignment;
+  typedef detail::alloc_pocs<Alloc> propagate_on_container_swap;
+  typedef detail::alloc_always_equal<Alloc> is_always_equal;
+
+  static pointer allocate(Alloc& a, size_t n) noexcept { return a.allocate(n); }
+
+  static void deallocate(Alloc& a, pointer ptr, size_t n) noexcept { a.deallocate(ptr, n); }
+
+  template <typename... Args>
+  static void construct(Alloc& a, pointer ptr, Args&&... args) noexcept {
+    if constexpr (detail::alloc_has_construct<Alloc, pointer, void, Args...>::value) {
+      a.construct(ptr, std::forward<Args>(args)...);
+    } else {
+      ::new ((void*)ptr) value_type(std::forward<Args>(args)...);
+    }
+  }
+
+  static void destroy(Alloc&, pointer ptr) noexcept { ptr->~value_type(); }
+
+  static void destroy(Alloc& a, pointer first, pointer last) noexcept {
+    if constexpr (!std::is_trivially_destructible<value_type>::value) {
+      while (first != last) destroy(a, first++);
+    }
+  }
+
+  static Alloc select_on_container_copy_construction(const Alloc& a) noexcept {
+    if constexpr (detail::alloc_has_soccc<Alloc>::value) {
+      return a.select_on_container_copy_construction();
+    } else {
+      return a;
+    }
+  }
+
+  static bool equal(const Alloc& a, const Alloc& b) noexcept {
+    if constexpr (is_always_equal::value) {
+      return true;
+    } else {
+      return a == b;
+    }
+  }
+};
+
+// stores the allocator of a container, empty allocators take no space
+template <typename Alloc, bool = std::is_empty<Alloc>::value && !std::is_final<Alloc>::value>
+class alloc_holder : private Alloc {
+ protected:
+  alloc_holder() noexcept = default;
+
+  explicit alloc_holder(const Alloc& a) noexcept : Alloc(a) {}
+
+  explicit alloc_holder(Alloc&& a) noexcept : Alloc(std::move(a)) {}
+
+  Alloc& _alloc() noexcept { return *this; }
+
+  const Alloc& _alloc() const noexcept { return *this; }
+};
+
+template <typename Alloc>
+class alloc_holder<Alloc, false> {
+ protected:
+  alloc_holder() noexcept = default;
+
+  explicit alloc_holder(const Alloc& a) noexcept : _a(a) {}
+
+  explicit alloc_holder(Alloc&& a) noexcept : _a(std::move(a)) {}
+
+  Alloc& _alloc() noexcept { return _a; }
+
+  const Alloc& _alloc() const noexcept { return _a; }
+
+ private:
+  Alloc _a;
+};
+
 }  // namespace hf
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "allocator.hpp"
+
+namespace hf {
+
+// monotonic bump allocator, memory is handed out from a chain of blocks and only
+// given back all at once, either by reset() which keeps the blocks for reuse or by
+// release()/destruction which returns the heap blocks to the system
+class arena {
+ public:
+  static constexpr size_t BLOCK_SIZE = 4096;
+  static constexpr size_t MAX_BLOCK_SIZE = 1024 * 1024;
+
+  arena() noexcept = default;
+
+  // the caller's buffer (typically on the stack) is used before any heap block
+  arena(void* buffer, size_t size) noexcept;
+
+  arena(const arena&) = delete;
+
+  arena& operator=(const arena&) = delete;
+
+  ~arena() { release(); }
+
+ public:
+  void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) noexcept;
+
+  void reset() noexcept;
+
+  void release() noexcept;
+
+  size_t used() const noexcept { return _used; }
+
+  // arena the arena_alloc family allocates from on this thread, see arena_scope
+  static arena*& current() noexcept {
+    static thread_local arena* cur = nullptr;
+    return cur;
+  }
+
+ private:
+  struct block {
+    block* next;
+    size_t size;
+    bool owned;
+  };
+
+  static constexpr size_t HEADER_SIZE =
+      (sizeof(block) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+
+  void* allocate_slow(size_t bytes, size_t align) noexcept;
+
+  void enter(block* b) noexcept {
+    _current = b;
+    _ptr = reinterpret_cast<char*>(b) + HEADER_SIZE;
+    _end = reinterpret_cast<char*>(b) + b->size;
+  }
+
+  block* _head = nullptr;
+  block* _current = nullptr;
+  char* _ptr = nullptr;
+  char* _end = nullptr;
+  size_t _used = 0;
+  size_t _next_size = BLOCK_SIZE;
+};
+
+inline arena::arena(void* buffer, size_t size) noexcept {
+  constexpr uintptr_t align = alignof(std::max_align_t);
+  auto addr = reinterpret_cast<uintptr_t>(buffer);
+  auto aligned = (addr + align - 1) & ~(align - 1);
+  if (buffer == nullptr || size < aligned - addr + HEADER_SIZE) return;
+
+  _head = reinterpret_cast<block*>(aligned);
+  _head->next = nullptr;
+  _head->size = size - (aligned - addr);
+  _head->owned = false;
+  enter(_head);
+}
+
+inline void* arena::allocate(size_t bytes, size_t align) noexcept {
+  auto p = reinterpret_cast<uintptr_t>(_ptr);
+  auto aligned = (p + align - 1) & ~(uintptr_t(align) - 1);
+
+  if (_ptr == nullptr || aligned + bytes > reinterpret_cast<uintptr_t>(_end)) {
+    return allocate_slow(bytes, align);
+  }
+
+  _ptr = reinterpret_cast<char*>(aligned + bytes);
+  _used += bytes;
+  return reinterpret_cast<void*>(aligned);
+}
+
+inline void* arena::allocate_slow(size_t bytes, size_t align) noexcept {
+  // blocks kept by reset() are reused in order before anything new is allocated
+  while (_current != nullptr && _current->next != nullptr) {
+    enter(_current->next);
+    auto p = reinterpret_cast<uintptr_t>(_ptr);
+    auto aligned = (p + align - 1) & ~(uintptr_t(align) - 1);
+    if (aligned + bytes <= reinterpret_cast<uintptr_t>(_end)) return allocate(bytes, align);
+  }
+
+  auto need = HEADER_SIZE + bytes + align;
+  auto size = need > _next_size ? need : _next_size;
+  if (_next_size < MAX_BLOCK_SIZE) _next_size <<= 1;
+
+  auto b = static_cast<block*>(::operator new(size));
+  b->next = nullptr;
+  b->size = size;
+  b->owned = true;
+
+  if (_current == nullptr) {
+    _head = b;
+  } else {
+    _current->next = b;
+  }
+  enter(b);
+
+  return allocate(bytes, align);
+}
+
+inline void arena::reset() noexcept {
+  _used = 0;
+  if (_head == nullptr) return;
+  enter(_head);
+}
+
+inline void arena::release() noexcept {
+  block* keep = nullptr;
+
+  for (auto b = _head; b != nullptr;) {
+    auto next = b->next;
+    if (b->owned) {
+      ::operator delete(b);
+    } else {
+      keep = b;
+      keep->next = nullptr;
+    }
+    b = next;
+  }
+
+  _head = _current = keep;
+  _ptr = _end = nullptr;
+  _used = 0;
+  _next_size = BLOCK_SIZE;
+  if (keep != nullptr) enter(keep);
+}
+
+/* ------------------------------------------------------------------------- */
+
+// installs an arena as arena::current() for the lifetime of the scope
+class arena_scope {
+ public:
+  explicit arena_scope(arena& a) noexcept : _prev(arena::current()) { arena::current() = &a; }
+
+  arena_scope(const arena_scope&) = delete;
+
+  arena_scope& operator=(const arena_scope&) = delete;
+
+  ~arena_scope() { arena::current() = _prev; }
+
+ private:
+  arena* _prev;
+};
+
+// allocates from an arena, deallocate is a no-op and memory comes back when the arena is
+// reset, containers using it must not outlive that. A default constructed arena_alloc
+// binds to arena::current()
+template <typename T>
+class arena_alloc : public hf::allocator<T> {
+ public:
+  typedef T value_type;
+
+  arena_alloc() noexcept : _arena(arena::current()) {}
+
+  arena_alloc(arena& a) noexcept : _arena(&a) {}
+
+  template <typename U>
+  arena_alloc(const arena_alloc<U>& rhs) noexcept : _arena(rhs.get_arena()) {}
+
+  T* allocate() noexcept { return allocate(1); }
+
+  T* allocate(size_t n) noexcept {
+    assert(_arena != nullptr);
+    if (n == 0) return nullptr;
+    return static_cast<T*>(_arena->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T*) noexcept {}
+
+  void deallocate(T*, size_t) noexcept {}
+
+  arena* get_arena() const noexcept { return _arena; }
+
+ private:
+  arena* _arena;
+};
+
+template <typename T, typename U>
+bool operator==(const arena_alloc<T>& lhs, const arena_alloc<U>& rhs) noexcept {
+  return lhs.get_arena() == rhs.get_arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const arena_alloc<T>& lhs, const arena_alloc<U>& rhs) noexcept {
+  return !(lhs == rhs);
+}
+
+}  // namespace hf
@@ -1,10 +1,24 @@
 #pragma once
 
+#include <cerrno>
 #include <cstring>
 #include <cwchar>
 #include <iostream>
 
+#if defined(__unix__) || defined(__APPLE__)
+#define HF_HAS_POSIX_IO 1
+#include <unistd.h>
+#endif
+
 #include "allocator.hpp"
+#include "charconv.hpp"
+#include "container_stats.hpp"
+#include "growth_policy.hpp"
+#include "hash.hpp"
+#include "simd.hpp"
+#include "string_search.hpp"
+#include "string_view.hpp"
+#include "type_traits.hpp"
 
 namespace hf {
 template <typename CharType>
@@ -49,6 +63,13 @@ struct char_traits {
     while (count--) *dst++ = ch;
     return r;
   }
+
+  static const char_type* find(const char_type* s, size_t n, const char_type& ch) {
+    for (; n != 0; --n, ++s) {
+      if (*s == ch) return s;
+    }
+    return nullptr;
+  }
 };
 
 template <>
@@ -73,6 +94,10 @@ struct char_traits<char> {
   static char_type* fill(char_type* dst, char_type ch, size_t count) noexcept {
     return static_cast<char_type*>(std::memset(dst, ch, count));
   }
+
+  static const char_type* find(const char_type* s, size_t n, const char_type& ch) noexcept {
+    return n == 0 ? nullptr : static_cast<const char_type*>(std::memchr(s, ch, n));
+  }
 };
 
 template <>
@@ -97,49 +122,40 @@ struct char_traits<wchar_t> {
   static char_type* fill(char_type* dst, char_type ch, size_t count) noexcept {
     return static_cast<char_type*>(std::wmemset(dst, ch, count));
   }
+
+  static const char_type* find(const char_type* s, size_t n, const char_type& ch) noexcept {
+    return n == 0 ? nullptr : std::wmemchr(s, ch, n);
+  }
 };
 
 template <>
 struct char_traits<char16_t> {
   typedef char16_t char_type;
 
-  static size_t length(const char_type* str) {
-    size_t len = 0;
-    while (*str++ != char_type(0)) ++len;
-    return len;
-  }
+  static size_t length(const char_type* str) noexcept { return simd::length(str); }
 
-  static int compare(const char_type* s1, const char_type* s2, size_t n) {
-    for (; n != 0; --n, ++s1, ++s2) {
-      if (*s1 < *s2) return -1;
-      if (*s1 > *s2) return 1;
-    }
-    return 0;
+  static int compare(const char_type* s1, const char_type* s2, size_t n) noexcept {
+    auto i = simd::mismatch(s1, s2, n);
+    if (i == n) return 0;
+    return s1[i] < s2[i] ? -1 : 1;
   }
 
-  static char_type* copy(char_type* dst, const char_type* src, size_t n) {
+  static char_type* copy(char_type* dst, const char_type* src, size_t n) noexcept {
     assert(src + n <= dst || dst + n <= src);
-
-    char_type* r = dst;
-    while (n--) *dst++ = *src++;
-    return r;
+    return static_cast<char_type*>(std::memcpy(dst, src, n * sizeof(char_type)));
   }
 
-  static char_type* move(char_type* dst, const char_type* src, size_t n) {
-    char_type* r = dst;
-
-    if (dst < src)
-      while (n--) *dst++ = *src++;
-    else if (dst > src)
-      for (dst += n, src += n; n; --n) *--dst = *--src;
+  static char_type* move(char_type* dst, const char_type* src, size_t n) noexcept {
+    return static_cast<char_type*>(std::memmove(dst, src, n * sizeof(char_type)));
+  }
 
-    return r;
+  static char_type* fill(char_type* dst, char_type ch, size_t count) noexcept {
+    simd::fill(dst, ch, count);
+    return dst;
   }
 
-  static char_type* fill(char_type* dst, char_type ch, size_t count) {
-    char_type* r = dst;
-    while (count--) *dst++ = ch;
-    return r;
+  static const char_type* find(const char_type* s, size_t n, const char_type& ch) noexcept {
+    return simd::find(s, n, ch);
   }
 };
 
@@ -147,50 +163,38 @@ template <>
 struct char_traits<char32_t> {
   typedef char32_t char_type;
 
-  static size_t length(const char_type* str) {
-    size_t len = 0;
-    while (*str++ != char_type(0)) ++len;
-    return len;
-  }
+  static size_t length(const char_type* str) noexcept { return simd::length(str); }
 
-  static int compare(const char_type* s1, const char_type* s2, size_t n) {
-    for (; n != 0; --n, ++s1, ++s2) {
-      if (*s1 < *s2) return -1;
-      if (*s1 > *s2) return 1;
-    }
-    return 0;
+  static int compare(const char_type* s1, const char_type* s2, size_t n) noexcept {
+    auto i = simd::mismatch(s1, s2, n);
+    if (i == n) return 0;
+    return s1[i] < s2[i] ? -1 : 1;
   }
 
-  static char_type* copy(char_type* dst, const char_type* src, size_t n) {
+  static char_type* copy(char_type* dst, const char_type* src, size_t n) noexcept {
     assert(src + n <= dst || dst + n <= src);
-
-    char_type* r = dst;
-    while (n--) *dst++ = *src++;
-    return r;
+    return static_cast<char_type*>(std::memcpy(dst, src, n * sizeof(char_type)));
   }
 
-  static char_type* move(char_type* dst, const char_type* src, size_t n) {
-    char_type* r = dst;
-
-    if (dst < src)
-      while (n--) *dst++ = *src++;
-    else if (dst > src)
-      for (dst += n, src += n; n; --n) *--dst = *--src;
+  static char_type* move(char_type* dst, const char_type* src, size_t n) noexcept {
+    return static_cast<char_type*>(std::memmove(dst, src, n * sizeof(char_type)));
+  }
 
-    return r;
+  static char_type* fill(char_type* dst, char_type ch, size_t count) noexcept {
+    simd::fill(dst, ch, count);
+    return dst;
   }
 
-  static char_type* fill(char_type* dst, char_type ch, size_t count) {
-    char_type* r = dst;
-    while (count--) *dst++ = ch;
-    return r;
+  static const char_type* find(const char_type* s, size_t n, const char_type& ch) noexcept {
+    return simd::find(s, n, ch);
   }
 };
 
-template <typename CharType, typename CharTraits = hf::char_traits<CharType>>
-class basic_string {
+template <typename CharType, typename CharTraits = hf::char_traits<CharType>,
+          typename Alloc = hf::allocator<CharType>, typename Growth = hf::growth_1_5x>
+class basic_string : private hf::alloc_holder<Alloc> {
  public:
-  typedef hf::allocator<CharType> Alloc;
+  typedef Alloc allocator_type;
 
   typedef CharTraits char_traits;
 
@@ -203,55 +207,130 @@ class basic_string {
   typedef CharType& reference;
   typedef const CharType& const_reference;
 
+  typedef hf::basic_string_view<CharType, CharTraits> view_type;
+
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
  private:
-  iterator _buffer;
-  size_t _size;
-  size_t _cap;
+  typedef hf::alloc_holder<Alloc> holder;
+  typedef hf::allocator_traits<Alloc> alloc_traits;
+
+  using holder::_alloc;
+
+  struct long_rep {
+    pointer _buffer;
+    size_t _size;
+    size_t _cap;
+  };
+
+  // short strings live inline in the footprint of long_rep, the last slot stores
+  // SSO_CAPACITY - size, so it doubles as the terminator when the inline buffer is full
+  static constexpr size_t SSO_CAPACITY = sizeof(long_rep) / sizeof(value_type) - 1;
+
+  struct short_rep {
+    value_type _data[SSO_CAPACITY + 1];
+  };
+
+  static_assert(sizeof(long_rep) % sizeof(value_type) == 0, "char type must divide long_rep");
+  static_assert(sizeof(short_rep) == sizeof(long_rep), "short_rep must overlay long_rep");
 
-  static constexpr size_t STRING_INIT_SIZE = 16;
+  // the top bit of the last byte tells the two layouts apart, it is never set by the
+  // spare count of a short string and always set in the encoded capacity of a long one
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  static constexpr size_t encode_cap(size_t n) noexcept { return (n << 8) | 0x80; }
+
+  static constexpr size_t decode_cap(size_t n) noexcept { return n >> 8; }
+#else
+  static constexpr size_t LONG_FLAG = static_cast<size_t>(1) << (sizeof(size_t) * 8 - 1);
+
+  static constexpr size_t encode_cap(size_t n) noexcept { return n | LONG_FLAG; }
+
+  static constexpr size_t decode_cap(size_t n) noexcept { return n & ~LONG_FLAG; }
+#endif
+
+  union {
+    long_rep _l;
+    short_rep _s;
+  };
 
  public:
   basic_string() noexcept { _init(); }
 
-  basic_string(const_pointer str) { init_from(str, 0, char_traits::length(str)); }
+  explicit basic_string(const Alloc& alloc) noexcept : holder(alloc) { _init(); }
+
+  basic_string(const_pointer str, const Alloc& alloc = Alloc()) : holder(alloc) {
+    init_from(str, 0, char_traits::length(str));
+  }
+
+  basic_string(const_pointer str, size_t count, const Alloc& alloc = Alloc()) : holder(alloc) {
+    init_from(str, 0, count);
+  }
+
+  explicit basic_string(view_type sv, const Alloc& alloc = Alloc()) : holder(alloc) {
+    init_from(sv.data(), 0, sv.size());
+  }
+
+  basic_string(const basic_string& rhs)
+      : holder(alloc_traits::select_on_container_copy_construction(rhs._alloc())) {
+    init_from(rhs.data(), 0, rhs.size());
+  }
+
+  basic_string(const basic_string& rhs, const Alloc& alloc) : holder(alloc) {
+    init_from(rhs.data(), 0, rhs.size());
+  }
+
+  basic_string(basic_string&& rhs) noexcept : holder(std::move(rhs._alloc())) {
+    std::memcpy(static_cast<void*>(&_l), static_cast<const void*>(&rhs._l), sizeof(long_rep));
+    rhs._init();
+  }
+
+  basic_string& operator=(const basic_string& rhs) noexcept;
+
+  basic_string& operator=(basic_string&& rhs) noexcept;
 
   ~basic_string() { destroy_buffer(); }
 
  public:
-  iterator begin() noexcept { return _buffer; }
+  iterator begin() noexcept { return _data(); }
+
+  iterator end() noexcept { return _data() + size(); }
 
-  iterator end() noexcept { return _buffer + _size; }
+  const_iterator begin() const noexcept { return _data(); }
 
-  const_iterator begin() const noexcept { return _buffer; }
+  const_iterator end() const noexcept { return _data() + size(); }
 
-  const_iterator end() const noexcept { return _buffer + _size; }
+  const_iterator cbegin() const noexcept { return _data(); }
 
-  const_iterator cbegin() const noexcept { return _buffer; }
+  const_iterator cend() const noexcept { return _data() + size(); }
 
-  const_iterator cend() const noexcept { return _buffer + _size; }
+  allocator_type get_allocator() const noexcept { return _alloc(); }
 
   /* ------------------------------------------------------------------------- */
 
-  bool empty() const noexcept { return _size == 0; }
+  bool empty() const noexcept { return size() == 0; }
 
-  size_t size() const noexcept { return _size; }
+  size_t size() const noexcept {
+    return is_long() ? _l._size : short_size();
+  }
 
-  size_t length() const noexcept { return _size; }
+  size_t length() const noexcept { return size(); }
 
-  size_t capacity() const noexcept { return _cap; }
+  size_t capacity() const noexcept { return is_long() ? decode_cap(_l._cap) : SSO_CAPACITY + 1; }
 
-  size_t max_size() const noexcept { return static_cast<size_t>(-1); }
+  size_t max_size() const noexcept {
+    return decode_cap(static_cast<size_t>(-1)) / sizeof(value_type);
+  }
 
   /* ------------------------------------------------------------------------- */
 
   reference operator[](size_t n) {
-    assert(n <= _size);
-    return *(_buffer + n);
+    assert(n <= size());
+    return *(_data() + n);
   }
 
   const_reference operator[](size_t n) const {
-    assert(n <= _size);
-    return *(_buffer + n);
+    assert(n <= size());
+    return *(_data() + n);
   }
 
   reference front() noexcept {
@@ -274,9 +353,18 @@ class basic_string {
     return *(end() - 1);
   }
 
-  const_pointer data() const noexcept { return _buffer; }
+  const_pointer data() const noexcept { return _data(); }
+
+  const_pointer c_str() const noexcept { return _data(); }
+
+  operator view_type() const noexcept { return view_type(data(), size()); }
 
-  const_pointer c_str() const noexcept { return _buffer; }
+  // the view borrows this string's buffer, it is invalidated by anything that reallocates
+  view_type substr(size_t pos, size_t count = npos) const noexcept {
+    return view_type(*this).substr(pos, count);
+  }
+
+  int compare(view_type sv) const noexcept { return view_type(*this).compare(sv); }
 
   /* ------------------------------------------------------------------------- */
 
@@ -286,50 +374,334 @@ class basic_string {
 
   basic_string& append(const_pointer s, size_t count) noexcept;
 
+  basic_string& append(view_type sv) noexcept { return append(sv.data(), sv.size()); }
+
+  // decimal, formatted straight into the buffer
+  template <typename T>
+  basic_string& append_int(T value) noexcept {
+    static_assert(std::is_integral<T>::value, "append_int needs an integral type");
+    return append_number(value, detail::MAX_INT_CHARS);
+  }
+
+  // the shortest digits that read back to the same value, see hf::to_chars
+  basic_string& append_double(double value) noexcept {
+    return append_number(value, detail::MAX_DOUBLE_CHARS);
+  }
+
+  // the whole string as one number in the format of hf::from_chars, value is left
+  // untouched and false returned if that fails
+  template <typename T>
+  bool parse(T& value) const noexcept;
+
+  void swap(basic_string& rhs) noexcept;
+
+  void reserve(size_t n) noexcept {
+    assert(n < max_size());
+    if (n >= capacity()) reallocate_to(n + 1);
+  }
+
+  void shrink_to_fit() noexcept;
+
+  // sets the size to n and lets op(pointer, n) write the contents in place, op returns the
+  // final size, at most n. Characters past the old size are uninitialized when op runs
+  template <typename Op>
+  void resize_and_overwrite(size_t n, Op op);
+
+#ifdef HF_HAS_POSIX_IO
+  // appends what a single read of up to n bytes from fd returns, straight into spare
+  // capacity, the count read, 0 at end of file or -1 with errno set
+  ssize_t read_from(int fd, size_t n) noexcept;
+
+  // writes the whole string to fd, resuming after short writes, false on error with errno set
+  bool write_to(int fd) const noexcept;
+#endif
+
+  /* ------------------------------------------------------------------------- */
+
+  size_t find(value_type ch, size_t pos = 0) const noexcept {
+    return detail::str_find<char_traits>(data(), size(), ch, pos);
+  }
+
+  size_t find(const_pointer s, size_t pos, size_t count) const noexcept {
+    return detail::str_find<char_traits>(data(), size(), s, pos, count);
+  }
+
+  size_t find(const_pointer s, size_t pos = 0) const noexcept {
+    return find(s, pos, char_traits::length(s));
+  }
+
+  size_t find(view_type sv, size_t pos = 0) const noexcept {
+    return find(sv.data(), pos, sv.size());
+  }
+
+  size_t rfind(value_type ch, size_t pos = npos) const noexcept {
+    return detail::str_rfind<char_traits>(data(), size(), ch, pos);
+  }
+
+  size_t rfind(const_pointer s, size_t pos, size_t count) const noexcept {
+    return detail::str_rfind<char_traits>(data(), size(), s, pos, count);
+  }
+
+  size_t rfind(const_pointer s, size_t pos = npos) const noexcept {
+    return rfind(s, pos, char_traits::length(s));
+  }
+
+  size_t rfind(view_type sv, size_t pos = npos) const noexcept {
+    return rfind(sv.data(), pos, sv.size());
+  }
+
+  size_t find_first_of(value_type ch, size_t pos = 0) const noexcept { return find(ch, pos); }
+
+  size_t find_first_of(const_pointer s, size_t pos, size_t count) const noexcept {
+    return detail::str_find_first_of<char_traits>(data(), size(), s, pos, count);
+  }
+
+  size_t find_first_of(const_pointer s, size_t pos = 0) const noexcept {
+    return find_first_of(s, pos, char_traits::length(s));
+  }
+
+  size_t find_first_of(view_type sv, size_t pos = 0) const noexcept {
+    return find_first_of(sv.data(), pos, sv.size());
+  }
+
+  size_t find_last_of(value_type ch, size_t pos = npos) const noexcept { return rfind(ch, pos); }
+
+  size_t find_last_of(const_pointer s, size_t pos, size_t count) const noexcept {
+    return detail::str_find_last_of<char_traits>(data(), size(), s, pos, count);
+  }
+
+  size_t find_last_of(const_pointer s, size_t pos = npos) const noexcept {
+    return find_last_of(s, pos, char_traits::length(s));
+  }
+
+  size_t find_last_of(view_type sv, size_t pos = npos) const noexcept {
+    return find_last_of(sv.data(), pos, sv.size());
+  }
+
+  bool starts_with(value_type ch) const noexcept { return !empty() && front() == ch; }
+
+  bool starts_with(view_type sv) const noexcept { return view_type(*this).starts_with(sv); }
+
+  bool ends_with(value_type ch) const noexcept { return !empty() && back() == ch; }
+
+  bool ends_with(view_type sv) const noexcept { return view_type(*this).ends_with(sv); }
+
+  bool contains(value_type ch) const noexcept { return find(ch) != npos; }
+
+  bool contains(view_type sv) const noexcept { return find(sv) != npos; }
+
   /* ------------------------------------------------------------------------- */
 
+  // mixed comparisons against a view go through the view's own operators
+  friend bool operator==(const basic_string& lhs, const basic_string& rhs) noexcept {
+    return view_type(lhs) == view_type(rhs);
+  }
+
+  friend bool operator==(const basic_string& lhs, const_pointer rhs) noexcept {
+    return view_type(lhs) == view_type(rhs);
+  }
+
+  friend bool operator==(const_pointer lhs, const basic_string& rhs) noexcept {
+    return view_type(lhs) == view_type(rhs);
+  }
+
+  friend bool operator!=(const basic_string& lhs, const basic_string& rhs) noexcept {
+    return !(lhs == rhs);
+  }
+
+  friend bool operator!=(const basic_string& lhs, const_pointer rhs) noexcept {
+    return !(lhs == rhs);
+  }
+
+  friend bool operator!=(const_pointer lhs, const basic_string& rhs) noexcept {
+    return !(lhs == rhs);
+  }
+
+  friend bool operator<(const basic_string& lhs, const basic_string& rhs) noexcept {
+    return lhs.compare(rhs) < 0;
+  }
+
+  friend bool operator<(const basic_string& lhs, const_pointer rhs) noexcept {
+    return lhs.compare(rhs) < 0;
+  }
+
+  friend bool operator<(const_pointer lhs, const basic_string& rhs) noexcept {
+    return rhs.compare(lhs) > 0;
+  }
+
+  friend bool operator>(const basic_string& lhs, const basic_string& rhs) noexcept {
+    return lhs.compare(rhs) > 0;
+  }
+
+  friend bool operator>(const basic_string& lhs, const_pointer rhs) noexcept {
+    return lhs.compare(rhs) > 0;
+  }
+
+  friend bool operator>(const_pointer lhs, const basic_string& rhs) noexcept {
+    return rhs.compare(lhs) < 0;
+  }
+
+  friend bool operator<=(const basic_string& lhs, const basic_string& rhs) noexcept {
+    return !(lhs > rhs);
+  }
+
+  friend bool operator<=(const basic_string& lhs, const_pointer rhs) noexcept {
+    return !(lhs > rhs);
+  }
+
+  friend bool operator<=(const_pointer lhs, const basic_string& rhs) noexcept {
+    return !(lhs > rhs);
+  }
+
+  friend bool operator>=(const basic_string& lhs, const basic_string& rhs) noexcept {
+    return !(lhs < rhs);
+  }
+
+  friend bool operator>=(const basic_string& lhs, const_pointer rhs) noexcept {
+    return !(lhs < rhs);
+  }
+
+  friend bool operator>=(const_pointer lhs, const basic_string& rhs) noexcept {
+    return !(lhs < rhs);
+  }
+
   friend std::ostream& operator<<(std::ostream& os, const basic_string& str) {
-    for (size_t i = 0; i < str._size; ++i) os << *(str._buffer + i);
-    return os;
+    return os << view_type(str);
   }
 
  private:
+  bool is_long() const noexcept {
+    return (reinterpret_cast<const unsigned char*>(&_s)[sizeof(long_rep) - 1] & 0x80) != 0;
+  }
+
+  // the spare count is read unsigned and clamped so a signed char type never widens
+  // into a huge size, this also lets the compiler bound copies out of the inline buffer
+  size_t short_size() const noexcept {
+    typedef std::make_unsigned_t<value_type> slot_type;
+    auto spare = static_cast<size_t>(static_cast<slot_type>(_s._data[SSO_CAPACITY]));
+    return SSO_CAPACITY - (spare < SSO_CAPACITY ? spare : SSO_CAPACITY);
+  }
+
+  pointer _data() noexcept { return is_long() ? _l._buffer : _s._data; }
+
+  const_pointer _data() const noexcept { return is_long() ? _l._buffer : _s._data; }
+
+  void _set_size(size_t n) noexcept;
+
   void _init() noexcept;
 
-  void _init_tail() noexcept { *(_buffer + _size) = value_type(); };
+  void _init_tail() noexcept { *(_data() + size()) = value_type(); };
 
   void init_from(const_pointer src, size_t pos, size_t count) noexcept;
 
+  // replaces the contents with rhs's, keeping our allocator and reusing our buffer if it fits
+  void copy_contents(const basic_string& rhs) noexcept;
+
   size_t get_new_cap(size_t add_size) const noexcept;
 
-  void reallocate(size_t n) noexcept;
+  // both return the new buffer, the string is always long afterwards
+  pointer reallocate(size_t n) noexcept { return reallocate_to(get_new_cap(n)); }
+
+  pointer reallocate_to(size_t new_cap) noexcept;
+
+  template <typename T>
+  basic_string& append_number(T value, size_t max_chars) noexcept;
 
   void destroy_buffer() noexcept;
 };
 
-template <typename CharType, typename CharTraits>
-basic_string<CharType, CharTraits>& basic_string<CharType, CharTraits>::append(
-    size_t count, value_type ch) noexcept {
-  assert(_size <= max_size() - count);
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+basic_string<CharType, CharTraits, Alloc, Growth>&
+basic_string<CharType, CharTraits, Alloc, Growth>::operator=(const basic_string& rhs) noexcept {
+  if (this != &rhs) {
+    if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+      if (!alloc_traits::equal(_alloc(), rhs._alloc())) destroy_buffer();
+      _alloc() = rhs._alloc();
+    }
+    copy_contents(rhs);
+  }
+  return *this;
+}
+
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+basic_string<CharType, CharTraits, Alloc, Growth>&
+basic_string<CharType, CharTraits, Alloc, Growth>::operator=(basic_string&& rhs) noexcept {
+  if (this != &rhs) {
+    // a heap buffer can only be stolen if our allocator is able to release it
+    if constexpr (!alloc_traits::propagate_on_container_move_assignment::value) {
+      if (!alloc_traits::equal(_alloc(), rhs._alloc())) {
+        copy_contents(rhs);
+        rhs.destroy_buffer();
+        return *this;
+      }
+    }
+
+    destroy_buffer();
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+      _alloc() = std::move(rhs._alloc());
+    }
+    std::memcpy(static_cast<void*>(&_l), static_cast<const void*>(&rhs._l), sizeof(long_rep));
+    rhs._init();
+  }
+  return *this;
+}
+
+// both layouts are plain bytes without pointers into the object, so swapping the
+// representations swaps short and long strings alike
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+void basic_string<CharType, CharTraits, Alloc, Growth>::swap(basic_string& rhs) noexcept {
+  if (this != &rhs) {
+    if constexpr (alloc_traits::propagate_on_container_swap::value) {
+      std::swap(_alloc(), rhs._alloc());
+    } else {
+      assert(alloc_traits::equal(_alloc(), rhs._alloc()));
+    }
+    long_rep tmp;
+    std::memcpy(static_cast<void*>(&tmp), static_cast<const void*>(&_l), sizeof(long_rep));
+    std::memcpy(static_cast<void*>(&_l), static_cast<const void*>(&rhs._l), sizeof(long_rep));
+    std::memcpy(static_cast<void*>(&rhs._l), static_cast<const void*>(&tmp), sizeof(long_rep));
+  }
+}
+
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+void basic_string<CharType, CharTraits, Alloc, Growth>::copy_contents(
+    const basic_string& rhs) noexcept {
+  auto n = rhs.size();
+  if (n >= capacity()) {
+    destroy_buffer();
+    init_from(rhs.data(), 0, n);
+  } else {
+    char_traits::copy(_data(), rhs.data(), n);
+    _set_size(n);
+    _init_tail();
+  }
+}
+
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+basic_string<CharType, CharTraits, Alloc, Growth>&
+basic_string<CharType, CharTraits, Alloc, Growth>::append(size_t count, value_type ch) noexcept {
+  auto old_size = size();
+  assert(old_size <= max_size() - count);
 
-  if (_size + count >= _cap) reallocate(count);
+  auto buf = old_size + count >= capacity() ? reallocate(count) : _data();
 
-  char_traits::fill(_buffer + _size, ch, count);
-  _size += count;
+  char_traits::fill(buf + old_size, ch, count);
+  _set_size(old_size + count);
   _init_tail();
 
   return *this;
 }
 
-template <typename CharType, typename CharTraits>
-basic_string<CharType, CharTraits>& basic_string<CharType, CharTraits>::append(
-    const_pointer s, size_t count) noexcept {
-  assert(_size <= max_size() - count);
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+basic_string<CharType, CharTraits, Alloc, Growth>&
+basic_string<CharType, CharTraits, Alloc, Growth>::append(const_pointer s, size_t count) noexcept {
+  auto old_size = size();
+  assert(old_size <= max_size() - count);
 
-  if (_size + count >= _cap) reallocate(count);
+  auto buf = old_size + count >= capacity() ? reallocate(count) : _data();
 
-  char_traits::copy(_buffer + _size, s, count);
-  _size += count;
+  char_traits::copy(buf + old_size, s, count);
+  _set_size(old_size + count);
   _init_tail();
 
   return *this;
@@ -337,57 +709,208 @@ basic_string<CharType, CharTraits>& basic_string<CharType, CharTraits>::append(
 
 /* ------------------------------------------------------------------------- */
 
-template <typename CharType, typename CharTraits>
-void basic_string<CharType, CharTraits>::_init() noexcept {
-  _buffer = Alloc::allocate(STRING_INIT_SIZE);
-  _size = 0;
-  _cap = STRING_INIT_SIZE;
+// narrow strings are formatted in place, wider ones through a small char buffer
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+template <typename T>
+basic_string<CharType, CharTraits, Alloc, Growth>&
+basic_string<CharType, CharTraits, Alloc, Growth>::append_number(T value,
+                                                                 size_t max_chars) noexcept {
+  auto old_size = size();
+  assert(old_size <= max_size() - max_chars);
+
+  auto buf = old_size + max_chars >= capacity() ? reallocate(max_chars) : _data();
+  size_t n;
+  if constexpr (sizeof(value_type) == 1) {
+    auto first = reinterpret_cast<char*>(buf + old_size);
+    n = static_cast<size_t>(hf::to_chars(first, first + max_chars, value).ptr - first);
+  } else {
+    char tmp[32];
+    n = static_cast<size_t>(hf::to_chars(tmp, tmp + sizeof(tmp), value).ptr - tmp);
+    for (size_t i = 0; i < n; ++i) buf[old_size + i] = static_cast<value_type>(tmp[i]);
+  }
+  _set_size(old_size + n);
   _init_tail();
+  return *this;
+}
+
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+template <typename T>
+bool basic_string<CharType, CharTraits, Alloc, Growth>::parse(T& value) const noexcept {
+  auto n = size();
+  if constexpr (sizeof(value_type) == 1) {
+    auto first = reinterpret_cast<const char*>(data());
+    auto r = hf::from_chars(first, first + n, value);
+    return r.ec == std::errc() && r.ptr == first + n;
+  } else {
+    // anything longer or outside ASCII is not a number in this format anyway
+    char tmp[128];
+    if (n > sizeof(tmp)) return false;
+    for (size_t i = 0; i < n; ++i) {
+      auto ch = data()[i];
+      if (ch < 0 || ch > 127) return false;
+      tmp[i] = static_cast<char>(ch);
+    }
+    auto r = hf::from_chars(tmp, tmp + n, value);
+    return r.ec == std::errc() && r.ptr == tmp + n;
+  }
 }
 
-template <typename CharType, typename CharTraits>
-void basic_string<CharType, CharTraits>::init_from(const_pointer src, size_t pos,
-                                                   size_t count) noexcept {
-  auto init_size = std::max(count + 1, STRING_INIT_SIZE);
-  _buffer = Alloc::allocate(init_size);
-  char_traits::copy(_buffer, src + pos, count);
-  _size = count;
-  _cap = init_size;
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+template <typename Op>
+void basic_string<CharType, CharTraits, Alloc, Growth>::resize_and_overwrite(size_t n, Op op) {
+  assert(n < max_size());
+
+  auto buf = n >= capacity() ? reallocate(n - size()) : _data();
+  auto new_size = static_cast<size_t>(op(buf, n));
+  assert(new_size <= n);
+  _set_size(new_size);
   _init_tail();
 }
 
-template <typename CharType, typename CharTraits>
-size_t basic_string<CharType, CharTraits>::get_new_cap(size_t add_size) const noexcept {
-  auto old_size = capacity();
+#ifdef HF_HAS_POSIX_IO
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+ssize_t basic_string<CharType, CharTraits, Alloc, Growth>::read_from(int fd, size_t n) noexcept {
+  static_assert(sizeof(value_type) == 1, "read_from appends bytes, it needs a narrow string");
+
+  auto old_size = size();
+  ssize_t r;
+  resize_and_overwrite(old_size + n, [&](pointer buf, size_t) {
+    do {
+      r = ::read(fd, buf + old_size, n);
+    } while (r < 0 && errno == EINTR);
+    return r > 0 ? old_size + static_cast<size_t>(r) : old_size;
+  });
+  return r;
+}
 
-  if (old_size > max_size() - (old_size >> 1)) {
-    return old_size + add_size > max_size() - STRING_INIT_SIZE
-               ? old_size + add_size + 1
-               : old_size + add_size + STRING_INIT_SIZE;
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+bool basic_string<CharType, CharTraits, Alloc, Growth>::write_to(int fd) const noexcept {
+  auto p = reinterpret_cast<const char*>(data());
+  auto left = size() * sizeof(value_type);
+  while (left != 0) {
+    auto r = ::write(fd, p, left);
+    if (r < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    p += r;
+    left -= static_cast<size_t>(r);
   }
+  return true;
+}
+#endif
 
-  return old_size == 0 ? std::max(add_size + 1, STRING_INIT_SIZE)
-                       : std::max(old_size + (old_size >> 1), old_size + add_size + 1);
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+void basic_string<CharType, CharTraits, Alloc, Growth>::_set_size(size_t n) noexcept {
+  if (is_long()) {
+    _l._size = n;
+  } else {
+    assert(n <= SSO_CAPACITY);
+    _s._data[SSO_CAPACITY] = static_cast<value_type>(SSO_CAPACITY - n);
+  }
 }
 
-template <typename CharType, typename CharTraits>
-void basic_string<CharType, CharTraits>::reallocate(size_t n) noexcept {
-  auto new_cap = get_new_cap(n);
-  auto new_buffer = Alloc::allocate(new_cap);
-  char_traits::move(new_buffer, _buffer, _size);
-  Alloc::deallocate(_buffer);
-  _buffer = new_buffer;
-  _cap = new_cap;
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+void basic_string<CharType, CharTraits, Alloc, Growth>::_init() noexcept {
+  _s._data[SSO_CAPACITY] = static_cast<value_type>(SSO_CAPACITY);
+  _s._data[0] = value_type();
 }
 
-template <typename CharType, typename CharTraits>
-void basic_string<CharType, CharTraits>::destroy_buffer() noexcept {
-  if (_buffer != nullptr) {
-    Alloc::deallocate(_buffer, _cap);
-    _buffer = nullptr;
-    _size = 0;
-    _cap = 0;
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+void basic_string<CharType, CharTraits, Alloc, Growth>::init_from(const_pointer src, size_t pos,
+                                                                  size_t count) noexcept {
+  if (count <= SSO_CAPACITY) {
+    _s._data[SSO_CAPACITY] = static_cast<value_type>(SSO_CAPACITY - count);
+    char_traits::copy(_s._data, src + pos, count);
+  } else {
+    // count < max_size() is a precondition, bounding it in release builds keeps count + 1
+    // from wrapping into an empty buffer that the copy below would overrun
+    assert(count < max_size());
+    if (count >= max_size()) count = max_size() - 1;
+    auto init_size = count + 1;
+    stats::on_allocate<basic_string>(init_size * sizeof(value_type));
+    _l._buffer = alloc_traits::allocate(_alloc(), init_size);
+    _l._size = count;
+    _l._cap = encode_cap(init_size);
+    char_traits::copy(_l._buffer, src + pos, count);
   }
+  _init_tail();
+}
+
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+size_t basic_string<CharType, CharTraits, Alloc, Growth>::get_new_cap(
+    size_t add_size) const noexcept {
+  return Growth::next(capacity(), size() + add_size + 1, max_size(), sizeof(value_type));
+}
+
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+typename basic_string<CharType, CharTraits, Alloc, Growth>::pointer
+basic_string<CharType, CharTraits, Alloc, Growth>::reallocate_to(size_t new_cap) noexcept {
+  auto old_size = size();
+  assert(new_cap > old_size);
+
+  auto new_buffer = alloc_traits::allocate(_alloc(), new_cap);
+  char_traits::copy(new_buffer, _data(), old_size + 1);
+  if (is_long()) {
+    stats::on_reallocate<basic_string>(new_cap * sizeof(value_type), old_size);
+    stats::on_release<basic_string>((decode_cap(_l._cap) - old_size - 1) * sizeof(value_type));
+    alloc_traits::deallocate(_alloc(), _l._buffer, decode_cap(_l._cap));
+  } else {
+    stats::on_allocate<basic_string>(new_cap * sizeof(value_type));
+    stats::on_move<basic_string>(old_size);
+  }
+  _l._buffer = new_buffer;
+  _l._size = old_size;
+  _l._cap = encode_cap(new_cap);
+  return new_buffer;
 }
 
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+void basic_string<CharType, CharTraits, Alloc, Growth>::shrink_to_fit() noexcept {
+  if (!is_long()) return;
+
+  auto n = size();
+  if (n > SSO_CAPACITY) {
+    if (decode_cap(_l._cap) > n + 1) reallocate_to(n + 1);
+    return;
+  }
+
+  // back into the inline buffer, which overlays the fields being read
+  auto buffer = _l._buffer;
+  auto cap = decode_cap(_l._cap);
+  char_traits::copy(_s._data, buffer, n);
+  _s._data[SSO_CAPACITY] = static_cast<value_type>(SSO_CAPACITY - n);
+  _init_tail();
+  stats::on_release<basic_string>((cap - n - 1) * sizeof(value_type));
+  stats::on_move<basic_string>(n);
+  alloc_traits::deallocate(_alloc(), buffer, cap);
+}
+
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+void basic_string<CharType, CharTraits, Alloc, Growth>::destroy_buffer() noexcept {
+  if (is_long()) {
+    stats::on_release<basic_string>((decode_cap(_l._cap) - _l._size - 1) * sizeof(value_type));
+    alloc_traits::deallocate(_alloc(), _l._buffer, decode_cap(_l._cap));
+  }
+  _init();
+}
+
+// the inline buffer is addressed through this, never through a stored pointer
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+struct is_trivially_relocatable<basic_string<CharType, CharTraits, Alloc, Growth>>
+    : public is_trivially_relocatable<Alloc> {};
+
 }  // namespace hf
+
+namespace std {
+
+// hashes the same as an equal view, so either can be used to look up the other
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+struct hash<hf::basic_string<CharType, CharTraits, Alloc, Growth>> {
+  size_t operator()(
+      const hf::basic_string<CharType, CharTraits, Alloc, Growth>& str) const noexcept {
+    return hf::hash<hf::basic_string_view<CharType, CharTraits>>()(str);
+  }
+};
+
+}  // namespace std
@@ -0,0 +1,1063 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+
+#include "allocator.hpp"
+#include "container_stats.hpp"
+#include "iterator.hpp"
+#include "simd.hpp"
+#include "type_traits.hpp"
+#include "utils.hpp"
+
+namespace hf {
+
+namespace detail {
+
+// number of keys in the sorted run [p, p + n) that are less than key
+template <typename T>
+inline size_t count_less_scalar(const T* p, size_t n, T key) noexcept {
+  size_t i = 0;
+  for (size_t j = 0; j < n; ++j) i += p[j] < key;
+  return i;
+}
+
+#if defined(HF_SIMD_X86)
+// unsigned keys are biased into the signed range the compare works on, the first lane
+// that is not less ends the run
+template <typename T>
+HF_TARGET_AVX2 inline size_t count_less_avx2(const T* p, size_t n, T key) noexcept {
+  static_assert(sizeof(T) == 4 || sizeof(T) == 8, "4 or 8 byte keys only");
+  constexpr size_t W = 32 / sizeof(T);
+
+  __m256i bias, k;
+  if constexpr (sizeof(T) == 4) {
+    bias = _mm256_set1_epi32(std::is_signed<T>::value ? 0 : INT32_MIN);
+    k = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int32_t>(key)), bias);
+  } else {
+    bias = _mm256_set1_epi64x(std::is_signed<T>::value ? 0 : INT64_MIN);
+    k = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(key)), bias);
+  }
+
+  size_t i = 0;
+  for (; i + W <= n; i += W) {
+    auto v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), bias);
+    __m256i lt;
+    if constexpr (sizeof(T) == 4) {
+      lt = _mm256_cmpgt_epi32(k, v);
+    } else {
+      lt = _mm256_cmpgt_epi64(k, v);
+    }
+    auto m = static_cast<uint32_t>(_mm256_movemask_epi8(lt));
+    if (m != 0xFFFFFFFF) return i + simd::ctz(~m) / sizeof(T);
+  }
+  for (; i < n && p[i] < key; ++i) {
+  }
+  return i;
+}
+#endif
+
+/* ------------------------------------------------------------------------- */
+
+// B-tree shared by btree_map and btree_set, values are kept in every node, each node
+// holds up to NODE_SLOTS of them sorted in place, sized so that a leaf spans about four
+// cache lines. Internal nodes carry NODE_SLOTS + 1 child pointers behind the values.
+// Inserting or erasing moves values between nodes and invalidates every iterator and
+// reference into the tree
+template <typename Policy, typename Compare, typename Alloc>
+class btree : private hf::alloc_holder<Alloc> {
+ public:
+  typedef typename Policy::key_type key_type;
+  typedef typename Policy::value_type value_type;
+  typedef Compare key_compare;
+  typedef Alloc allocator_type;
+  typedef size_t size_type;
+
+  template <bool Const>
+  class basic_iterator;
+
+  typedef basic_iterator<Policy::CONST_ITERATOR> iterator;
+  typedef basic_iterator<true> const_iterator;
+
+ protected:
+  typedef hf::alloc_holder<Alloc> holder;
+  typedef hf::allocator_traits<Alloc> alloc_traits;
+
+  using holder::_alloc;
+
+  struct node {
+    node* parent;
+    uint16_t position;  // index among the children of parent
+    uint16_t count;     // values in use
+    bool leaf;
+  };
+
+  static constexpr size_t align_up(size_t n, size_t a) noexcept { return (n + a - 1) / a * a; }
+
+  static constexpr size_t TARGET_NODE_BYTES = 256;
+  static constexpr size_t VALUES_OFFSET = align_up(sizeof(node), alignof(value_type));
+  static constexpr size_t FITTING_SLOTS = (TARGET_NODE_BYTES - VALUES_OFFSET) / sizeof(value_type);
+
+ public:
+  static constexpr size_t NODE_SLOTS = FITTING_SLOTS < 4 ? 4 : FITTING_SLOTS;
+
+ protected:
+  // nodes below this fill borrow from or merge with a sibling after an erase
+  static constexpr size_t MIN_SLOTS = NODE_SLOTS / 2;
+
+  static constexpr size_t CHILDREN_OFFSET =
+      align_up(VALUES_OFFSET + NODE_SLOTS * sizeof(value_type), alignof(node*));
+
+  // nodes are allocated in whole value_type units from the container allocator
+  static constexpr size_t LEAF_UNITS =
+      (CHILDREN_OFFSET + sizeof(value_type) - 1) / sizeof(value_type);
+  static constexpr size_t INTERNAL_UNITS =
+      (CHILDREN_OFFSET + (NODE_SLOTS + 1) * sizeof(node*) + sizeof(value_type) - 1) /
+      sizeof(value_type);
+
+  // deep enough for any tree assign_sorted builds from 2^64 values
+  static constexpr size_t MAX_HEIGHT = 40;
+
+  node* _root = nullptr;
+  node* _leftmost = nullptr;
+  node* _rightmost = nullptr;
+  size_t _size = 0;
+  Compare _comp;
+
+  // lookups by any type the comparator accepts, only when it is transparent
+  template <typename K>
+  using if_transparent = typename std::enable_if<is_transparent<Compare>::value, K>::type;
+
+  // keeps erase(key) from taking iterators when the key overloads are templates
+  template <typename K>
+  using if_not_iterator =
+      typename std::enable_if<!std::is_convertible<K, iterator>::value &&
+                                  !std::is_convertible<K, const_iterator>::value,
+                              K>::type;
+
+  // integer keys under std::less are counted across the whole node without branching,
+  // the contiguous 4 and 8 byte keys of a set with AVX2
+  template <typename K>
+  static constexpr bool LINEAR_SEARCH =
+      std::is_integral<key_type>::value && std::is_same<K, key_type>::value &&
+      (std::is_same<Compare, std::less<key_type>>::value ||
+       std::is_same<Compare, std::less<>>::value);
+
+  static constexpr bool SIMD_SEARCH = std::is_same<value_type, key_type>::value &&
+                                      !std::is_same<key_type, bool>::value &&
+                                      (sizeof(key_type) == 4 || sizeof(key_type) == 8);
+
+ public:
+  btree() noexcept = default;
+
+  explicit btree(const Compare& comp, const Alloc& alloc = Alloc()) noexcept
+      : holder(alloc), _comp(comp) {}
+
+  btree(const btree& rhs) noexcept
+      : holder(alloc_traits::select_on_container_copy_construction(rhs._alloc())),
+        _comp(rhs._comp) {
+    copy_from(rhs);
+  }
+
+  btree(btree&& rhs) noexcept
+      : holder(std::move(rhs._alloc())),
+        _root(rhs._root),
+        _leftmost(rhs._leftmost),
+        _rightmost(rhs._rightmost),
+        _size(rhs._size),
+        _comp(std::move(rhs._comp)) {
+    rhs._root = rhs._leftmost = rhs._rightmost = nullptr;
+    rhs._size = 0;
+  }
+
+  btree& operator=(const btree& rhs) noexcept;
+
+  btree& operator=(btree&& rhs) noexcept;
+
+  ~btree() { clear(); }
+
+ public:
+  iterator begin() noexcept { return _leftmost == nullptr ? end() : iterator(_leftmost, 0); }
+
+  iterator end() noexcept {
+    return _rightmost == nullptr ? iterator() : iterator(_rightmost, _rightmost->count);
+  }
+
+  const_iterator begin() const noexcept { return const_cast<btree*>(this)->begin(); }
+
+  const_iterator end() const noexcept { return const_cast<btree*>(this)->end(); }
+
+  const_iterator cbegin() const noexcept { return begin(); }
+
+  const_iterator cend() const noexcept { return end(); }
+
+  allocator_type get_allocator() const noexcept { return _alloc(); }
+
+  key_compare key_comp() const noexcept { return _comp; }
+
+  /* ------------------------------------------------------------------------- */
+
+  bool empty() const noexcept { return _size == 0; }
+
+  size_t size() const noexcept { return _size; }
+
+  /* ------------------------------------------------------------------------- */
+
+  iterator find(const key_type& key) noexcept { return iterator_at(find_pos(key)); }
+
+  const_iterator find(const key_type& key) const noexcept {
+    return const_cast<btree*>(this)->find(key);
+  }
+
+  template <typename K, typename = if_transparent<K>>
+  iterator find(const K& key) noexcept {
+    return iterator_at(find_pos(key));
+  }
+
+  template <typename K, typename = if_transparent<K>>
+  const_iterator find(const K& key) const noexcept {
+    return const_cast<btree*>(this)->find(key);
+  }
+
+  bool contains(const key_type& key) const noexcept { return find_pos(key).first != nullptr; }
+
+  template <typename K, typename = if_transparent<K>>
+  bool contains(const K& key) const noexcept {
+    return find_pos(key).first != nullptr;
+  }
+
+  size_t count(const key_type& key) const noexcept { return contains(key) ? 1 : 0; }
+
+  template <typename K, typename = if_transparent<K>>
+  size_t count(const K& key) const noexcept {
+    return contains(key) ? 1 : 0;
+  }
+
+  // first value whose key is not less than key
+  iterator lower_bound(const key_type& key) noexcept { return iterator_at(bound_pos<false>(key)); }
+
+  const_iterator lower_bound(const key_type& key) const noexcept {
+    return const_cast<btree*>(this)->lower_bound(key);
+  }
+
+  template <typename K, typename = if_transparent<K>>
+  iterator lower_bound(const K& key) noexcept {
+    return iterator_at(bound_pos<false>(key));
+  }
+
+  template <typename K, typename = if_transparent<K>>
+  const_iterator lower_bound(const K& key) const noexcept {
+    return const_cast<btree*>(this)->lower_bound(key);
+  }
+
+  // first value whose key is greater than key
+  iterator upper_bound(const key_type& key) noexcept { return iterator_at(bound_pos<true>(key)); }
+
+  const_iterator upper_bound(const key_type& key) const noexcept {
+    return const_cast<btree*>(this)->upper_bound(key);
+  }
+
+  template <typename K, typename = if_transparent<K>>
+  iterator upper_bound(const K& key) noexcept {
+    return iterator_at(bound_pos<true>(key));
+  }
+
+  template <typename K, typename = if_transparent<K>>
+  const_iterator upper_bound(const K& key) const noexcept {
+    return const_cast<btree*>(this)->upper_bound(key);
+  }
+
+  hf::pair<iterator, iterator> equal_range(const key_type& key) noexcept {
+    return hf::pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+  }
+
+  hf::pair<const_iterator, const_iterator> equal_range(const key_type& key) const noexcept {
+    return hf::pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+  }
+
+  /* ------------------------------------------------------------------------- */
+
+  hf::pair<iterator, bool> insert(const value_type& value) noexcept {
+    return emplace_key(Policy::key(value), value);
+  }
+
+  hf::pair<iterator, bool> insert(value_type&& value) noexcept {
+    return emplace_key(Policy::key(value), std::move(value));
+  }
+
+  template <typename Iter>
+  void insert(Iter first, Iter last) noexcept {
+    for (; first != last; ++first) insert(*first);
+  }
+
+  void insert(std::initializer_list<value_type> list) noexcept {
+    insert(list.begin(), list.end());
+  }
+
+  template <typename... Args>
+  hf::pair<iterator, bool> emplace(Args&&... args) noexcept {
+    value_type value(std::forward<Args>(args)...);
+    return insert(std::move(value));
+  }
+
+  size_t erase(const key_type& key) noexcept { return erase_key(key); }
+
+  template <typename K, typename = if_transparent<K>, typename = if_not_iterator<K>>
+  size_t erase(const K& key) noexcept {
+    return erase_key(key);
+  }
+
+  // values shift between nodes while the tree rebalances, so no iterator is returned,
+  // use hf::erase_if to erase while iterating
+  void erase(const_iterator pos) noexcept { erase_at(pos._node, pos._pos); }
+
+  void clear() noexcept;
+
+  void swap(btree& rhs) noexcept;
+
+  // the survivors are relocated into a freshly packed tree, every value is visited once
+  template <typename Pred>
+  size_t erase_if(Pred pred) noexcept;
+
+  // replaces the contents with values already sorted by key without duplicates, such as a
+  // sorted hf::vector. Nodes are filled left to right without any search or split, which
+  // leaves them full instead of the half to two thirds that random inserts end up with
+  template <typename Iter>
+  void assign_sorted(Iter first, Iter last) noexcept;
+
+  /* ------------------------------------------------------------------------- */
+
+ protected:
+  static value_type* values(const node* n) noexcept {
+    return reinterpret_cast<value_type*>(reinterpret_cast<char*>(const_cast<node*>(n)) +
+                                         VALUES_OFFSET);
+  }
+
+  static node** children(const node* n) noexcept {
+    return reinterpret_cast<node**>(reinterpret_cast<char*>(const_cast<node*>(n)) +
+                                    CHILDREN_OFFSET);
+  }
+
+  static node* child(const node* n, size_t i) noexcept { return children(n)[i]; }
+
+  static void set_child(node* n, size_t i, node* c) noexcept {
+    children(n)[i] = c;
+    c->parent = n;
+    c->position = static_cast<uint16_t>(i);
+  }
+
+  iterator iterator_at(hf::pair<node*, size_t> pos) noexcept {
+    return pos.first == nullptr ? end() : iterator(pos.first, pos.second);
+  }
+
+  // index of the first value in n whose key is not less than key
+  template <typename K>
+  size_t lower_index(const node* n, const K& key) const noexcept;
+
+  // index of the first value in n whose key is greater than key
+  template <typename K>
+  size_t upper_index(const node* n, const K& key) const noexcept;
+
+  template <typename K>
+  hf::pair<node*, size_t> find_pos(const K& key) const noexcept;
+
+  template <bool Upper, typename K>
+  hf::pair<node*, size_t> bound_pos(const K& key) const noexcept;
+
+  template <typename K, typename... Args>
+  hf::pair<iterator, bool> emplace_key(const K& key, Args&&... args) noexcept;
+
+  template <typename K>
+  size_t erase_key(const K& key) noexcept;
+
+  void erase_at(node* n, size_t i) noexcept;
+
+  hf::pair<node*, size_t> split(node* n, size_t i) noexcept;
+
+  void rebalance(node* n) noexcept;
+
+  void rotate_left(node* p, size_t k) noexcept;
+
+  void rotate_right(node* p, size_t k) noexcept;
+
+  void merge(node* p, size_t k) noexcept;
+
+  value_type* bulk_next(node** level, size_t& height) noexcept;
+
+  value_type* bulk_push(node** level, size_t& height, size_t l, node* right) noexcept;
+
+  void bulk_finish(node** level, size_t height) noexcept;
+
+  void relocate(value_type* dst, value_type* src) noexcept;
+
+  void move_values(value_type* dst, value_type* src, size_t n) noexcept;
+
+  static void move_children(node* n, size_t dst, size_t src, size_t count) noexcept;
+
+  node* new_node(bool leaf) noexcept;
+
+  void free_node(node* n) noexcept {
+    alloc_traits::deallocate(_alloc(), reinterpret_cast<value_type*>(n),
+                             n->leaf ? LEAF_UNITS : INTERNAL_UNITS);
+  }
+
+  node* clone(const node* src) noexcept;
+
+  void copy_from(const btree& rhs) noexcept;
+
+  void destroy_subtree(node* n, bool destroy_values) noexcept;
+};
+
+/* ------------------------------------------------------------------------- */
+
+template <typename Policy, typename Compare, typename Alloc>
+template <bool Const>
+class btree<Policy, Compare, Alloc>::basic_iterator {
+  friend class btree;
+
+ public:
+  typedef hf::bidirectional_iterator_tag iterator_category;
+  typedef typename btree::value_type value_type;
+  typedef ptrdiff_t difference_type;
+  typedef typename std::conditional<Const, const value_type*, value_type*>::type pointer;
+  typedef typename std::conditional<Const, const value_type&, value_type&>::type reference;
+
+  basic_iterator() noexcept = default;
+
+  // iterator converts to const_iterator
+  template <bool C, typename = typename std::enable_if<Const && !C>::type>
+  basic_iterator(const basic_iterator<C>& rhs) noexcept : _node(rhs._node), _pos(rhs._pos) {}
+
+  reference operator*() const noexcept { return values(_node)[_pos]; }
+
+  pointer operator->() const noexcept { return values(_node) + _pos; }
+
+  basic_iterator& operator++() noexcept;
+
+  basic_iterator operator++(int) noexcept {
+    auto tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  basic_iterator& operator--() noexcept;
+
+  basic_iterator operator--(int) noexcept {
+    auto tmp = *this;
+    --*this;
+    return tmp;
+  }
+
+  friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+    return lhs._node == rhs._node && lhs._pos == rhs._pos;
+  }
+
+  friend bool operator!=(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+    return !(lhs == rhs);
+  }
+
+ private:
+  template <bool>
+  friend class basic_iterator;
+
+  // end() is one past the last value of the rightmost leaf
+  basic_iterator(node* n, size_t pos) noexcept : _node(n), _pos(pos) {}
+
+  node* _node = nullptr;
+  size_t _pos = 0;
+};
+
+// the successor of an internal value is the leftmost value of the subtree to its right,
+// past the end of a leaf it is the first ancestor value the leaf sits left of
+template <typename Policy, typename Compare, typename Alloc>
+template <bool Const>
+typename btree<Policy, Compare, Alloc>::template basic_iterator<Const>&
+btree<Policy, Compare, Alloc>::basic_iterator<Const>::operator++() noexcept {
+  if (!_node->leaf) {
+    _node = child(_node, _pos + 1);
+    while (!_node->leaf) _node = child(_node, 0);
+    _pos = 0;
+    return *this;
+  }
+  if (++_pos < _node->count) return *this;
+
+  auto n = _node;
+  auto pos = _pos;
+  while (pos == n->count && n->parent != nullptr) {
+    pos = n->position;
+    n = n->parent;
+  }
+  // past the last value _node stays the rightmost leaf, which is end()
+  if (pos < n->count) {
+    _node = n;
+    _pos = pos;
+  }
+  return *this;
+}
+
+template <typename Policy, typename Compare, typename Alloc>
+template <bool Const>
+typename btree<Policy, Compare, Alloc>::template basic_iterator<Const>&
+btree<Policy, Compare, Alloc>::basic_iterator<Const>::operator--() noexcept {
+  if (!_node->leaf) {
+    _node = child(_node, _pos);
+    while (!_node->leaf) _node = child(_node, _node->count);
+    _pos = _node->count - 1;
+    return *this;
+  }
+  if (_pos > 0) {
+    --_pos;
+    return *this;
+  }
+
+  size_t pos = 0;
+  while (pos == 0 && _node->parent != nullptr) {
+    pos = _node->position;
+    _node = _node->parent;
+  }
+  _pos = pos - 1;
+  return *this;
+}
+
+/* ------------------------------------------------------------------------- */
+
+template <typename Policy, typename Compare, typename Alloc>
+btree<Policy, Compare, Alloc>& btree<Policy, Compare, Alloc>::operator=(
+    const btree& rhs) noexcept {
+  if (this != &rhs) {
+    clear();
+    if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+      _alloc() = rhs._alloc();
+    }
+    _comp = rhs._comp;
+    copy_from(rhs);
+  }
+  return *this;
+}
+
+template <typename Policy, typename Compare, typename Alloc>
+btree<Policy, Compare, Alloc>& btree<Policy, Compare, Alloc>::operator=(btree&& rhs) noexcept {
+  if (this != &rhs) {
+    clear();
+    _comp = std::move(rhs._comp);
+
+    // the nodes can only be stolen if they can be released with our allocator afterwards
+    if constexpr (!alloc_traits::propagate_on_container_move_assignment::value) {
+      if (!alloc_traits::equal(_alloc(), rhs._alloc())) {
+        for (auto& value : rhs) emplace_key(Policy::key(value), std::move(value));
+        rhs.clear();
+        return *this;
+      }
+    }
+
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+      _alloc() = std::move(rhs._alloc());
+    }
+    _root = rhs._root;
+    _leftmost = rhs._leftmost;
+    _rightmost = rhs._rightmost;
+    _size = rhs._size;
+    rhs._root = rhs._leftmost = rhs._rightmost = nullptr;
+    rhs._size = 0;
+  }
+  return *this;
+}
+
+template <typename Policy, typename Compare, typename Alloc>
+void btree<Policy, Compare, Alloc>::clear() noexcept {
+  if (_root != nullptr) destroy_subtree(_root, true);
+  _root = _leftmost = _rightmost = nullptr;
+  _size = 0;
+}
+
+template <typename Policy, typename Compare, typename Alloc>
+void btree<Policy, Compare, Alloc>::swap(btree& rhs) noexcept {
+  if (this == &rhs) return;
+  if constexpr (alloc_traits::propagate_on_container_swap::value) {
+    std::swap(_alloc(), rhs._alloc());
+  } else {
+    assert(alloc_traits::equal(_alloc(), rhs._alloc()));
+  }
+  std::swap(_root, rhs._root);
+  std::swap(_leftmost, rhs._leftmost);
+  std::swap(_rightmost, rhs._rightmost);
+  std::swap(_size, rhs._size);
+  std::swap(_comp, rhs._comp);
+}
+
+template <typename Policy, typename Compare, typename Alloc>
+template <typename Pred>
+size_t btree<Policy, Compare, Alloc>::erase_if(Pred pred) noexcept {
+  if (_size == 0) return 0;
+
+  const auto old_size = _size;
+  auto buf = alloc_traits::allocate(_alloc(), old_size);
+  size_t kept = 0;
+
+  // iterating only reads the node links, which stay intact until the nodes are freed
+  for (auto it = begin(); it != end(); ++it) {
+    auto p = values(it._node) + it._pos;
+    if (pred(static_cast<const value_type&>(*p))) {
+      alloc_traits::destroy(_alloc(), p);
+    } else {
+      relocate(buf + kept++, p);
+    }
+  }
+
+  destroy_subtree(_root, false);
+  _root = _leftmost = _rightmost = nullptr;
+  _size = 0;
+
+  node* level[MAX_HEIGHT];
+  size_t height = 0;
+  for (size_t i = 0; i < kept; ++i) relocate(bulk_next(level, height), buf + i);
+  bulk_finish(level, height);
+
+  alloc_traits::deallocate(_alloc(), buf, old_size);
+  return old_size - kept;
+}
+
+template <typename Policy, typename Compare, typename Alloc>
+template <typename Iter>
+void btree<Policy, Compare, Alloc>::assign_sorted(Iter first, Iter last) noexcept {
+  clear();
+
+  node* level[MAX_HEIGHT];
+  size_t height = 0;
+  [[maybe_unused]] const value_type* prev = nullptr;
+  for (; first != last; ++first) {
+    auto slot = bulk_next(level, height);
+    alloc_traits::construct(_alloc(), slot, *first);
+    assert(prev == nullptr || _comp(Policy::key(*prev), Policy::key(*slot)));
+    prev = slot;
+  }
+  bulk_finish(level, height);
+}
+
+/* ------------------------------------------------------------------------- */
+
+template <typename Policy, typename Compare, typename Alloc>
+template <typename K>
+size_t btree<Policy, Compare, Alloc>::lower_index(const node* n, const K& key) const noexcept {
+  auto v = values(n);
+  if constexpr (LINEAR_SEARCH<K>) {
+    if constexpr (SIMD_SEARCH) {
+#if defined(HF_SIMD_X86)
+      if (simd::has_avx2()) return count_less_avx2(v, n->count, key);
+#endif
+      return count_less_scalar(v, n->count, key);
+    } else {
+      size_t i = 0;
+      for (size_t j = 0; j < n->count; ++j) i += Policy::key(v[j]) < key;
+      return i;
+    }
+  } else {
+    size_t lo = 0, hi = n->count;
+    while (lo < hi) {
+      auto mid = (lo + hi) / 2;
+      if (_comp(Policy::key(v[mid]), key)) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+}
+
+template <typename Policy, typename Compare, typename Alloc>
+template <typename K>
+size_t btree<Policy, Compare, Alloc>::upper_index(const node* n, const K& key) const noexcept {
+  auto v = values(n);
+  if constexpr (LINEAR_SEARCH<K>) {
+    size_t i = 0;
+    for (size_t j = 0; j < n->count; ++j) i += !(key < Policy::key(v[j]));
+    return i;
+  } else {
+    size_t lo = 0, hi = n->count;
+    while (lo < hi) {
+      auto mid = (lo + hi) / 2;
+      if (_comp(key, Policy::key(v[mid]))) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
+      }
+    }
+    return lo;
+  }
+}
+
+template <typename Policy, typename Compare, typename Alloc>
+template <typename K>
+hf::pair<typename btree<Policy, Compare, Alloc>::node*, size_t>
+btree<Policy, Compare, Alloc>::find_pos(const K& key) const noexcept {
+  for (auto n = _root; n != nullptr;) {
+    auto i = lower_index(n, key);
+    if (i < n->count && !_comp(key, Policy::key(values(n)[i]))) {
+      return hf::pair<node*, size_t>(n, i);
+    }
+    if (n->leaf) break;
+    n = child(n, i);
+  }
+  return hf::pair<node*, size_t>(nullptr, 0);
+}
+
+// the deepest node where the bound falls inside the node wins, a position past the
+// last value of a leaf belongs to the ancestor found before
+template <typename Policy, typename Compare, typename Alloc>
+template <bool Upper, typename K>
+hf::pair<typename btree<Policy, Compare, Alloc>::node*, size_t>
+btree<Policy, Compare, Alloc>::bound_pos(const K& key) const noexcept {
+  hf::pair<node*, size_t> found(nullptr, 0);
+  for (auto n = _root; n != nullptr;) {
+    size_t i;
+    if constexpr (Upper) {
+      i = upper_index(n, key);
+    } else {
+      i = lower_index(n, key);
+    }
+    if (i < n->count) {
+      found = hf::pair<node*, size_t>(n, i);
+      if (!Upper && !_comp(key, Policy::key(values(n)[i]))) break;
+    }
+    if (n->leaf) break;
+    n = child(n, i);
+  }
+  return found;
+}
+
+template <typename Policy, typename Compare, typename Alloc>
+template <typename K, typename... Args>
+hf::pair<typename btree<Policy, Compare, Alloc>::iterator, bool>
+btree<Policy, Compare, Alloc>::emplace_key(const K& key, Args&&... args) noexcept {
+  if (_root == nullptr) _root = _leftmost = _rightmost = new_node(true);
+
+  auto n = _root;
+  size_t i;
+  for (;;) {
+    i = lower_index(n, key);
+    if (i < n->count && !_comp(key, Policy::key(values(n)[i]))) {
+      return hf::pair<iterator, bool>(iterator(n, i), false);
+    }
+    if (n->leaf) break;
+    n = child(n, i);
+  }
+
+  if (n->count == NODE_SLOTS) {
+    auto pos = split(n, i);
+    n = pos.first;
+    i = pos.second;
+  }
+
+  auto slot = values(n) + i;
+  move_values(slot + 1, slot, n->count - i);
+  alloc_traits::construct(_alloc(), slot, std::forward<Args>(args)...);
+  ++n->count;
+  ++_size;
+
+  return hf::pair<iterator, bool>(iterator(n, i), true);
+}
+
+template <typename Policy, typename Compare, typename Alloc>
+template <typename K>
+size_t btree<Policy, Compare, Alloc>::erase_key(const K& key) noexcept {
+  auto pos = find_pos(key);
+  if (pos.first == nullptr) return 0;
+  erase_at(pos.first, pos.second);
+  return 1;
+}
+
+// an internal value is replaced by its predecessor, so values only ever leave a leaf
+template <typename Policy, typename Compare, typename Alloc>
+void btree<Policy, Compare, Alloc>::erase_at(node* n, size_t i) noexcept {
+  assert(n != nullptr && i < n->count);
+
+  alloc_traits::destroy(_alloc(), values(n) + i);
+  if (n->leaf) {
+    move_values(values(n) + i, values(n) + i + 1, n->count - i - 1);
+  } else {
+    auto leaf = child(n, i);
+    while (!leaf->leaf) leaf = child(leaf, leaf->count);
+    relocate(values(n) + i, values(leaf) + leaf->count - 1);
+    n = leaf;
+  }
+  --n->count;
+  --_size;
+
+  rebalance(n);
+}
+
+// makes room in the full node n for a value at i. The median moves up into the parent,
+// which is split first when it is full itself. Appends leave the left node full and
+// prepends the right one, so sorted inserts pack the nodes instead of leaving them half
+// empty. Returns where the value goes
+template <typename Policy, typename Compare, typename Alloc>
+hf::pair<typename btree<Policy, Compare, Alloc>::node*, size_t>
+btree<Policy, Compare, Alloc>::split(node* n, size_t i) noexcept {
+  assert(n->count == NODE_SLOTS);
+
+  if (n->parent == nullptr) {
+    _root = new_node(false);
+    set_child(_root, 0, n);
+  } else if (n->parent->count == NODE_SLOTS) {
+    split(n->parent, n->position);
+  }
+
+  const size_t mid = i == NODE_SLOTS ? NODE_SLOTS - 1 : i == 0 ? 0 : NODE_SLOTS / 2;
+  auto right = new_node(n->leaf);
+  right->count = static_cast<uint16_t>(NODE_SLOTS - mid - 1);
+  move_values(values(right), values(n) + mid + 1, right->count);
+  if (!n->leaf) {
+    for (size_t j = 0; j <= right->count; ++j) set_child(right, j, child(n, mid + 1 + j));
+  }
+  n->count = static_cast<uint16_t>(mid);
+
+  auto p = n->parent;
+  size_t k = n->position;
+  move_values(values(p) + k + 1, values(p) + k, p->count - k);
+  move_children(p, k + 2, k + 1, p->count - k);
+  relocate(values(p) + k, values(n) + mid);
+  set_child(p, k + 1, right);
+  ++p->count;
+
+  if (n == _rightmost) _rightmost = right;
+  return i <= mid ? hf::pair<node*, size_t>(n, i) : hf::pair<node*, size_t>(right, i - mid - 1);
+}
+
+// an underfull node borrows a value from a sibling that can spare one, otherwise it is
+// merged with the sibling and the parent lost a value, which may leave it underfull
+template <typename Policy, typename Compare, typename Alloc>
+void btree<Policy, Compare, Alloc>::rebalance(node* n) noexcept {
+  while (n != _root && n->count < MIN_SLOTS) {
+    auto p = n->parent;
+    size_t k = n->position;
+    if (k > 0 && child(p, k - 1)->count > MIN_SLOTS) {
+      rotate_right(p, k - 1);
+      return;
+    }
+    if (k < p->count && child(p, k + 1)->count > MIN_SLOTS) {
+      rotate_left(p, k);
+      return;
+    }
+    merge(p, k > 0 ? k - 1 : k);
+    n = p;
+  }
+
+  if (_root->count == 0) {
+    auto old = _root;
+    if (old->leaf) {
+      _root = _leftmost = _rightmost = nullptr;
+    } else {
+      _root = child(old, 0);
+      _root->parent = nullptr;
+      _root->position = 0;
+    }
+    free_node(old);
+  }
+}
+
+// the first value of child k + 1 moves up to the parent, the separator down to child k
+template <typename Policy, typename Compare, typename Alloc>
+void btree<Policy, Compare, Alloc>::rotate_left(node* p, size_t k) noexcept {
+  auto left = child(p, k);
+  auto right = child(p, k + 1);
+
+  relocate(values(left) + left->count, values(p) + k);
+  relocate(values(p) + k, values(right));
+  move_values(values(right), values(right) + 1, right->count - 1);
+  if (!left->leaf) {
+    set_child(left, left->count + 1, child(right, 0));
+    move_children(right, 0, 1, right->count);
+  }
+  ++left->count;
+  --right->count;
+}
+
+// the last value of child k moves up to the parent, the separator down to child k + 1
+template <typename Policy, typename Compare, typename Alloc>
+void btree<Policy, Compare, Alloc>::rotate_right(node* p, size_t k) noexcept {
+  auto left = child(p, k);
+  auto right = child(p, k + 1);
+
+  move_values(values(right) + 1, values(right), right->count);
+  relocate(values(right), values(p) + k);
+  relocate(values(p) + k, values(left) + left->count - 1);
+  if (!right->leaf) {
+    move_children(right, 1, 0, right->count + 1);
+    set_child(right, 0, child(left, left->count));
+  }
+  --left->count;
+  ++right->count;
+}
+
+// child k + 1 and the separator between them are appended to child k
+template <typename Policy, typename Compare, typename Alloc>
+void btree<Policy, Compare, Alloc>::merge(node* p, size_t k) noexcept {
+  auto left = child(p, k);
+  auto right = child(p, k + 1);
+  assert(left->count + right->count + 1u <= NODE_SLOTS);
+
+  relocate(values(left) + left->count, values(p) + k);
+  move_values(values(left) + left->count + 1, values(right), right->count);
+  if (!left->leaf) {
+    for (size_t j = 0; j <= right->count; ++j) {
+      set_child(left, left->count + 1 + j, child(right, j));
+    }
+  }
+  left->count = static_cast<uint16_t>(left->count + 1 + right->count);
+
+  move_values(values(p) + k, values(p) + k + 1, p->count - k - 1);
+  move_children(p, k + 1, k + 2, p->count - k - 1);
+  --p->count;
+
+  if (right == _rightmost) _rightmost = left;
+  free_node(right);
+}
+
+/* ------------------------------------------------------------------------- */
+
+// the tree grows to the right, level[l] is the rightmost node of level l counted from the
+// leaves. Returns the slot for the next value, counted but not yet constructed
+template <typename Policy, typename Compare, typename Alloc>
+typename btree<Policy, Compare, Alloc>::value_type* btree<Policy, Compare, Alloc>::bulk_next(
+    node** level, size_t& height) noexcept {
+  ++_size;
+  if (height == 0) {
+    level[0] = _root = _leftmost = new_node(true);
+    height = 1;
+  }
+
+  auto n = level[0];
+  if (n->count < NODE_SLOTS) return values(n) + n->count++;
+
+  // the leaf is full, the value separates it from the next leaf one level up
+  auto right = new_node(true);
+  auto slot = bulk_push(level, height, 1, right);
+  level[0] = right;
+  return slot;
+}
+
+template <typename Policy, typename Compare, typename Alloc>
+typename btree<Policy, Compare, Alloc>::value_type* btree<Policy, Compare, Alloc>::bulk_push(
+    node** level, size_t& height, size_t l, node* right) noexcept {
+  if (l == height) {
+    assert(height < MAX_HEIGHT);
+    _root = new_node(false);
+    set_child(_root, 0, level[l - 1]);
+    level[l] = _root;
+    ++height;
+  }
+
+  auto n = level[l];
+  if (n->count < NODE_SLOTS) {
+    set_child(n, n->count + 1, right);
+    return values(n) + n->count++;
+  }
+
+  auto next = new_node(false);
+  set_child(next, 0, right);
+  auto slot = bulk_push(level, height, l + 1, next);
+  level[l] = next;
+  return slot;
+}
+
+// every node but the rightmost of each level is full, the rightmost ones may hold next to
+// nothing and borrow from their left sibling, from the top down so that each parent has
+// a left sibling to offer first
+template <typename Policy, typename Compare, typename Alloc>
+void btree<Policy, Compare, Alloc>::bulk_finish(node** level, size_t height) noexcept {
+  if (height == 0) return;
+  _rightmost = level[0];
+  for (size_t l = height - 1; l-- > 0;) {
+    auto n = level[l];
+    while (n->count < MIN_SLOTS) rotate_right(n->parent, n->position - 1u);
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+template <typename Policy, typename Compare, typename Alloc>
+void btree<Policy, Compare, Alloc>::relocate(value_type* dst, value_type* src) noexcept {
+  if constexpr (hf::is_trivially_relocatable<value_type>::value) {
+    std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), sizeof(value_type));
+  } else {
+    alloc_traits::construct(_alloc(), dst, std::move(*src));
+    alloc_traits::destroy(_alloc(), src);
+  }
+}
+
+// relocates n values, the ranges may overlap
+template <typename Policy, typename Compare, typename Alloc>
+void btree<Policy, Compare, Alloc>::move_values(value_type* dst, value_type* src,
+                                                size_t n) noexcept {
+  if (n == 0 || dst == src) return;
+  if constexpr (hf::is_trivially_relocatable<value_type>::value) {
+    std::memmove(static_cast<void*>(dst), static_cast<const void*>(src), n * sizeof(value_type));
+  } else if (dst < src) {
+    for (size_t j = 0; j < n; ++j) relocate(dst + j, src + j);
+  } else {
+    for (size_t j = n; j-- > 0;) relocate(dst + j, src + j);
+  }
+}
+
+template <typename Policy, typename Compare, typename Alloc>
+void btree<Policy, Compare, Alloc>::move_children(node* n, size_t dst, size_t src,
+                                                  size_t count) noexcept {
+  if (count == 0) return;
+  std::memmove(children(n) + dst, children(n) + src, count * sizeof(node*));
+  for (size_t j = dst; j < dst + count; ++j) children(n)[j]->position = static_cast<uint16_t>(j);
+}
+
+template <typename Policy, typename Compare, typename Alloc>
+typename btree<Policy, Compare, Alloc>::node* btree<Policy, Compare, Alloc>::new_node(
+    bool leaf) noexcept {
+  const size_t units = leaf ? LEAF_UNITS : INTERNAL_UNITS;
+  stats::on_allocate<btree>(units * sizeof(value_type));
+
+  // the allocator has to align the block for the node links as well
+  auto p = alloc_traits::allocate(_alloc(), units);
+  assert(reinterpret_cast<uintptr_t>(p) % alignof(node) == 0);
+  return ::new (static_cast<void*>(p)) node{nullptr, 0, 0, leaf};
+}
+
+template <typename Policy, typename Compare, typename Alloc>
+typename btree<Policy, Compare, Alloc>::node* btree<Policy, Compare, Alloc>::clone(
+    const node* src) noexcept {
+  auto n = new_node(src->leaf);
+  for (size_t j = 0; j < src->count; ++j) {
+    alloc_traits::construct(_alloc(), values(n) + j, values(src)[j]);
+  }
+  n->count = src->count;
+  if (!src->leaf) {
+    for (size_t j = 0; j <= src->count; ++j) set_child(n, j, clone(child(src, j)));
+  }
+  return n;
+}
+
+template <typename Policy, typename Compare, typename Alloc>
+void btree<Policy, Compare, Alloc>::copy_from(const btree& rhs) noexcept {
+  if (rhs._root == nullptr) return;
+
+  _root = clone(rhs._root);
+  _leftmost = _rightmost = _root;
+  while (!_leftmost->leaf) _leftmost = child(_leftmost, 0);
+  while (!_rightmost->leaf) _rightmost = child(_rightmost, _rightmost->count);
+  _size = rhs._size;
+}
+
+template <typename Policy, typename Compare, typename Alloc>
+void btree<Policy, Compare, Alloc>::destroy_subtree(node* n, bool destroy_values) noexcept {
+  if (!n->leaf) {
+    for (size_t j = 0; j <= n->count; ++j) destroy_subtree(child(n, j), destroy_values);
+  }
+  if constexpr (!std::is_trivially_destructible<value_type>::value) {
+    if (destroy_values) alloc_traits::destroy(_alloc(), values(n), values(n) + n->count);
+  }
+  free_node(n);
+}
+
+}  // namespace detail
+}  // namespace hf
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+
+#include "allocator.hpp"
+#include "btree.hpp"
+#include "utils.hpp"
+
+namespace hf {
+
+namespace detail {
+
+template <typename Key, typename Value>
+struct btree_map_policy {
+  typedef Key key_type;
+  typedef hf::pair<const Key, Value> value_type;
+
+  static constexpr bool CONST_ITERATOR = false;
+
+  static const Key& key(const value_type& value) noexcept { return value.first; }
+};
+
+}  // namespace detail
+
+// ordered map storing hf::pair<const Key, Value> inline in the nodes of a B-tree, see
+// btree, inserting or erasing invalidates every iterator and reference into the map
+template <typename Key, typename Value, typename Compare = std::less<Key>,
+          typename Alloc = hf::allocator<hf::pair<const Key, Value>>>
+class btree_map : public detail::btree<detail::btree_map_policy<Key, Value>, Compare, Alloc> {
+  typedef detail::btree<detail::btree_map_policy<Key, Value>, Compare, Alloc> base;
+
+ public:
+  typedef Value mapped_type;
+
+  using typename base::const_iterator;
+  using typename base::iterator;
+  using typename base::key_type;
+  using typename base::value_type;
+
+ public:
+  btree_map() noexcept = default;
+
+  explicit btree_map(const Compare& comp, const Alloc& alloc = Alloc()) noexcept
+      : base(comp, alloc) {}
+
+  btree_map(std::initializer_list<value_type> list) noexcept { base::insert(list); }
+
+  btree_map(const btree_map&) noexcept = default;
+
+  btree_map(btree_map&&) noexcept = default;
+
+  btree_map& operator=(const btree_map&) noexcept = default;
+
+  btree_map& operator=(btree_map&&) noexcept = default;
+
+  ~btree_map() = default;
+
+ public:
+  // unlike emplace, the value is only constructed when the key is missing
+  template <typename... Args>
+  hf::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args) noexcept {
+    return base::emplace_key(key, std::piecewise_construct, std::forward_as_tuple(key),
+                             std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  template <typename... Args>
+  hf::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args) noexcept {
+    return base::emplace_key(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                             std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  template <typename M>
+  hf::pair<iterator, bool> insert_or_assign(const key_type& key, M&& value) noexcept {
+    auto r = try_emplace(key, std::forward<M>(value));
+    if (!r.second) r.first->second = std::forward<M>(value);
+    return r;
+  }
+
+  mapped_type& operator[](const key_type& key) noexcept { return try_emplace(key).first->second; }
+
+  mapped_type& operator[](key_type&& key) noexcept {
+    return try_emplace(std::move(key)).first->second;
+  }
+
+  mapped_type& at(const key_type& key) noexcept {
+    auto it = base::find(key);
+    assert(it != base::end());
+    return it->second;
+  }
+
+  const mapped_type& at(const key_type& key) const noexcept {
+    auto it = base::find(key);
+    assert(it != base::end());
+    return it->second;
+  }
+
+  void swap(btree_map& rhs) noexcept { base::swap(rhs); }
+};
+
+template <typename Key, typename Value, typename Compare, typename Alloc>
+bool operator==(const btree_map<Key, Value, Compare, Alloc>& lhs,
+                const btree_map<Key, Value, Compare, Alloc>& rhs) noexcept {
+  if (lhs.size() != rhs.size()) return false;
+  for (auto l = lhs.begin(), r = rhs.begin(); l != lhs.end(); ++l, ++r) {
+    if (!(l->first == r->first) || !(l->second == r->second)) return false;
+  }
+  return true;
+}
+
+template <typename Key, typename Value, typename Compare, typename Alloc>
+bool operator!=(const btree_map<Key, Value, Compare, Alloc>& lhs,
+                const btree_map<Key, Value, Compare, Alloc>& rhs) noexcept {
+  return !(lhs == rhs);
+}
+
+template <typename Key, typename Value, typename Compare, typename Alloc>
+void swap(btree_map<Key, Value, Compare, Alloc>& lhs,
+          btree_map<Key, Value, Compare, Alloc>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+template <typename Key, typename Value, typename Compare, typename Alloc, typename Pred>
+size_t erase_if(btree_map<Key, Value, Compare, Alloc>& map, Pred pred) noexcept {
+  return map.erase_if(pred);
+}
+
+}  // namespace hf
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+
+#include "allocator.hpp"
+#include "btree.hpp"
+
+namespace hf {
+
+namespace detail {
+
+template <typename Key>
+struct btree_set_policy {
+  typedef Key key_type;
+  typedef Key value_type;
+
+  // the key decides the position, so elements can not be modified through an iterator
+  static constexpr bool CONST_ITERATOR = true;
+
+  static const Key& key(const value_type& value) noexcept { return value; }
+};
+
+}  // namespace detail
+
+// ordered set storing the keys inline in the nodes of a B-tree, see btree, inserting or
+// erasing invalidates every iterator and reference into the set
+template <typename Key, typename Compare = std::less<Key>, typename Alloc = hf::allocator<Key>>
+class btree_set : public detail::btree<detail::btree_set_policy<Key>, Compare, Alloc> {
+  typedef detail::btree<detail::btree_set_policy<Key>, Compare, Alloc> base;
+
+ public:
+  using typename base::const_iterator;
+  using typename base::iterator;
+  using typename base::key_type;
+  using typename base::value_type;
+
+ public:
+  btree_set() noexcept = default;
+
+  explicit btree_set(const Compare& comp, const Alloc& alloc = Alloc()) noexcept
+      : base(comp, alloc) {}
+
+  btree_set(std::initializer_list<value_type> list) noexcept { base::insert(list); }
+
+  btree_set(const btree_set&) noexcept = default;
+
+  btree_set(btree_set&&) noexcept = default;
+
+  btree_set& operator=(const btree_set&) noexcept = default;
+
+  btree_set& operator=(btree_set&&) noexcept = default;
+
+  ~btree_set() = default;
+
+  void swap(btree_set& rhs) noexcept { base::swap(rhs); }
+};
+
+template <typename Key, typename Compare, typename Alloc>
+bool operator==(const btree_set<Key, Compare, Alloc>& lhs,
+                const btree_set<Key, Compare, Alloc>& rhs) noexcept {
+  if (lhs.size() != rhs.size()) return false;
+  for (auto l = lhs.begin(), r = rhs.begin(); l != lhs.end(); ++l, ++r) {
+    if (!(*l == *r)) return false;
+  }
+  return true;
+}
+
+template <typename Key, typename Compare, typename Alloc>
+bool operator!=(const btree_set<Key, Compare, Alloc>& lhs,
+                const btree_set<Key, Compare, Alloc>& rhs) noexcept {
+  return !(lhs == rhs);
+}
+
+template <typename Key, typename Compare, typename Alloc>
+void swap(btree_set<Key, Compare, Alloc>& lhs, btree_set<Key, Compare, Alloc>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+template <typename Key, typename Compare, typename Alloc, typename Pred>
+size_t erase_if(btree_set<Key, Compare, Alloc>& set, Pred pred) noexcept {
+  return set.erase_if(pred);
+}
+
+}  // namespace hf
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <system_error>
+#include <type_traits>
+
+namespace hf {
+
+// same contract as std::to_chars/from_chars, no locale, no allocation and no exceptions
+struct to_chars_result {
+  char* ptr;
+  std::errc ec;
+};
+
+struct from_chars_result {
+  const char* ptr;
+  std::errc ec;
+};
+
+namespace detail {
+
+// the longest output of each kind: 20 digits and a sign, 17 significant digits with sign,
+// point and a four character exponent
+constexpr size_t MAX_INT_CHARS = 21;
+constexpr size_t MAX_DOUBLE_CHARS = 24;
+
+constexpr char DIGIT_PAIRS[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// number of decimal digits of x, from its bit length and one comparison, x | 1 has the
+// same count and makes 0 come out as one digit
+inline unsigned count_digits(uint64_t x) noexcept {
+  static constexpr uint64_t POW10[20] = {
+      1ull,           10ull,           100ull,           1000ull,           10000ull,
+      100000ull,      1000000ull,      10000000ull,      100000000ull,      1000000000ull,
+      10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+      1000000000000000ull,    10000000000000000ull,    100000000000000000ull,
+      1000000000000000000ull, 10000000000000000000ull};
+  x |= 1;
+  // 1233 / 4096 approximates log10(2)
+  unsigned t = ((64 - static_cast<unsigned>(__builtin_clzll(x))) * 1233) >> 12;
+  return t + (x >= POW10[t] ? 1 : 0);
+}
+
+// writes x backwards ending at end, two digits per step
+inline void write_digits(char* end, uint64_t x) noexcept {
+  while (x >= 100) {
+    auto r = static_cast<unsigned>(x % 100) * 2;
+    x /= 100;
+    *--end = DIGIT_PAIRS[r + 1];
+    *--end = DIGIT_PAIRS[r];
+  }
+  if (x >= 10) {
+    auto r = static_cast<unsigned>(x) * 2;
+    *--end = DIGIT_PAIRS[r + 1];
+    *--end = DIGIT_PAIRS[r];
+  } else {
+    *--end = static_cast<char>('0' + x);
+  }
+}
+
+}  // namespace detail
+
+/* ------------------------------------------------------------------------- */
+
+// decimal
+template <typename T, typename = typename std::enable_if<std::is_integral<T>::value &&
+                                                         !std::is_same<T, bool>::value>::type>
+to_chars_result to_chars(char* first, char* last, T value) noexcept {
+  typedef typename std::make_unsigned<T>::type U;
+  auto u = static_cast<uint64_t>(static_cast<U>(value));
+
+  if constexpr (std::is_signed<T>::value) {
+    if (value < 0) {
+      if (first == last) return {last, std::errc::value_too_large};
+      *first++ = '-';
+      u = static_cast<uint64_t>(static_cast<U>(U(0) - static_cast<U>(value)));
+    }
+  }
+
+  auto n = detail::count_digits(u);
+  if (static_cast<size_t>(last - first) < n) return {last, std::errc::value_too_large};
+  detail::write_digits(first + n, u);
+  return {first + n, std::errc()};
+}
+
+// the shortest digits that read back to the same value, in the shorter of fixed and
+// scientific notation, as std::to_chars without a format
+inline to_chars_result to_chars(char* first, char* last, double value) noexcept {
+  // small whole numbers, counters mostly, print the same as the integer and never
+  // shorter in scientific notation, -0.0 keeps its sign below
+  if (value > -100000.0 && value < 100000.0) {
+    auto i = static_cast<int32_t>(value);
+    if (static_cast<double>(i) == value && (i != 0 || !std::signbit(value))) {
+      return to_chars(first, last, i);
+    }
+  }
+
+#if defined(__cpp_lib_to_chars)
+  auto r = std::to_chars(first, last, value);
+  return {r.ptr, r.ec};
+#else
+  char buf[32];
+  auto n = static_cast<size_t>(std::snprintf(buf, sizeof(buf), "%.17g", value));
+  if (static_cast<size_t>(last - first) < n) return {last, std::errc::value_too_large};
+  std::memcpy(first, buf, n);
+  return {first + n, std::errc()};
+#endif
+}
+
+inline to_chars_result to_chars(char* first, char* last, float value) noexcept {
+#if defined(__cpp_lib_to_chars)
+  auto r = std::to_chars(first, last, value);
+  return {r.ptr, r.ec};
+#else
+  return to_chars(first, last, static_cast<double>(value));
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+
+// decimal with an optional '-' for signed types, no leading whitespace or '+'
+template <typename T, typename = typename std::enable_if<std::is_integral<T>::value &&
+                                                         !std::is_same<T, bool>::value>::type>
+from_chars_result from_chars(const char* first, const char* last, T& value) noexcept {
+  typedef typename std::make_unsigned<T>::type U;
+  auto p = first;
+  bool negative = false;
+
+  if constexpr (std::is_signed<T>::value) {
+    if (p != last && *p == '-') {
+      negative = true;
+      ++p;
+    }
+  }
+
+  auto digits = p;
+  U u = 0;
+  bool overflow = false;
+  for (; p != last && static_cast<unsigned char>(*p - '0') < 10; ++p) {
+    overflow |= __builtin_mul_overflow(u, U(10), &u);
+    overflow |= __builtin_add_overflow(u, static_cast<U>(*p - '0'), &u);
+  }
+
+  if (p == digits) return {first, std::errc::invalid_argument};
+  if constexpr (std::is_signed<T>::value) {
+    // the magnitude of the minimum is one more than the maximum
+    auto limit = static_cast<U>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+    if (overflow || u > limit) return {p, std::errc::result_out_of_range};
+    value = negative ? static_cast<T>(U(0) - u) : static_cast<T>(u);
+  } else {
+    if (overflow) return {p, std::errc::result_out_of_range};
+    value = u;
+  }
+  return {p, std::errc()};
+}
+
+// fixed or scientific notation, "inf" and "nan", correctly rounded
+inline from_chars_result from_chars(const char* first, const char* last, double& value) noexcept {
+#if defined(__cpp_lib_to_chars)
+  auto r = std::from_chars(first, last, value);
+  return {r.ptr, r.ec};
+#else
+  char buf[512];
+  auto n = static_cast<size_t>(last - first);
+  if (n >= sizeof(buf)) n = sizeof(buf) - 1;
+  std::memcpy(buf, first, n);
+  buf[n] = '\0';
+  char* end;
+  errno = 0;
+  auto v = std::strtod(buf, &end);
+  if (end == buf) return {first, std::errc::invalid_argument};
+  if (errno == ERANGE) return {first + (end - buf), std::errc::result_out_of_range};
+  value = v;
+  return {first + (end - buf), std::errc()};
+#endif
+}
+
+inline from_chars_result from_chars(const char* first, const char* last, float& value) noexcept {
+#if defined(__cpp_lib_to_chars)
+  auto r = std::from_chars(first, last, value);
+  return {r.ptr, r.ec};
+#else
+  double d;
+  auto r = from_chars(first, last, d);
+  if (r.ec == std::errc()) value = static_cast<float>(d);
+  return r;
+#endif
+}
+
+}  // namespace hf
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <typeinfo>
+#include <utility>
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+// per container type allocation statistics, compiled in only when HF_CONTAINER_STATS is
+// defined, otherwise every hook is an empty inline function and nothing is registered
+
+namespace hf {
+namespace stats {
+
+#ifdef HF_CONTAINER_STATS
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif
+
+// plain copy of the counters of one container type
+struct snapshot {
+  uint64_t allocations;    // buffers obtained from the allocator
+  uint64_t bytes;          // total size of those buffers
+  uint64_t reallocations;  // buffers replaced because the container grew or shrank
+  uint64_t wasted_bytes;   // capacity that was never used when a buffer was released
+  uint64_t moves;          // elements relocated or shifted to make room
+};
+
+class entry {
+ public:
+  explicit entry(std::string name) noexcept;
+
+  entry(const entry&) = delete;
+
+  entry& operator=(const entry&) = delete;
+
+  const std::string& name() const noexcept { return _name; }
+
+  entry* next() const noexcept { return _next; }
+
+  snapshot get() const noexcept {
+    return {_allocations.load(std::memory_order_relaxed), _bytes.load(std::memory_order_relaxed),
+            _reallocations.load(std::memory_order_relaxed),
+            _wasted_bytes.load(std::memory_order_relaxed), _moves.load(std::memory_order_relaxed)};
+  }
+
+  void reset() noexcept {
+    _allocations.store(0, std::memory_order_relaxed);
+    _bytes.store(0, std::memory_order_relaxed);
+    _reallocations.store(0, std::memory_order_relaxed);
+    _wasted_bytes.store(0, std::memory_order_relaxed);
+    _moves.store(0, std::memory_order_relaxed);
+  }
+
+  void add_allocation(size_t bytes) noexcept {
+    _allocations.fetch_add(1, std::memory_order_relaxed);
+    _bytes.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  void add_reallocation() noexcept { _reallocations.fetch_add(1, std::memory_order_relaxed); }
+
+  void add_waste(size_t bytes) noexcept {
+    _wasted_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  }
+
+  void add_moves(size_t n) noexcept { _moves.fetch_add(n, std::memory_order_relaxed); }
+
+ private:
+  std::string _name;
+  entry* _next = nullptr;
+
+  std::atomic<uint64_t> _allocations{0};
+  std::atomic<uint64_t> _bytes{0};
+  std::atomic<uint64_t> _reallocations{0};
+  std::atomic<uint64_t> _wasted_bytes{0};
+  std::atomic<uint64_t> _moves{0};
+};
+
+namespace detail {
+
+// entries are never removed, so readers can walk the list without a lock
+inline std::atomic<entry*>& registry_head() noexcept {
+  static std::atomic<entry*> head{nullptr};
+  return head;
+}
+
+inline std::string demangle(const char* name) {
+#if defined(__GNUG__)
+  int status = 0;
+  char* s = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+  if (status == 0 && s != nullptr) {
+    std::string r(s);
+    std::free(s);
+    return r;
+  }
+#endif
+  return name;
+}
+
+}  // namespace detail
+
+inline entry::entry(std::string name) noexcept : _name(std::move(name)) {
+  auto& head = detail::registry_head();
+  _next = head.load(std::memory_order_relaxed);
+  while (!head.compare_exchange_weak(_next, this, std::memory_order_release,
+                                     std::memory_order_relaxed)) {
+  }
+}
+
+// the entry of a container type, registered on first use
+template <typename Container>
+entry& of() noexcept {
+  static entry* e = new entry(detail::demangle(typeid(Container).name()));
+  return *e;
+}
+
+template <typename F>
+void for_each(F&& f) {
+  for (auto e = detail::registry_head().load(std::memory_order_acquire); e != nullptr;
+       e = e->next()) {
+    f(*e);
+  }
+}
+
+inline void reset() noexcept {
+  for_each([](entry& e) { e.reset(); });
+}
+
+// {"containers": [{"type": ..., "allocations": ..., ...}, ...]}
+inline void dump_json(std::ostream& os) {
+  os << "{\"containers\": [";
+  bool first = true;
+  for_each([&](const entry& e) {
+    auto s = e.get();
+    os << (first ? "\n" : ",\n") << "  {\"type\": \"";
+    for (char c : e.name()) {
+      if (c == '"' || c == '\\') os << '\\';
+      os << c;
+    }
+    os << "\", \"allocations\": " << s.allocations << ", \"bytes\": " << s.bytes
+       << ", \"reallocations\": " << s.reallocations << ", \"wasted_bytes\": " << s.wasted_bytes
+       << ", \"moves\": " << s.moves << "}";
+    first = false;
+  });
+  os << (first ? "]}\n" : "\n]}\n");
+}
+
+/* ------------------------------------------------------------------------- */
+
+// hooks called by the containers
+
+template <typename Container>
+inline void on_allocate(size_t bytes) noexcept {
+  if constexpr (enabled) of<Container>().add_allocation(bytes);
+}
+
+// a buffer of new_bytes replaced the current one and moved elements over
+template <typename Container>
+inline void on_reallocate(size_t new_bytes, size_t moved) noexcept {
+  if constexpr (enabled) {
+    auto& e = of<Container>();
+    e.add_allocation(new_bytes);
+    e.add_reallocation();
+    e.add_moves(moved);
+  }
+}
+
+template <typename Container>
+inline void on_release(size_t unused_bytes) noexcept {
+  if constexpr (enabled) of<Container>().add_waste(unused_bytes);
+}
+
+template <typename Container>
+inline void on_move(size_t n) noexcept {
+  if constexpr (enabled) of<Container>().add_moves(n);
+}
+
+}  // namespace stats
+}  // namespace hf
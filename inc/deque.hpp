@@ -0,0 +1,572 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+
+#include "allocator.hpp"
+#include "container_stats.hpp"
+#include "iterator.hpp"
+#include "type_traits.hpp"
+
+namespace hf {
+
+// double ended queue over fixed size blocks, a map of block pointers grows at either end
+// and only ever moves the pointers, so elements stay where they were constructed and
+// references survive pushes and pops at both ends. The block at each end is kept even
+// when it runs empty and one more is held in reserve, a queue that stays around the same
+// length does not allocate once it is warm
+template <typename T, typename Alloc = hf::allocator<T>>
+class deque : private hf::alloc_holder<Alloc> {
+ public:
+  // elements per block, blocks of about 4KB and never fewer than 16 elements
+  static constexpr size_t BLOCK_SIZE = sizeof(T) <= 256 ? 4096 / sizeof(T) : 16;
+
+  template <bool Const>
+  class basic_iterator;
+
+  typedef basic_iterator<false> iterator;
+  typedef basic_iterator<true> const_iterator;
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+
+  typedef Alloc allocator_type;
+
+ private:
+  typedef hf::alloc_holder<Alloc> holder;
+  typedef hf::allocator_traits<Alloc> alloc_traits;
+  typedef hf::allocator<T*> map_allocator;
+
+  using holder::_alloc;
+
+ public:
+  deque() noexcept = default;
+
+  explicit deque(const Alloc& alloc) noexcept : holder(alloc) {}
+
+  explicit deque(size_t n, const Alloc& alloc = Alloc()) noexcept : holder(alloc) {
+    for (size_t i = 0; i < n; ++i) emplace_back();
+  }
+
+  deque(const deque& rhs)
+      : holder(alloc_traits::select_on_container_copy_construction(rhs._alloc())) {
+    for (auto& x : rhs) emplace_back(x);
+  }
+
+  deque(deque&& rhs) noexcept : holder(std::move(rhs._alloc())) { steal(rhs); }
+
+  deque(std::initializer_list<T> list, const Alloc& alloc = Alloc()) : holder(alloc) {
+    for (auto& x : list) emplace_back(x);
+  }
+
+  deque& operator=(const deque& rhs);
+
+  deque& operator=(deque&& rhs) noexcept;
+
+  ~deque() { release(); }
+
+ public:
+  iterator begin() noexcept { return _start; }
+
+  iterator end() noexcept { return _finish; }
+
+  const_iterator begin() const noexcept { return _start; }
+
+  const_iterator end() const noexcept { return _finish; }
+
+  const_iterator cbegin() const noexcept { return _start; }
+
+  const_iterator cend() const noexcept { return _finish; }
+
+  allocator_type get_allocator() const noexcept { return _alloc(); }
+
+  /* ------------------------------------------------------------------------- */
+
+  size_t size() const noexcept { return static_cast<size_t>(_finish - _start); }
+
+  size_t max_size() const noexcept { return static_cast<size_t>(-1) / sizeof(T); }
+
+  bool empty() const noexcept { return _start == _finish; }
+
+  /* ------------------------------------------------------------------------- */
+
+  reference operator[](size_t n) noexcept { return _start[static_cast<ptrdiff_t>(n)]; }
+
+  const_reference operator[](size_t n) const noexcept {
+    return _start[static_cast<ptrdiff_t>(n)];
+  }
+
+  reference front() noexcept { return *_start; }
+
+  const_reference front() const noexcept { return *_start; }
+
+  reference back() noexcept {
+    return _finish._cur != _finish._first ? _finish._cur[-1] : _finish._node[-1][BLOCK_SIZE - 1];
+  }
+
+  const_reference back() const noexcept {
+    return _finish._cur != _finish._first ? _finish._cur[-1] : _finish._node[-1][BLOCK_SIZE - 1];
+  }
+
+  /* ------------------------------------------------------------------------- */
+
+  // the block at the back always has a free slot past the last element, so end() stays
+  // dereferenceable as a position
+  template <typename... Args>
+  reference emplace_back(Args&&... args) noexcept {
+    if (_finish._last - _finish._cur > 1) {
+      alloc_traits::construct(_alloc(), _finish._cur, std::forward<Args>(args)...);
+      return *_finish._cur++;
+    }
+    return emplace_back_slow(std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  reference emplace_front(Args&&... args) noexcept {
+    if (_start._cur != _start._first) {
+      alloc_traits::construct(_alloc(), _start._cur - 1, std::forward<Args>(args)...);
+      return *--_start._cur;
+    }
+    return emplace_front_slow(std::forward<Args>(args)...);
+  }
+
+  void push_back(const_reference value) noexcept { emplace_back(value); }
+
+  void push_back(T&& value) noexcept { emplace_back(std::move(value)); }
+
+  void push_front(const_reference value) noexcept { emplace_front(value); }
+
+  void push_front(T&& value) noexcept { emplace_front(std::move(value)); }
+
+  void pop_back() noexcept {
+    assert(!empty());
+    if (_finish._cur == _finish._first) {
+      put_block(*_finish._node);
+      _finish.set_node(_finish._node - 1);
+      _finish._cur = _finish._last;
+    }
+    alloc_traits::destroy(_alloc(), --_finish._cur);
+  }
+
+  void pop_front() noexcept {
+    assert(!empty());
+    alloc_traits::destroy(_alloc(), _start._cur);
+    if (++_start._cur == _start._last) {
+      put_block(*_start._node);
+      _start.set_node(_start._node + 1);
+      _start._cur = _start._first;
+    }
+  }
+
+  void resize(size_t new_size) noexcept;
+
+  void resize(size_t new_size, const_reference value) noexcept;
+
+  // keeps one block, with both ends in its middle
+  void clear() noexcept;
+
+  void swap(deque& rhs) noexcept;
+
+  // gives the reserve block back, the map and the end blocks stay
+  void shrink_to_fit() noexcept {
+    if (_spare != nullptr) {
+      alloc_traits::deallocate(_alloc(), _spare, BLOCK_SIZE);
+      _spare = nullptr;
+    }
+  }
+
+  /* ------------------------------------------------------------------------- */
+
+  template <bool Const>
+  class basic_iterator {
+   public:
+    typedef hf::random_access_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef ptrdiff_t difference_type;
+    typedef typename std::conditional<Const, const T*, T*>::type pointer;
+    typedef typename std::conditional<Const, const T&, T&>::type reference;
+
+    basic_iterator() noexcept = default;
+
+    // a const iterator from a mutable one
+    template <bool C = Const, typename = typename std::enable_if<C>::type>
+    basic_iterator(const basic_iterator<false>& rhs) noexcept
+        : _cur(rhs._cur), _first(rhs._first), _last(rhs._last), _node(rhs._node) {}
+
+    reference operator*() const noexcept { return *_cur; }
+
+    pointer operator->() const noexcept { return _cur; }
+
+    reference operator[](difference_type n) const noexcept { return *(*this + n); }
+
+    basic_iterator& operator++() noexcept {
+      if (++_cur == _last) {
+        set_node(_node + 1);
+        _cur = _first;
+      }
+      return *this;
+    }
+
+    basic_iterator operator++(int) noexcept {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    basic_iterator& operator--() noexcept {
+      if (_cur == _first) {
+        set_node(_node - 1);
+        _cur = _last;
+      }
+      --_cur;
+      return *this;
+    }
+
+    basic_iterator operator--(int) noexcept {
+      auto tmp = *this;
+      --*this;
+      return tmp;
+    }
+
+    basic_iterator& operator+=(difference_type n) noexcept;
+
+    basic_iterator& operator-=(difference_type n) noexcept { return *this += -n; }
+
+    friend basic_iterator operator+(basic_iterator it, difference_type n) noexcept {
+      return it += n;
+    }
+
+    friend basic_iterator operator+(difference_type n, basic_iterator it) noexcept {
+      return it += n;
+    }
+
+    friend basic_iterator operator-(basic_iterator it, difference_type n) noexcept {
+      return it -= n;
+    }
+
+    friend difference_type operator-(const basic_iterator& lhs,
+                                     const basic_iterator& rhs) noexcept {
+      if (lhs._node == rhs._node) return lhs._cur - rhs._cur;
+      return static_cast<difference_type>(BLOCK_SIZE) * (lhs._node - rhs._node - 1) +
+             (lhs._cur - lhs._first) + (rhs._last - rhs._cur);
+    }
+
+    friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+      return lhs._cur == rhs._cur;
+    }
+
+    friend bool operator!=(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+      return lhs._cur != rhs._cur;
+    }
+
+    friend bool operator<(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+      return lhs._node == rhs._node ? lhs._cur < rhs._cur : lhs._node < rhs._node;
+    }
+
+    friend bool operator>(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+      return rhs < lhs;
+    }
+
+    friend bool operator<=(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+      return !(rhs < lhs);
+    }
+
+    friend bool operator>=(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+      return !(lhs < rhs);
+    }
+
+   private:
+    friend class deque;
+    friend class basic_iterator<!Const>;
+
+    basic_iterator(T* cur, T** node) noexcept
+        : _cur(cur), _first(*node), _last(*node + BLOCK_SIZE), _node(node) {}
+
+    void set_node(T** node) noexcept {
+      _node = node;
+      _first = *node;
+      _last = *node + BLOCK_SIZE;
+    }
+
+    // the element, the bounds of its block and the block's slot in the map
+    T* _cur = nullptr;
+    T* _first = nullptr;
+    T* _last = nullptr;
+    T** _node = nullptr;
+  };
+
+ private:
+  template <typename... Args>
+  reference emplace_back_slow(Args&&... args) noexcept;
+
+  template <typename... Args>
+  reference emplace_front_slow(Args&&... args) noexcept;
+
+  void init_map() noexcept;
+
+  void reserve_map(bool at_front) noexcept;
+
+  T* get_block() noexcept;
+
+  void put_block(T* block) noexcept;
+
+  void destroy_elements() noexcept;
+
+  void release() noexcept;
+
+  void steal(deque& rhs) noexcept;
+
+  iterator _start;
+  iterator _finish;
+  T** _map = nullptr;
+  size_t _map_size = 0;
+  T* _spare = nullptr;
+};
+
+/* ------------------------------------------------------------------------- */
+
+template <typename T, typename Alloc>
+deque<T, Alloc>& deque<T, Alloc>::operator=(const deque& rhs) {
+  if (this != &rhs) {
+    if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+      if (!alloc_traits::equal(_alloc(), rhs._alloc())) release();
+      _alloc() = rhs._alloc();
+    }
+    clear();
+    for (auto& x : rhs) emplace_back(x);
+  }
+  return *this;
+}
+
+template <typename T, typename Alloc>
+deque<T, Alloc>& deque<T, Alloc>::operator=(deque&& rhs) noexcept {
+  if (this != &rhs) {
+    // blocks can only be stolen if our allocator is able to release them afterwards
+    if constexpr (!alloc_traits::propagate_on_container_move_assignment::value) {
+      if (!alloc_traits::equal(_alloc(), rhs._alloc())) {
+        clear();
+        for (auto& x : rhs) emplace_back(std::move(x));
+        rhs.clear();
+        return *this;
+      }
+    }
+
+    release();
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+      _alloc() = std::move(rhs._alloc());
+    }
+    steal(rhs);
+  }
+  return *this;
+}
+
+template <typename T, typename Alloc>
+void deque<T, Alloc>::resize(size_t new_size) noexcept {
+  while (size() > new_size) pop_back();
+  while (size() < new_size) emplace_back();
+}
+
+template <typename T, typename Alloc>
+void deque<T, Alloc>::resize(size_t new_size, const_reference value) noexcept {
+  while (size() > new_size) pop_back();
+  while (size() < new_size) emplace_back(value);
+}
+
+template <typename T, typename Alloc>
+void deque<T, Alloc>::clear() noexcept {
+  if (_map == nullptr) return;
+  destroy_elements();
+  for (auto node = _start._node + 1; node <= _finish._node; ++node) put_block(*node);
+
+  auto middle = *_start._node + BLOCK_SIZE / 2;
+  _start._cur = middle;
+  _finish = _start;
+}
+
+template <typename T, typename Alloc>
+void deque<T, Alloc>::swap(deque& rhs) noexcept {
+  if (this != &rhs) {
+    if constexpr (alloc_traits::propagate_on_container_swap::value) {
+      std::swap(_alloc(), rhs._alloc());
+    } else {
+      assert(alloc_traits::equal(_alloc(), rhs._alloc()));
+    }
+    std::swap(_start, rhs._start);
+    std::swap(_finish, rhs._finish);
+    std::swap(_map, rhs._map);
+    std::swap(_map_size, rhs._map_size);
+    std::swap(_spare, rhs._spare);
+  }
+}
+
+template <typename T, typename Alloc>
+template <bool Const>
+typename deque<T, Alloc>::template basic_iterator<Const>&
+deque<T, Alloc>::basic_iterator<Const>::operator+=(difference_type n) noexcept {
+  constexpr auto block = static_cast<difference_type>(BLOCK_SIZE);
+  auto offset = n + (_cur - _first);
+  if (offset >= 0 && offset < block) {
+    _cur += n;
+  } else {
+    auto nodes = offset > 0 ? offset / block : -((-offset - 1) / block) - 1;
+    set_node(_node + nodes);
+    _cur = _first + (offset - nodes * block);
+  }
+  return *this;
+}
+
+/* ------------------------------------------------------------------------- */
+
+// the element goes into the last free slot of the back block, a fresh block then follows
+template <typename T, typename Alloc>
+template <typename... Args>
+typename deque<T, Alloc>::reference deque<T, Alloc>::emplace_back_slow(Args&&... args) noexcept {
+  if (_map == nullptr) {
+    init_map();
+    alloc_traits::construct(_alloc(), _finish._cur, std::forward<Args>(args)...);
+    return *_finish._cur++;
+  }
+
+  reserve_map(false);
+  _finish._node[1] = get_block();
+  auto p = _finish._cur;
+  alloc_traits::construct(_alloc(), p, std::forward<Args>(args)...);
+  _finish.set_node(_finish._node + 1);
+  _finish._cur = _finish._first;
+  return *p;
+}
+
+template <typename T, typename Alloc>
+template <typename... Args>
+typename deque<T, Alloc>::reference deque<T, Alloc>::emplace_front_slow(Args&&... args) noexcept {
+  if (_map == nullptr) init_map();
+  if (_start._cur != _start._first) {
+    alloc_traits::construct(_alloc(), _start._cur - 1, std::forward<Args>(args)...);
+    return *--_start._cur;
+  }
+
+  reserve_map(true);
+  _start._node[-1] = get_block();
+  auto p = _start._node[-1] + BLOCK_SIZE - 1;
+  alloc_traits::construct(_alloc(), p, std::forward<Args>(args)...);
+  _start.set_node(_start._node - 1);
+  _start._cur = p;
+  return *p;
+}
+
+// one block in the middle of a small map, both ends start in the middle of the block
+template <typename T, typename Alloc>
+void deque<T, Alloc>::init_map() noexcept {
+  _map_size = 8;
+  _map = map_allocator::allocate(_map_size);
+  stats::on_allocate<deque>(_map_size * sizeof(T*));
+
+  auto node = _map + _map_size / 2;
+  *node = get_block();
+  _start = iterator(*node + BLOCK_SIZE / 2, node);
+  _finish = _start;
+}
+
+// makes room for one more block pointer at the front or back of the map. Pointers are
+// recentered if the map is less than half full, otherwise they move to a map twice the size
+template <typename T, typename Alloc>
+void deque<T, Alloc>::reserve_map(bool at_front) noexcept {
+  if (at_front ? _start._node != _map : _finish._node + 1 != _map + _map_size) return;
+
+  auto old_nodes = static_cast<size_t>(_finish._node - _start._node) + 1;
+  auto new_nodes = old_nodes + 1;
+  T** new_start;
+
+  if (_map_size > 2 * new_nodes) {
+    new_start = _map + (_map_size - new_nodes) / 2 + (at_front ? 1 : 0);
+    std::memmove(new_start, _start._node, old_nodes * sizeof(T*));
+  } else {
+    auto new_map_size = _map_size * 2;
+    auto new_map = map_allocator::allocate(new_map_size);
+    stats::on_reallocate<deque>(new_map_size * sizeof(T*), 0);
+    new_start = new_map + (new_map_size - new_nodes) / 2 + (at_front ? 1 : 0);
+    std::memcpy(new_start, _start._node, old_nodes * sizeof(T*));
+    map_allocator::deallocate(_map, _map_size);
+    _map = new_map;
+    _map_size = new_map_size;
+  }
+
+  // the blocks did not move, only the slots that point at them
+  _start.set_node(new_start);
+  _finish.set_node(new_start + old_nodes - 1);
+}
+
+template <typename T, typename Alloc>
+T* deque<T, Alloc>::get_block() noexcept {
+  if (_spare != nullptr) {
+    auto block = _spare;
+    _spare = nullptr;
+    return block;
+  }
+  stats::on_allocate<deque>(BLOCK_SIZE * sizeof(T));
+  return alloc_traits::allocate(_alloc(), BLOCK_SIZE);
+}
+
+template <typename T, typename Alloc>
+void deque<T, Alloc>::put_block(T* block) noexcept {
+  if (_spare == nullptr) {
+    _spare = block;
+  } else {
+    alloc_traits::deallocate(_alloc(), block, BLOCK_SIZE);
+  }
+}
+
+template <typename T, typename Alloc>
+void deque<T, Alloc>::destroy_elements() noexcept {
+  if constexpr (!std::is_trivially_destructible<T>::value) {
+    if (_start._node == _finish._node) {
+      alloc_traits::destroy(_alloc(), _start._cur, _finish._cur);
+    } else {
+      alloc_traits::destroy(_alloc(), _start._cur, _start._last);
+      for (auto node = _start._node + 1; node < _finish._node; ++node) {
+        alloc_traits::destroy(_alloc(), *node, *node + BLOCK_SIZE);
+      }
+      alloc_traits::destroy(_alloc(), _finish._first, _finish._cur);
+    }
+  }
+}
+
+template <typename T, typename Alloc>
+void deque<T, Alloc>::release() noexcept {
+  if (_map != nullptr) {
+    destroy_elements();
+    for (auto node = _start._node; node <= _finish._node; ++node) {
+      alloc_traits::deallocate(_alloc(), *node, BLOCK_SIZE);
+    }
+    map_allocator::deallocate(_map, _map_size);
+  }
+  shrink_to_fit();
+  _start = _finish = iterator();
+  _map = nullptr;
+  _map_size = 0;
+}
+
+template <typename T, typename Alloc>
+void deque<T, Alloc>::steal(deque& rhs) noexcept {
+  _start = rhs._start;
+  _finish = rhs._finish;
+  _map = rhs._map;
+  _map_size = rhs._map_size;
+  _spare = rhs._spare;
+  rhs._start = rhs._finish = iterator();
+  rhs._map = nullptr;
+  rhs._map_size = 0;
+  rhs._spare = nullptr;
+}
+
+// no pointer refers into the deque object itself
+template <typename T, typename Alloc>
+struct is_trivially_relocatable<deque<T, Alloc>> : public is_trivially_relocatable<Alloc> {};
+
+}  // namespace hf
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <initializer_list>
+
+#include "allocator.hpp"
+#include "flat_hash_table.hpp"
+#include "hash.hpp"
+#include "utils.hpp"
+
+namespace hf {
+
+namespace detail {
+
+template <typename Key, typename Value>
+struct flat_map_policy {
+  typedef Key key_type;
+  typedef hf::pair<const Key, Value> value_type;
+
+  static constexpr bool CONST_ITERATOR = false;
+
+  static const Key& key(const value_type& value) noexcept { return value.first; }
+};
+
+}  // namespace detail
+
+// open addressing hash map storing hf::pair<const Key, Value> inline, see flat_table,
+// inserting or erasing invalidates every iterator and reference into the map
+template <typename Key, typename Value, typename Hash = hf::hash<Key>,
+          typename KeyEqual = detail::default_equal<Key>,
+          typename Alloc = hf::allocator<hf::pair<const Key, Value>>>
+class flat_hash_map
+    : public detail::flat_table<detail::flat_map_policy<Key, Value>, Hash, KeyEqual, Alloc> {
+  typedef detail::flat_table<detail::flat_map_policy<Key, Value>, Hash, KeyEqual, Alloc> base;
+
+ public:
+  typedef Value mapped_type;
+
+  using typename base::const_iterator;
+  using typename base::iterator;
+  using typename base::key_type;
+  using typename base::value_type;
+
+ public:
+  flat_hash_map() noexcept = default;
+
+  explicit flat_hash_map(size_t n, const Hash& hash = Hash(), const KeyEqual& eq = KeyEqual(),
+                         const Alloc& alloc = Alloc()) noexcept
+      : base(n, hash, eq, alloc) {}
+
+  flat_hash_map(std::initializer_list<value_type> list) noexcept : base(list.size()) {
+    base::insert(list);
+  }
+
+  flat_hash_map(const flat_hash_map&) noexcept = default;
+
+  flat_hash_map(flat_hash_map&&) noexcept = default;
+
+  flat_hash_map& operator=(const flat_hash_map&) noexcept = default;
+
+  flat_hash_map& operator=(flat_hash_map&&) noexcept = default;
+
+  ~flat_hash_map() = default;
+
+ public:
+  // unlike emplace, the value is only constructed when the key is missing
+  template <typename... Args>
+  hf::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args) noexcept {
+    return base::emplace_key(key, std::piecewise_construct, std::forward_as_tuple(key),
+                             std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  template <typename... Args>
+  hf::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args) noexcept {
+    return base::emplace_key(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                             std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  template <typename M>
+  hf::pair<iterator, bool> insert_or_assign(const key_type& key, M&& value) noexcept {
+    auto r = try_emplace(key, std::forward<M>(value));
+    if (!r.second) r.first->second = std::forward<M>(value);
+    return r;
+  }
+
+  mapped_type& operator[](const key_type& key) noexcept { return try_emplace(key).first->second; }
+
+  mapped_type& operator[](key_type&& key) noexcept {
+    return try_emplace(std::move(key)).first->second;
+  }
+
+  mapped_type& at(const key_type& key) noexcept {
+    auto it = base::find(key);
+    assert(it != base::end());
+    return it->second;
+  }
+
+  const mapped_type& at(const key_type& key) const noexcept {
+    auto it = base::find(key);
+    assert(it != base::end());
+    return it->second;
+  }
+
+  void swap(flat_hash_map& rhs) noexcept { base::swap(rhs); }
+};
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Alloc>
+bool operator==(const flat_hash_map<Key, Value, Hash, KeyEqual, Alloc>& lhs,
+                const flat_hash_map<Key, Value, Hash, KeyEqual, Alloc>& rhs) noexcept {
+  if (lhs.size() != rhs.size()) return false;
+  for (auto& value : lhs) {
+    auto it = rhs.find(value.first);
+    if (it == rhs.end() || !(it->second == value.second)) return false;
+  }
+  return true;
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Alloc>
+bool operator!=(const flat_hash_map<Key, Value, Hash, KeyEqual, Alloc>& lhs,
+                const flat_hash_map<Key, Value, Hash, KeyEqual, Alloc>& rhs) noexcept {
+  return !(lhs == rhs);
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Alloc>
+void swap(flat_hash_map<Key, Value, Hash, KeyEqual, Alloc>& lhs,
+          flat_hash_map<Key, Value, Hash, KeyEqual, Alloc>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+template <typename Key, typename Value, typename Hash, typename KeyEqual, typename Alloc,
+          typename Pred>
+size_t erase_if(flat_hash_map<Key, Value, Hash, KeyEqual, Alloc>& map, Pred pred) noexcept {
+  return map.erase_if(pred);
+}
+
+}  // namespace hf
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <initializer_list>
+
+#include "allocator.hpp"
+#include "flat_hash_table.hpp"
+#include "hash.hpp"
+
+namespace hf {
+
+namespace detail {
+
+template <typename Key>
+struct flat_set_policy {
+  typedef Key key_type;
+  typedef Key value_type;
+
+  // the key decides the slot, so elements can not be modified through an iterator
+  static constexpr bool CONST_ITERATOR = true;
+
+  static const Key& key(const value_type& value) noexcept { return value; }
+};
+
+}  // namespace detail
+
+// open addressing hash set storing the keys inline, see flat_table, inserting or
+// erasing invalidates every iterator and reference into the set
+template <typename Key, typename Hash = hf::hash<Key>,
+          typename KeyEqual = detail::default_equal<Key>, typename Alloc = hf::allocator<Key>>
+class flat_hash_set
+    : public detail::flat_table<detail::flat_set_policy<Key>, Hash, KeyEqual, Alloc> {
+  typedef detail::flat_table<detail::flat_set_policy<Key>, Hash, KeyEqual, Alloc> base;
+
+ public:
+  using typename base::const_iterator;
+  using typename base::iterator;
+  using typename base::key_type;
+  using typename base::value_type;
+
+ public:
+  flat_hash_set() noexcept = default;
+
+  explicit flat_hash_set(size_t n, const Hash& hash = Hash(), const KeyEqual& eq = KeyEqual(),
+                         const Alloc& alloc = Alloc()) noexcept
+      : base(n, hash, eq, alloc) {}
+
+  flat_hash_set(std::initializer_list<value_type> list) noexcept : base(list.size()) {
+    base::insert(list);
+  }
+
+  flat_hash_set(const flat_hash_set&) noexcept = default;
+
+  flat_hash_set(flat_hash_set&&) noexcept = default;
+
+  flat_hash_set& operator=(const flat_hash_set&) noexcept = default;
+
+  flat_hash_set& operator=(flat_hash_set&&) noexcept = default;
+
+  ~flat_hash_set() = default;
+
+  void swap(flat_hash_set& rhs) noexcept { base::swap(rhs); }
+};
+
+template <typename Key, typename Hash, typename KeyEqual, typename Alloc>
+bool operator==(const flat_hash_set<Key, Hash, KeyEqual, Alloc>& lhs,
+                const flat_hash_set<Key, Hash, KeyEqual, Alloc>& rhs) noexcept {
+  if (lhs.size() != rhs.size()) return false;
+  for (auto& key : lhs) {
+    if (!rhs.contains(key)) return false;
+  }
+  return true;
+}
+
+template <typename Key, typename Hash, typename KeyEqual, typename Alloc>
+bool operator!=(const flat_hash_set<Key, Hash, KeyEqual, Alloc>& lhs,
+                const flat_hash_set<Key, Hash, KeyEqual, Alloc>& rhs) noexcept {
+  return !(lhs == rhs);
+}
+
+template <typename Key, typename Hash, typename KeyEqual, typename Alloc>
+void swap(flat_hash_set<Key, Hash, KeyEqual, Alloc>& lhs,
+          flat_hash_set<Key, Hash, KeyEqual, Alloc>& rhs) noexcept {
+  lhs.swap(rhs);
+}
+
+template <typename Key, typename Hash, typename KeyEqual, typename Alloc, typename Pred>
+size_t erase_if(flat_hash_set<Key, Hash, KeyEqual, Alloc>& set, Pred pred) noexcept {
+  return set.erase_if(pred);
+}
+
+}  // namespace hf
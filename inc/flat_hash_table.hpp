@@ -0,0 +1,659 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+
+#include "allocator.hpp"
+#include "container_stats.hpp"
+#include "hash.hpp"
+#include "simd.hpp"
+#include "type_traits.hpp"
+#include "utils.hpp"
+
+namespace hf {
+
+namespace detail {
+
+// one control byte per slot, the low 7 bits of the hash for a full slot and CTRL_EMPTY
+// otherwise, erasure shifts entries back instead of leaving tombstones behind
+typedef int8_t ctrl_t;
+
+constexpr ctrl_t CTRL_EMPTY = -128;
+
+constexpr size_t GROUP_WIDTH = 16;
+
+// the control bytes of GROUP_WIDTH consecutive slots, bit i of a mask stands for slot i
+class ctrl_group {
+ public:
+#if defined(HF_SIMD_X86) && defined(__SSE2__)
+  explicit ctrl_group(const ctrl_t* p) noexcept
+      : _v(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) {}
+
+  uint32_t match(ctrl_t h2) const noexcept {
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_v, _mm_set1_epi8(h2))));
+  }
+
+  uint32_t match_full() const noexcept {
+    return static_cast<uint32_t>(_mm_movemask_epi8(_v)) ^ 0xFFFF;
+  }
+
+ private:
+  __m128i _v;
+#else
+  explicit ctrl_group(const ctrl_t* p) noexcept : _p(p) {}
+
+  uint32_t match(ctrl_t h2) const noexcept {
+    uint32_t m = 0;
+    for (size_t i = 0; i < GROUP_WIDTH; ++i) m |= static_cast<uint32_t>(_p[i] == h2) << i;
+    return m;
+  }
+
+  uint32_t match_full() const noexcept {
+    uint32_t m = 0;
+    for (size_t i = 0; i < GROUP_WIDTH; ++i) m |= static_cast<uint32_t>(_p[i] >= 0) << i;
+    return m;
+  }
+
+ private:
+  const ctrl_t* _p;
+#endif
+
+ public:
+  uint32_t match_empty() const noexcept { return match(CTRL_EMPTY); }
+};
+
+// spreads the entropy of weak hashes such as std::hash<int> over all bits, skipped for
+// hashers marked is_avalanching
+inline size_t mix_hash(size_t h) noexcept {
+  auto r = static_cast<unsigned __int128>(h) * 0x9E3779B97F4A7C15ull;
+  return static_cast<size_t>(r) ^ static_cast<size_t>(r >> 64);
+}
+
+/* ------------------------------------------------------------------------- */
+
+// open addressing table shared by flat_hash_map and flat_hash_set, slots and control
+// bytes live in one allocation of capacity slots followed by capacity + GROUP_WIDTH
+// control bytes, the last GROUP_WIDTH of which mirror the first so that a group can
+// be loaded at any slot. Probing is linear, a key sits after its home slot with no
+// empty slot in between, which is what lets erase shift entries back
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+class flat_table : private hf::alloc_holder<Alloc> {
+ public:
+  typedef typename Policy::key_type key_type;
+  typedef typename Policy::value_type value_type;
+  typedef Hash hasher;
+  typedef KeyEqual key_equal;
+  typedef Alloc allocator_type;
+  typedef size_t size_type;
+
+  template <bool Const>
+  class basic_iterator;
+
+  typedef basic_iterator<Policy::CONST_ITERATOR> iterator;
+  typedef basic_iterator<true> const_iterator;
+
+ protected:
+  typedef hf::alloc_holder<Alloc> holder;
+  typedef hf::allocator_traits<Alloc> alloc_traits;
+
+  using holder::_alloc;
+
+  static constexpr size_t MIN_CAPACITY = GROUP_WIDTH;
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  value_type* _slots = nullptr;
+  ctrl_t* _ctrl = nullptr;
+  size_t _cap = 0;
+  size_t _size = 0;
+  Hash _hash;
+  KeyEqual _eq;
+
+  // lookups by any type the hasher and key_equal accept, only when both are transparent
+  template <typename K>
+  using if_transparent =
+      typename std::enable_if<is_transparent<Hash>::value && is_transparent<KeyEqual>::value,
+                              K>::type;
+
+  // keeps erase(key) from taking iterators when the key overloads are templates
+  template <typename K>
+  using if_not_iterator =
+      typename std::enable_if<!std::is_convertible<K, iterator>::value &&
+                                  !std::is_convertible<K, const_iterator>::value,
+                              K>::type;
+
+ public:
+  flat_table() noexcept = default;
+
+  explicit flat_table(size_t n, const Hash& hash = Hash(), const KeyEqual& eq = KeyEqual(),
+                      const Alloc& alloc = Alloc()) noexcept
+      : holder(alloc), _hash(hash), _eq(eq) {
+    reserve(n);
+  }
+
+  flat_table(const flat_table& rhs) noexcept
+      : holder(alloc_traits::select_on_container_copy_construction(rhs._alloc())),
+        _hash(rhs._hash),
+        _eq(rhs._eq) {
+    copy_from(rhs);
+  }
+
+  flat_table(flat_table&& rhs) noexcept
+      : holder(std::move(rhs._alloc())),
+        _slots(rhs._slots),
+        _ctrl(rhs._ctrl),
+        _cap(rhs._cap),
+        _size(rhs._size),
+        _hash(std::move(rhs._hash)),
+        _eq(std::move(rhs._eq)) {
+    rhs._slots = nullptr;
+    rhs._ctrl = nullptr;
+    rhs._cap = rhs._size = 0;
+  }
+
+  flat_table& operator=(const flat_table& rhs) noexcept;
+
+  flat_table& operator=(flat_table&& rhs) noexcept;
+
+  ~flat_table() { destroy_table(); }
+
+ public:
+  iterator begin() noexcept {
+    iterator it(_ctrl, _slots, _ctrl + _cap);
+    it.skip_empty();
+    return it;
+  }
+
+  iterator end() noexcept { return iterator(_ctrl + _cap, _slots + _cap, _ctrl + _cap); }
+
+  const_iterator begin() const noexcept {
+    const_iterator it(_ctrl, _slots, _ctrl + _cap);
+    it.skip_empty();
+    return it;
+  }
+
+  const_iterator end() const noexcept {
+    return const_iterator(_ctrl + _cap, _slots + _cap, _ctrl + _cap);
+  }
+
+  const_iterator cbegin() const noexcept { return begin(); }
+
+  const_iterator cend() const noexcept { return end(); }
+
+  allocator_type get_allocator() const noexcept { return _alloc(); }
+
+  hasher hash_function() const noexcept { return _hash; }
+
+  key_equal key_eq() const noexcept { return _eq; }
+
+  /* ------------------------------------------------------------------------- */
+
+  bool empty() const noexcept { return _size == 0; }
+
+  size_t size() const noexcept { return _size; }
+
+  size_t capacity() const noexcept { return _cap; }
+
+  float load_factor() const noexcept { return _cap == 0 ? 0.0f : float(_size) / float(_cap); }
+
+  /* ------------------------------------------------------------------------- */
+
+  iterator find(const key_type& key) noexcept { return iterator_at(find_index(key)); }
+
+  const_iterator find(const key_type& key) const noexcept {
+    return const_cast<flat_table*>(this)->find(key);
+  }
+
+  template <typename K, typename = if_transparent<K>>
+  iterator find(const K& key) noexcept {
+    return iterator_at(find_index(key));
+  }
+
+  template <typename K, typename = if_transparent<K>>
+  const_iterator find(const K& key) const noexcept {
+    return const_cast<flat_table*>(this)->find(key);
+  }
+
+  bool contains(const key_type& key) const noexcept { return find_index(key) != npos; }
+
+  template <typename K, typename = if_transparent<K>>
+  bool contains(const K& key) const noexcept {
+    return find_index(key) != npos;
+  }
+
+  size_t count(const key_type& key) const noexcept { return contains(key) ? 1 : 0; }
+
+  template <typename K, typename = if_transparent<K>>
+  size_t count(const K& key) const noexcept {
+    return find_index(key) != npos ? 1 : 0;
+  }
+
+  /* ------------------------------------------------------------------------- */
+
+  hf::pair<iterator, bool> insert(const value_type& value) noexcept {
+    return emplace_key(Policy::key(value), value);
+  }
+
+  hf::pair<iterator, bool> insert(value_type&& value) noexcept {
+    return emplace_key(Policy::key(value), std::move(value));
+  }
+
+  template <typename Iter>
+  void insert(Iter first, Iter last) noexcept {
+    for (; first != last; ++first) insert(*first);
+  }
+
+  void insert(std::initializer_list<value_type> list) noexcept {
+    insert(list.begin(), list.end());
+  }
+
+  template <typename... Args>
+  hf::pair<iterator, bool> emplace(Args&&... args) noexcept {
+    value_type value(std::forward<Args>(args)...);
+    return insert(std::move(value));
+  }
+
+  size_t erase(const key_type& key) noexcept { return erase_key(key); }
+
+  template <typename K, typename = if_transparent<K>, typename = if_not_iterator<K>>
+  size_t erase(const K& key) noexcept {
+    return erase_key(key);
+  }
+
+  // entries behind the erased one may shift into its slot, so unlike the node based
+  // containers no iterator is returned, use hf::erase_if to erase while iterating
+  void erase(const_iterator pos) noexcept { erase_at(pos._slot - _slots); }
+
+  void clear() noexcept;
+
+  void reserve(size_t n) noexcept;
+
+  void swap(flat_table& rhs) noexcept;
+
+  template <typename Pred>
+  size_t erase_if(Pred pred) noexcept;
+
+ protected:
+  static size_t max_load(size_t cap) noexcept { return cap - cap / 8; }
+
+  template <typename K>
+  size_t hash_key(const K& key) const noexcept {
+    if constexpr (is_avalanching<Hash>::value) {
+      return _hash(key);
+    } else {
+      return mix_hash(_hash(key));
+    }
+  }
+
+  size_t hash_of(const value_type& value) const noexcept { return hash_key(Policy::key(value)); }
+
+  void set_ctrl(size_t i, ctrl_t h) noexcept {
+    _ctrl[i] = h;
+    if (i < GROUP_WIDTH) _ctrl[_cap + i] = h;
+  }
+
+  iterator iterator_at(size_t i) noexcept {
+    return i == npos ? end() : iterator(_ctrl + i, _slots + i, _ctrl + _cap);
+  }
+
+  template <typename K>
+  size_t find_index(const K& key) const noexcept {
+    return _size == 0 ? npos : find_index(key, hash_key(key));
+  }
+
+  template <typename K>
+  size_t find_index(const K& key, size_t hash) const noexcept;
+
+  size_t find_empty(size_t hash) const noexcept;
+
+  template <typename K, typename... Args>
+  hf::pair<iterator, bool> emplace_key(const K& key, Args&&... args) noexcept;
+
+  template <typename K>
+  size_t erase_key(const K& key) noexcept;
+
+  void erase_at(size_t i) noexcept;
+
+  void relocate_slot(value_type* dst, value_type* src) noexcept;
+
+  size_t block_units(size_t cap) const noexcept {
+    return cap + (cap + GROUP_WIDTH + sizeof(value_type) - 1) / sizeof(value_type);
+  }
+
+  void allocate_table(size_t cap) noexcept;
+
+  void rehash(size_t new_cap) noexcept;
+
+  void copy_from(const flat_table& rhs) noexcept;
+
+  void destroy_table() noexcept;
+};
+
+/* ------------------------------------------------------------------------- */
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+template <bool Const>
+class flat_table<Policy, Hash, KeyEqual, Alloc>::basic_iterator {
+  friend class flat_table;
+
+ public:
+  typedef std::forward_iterator_tag iterator_category;
+  typedef typename flat_table::value_type value_type;
+  typedef ptrdiff_t difference_type;
+  typedef typename std::conditional<Const, const value_type*, value_type*>::type pointer;
+  typedef typename std::conditional<Const, const value_type&, value_type&>::type reference;
+
+  basic_iterator() noexcept = default;
+
+  // iterator converts to const_iterator
+  template <bool C, typename = typename std::enable_if<Const && !C>::type>
+  basic_iterator(const basic_iterator<C>& rhs) noexcept
+      : _ctrl(rhs._ctrl), _slot(rhs._slot), _end(rhs._end) {}
+
+  reference operator*() const noexcept { return *_slot; }
+
+  pointer operator->() const noexcept { return _slot; }
+
+  basic_iterator& operator++() noexcept {
+    ++_ctrl;
+    ++_slot;
+    skip_empty();
+    return *this;
+  }
+
+  basic_iterator operator++(int) noexcept {
+    auto tmp = *this;
+    ++*this;
+    return tmp;
+  }
+
+  friend bool operator==(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+    return lhs._slot == rhs._slot;
+  }
+
+  friend bool operator!=(const basic_iterator& lhs, const basic_iterator& rhs) noexcept {
+    return lhs._slot != rhs._slot;
+  }
+
+ private:
+  template <bool>
+  friend class basic_iterator;
+
+  // placed on a full slot or at the end, begin() skips to the first full slot itself
+  basic_iterator(const ctrl_t* ctrl, value_type* slot, const ctrl_t* end) noexcept
+      : _ctrl(ctrl), _slot(slot), _end(end) {}
+
+  // the group load may run into the mirrored tail bytes, which are masked off
+  void skip_empty() noexcept {
+    while (_ctrl != _end) {
+      auto m = ctrl_group(_ctrl).match_full();
+      auto left = static_cast<size_t>(_end - _ctrl);
+      if (left < GROUP_WIDTH) m &= (1u << left) - 1;
+      auto step = m != 0 ? simd::ctz(m) : (left < GROUP_WIDTH ? left : GROUP_WIDTH);
+      _ctrl += step;
+      _slot += step;
+      if (m != 0) return;
+    }
+  }
+
+  const ctrl_t* _ctrl = nullptr;
+  value_type* _slot = nullptr;
+  const ctrl_t* _end = nullptr;
+};
+
+/* ------------------------------------------------------------------------- */
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+flat_table<Policy, Hash, KeyEqual, Alloc>& flat_table<Policy, Hash, KeyEqual, Alloc>::operator=(
+    const flat_table& rhs) noexcept {
+  if (this != &rhs) {
+    destroy_table();
+    if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+      _alloc() = rhs._alloc();
+    }
+    _hash = rhs._hash;
+    _eq = rhs._eq;
+    copy_from(rhs);
+  }
+  return *this;
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+flat_table<Policy, Hash, KeyEqual, Alloc>& flat_table<Policy, Hash, KeyEqual, Alloc>::operator=(
+    flat_table&& rhs) noexcept {
+  if (this != &rhs) {
+    _hash = std::move(rhs._hash);
+    _eq = std::move(rhs._eq);
+
+    // the table can only be stolen if it can be released with our allocator afterwards
+    if constexpr (!alloc_traits::propagate_on_container_move_assignment::value) {
+      if (!alloc_traits::equal(_alloc(), rhs._alloc())) {
+        clear();
+        reserve(rhs._size);
+        for (auto& value : rhs) emplace_key(Policy::key(value), std::move(value));
+        rhs.clear();
+        return *this;
+      }
+    }
+
+    destroy_table();
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+      _alloc() = std::move(rhs._alloc());
+    }
+    _slots = rhs._slots;
+    _ctrl = rhs._ctrl;
+    _cap = rhs._cap;
+    _size = rhs._size;
+    rhs._slots = nullptr;
+    rhs._ctrl = nullptr;
+    rhs._cap = rhs._size = 0;
+  }
+  return *this;
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+void flat_table<Policy, Hash, KeyEqual, Alloc>::clear() noexcept {
+  if (_size == 0) return;
+  if constexpr (!std::is_trivially_destructible<value_type>::value) {
+    for (auto it = begin(); it != end(); ++it) alloc_traits::destroy(_alloc(), it._slot);
+  }
+  std::memset(_ctrl, CTRL_EMPTY, _cap + GROUP_WIDTH);
+  _size = 0;
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+void flat_table<Policy, Hash, KeyEqual, Alloc>::reserve(size_t n) noexcept {
+  size_t cap = MIN_CAPACITY;
+  while (max_load(cap) < n) cap <<= 1;
+  if (cap > _cap) rehash(cap);
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+void flat_table<Policy, Hash, KeyEqual, Alloc>::swap(flat_table& rhs) noexcept {
+  if (this == &rhs) return;
+  if constexpr (alloc_traits::propagate_on_container_swap::value) {
+    std::swap(_alloc(), rhs._alloc());
+  } else {
+    assert(alloc_traits::equal(_alloc(), rhs._alloc()));
+  }
+  std::swap(_slots, rhs._slots);
+  std::swap(_ctrl, rhs._ctrl);
+  std::swap(_cap, rhs._cap);
+  std::swap(_size, rhs._size);
+  std::swap(_hash, rhs._hash);
+  std::swap(_eq, rhs._eq);
+}
+
+// an entry shifted into slot i is looked at again, one that wraps around from the
+// front is looked at a second time, which is harmless for a pure predicate
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+template <typename Pred>
+size_t flat_table<Policy, Hash, KeyEqual, Alloc>::erase_if(Pred pred) noexcept {
+  size_t erased = 0;
+  for (size_t i = 0; i < _cap;) {
+    if (_ctrl[i] != CTRL_EMPTY && pred(static_cast<const value_type&>(_slots[i]))) {
+      erase_at(i);
+      ++erased;
+    } else {
+      ++i;
+    }
+  }
+  return erased;
+}
+
+/* ------------------------------------------------------------------------- */
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+template <typename K>
+size_t flat_table<Policy, Hash, KeyEqual, Alloc>::find_index(const K& key,
+                                                             size_t hash) const noexcept {
+  const size_t mask = _cap - 1;
+  const auto h2 = static_cast<ctrl_t>(hash & 0x7F);
+
+  for (size_t pos = (hash >> 7) & mask;; pos = (pos + GROUP_WIDTH) & mask) {
+    ctrl_group g(_ctrl + pos);
+    auto empty = g.match_empty();
+    auto m = g.match(h2);
+
+    // the key cannot lie past the first empty slot of its probe sequence
+    if (empty != 0) m &= (empty & (0u - empty)) - 1;
+    for (; m != 0; m &= m - 1) {
+      auto i = (pos + simd::ctz(m)) & mask;
+      if (_eq(Policy::key(_slots[i]), key)) return i;
+    }
+    if (empty != 0) return npos;
+  }
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+size_t flat_table<Policy, Hash, KeyEqual, Alloc>::find_empty(size_t hash) const noexcept {
+  const size_t mask = _cap - 1;
+
+  for (size_t pos = (hash >> 7) & mask;; pos = (pos + GROUP_WIDTH) & mask) {
+    auto empty = ctrl_group(_ctrl + pos).match_empty();
+    if (empty != 0) return (pos + simd::ctz(empty)) & mask;
+  }
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+template <typename K, typename... Args>
+hf::pair<typename flat_table<Policy, Hash, KeyEqual, Alloc>::iterator, bool>
+flat_table<Policy, Hash, KeyEqual, Alloc>::emplace_key(const K& key, Args&&... args) noexcept {
+  const size_t hash = hash_key(key);
+  if (_size != 0) {
+    auto i = find_index(key, hash);
+    if (i != npos) return hf::pair<iterator, bool>(iterator_at(i), false);
+  }
+
+  if (_size + 1 > max_load(_cap)) rehash(_cap == 0 ? MIN_CAPACITY : _cap << 1);
+
+  auto i = find_empty(hash);
+  alloc_traits::construct(_alloc(), _slots + i, std::forward<Args>(args)...);
+  set_ctrl(i, static_cast<ctrl_t>(hash & 0x7F));
+  ++_size;
+
+  return hf::pair<iterator, bool>(iterator_at(i), true);
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+template <typename K>
+size_t flat_table<Policy, Hash, KeyEqual, Alloc>::erase_key(const K& key) noexcept {
+  auto i = find_index(key);
+  if (i == npos) return 0;
+  erase_at(i);
+  return 1;
+}
+
+// backward shift deletion, every following entry of the cluster that may live in the
+// hole (its home is not between the hole and itself) moves into it and leaves a new hole
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+void flat_table<Policy, Hash, KeyEqual, Alloc>::erase_at(size_t i) noexcept {
+  assert(i < _cap && _ctrl[i] != CTRL_EMPTY);
+
+  const size_t mask = _cap - 1;
+  alloc_traits::destroy(_alloc(), _slots + i);
+  --_size;
+
+  for (size_t j = (i + 1) & mask; _ctrl[j] != CTRL_EMPTY; j = (j + 1) & mask) {
+    size_t home = (hash_of(_slots[j]) >> 7) & mask;
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      relocate_slot(_slots + i, _slots + j);
+      set_ctrl(i, _ctrl[j]);
+      i = j;
+    }
+  }
+  set_ctrl(i, CTRL_EMPTY);
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+void flat_table<Policy, Hash, KeyEqual, Alloc>::relocate_slot(value_type* dst,
+                                                              value_type* src) noexcept {
+  if constexpr (hf::is_trivially_relocatable<value_type>::value) {
+    std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), sizeof(value_type));
+  } else {
+    alloc_traits::construct(_alloc(), dst, std::move(*src));
+    alloc_traits::destroy(_alloc(), src);
+  }
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+void flat_table<Policy, Hash, KeyEqual, Alloc>::allocate_table(size_t cap) noexcept {
+  _slots = alloc_traits::allocate(_alloc(), block_units(cap));
+  _ctrl = reinterpret_cast<ctrl_t*>(_slots + cap);
+  _cap = cap;
+  std::memset(_ctrl, CTRL_EMPTY, cap + GROUP_WIDTH);
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+void flat_table<Policy, Hash, KeyEqual, Alloc>::rehash(size_t new_cap) noexcept {
+  assert((new_cap & (new_cap - 1)) == 0 && max_load(new_cap) >= _size);
+
+  auto old_slots = _slots;
+  auto old_ctrl = _ctrl;
+  auto old_cap = _cap;
+
+  if (old_cap == 0) {
+    stats::on_allocate<flat_table>(block_units(new_cap) * sizeof(value_type));
+  } else {
+    stats::on_reallocate<flat_table>(block_units(new_cap) * sizeof(value_type), _size);
+  }
+
+  allocate_table(new_cap);
+  for (size_t i = 0; i < old_cap; ++i) {
+    if (old_ctrl[i] == CTRL_EMPTY) continue;
+    auto hash = hash_of(old_slots[i]);
+    auto j = find_empty(hash);
+    relocate_slot(_slots + j, old_slots + i);
+    set_ctrl(j, static_cast<ctrl_t>(hash & 0x7F));
+  }
+
+  if (old_slots != nullptr) alloc_traits::deallocate(_alloc(), old_slots, block_units(old_cap));
+}
+
+// same capacity and layout as rhs, no hashing needed
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+void flat_table<Policy, Hash, KeyEqual, Alloc>::copy_from(const flat_table& rhs) noexcept {
+  if (rhs._size == 0) return;
+
+  stats::on_allocate<flat_table>(block_units(rhs._cap) * sizeof(value_type));
+  allocate_table(rhs._cap);
+  std::memcpy(_ctrl, rhs._ctrl, _cap + GROUP_WIDTH);
+  for (size_t i = 0; i < _cap; ++i) {
+    if (_ctrl[i] != CTRL_EMPTY) alloc_traits::construct(_alloc(), _slots + i, rhs._slots[i]);
+  }
+  _size = rhs._size;
+}
+
+template <typename Policy, typename Hash, typename KeyEqual, typename Alloc>
+void flat_table<Policy, Hash, KeyEqual, Alloc>::destroy_table() noexcept {
+  if (_slots == nullptr) return;
+  clear();
+  alloc_traits::deallocate(_alloc(), _slots, block_units(_cap));
+  _slots = nullptr;
+  _ctrl = nullptr;
+  _cap = 0;
+}
+
+}  // namespace detail
+}  // namespace hf
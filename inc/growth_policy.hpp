@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+
+namespace hf {
+
+// growth policies pick the capacity a container grows to once it runs out of room,
+// next() gets the current capacity, the capacity that is at least required and the
+// container's max_size, all counted in elements of elem_size bytes, and returns a
+// capacity in [required, max]
+
+// grows by half of the current capacity, memory freed by earlier buffers can be
+// reused after a few steps
+struct growth_1_5x {
+  static constexpr size_t INIT_SIZE = 16;
+
+  static size_t next(size_t cap, size_t required, size_t max, size_t) noexcept {
+    if (required >= max) return max;
+    size_t grown = cap == 0 ? INIT_SIZE : (cap > max - (cap >> 1) ? max : cap + (cap >> 1));
+    return grown < required ? required : (grown > max ? max : grown);
+  }
+};
+
+// doubles the capacity, fewer reallocations at the cost of more slack
+struct growth_2x {
+  static constexpr size_t INIT_SIZE = 16;
+
+  static size_t next(size_t cap, size_t required, size_t max, size_t) noexcept {
+    if (required >= max) return max;
+    size_t grown = cap == 0 ? INIT_SIZE : (cap > max - cap ? max : cap << 1);
+    return grown < required ? required : (grown > max ? max : grown);
+  }
+};
+
+// rounds the capacity chosen by Base up to a jemalloc size class, malloc hands out
+// the whole class anyway so the rounding turns that slack into usable capacity
+template <typename Base = growth_1_5x>
+struct size_class_growth {
+  static constexpr size_t INIT_SIZE = Base::INIT_SIZE;
+
+  // 8, then 16 byte steps up to 128, then four classes per power of two
+  static constexpr size_t round_up(size_t bytes) noexcept {
+    if (bytes <= 8) return 8;
+    if (bytes <= 128) return (bytes + 15) & ~size_t(15);
+
+    size_t lg = 0;
+    for (size_t n = bytes - 1; n > 1; n >>= 1) ++lg;
+    size_t delta = size_t(1) << (lg - 2);
+    return (bytes + delta - 1) & ~(delta - 1);
+  }
+
+  static size_t next(size_t cap, size_t required, size_t max, size_t elem_size) noexcept {
+    size_t grown = Base::next(cap, required, max, elem_size);
+    if (grown > static_cast<size_t>(-1) / 2 / elem_size) return grown;
+
+    size_t rounded = round_up(grown * elem_size) / elem_size;
+    return rounded > max ? max : rounded;
+  }
+};
+
+}  // namespace hf
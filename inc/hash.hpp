@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
+#include "type_traits.hpp"
+
+namespace hf {
+
+template <typename CharType, typename CharTraits>
+class basic_string_view;
+
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+class basic_string;
+
+template <typename T1, typename T2>
+struct pair;
+
+namespace detail {
+
+// wyhash, 64-bit multiply-xor mixing, the values are stable within a process but are
+// not meant to be persisted
+constexpr uint64_t WY_SECRET[4] = {0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+                                   0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull};
+
+inline void wy_mum(uint64_t& a, uint64_t& b) noexcept {
+  auto r = static_cast<unsigned __int128>(a) * b;
+  a = static_cast<uint64_t>(r);
+  b = static_cast<uint64_t>(r >> 64);
+}
+
+inline uint64_t wy_mix(uint64_t a, uint64_t b) noexcept {
+  wy_mum(a, b);
+  return a ^ b;
+}
+
+inline uint64_t wy_read8(const unsigned char* p) noexcept {
+  uint64_t v;
+  std::memcpy(&v, p, 8);
+  return v;
+}
+
+inline uint64_t wy_read4(const unsigned char* p) noexcept {
+  uint32_t v;
+  std::memcpy(&v, p, 4);
+  return v;
+}
+
+// up to 16 bytes are read as two possibly overlapping words without a loop, longer inputs
+// run three independent multiply chains over 48 byte blocks
+inline uint64_t hash_bytes(const void* data, size_t n, uint64_t seed = 0) noexcept {
+  auto p = static_cast<const unsigned char*>(data);
+  seed ^= wy_mix(seed ^ WY_SECRET[0], WY_SECRET[1]);
+
+  uint64_t a, b;
+  if (n <= 16) {
+    if (n >= 4) {
+      auto off = (n >> 3) << 2;
+      a = (wy_read4(p) << 32) | wy_read4(p + off);
+      b = (wy_read4(p + n - 4) << 32) | wy_read4(p + n - 4 - off);
+    } else if (n > 0) {
+      a = (uint64_t(p[0]) << 16) | (uint64_t(p[n >> 1]) << 8) | p[n - 1];
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    auto i = n;
+    if (i > 48) {
+      auto seed1 = seed;
+      auto seed2 = seed;
+      do {
+        seed = wy_mix(wy_read8(p) ^ WY_SECRET[1], wy_read8(p + 8) ^ seed);
+        seed1 = wy_mix(wy_read8(p + 16) ^ WY_SECRET[2], wy_read8(p + 24) ^ seed1);
+        seed2 = wy_mix(wy_read8(p + 32) ^ WY_SECRET[3], wy_read8(p + 40) ^ seed2);
+        p += 48;
+        i -= 48;
+      } while (i > 48);
+      seed ^= seed1 ^ seed2;
+    }
+    for (; i > 16; i -= 16, p += 16) {
+      seed = wy_mix(wy_read8(p) ^ WY_SECRET[1], wy_read8(p + 8) ^ seed);
+    }
+    a = wy_read8(p + i - 16);
+    b = wy_read8(p + i - 8);
+  }
+
+  a ^= WY_SECRET[1];
+  b ^= seed;
+  wy_mum(a, b);
+  return wy_mix(a ^ WY_SECRET[0] ^ n, b ^ WY_SECRET[1]);
+}
+
+inline uint64_t hash_int(uint64_t x) noexcept {
+  return wy_mix(x ^ WY_SECRET[0], WY_SECRET[1]);
+}
+
+inline uint64_t hash_combine(uint64_t h1, uint64_t h2) noexcept {
+  return wy_mix(h1 ^ WY_SECRET[2], h2 ^ WY_SECRET[3]);
+}
+
+template <typename T>
+struct int_hash {
+  typedef void is_avalanching;
+
+  size_t operator()(T x) const noexcept { return hash_int(static_cast<uint64_t>(x)); }
+};
+
+}  // namespace detail
+
+/* ------------------------------------------------------------------------- */
+
+// hasher of the hf containers, types without a specialization fall back to std::hash
+template <typename T>
+struct hash : public std::hash<T> {};
+
+// a hasher whose results are uniform in every bit, the hash tables then use its values
+// directly instead of mixing them once more
+template <typename Hash, typename = void>
+struct is_avalanching : public false_type {};
+
+template <typename Hash>
+struct is_avalanching<Hash, std::void_t<typename Hash::is_avalanching>> : public true_type {};
+
+#define HF_INT_HASH(type) \
+  template <>             \
+  struct hash<type> : public detail::int_hash<type> {}
+
+HF_INT_HASH(bool);
+HF_INT_HASH(char);
+HF_INT_HASH(signed char);
+HF_INT_HASH(unsigned char);
+HF_INT_HASH(wchar_t);
+HF_INT_HASH(char16_t);
+HF_INT_HASH(char32_t);
+HF_INT_HASH(short);
+HF_INT_HASH(unsigned short);
+HF_INT_HASH(int);
+HF_INT_HASH(unsigned int);
+HF_INT_HASH(long);
+HF_INT_HASH(unsigned long);
+HF_INT_HASH(long long);
+HF_INT_HASH(unsigned long long);
+
+#undef HF_INT_HASH
+
+template <typename T>
+struct hash<T*> {
+  typedef void is_avalanching;
+
+  size_t operator()(T* p) const noexcept {
+    return detail::hash_int(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(p)));
+  }
+};
+
+template <typename T1, typename T2>
+struct hash<hf::pair<T1, T2>> {
+  typedef void is_avalanching;
+
+  size_t operator()(const hf::pair<T1, T2>& p) const noexcept {
+    return detail::hash_combine(hash<typename std::remove_const<T1>::type>()(p.first),
+                                hash<typename std::remove_const<T2>::type>()(p.second));
+  }
+};
+
+template <typename CharType, typename CharTraits>
+struct hash<hf::basic_string_view<CharType, CharTraits>> {
+  typedef void is_avalanching;
+
+  size_t operator()(hf::basic_string_view<CharType, CharTraits> sv) const noexcept {
+    return detail::hash_bytes(sv.data(), sv.size() * sizeof(CharType));
+  }
+};
+
+// hashes the same as an equal view, so views and literals can look up string keys
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+struct hash<hf::basic_string<CharType, CharTraits, Alloc, Growth>>
+    : public hash<hf::basic_string_view<CharType, CharTraits>> {
+  typedef void is_transparent;
+};
+
+namespace detail {
+
+// key comparison of the hf hash tables, string keys compare through views, together with
+// the transparent hf::hash lookups by view or literal never build a temporary string
+template <typename Key>
+struct default_equal : public std::equal_to<Key> {};
+
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+struct default_equal<hf::basic_string<CharType, CharTraits, Alloc, Growth>>
+    : public std::equal_to<> {};
+
+}  // namespace detail
+
+}  // namespace hf
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "basic_string.hpp"
+#include "hash.hpp"
+#include "type_traits.hpp"
+
+namespace hf {
+
+// immutable string that carries its hf::hash, computed once on construction, as a hash
+// table key it is never rehashed on growth or erase, and a lookup key built once can be
+// used for any number of lookups without hashing it again
+template <typename CharType, typename CharTraits = hf::char_traits<CharType>,
+          typename Alloc = hf::allocator<CharType>, typename Growth = hf::growth_1_5x>
+class basic_hashed_string {
+ public:
+  typedef hf::basic_string<CharType, CharTraits, Alloc, Growth> string_type;
+  typedef typename string_type::view_type view_type;
+  typedef typename string_type::value_type value_type;
+  typedef typename string_type::const_pointer const_pointer;
+  typedef typename string_type::const_iterator const_iterator;
+
+ public:
+  basic_hashed_string() noexcept : _hash(hash_of(view_type())) {}
+
+  explicit basic_hashed_string(string_type str) noexcept
+      : _str(std::move(str)), _hash(hash_of(_str)) {}
+
+  explicit basic_hashed_string(view_type sv) : _str(sv), _hash(hash_of(sv)) {}
+
+  explicit basic_hashed_string(const_pointer str) : basic_hashed_string(view_type(str)) {}
+
+  basic_hashed_string(const basic_hashed_string&) = default;
+
+  basic_hashed_string(basic_hashed_string&&) noexcept = default;
+
+  basic_hashed_string& operator=(const basic_hashed_string&) = default;
+
+  basic_hashed_string& operator=(basic_hashed_string&&) noexcept = default;
+
+  ~basic_hashed_string() = default;
+
+ public:
+  const_iterator begin() const noexcept { return _str.begin(); }
+
+  const_iterator end() const noexcept { return _str.end(); }
+
+  const_pointer data() const noexcept { return _str.data(); }
+
+  const_pointer c_str() const noexcept { return _str.c_str(); }
+
+  size_t size() const noexcept { return _str.size(); }
+
+  bool empty() const noexcept { return _str.empty(); }
+
+  size_t hash() const noexcept { return _hash; }
+
+  const string_type& str() const noexcept { return _str; }
+
+  operator view_type() const noexcept { return _str; }
+
+  // hands the string back, this is left empty
+  string_type release() noexcept {
+    string_type r(std::move(_str));
+    _hash = hash_of(view_type());
+    return r;
+  }
+
+  /* ------------------------------------------------------------------------- */
+
+  // unequal hashes settle most mismatches without touching the characters
+  friend bool operator==(const basic_hashed_string& lhs,
+                         const basic_hashed_string& rhs) noexcept {
+    return lhs._hash == rhs._hash && view_type(lhs._str) == view_type(rhs._str);
+  }
+
+  friend bool operator!=(const basic_hashed_string& lhs,
+                         const basic_hashed_string& rhs) noexcept {
+    return !(lhs == rhs);
+  }
+
+  friend bool operator==(const basic_hashed_string& lhs, view_type rhs) noexcept {
+    return view_type(lhs._str) == rhs;
+  }
+
+  friend bool operator==(view_type lhs, const basic_hashed_string& rhs) noexcept {
+    return lhs == view_type(rhs._str);
+  }
+
+  friend bool operator!=(const basic_hashed_string& lhs, view_type rhs) noexcept {
+    return !(lhs == rhs);
+  }
+
+  friend bool operator!=(view_type lhs, const basic_hashed_string& rhs) noexcept {
+    return !(lhs == rhs);
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, const basic_hashed_string& str) {
+    return os << str._str;
+  }
+
+ private:
+  static size_t hash_of(view_type sv) noexcept { return hf::hash<view_type>()(sv); }
+
+  string_type _str;
+  size_t _hash;
+};
+
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+struct is_trivially_relocatable<basic_hashed_string<CharType, CharTraits, Alloc, Growth>>
+    : public is_trivially_relocatable<basic_string<CharType, CharTraits, Alloc, Growth>> {};
+
+// the cached value for keys, views and literals are hashed as usual and match it
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+struct hash<basic_hashed_string<CharType, CharTraits, Alloc, Growth>> {
+  typedef void is_avalanching;
+  typedef void is_transparent;
+
+  size_t operator()(
+      const basic_hashed_string<CharType, CharTraits, Alloc, Growth>& str) const noexcept {
+    return str.hash();
+  }
+
+  size_t operator()(basic_string_view<CharType, CharTraits> sv) const noexcept {
+    return hf::hash<basic_string_view<CharType, CharTraits>>()(sv);
+  }
+};
+
+namespace detail {
+
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+struct default_equal<basic_hashed_string<CharType, CharTraits, Alloc, Growth>>
+    : public std::equal_to<> {};
+
+}  // namespace detail
+
+typedef basic_hashed_string<char> hashed_string;
+typedef basic_hashed_string<wchar_t> whashed_string;
+typedef basic_hashed_string<char16_t> u16hashed_string;
+typedef basic_hashed_string<char32_t> u32hashed_string;
+
+}  // namespace hf
+
+namespace std {
+
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
+struct hash<hf::basic_hashed_string<CharType, CharTraits, Alloc, Growth>> {
+  size_t operator()(
+      const hf::basic_hashed_string<CharType, CharTraits, Alloc, Growth>& str) const noexcept {
+    return str.hash();
+  }
+};
+
+}  // namespace std
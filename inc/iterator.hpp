@@ -1,16 +1,17 @@
 #pragma once
 
 #include <cstddef>
+#include <iterator>
 
 #include "type_traits.hpp"
 
 namespace hf {
 
-// iterator five type
-struct input_iterator_tag {};
-struct output_iterator_tag {};
-struct forward_iterator_tag : public input_iterator_tag {};
-struct bidirectional_iterator_tag : public forward_iterator_tag {};
-struct random_access_iterator_tag : public bidirectional_iterator_tag {};
+// iterator five type, the std tags themselves so std algorithms take hf iterators as they are
+typedef std::input_iterator_tag input_iterator_tag;
+typedef std::output_iterator_tag output_iterator_tag;
+typedef std::forward_iterator_tag forward_iterator_tag;
+typedef std::bidirectional_iterator_tag bidirectional_iterator_tag;
+typedef std::random_access_iterator_tag random_access_iterator_tag;
 
 }  // namespace hf
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+#include "allocator.hpp"
+#include "arena.hpp"
+#include "pool_allocator.hpp"
+
+namespace hf {
+
+// runtime-selectable memory strategy, containers parameterized on polymorphic_allocator
+// can switch between resources without being recompiled
+class memory_resource {
+ public:
+  virtual ~memory_resource() = default;
+
+  void* allocate(size_t bytes, size_t align = alignof(std::max_align_t)) noexcept {
+    return do_allocate(bytes, align);
+  }
+
+  void deallocate(void* ptr, size_t bytes, size_t align = alignof(std::max_align_t)) noexcept {
+    do_deallocate(ptr, bytes, align);
+  }
+
+  bool is_equal(const memory_resource& rhs) const noexcept {
+    return this == &rhs || do_is_equal(rhs);
+  }
+
+ private:
+  virtual void* do_allocate(size_t bytes, size_t align) noexcept = 0;
+
+  virtual void do_deallocate(void* ptr, size_t bytes, size_t align) noexcept = 0;
+
+  virtual bool do_is_equal(const memory_resource& rhs) const noexcept { return this == &rhs; }
+};
+
+inline bool operator==(const memory_resource& lhs, const memory_resource& rhs) noexcept {
+  return lhs.is_equal(rhs);
+}
+
+inline bool operator!=(const memory_resource& lhs, const memory_resource& rhs) noexcept {
+  return !lhs.is_equal(rhs);
+}
+
+/* ------------------------------------------------------------------------- */
+
+namespace detail {
+
+class new_delete_resource_impl final : public memory_resource {
+ private:
+  void* do_allocate(size_t bytes, size_t align) noexcept override {
+    if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      return ::operator new(bytes, std::align_val_t(align));
+    }
+    return ::operator new(bytes);
+  }
+
+  void do_deallocate(void* ptr, size_t, size_t align) noexcept override {
+    if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+      ::operator delete(ptr, std::align_val_t(align));
+    } else {
+      ::operator delete(ptr);
+    }
+  }
+};
+
+class pool_resource_impl final : public memory_resource {
+ private:
+  static bool pooled(size_t bytes, size_t align) noexcept {
+    return align <= pool_size_class::ALIGN && bytes <= pool_size_class::MAX_SIZE;
+  }
+
+  void* do_allocate(size_t bytes, size_t align) noexcept override {
+    if (!pooled(bytes, align)) return _upstream.allocate(bytes, align);
+    return pool_cache::local().allocate(bytes);
+  }
+
+  void do_deallocate(void* ptr, size_t bytes, size_t align) noexcept override {
+    if (!pooled(bytes, align)) return _upstream.deallocate(ptr, bytes, align);
+    pool_cache::local().deallocate(ptr, bytes);
+  }
+
+  new_delete_resource_impl _upstream;
+};
+
+}  // namespace detail
+
+inline memory_resource* new_delete_resource() noexcept {
+  static detail::new_delete_resource_impl resource;
+  return &resource;
+}
+
+// the size-class pools behind hf::pool_allocator
+inline memory_resource* pool_resource() noexcept {
+  static detail::pool_resource_impl resource;
+  return &resource;
+}
+
+// bump allocates from an arena, deallocation is a no-op
+class arena_resource final : public memory_resource {
+ public:
+  explicit arena_resource(arena& a) noexcept : _arena(&a) {}
+
+  arena* get_arena() const noexcept { return _arena; }
+
+ private:
+  void* do_allocate(size_t bytes, size_t align) noexcept override {
+    return _arena->allocate(bytes, align);
+  }
+
+  void do_deallocate(void*, size_t, size_t) noexcept override {}
+
+  bool do_is_equal(const memory_resource& rhs) const noexcept override {
+    auto other = dynamic_cast<const arena_resource*>(&rhs);
+    return other != nullptr && other->_arena == _arena;
+  }
+
+  arena* _arena;
+};
+
+namespace detail {
+
+inline std::atomic<memory_resource*>& default_resource() noexcept {
+  static std::atomic<memory_resource*> resource{new_delete_resource()};
+  return resource;
+}
+
+}  // namespace detail
+
+inline memory_resource* get_default_resource() noexcept {
+  return detail::default_resource().load(std::memory_order_acquire);
+}
+
+// returns the previous default, nullptr restores new_delete_resource()
+inline memory_resource* set_default_resource(memory_resource* resource) noexcept {
+  if (resource == nullptr) resource = new_delete_resource();
+  return detail::default_resource().exchange(resource, std::memory_order_acq_rel);
+}
+
+/* ------------------------------------------------------------------------- */
+
+template <typename T>
+class polymorphic_allocator {
+ public:
+  typedef T value_type;
+
+  polymorphic_allocator() noexcept : _resource(get_default_resource()) {}
+
+  polymorphic_allocator(memory_resource* resource) noexcept : _resource(resource) {}
+
+  template <typename U>
+  polymorphic_allocator(const polymorphic_allocator<U>& rhs) noexcept
+      : _resource(rhs.resource()) {}
+
+  T* allocate(size_t n) noexcept {
+    if (n == 0) return nullptr;
+    return static_cast<T*>(_resource->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* ptr, size_t n) noexcept {
+    if (ptr != nullptr) _resource->deallocate(ptr, n * sizeof(T), alignof(T));
+  }
+
+  // like std::pmr, a copied container goes back to the default resource
+  polymorphic_allocator select_on_container_copy_construction() const noexcept {
+    return polymorphic_allocator();
+  }
+
+  memory_resource* resource() const noexcept { return _resource; }
+
+ private:
+  memory_resource* _resource;
+};
+
+template <typename T, typename U>
+bool operator==(const polymorphic_allocator<T>& lhs, const polymorphic_allocator<U>& rhs) noexcept {
+  return *lhs.resource() == *rhs.resource();
+}
+
+template <typename T, typename U>
+bool operator!=(const polymorphic_allocator<T>& lhs, const polymorphic_allocator<U>& rhs) noexcept {
+  return !(lhs == rhs);
+}
+
+}  // namespace hf
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+#include "thread_pool.hpp"
+#include "vector.hpp"
+
+// data parallel algorithms over random access ranges and hf::vector, run on an
+// hf::thread_pool. A range is halved recursively until the pieces reach the grain size,
+// the second half of every split is left for other workers to steal. With grain == 0 the
+// grain is picked so there are about PARALLEL_SPLITS pieces per worker, enough for
+// stealing to even out uneven pieces without paying for a fork per element
+
+namespace hf {
+
+namespace detail {
+
+constexpr size_t PARALLEL_SPLITS = 8;
+
+// sort pieces smaller than this are not worth a partition pass on another worker
+constexpr size_t PARALLEL_SORT_MIN_GRAIN = 1 << 12;
+
+inline size_t parallel_grain(size_t n, size_t grain, const thread_pool& pool) noexcept {
+  if (grain != 0) return grain;
+  grain = n / (pool.size() * PARALLEL_SPLITS);
+  return grain != 0 ? grain : 1;
+}
+
+// calls leaf(first, last) on pieces of at most grain elements
+template <typename Iter, typename Leaf>
+void parallel_split(thread_pool& pool, Iter first, Iter last, size_t grain, Leaf& leaf) noexcept {
+  auto n = static_cast<size_t>(last - first);
+  if (n <= grain) {
+    leaf(first, last);
+    return;
+  }
+  auto mid = first + static_cast<ptrdiff_t>(n / 2);
+  pool.invoke([&] { parallel_split(pool, first, mid, grain, leaf); },
+              [&] { parallel_split(pool, mid, last, grain, leaf); });
+}
+
+template <typename T, typename Iter, typename Op>
+T parallel_reduce_split(thread_pool& pool, Iter first, Iter last, size_t grain, Op& op) noexcept {
+  auto n = static_cast<size_t>(last - first);
+  if (n <= grain) {
+    T acc = *first;
+    while (++first != last) acc = op(std::move(acc), *first);
+    return acc;
+  }
+  auto mid = first + static_cast<ptrdiff_t>(n / 2);
+  T left, right;
+  pool.invoke([&] { left = parallel_reduce_split<T>(pool, first, mid, grain, op); },
+              [&] { right = parallel_reduce_split<T>(pool, mid, last, grain, op); });
+  return op(std::move(left), std::move(right));
+}
+
+template <typename Iter, typename Compare>
+Iter median_of_three(Iter a, Iter b, Iter c, Compare& comp) noexcept {
+  if (comp(*a, *b)) {
+    if (comp(*b, *c)) return b;
+    return comp(*a, *c) ? c : a;
+  }
+  if (comp(*a, *c)) return a;
+  return comp(*b, *c) ? c : b;
+}
+
+// quicksort whose partitions are sorted in parallel, each pass splits three ways so runs
+// of equal keys drop out instead of unbalancing the recursion. depth bounds the number of
+// partition passes, a range that is still large by then is handed to std::sort
+template <typename Iter, typename Compare>
+void parallel_sort_split(thread_pool& pool, Iter first, Iter last, size_t grain, Compare& comp,
+                         int depth) noexcept {
+  auto n = static_cast<size_t>(last - first);
+  if (n <= grain || depth == 0) {
+    std::sort(first, last, comp);
+    return;
+  }
+
+  // pseudo median of nine
+  auto step = static_cast<ptrdiff_t>(n / 8);
+  auto mid = first + static_cast<ptrdiff_t>(n / 2);
+  auto back = last - 1;
+  auto pivot = *median_of_three(median_of_three(first, first + step, first + 2 * step, comp),
+                                median_of_three(mid - step, mid, mid + step, comp),
+                                median_of_three(back - 2 * step, back - step, back, comp), comp);
+
+  auto less_end = std::partition(first, last, [&](const auto& x) { return comp(x, pivot); });
+  auto equal_end = std::partition(less_end, last, [&](const auto& x) { return !comp(pivot, x); });
+
+  pool.invoke([&] { parallel_sort_split(pool, first, less_end, grain, comp, depth - 1); },
+              [&] { parallel_sort_split(pool, equal_end, last, grain, comp, depth - 1); });
+}
+
+}  // namespace detail
+
+/* ------------------------------------------------------------------------- */
+
+// f(x) for every element, in no particular order
+template <typename Iter, typename F>
+void parallel_for(Iter first, Iter last, F f, size_t grain = 0,
+                  thread_pool& pool = thread_pool::instance()) noexcept {
+  auto n = static_cast<size_t>(last - first);
+  if (n == 0) return;
+  auto leaf = [&f](Iter lo, Iter hi) {
+    for (; lo != hi; ++lo) f(*lo);
+  };
+  detail::parallel_split(pool, first, last, detail::parallel_grain(n, grain, pool), leaf);
+}
+
+template <typename T, typename Alloc, typename Growth, typename F>
+void parallel_for(hf::vector<T, Alloc, Growth>& v, F f, size_t grain = 0,
+                  thread_pool& pool = thread_pool::instance()) noexcept {
+  parallel_for(v.begin(), v.end(), std::move(f), grain, pool);
+}
+
+/* ------------------------------------------------------------------------- */
+
+// out[i] = op(first[i]), out has room for last - first elements, returns the end of out
+template <typename Iter, typename OutIter, typename Op>
+OutIter parallel_transform(Iter first, Iter last, OutIter out, Op op, size_t grain = 0,
+                           thread_pool& pool = thread_pool::instance()) noexcept {
+  auto n = static_cast<size_t>(last - first);
+  if (n == 0) return out;
+  auto leaf = [&](Iter lo, Iter hi) {
+    auto dst = out + (lo - first);
+    for (; lo != hi; ++lo, ++dst) *dst = op(*lo);
+  };
+  detail::parallel_split(pool, first, last, detail::parallel_grain(n, grain, pool), leaf);
+  return out + static_cast<ptrdiff_t>(n);
+}
+
+// out is resized to the size of in first
+template <typename T, typename AllocT, typename GrowthT, typename U, typename AllocU,
+          typename GrowthU, typename Op>
+void parallel_transform(const hf::vector<T, AllocT, GrowthT>& in,
+                        hf::vector<U, AllocU, GrowthU>& out, Op op, size_t grain = 0,
+                        thread_pool& pool = thread_pool::instance()) noexcept {
+  out.resize(in.size());
+  parallel_transform(in.begin(), in.end(), out.begin(), std::move(op), grain, pool);
+}
+
+/* ------------------------------------------------------------------------- */
+
+// op(init, x0, x1, ...) for an associative op, the pieces are combined in an unspecified
+// grouping but keep their order. T is default constructible
+template <typename Iter, typename T, typename Op = std::plus<>>
+T parallel_reduce(Iter first, Iter last, T init, Op op = Op(), size_t grain = 0,
+                  thread_pool& pool = thread_pool::instance()) noexcept {
+  auto n = static_cast<size_t>(last - first);
+  if (n == 0) return init;
+  auto grain_size = detail::parallel_grain(n, grain, pool);
+  T result;
+  pool.run([&] {
+    result = detail::parallel_reduce_split<T>(pool, first, last, grain_size, op);
+  });
+  return op(std::move(init), std::move(result));
+}
+
+template <typename T, typename Alloc, typename Growth, typename U, typename Op = std::plus<>>
+U parallel_reduce(const hf::vector<T, Alloc, Growth>& v, U init, Op op = Op(), size_t grain = 0,
+                  thread_pool& pool = thread_pool::instance()) noexcept {
+  return parallel_reduce(v.begin(), v.end(), std::move(init), std::move(op), grain, pool);
+}
+
+/* ------------------------------------------------------------------------- */
+
+// not stable
+template <typename Iter, typename Compare = std::less<>>
+void parallel_sort(Iter first, Iter last, Compare comp = Compare(), size_t grain = 0,
+                   thread_pool& pool = thread_pool::instance()) noexcept {
+  auto n = static_cast<size_t>(last - first);
+  if (n < 2) return;
+  if (grain == 0) {
+    grain = std::max(detail::parallel_grain(n, 0, pool), detail::PARALLEL_SORT_MIN_GRAIN);
+  }
+  int depth = 0;
+  for (auto m = n; m > 1; m >>= 1) depth += 2;
+  pool.run([&] { detail::parallel_sort_split(pool, first, last, grain, comp, depth); });
+}
+
+template <typename T, typename Alloc, typename Growth, typename Compare = std::less<>>
+void parallel_sort(hf::vector<T, Alloc, Growth>& v, Compare comp = Compare(), size_t grain = 0,
+                   thread_pool& pool = thread_pool::instance()) noexcept {
+  parallel_sort(v.begin(), v.end(), std::move(comp), grain, pool);
+}
+
+}  // namespace hf
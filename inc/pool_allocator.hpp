@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+
+#include "allocator.hpp"
+
+namespace hf {
+
+namespace detail {
+
+// size classes: 16 byte steps up to 256 bytes, then powers of two up to 4 KiB,
+// anything larger goes straight to ::operator new
+struct pool_size_class {
+  static constexpr size_t ALIGN = 16;
+  static constexpr size_t SMALL_MAX = 256;
+  static constexpr size_t MAX_SIZE = 4096;
+  static constexpr size_t SMALL_CLASSES = SMALL_MAX / ALIGN;
+  static constexpr size_t COUNT = SMALL_CLASSES + 4;
+
+  static size_t index(size_t bytes) noexcept {
+    if (bytes <= SMALL_MAX) return bytes == 0 ? 0 : (bytes - 1) / ALIGN;
+    size_t i = SMALL_CLASSES;
+    for (size_t cls = SMALL_MAX << 1; cls < bytes; cls <<= 1) ++i;
+    return i;
+  }
+
+  static size_t size(size_t index) noexcept {
+    return index < SMALL_CLASSES ? (index + 1) * ALIGN : SMALL_MAX << (index - SMALL_CLASSES + 1);
+  }
+};
+
+struct pool_block {
+  pool_block* next;
+};
+
+// process wide store for slabs, for the free lists of exited threads and for the excess of
+// threads that free more than they allocate. Slabs are never returned to the system
+// because blocks may outlive the thread that carved them
+class pool_depot {
+ public:
+  static constexpr size_t SLAB_SIZE = 64 * 1024;
+
+  static pool_depot& instance() noexcept {
+    static pool_depot* depot = new pool_depot();
+    return *depot;
+  }
+
+  pool_block* take(size_t index) noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    pool_block* list = _lists[index];
+    _lists[index] = nullptr;
+    return list;
+  }
+
+  void give(size_t index, pool_block* first, pool_block* last) noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    last->next = _lists[index];
+    _lists[index] = first;
+  }
+
+  void* new_slab() noexcept {
+    auto slab = static_cast<pool_block*>(::operator new(SLAB_SIZE));
+    std::lock_guard<std::mutex> lock(_mutex);
+    slab->next = _slabs;
+    _slabs = slab;
+    return slab;
+  }
+
+ private:
+  pool_depot() noexcept = default;
+
+  std::mutex _mutex;
+  pool_block* _lists[pool_size_class::COUNT] = {};
+  pool_block* _slabs = nullptr;
+};
+
+class pool_cache {
+ public:
+  static pool_cache& local() noexcept {
+    static thread_local pool_cache cache;
+    return cache;
+  }
+
+  ~pool_cache() {
+    for (size_t i = 0; i < pool_size_class::COUNT; ++i) {
+      if (_lists[i] == nullptr) continue;
+      auto last = _lists[i];
+      while (last->next != nullptr) last = last->next;
+      pool_depot::instance().give(i, _lists[i], last);
+    }
+  }
+
+  void* allocate(size_t bytes) noexcept {
+    auto i = pool_size_class::index(bytes);
+    if (_lists[i] == nullptr) refill(i);
+
+    auto block = _lists[i];
+    _lists[i] = block->next;
+    --_counts[i];
+    return block;
+  }
+
+  void deallocate(void* ptr, size_t bytes) noexcept {
+    auto i = pool_size_class::index(bytes);
+    auto block = static_cast<pool_block*>(ptr);
+    block->next = _lists[i];
+    _lists[i] = block;
+    if (++_counts[i] > limit(i)) flush(i);
+  }
+
+ private:
+  // a slab's worth of blocks per class, a thread that frees what others allocated, like the
+  // consumer of a pipeline, hands the excess back to the depot where the allocating thread
+  // picks it up on its next refill instead of carving new slabs
+  static size_t limit(size_t index) noexcept {
+    return pool_depot::SLAB_SIZE / pool_size_class::size(index);
+  }
+
+  void refill(size_t index) noexcept;
+
+  void flush(size_t index) noexcept;
+
+  pool_block* _lists[pool_size_class::COUNT] = {};
+  size_t _counts[pool_size_class::COUNT] = {};
+};
+
+inline void pool_cache::refill(size_t index) noexcept {
+  auto& depot = pool_depot::instance();
+
+  _lists[index] = depot.take(index);
+  if (_lists[index] != nullptr) {
+    size_t count = 0;
+    for (auto b = _lists[index]; b != nullptr; b = b->next) ++count;
+    _counts[index] = count;
+    return;
+  }
+
+  // the first block of every slab is its link in the depot's slab chain
+  auto slab = static_cast<char*>(depot.new_slab());
+  auto size = pool_size_class::size(index);
+  auto count = (pool_depot::SLAB_SIZE - pool_size_class::ALIGN) / size;
+
+  auto cur = slab + pool_size_class::ALIGN;
+  for (size_t n = 0; n < count; ++n, cur += size) {
+    auto block = reinterpret_cast<pool_block*>(cur);
+    block->next = n + 1 == count ? nullptr : reinterpret_cast<pool_block*>(cur + size);
+  }
+  _lists[index] = reinterpret_cast<pool_block*>(slab + pool_size_class::ALIGN);
+  _counts[index] = count;
+}
+
+// keeps the most recently freed half, the blocks most likely still in cache
+inline void pool_cache::flush(size_t index) noexcept {
+  auto keep = limit(index) / 2;
+  auto cut = _lists[index];
+  for (size_t n = 1; n < keep; ++n) cut = cut->next;
+
+  auto first = cut->next;
+  auto last = first;
+  while (last->next != nullptr) last = last->next;
+  cut->next = nullptr;
+  _counts[index] = keep;
+  pool_depot::instance().give(index, first, last);
+}
+
+}  // namespace detail
+
+// drop-in replacement for hf::allocator that serves small requests from thread local
+// size-class free lists, a block may be freed on any thread and finds its way back to
+// the allocating ones through the depot
+template <typename T>
+class pool_allocator : public hf::allocator<T> {
+ public:
+  static T* allocate() noexcept { return allocate(1); }
+  static T* allocate(size_t n) noexcept;
+
+  static void deallocate(T* ptr) noexcept { deallocate(ptr, 1); }
+  static void deallocate(T* ptr, size_t n) noexcept;
+
+ private:
+  static bool pooled(size_t n) noexcept {
+    return alignof(T) <= detail::pool_size_class::ALIGN &&
+           n <= detail::pool_size_class::MAX_SIZE / sizeof(T);
+  }
+};
+
+template <typename T>
+T* pool_allocator<T>::allocate(size_t n) noexcept {
+  if (n == 0) return nullptr;
+  if (!pooled(n)) return hf::allocator<T>::allocate(n);
+  return static_cast<T*>(detail::pool_cache::local().allocate(n * sizeof(T)));
+}
+
+template <typename T>
+void pool_allocator<T>::deallocate(T* ptr, size_t n) noexcept {
+  if (ptr == nullptr) return;
+  if (!pooled(n)) return hf::allocator<T>::deallocate(ptr, n);
+  detail::pool_cache::local().deallocate(ptr, n * sizeof(T));
+}
+
+}  // namespace hf
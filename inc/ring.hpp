@@ -0,0 +1,434 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include "allocator.hpp"
+#include "simd.hpp"
+
+namespace hf {
+
+namespace detail {
+
+// waits in the rings are expected to be short, spin with a pause for a while before
+// giving the core away
+inline void ring_backoff(unsigned& spins) noexcept {
+  if (++spins < 64) {
+#if defined(HF_SIMD_X86)
+    __builtin_ia32_pause();
+#endif
+  } else {
+    std::this_thread::yield();
+  }
+}
+
+inline size_t ring_capacity(size_t n) noexcept {
+  size_t cap = 2;
+  while (cap < n) cap <<= 1;
+  return cap;
+}
+
+}  // namespace detail
+
+/* ------------------------------------------------------------------------- */
+
+// bounded lock-free queue between exactly one producer thread and one consumer thread.
+// Positions only grow and are masked into the power of two slot array, head and tail sit
+// on their own cache lines and each side keeps a cached copy of the other one's
+// position, so the shared lines are only read when the ring looks full or empty
+template <typename T, typename Alloc = hf::allocator<T>>
+class spsc_ring : private hf::alloc_holder<Alloc> {
+ public:
+  typedef T value_type;
+  typedef Alloc allocator_type;
+
+ private:
+  typedef hf::alloc_holder<Alloc> holder;
+  typedef hf::allocator_traits<Alloc> alloc_traits;
+
+  using holder::_alloc;
+
+ public:
+  // the capacity is rounded up to a power of two
+  explicit spsc_ring(size_t capacity, const Alloc& alloc = Alloc()) noexcept
+      : holder(alloc), _mask(detail::ring_capacity(capacity) - 1) {
+    _slots = alloc_traits::allocate(_alloc(), _mask + 1);
+  }
+
+  spsc_ring(const spsc_ring&) = delete;
+
+  spsc_ring& operator=(const spsc_ring&) = delete;
+
+  ~spsc_ring();
+
+ public:
+  size_t capacity() const noexcept { return _mask + 1; }
+
+  // exact only while neither side is active
+  size_t size() const noexcept {
+    return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+  }
+
+  bool empty() const noexcept { return size() == 0; }
+
+  /* ------------------------------------------------------------------------- */
+
+  // producer side, false when the ring is full
+  template <typename... Args>
+  bool try_emplace(Args&&... args) noexcept;
+
+  bool try_push(const T& value) noexcept { return try_emplace(value); }
+
+  bool try_push(T&& value) noexcept { return try_emplace(std::move(value)); }
+
+  // waits until there is room
+  template <typename... Args>
+  void emplace(Args&&... args) noexcept {
+    for (unsigned spins = 0; !try_emplace(std::forward<Args>(args)...);) {
+      detail::ring_backoff(spins);
+    }
+  }
+
+  void push(const T& value) noexcept { emplace(value); }
+
+  void push(T&& value) noexcept { emplace(std::move(value)); }
+
+  // constructs up to n elements from first on, published together, returns how many
+  template <typename Iter>
+  size_t try_push_n(Iter first, size_t n) noexcept;
+
+  /* ------------------------------------------------------------------------- */
+
+  // consumer side, the front element is moved into out, false when the ring is empty
+  bool try_pop(T& out) noexcept;
+
+  // waits until there is an element
+  void pop(T& out) noexcept {
+    for (unsigned spins = 0; !try_pop(out);) detail::ring_backoff(spins);
+  }
+
+  // moves up to n elements to out, released together, returns how many
+  template <typename OutIter>
+  size_t try_pop_n(OutIter out, size_t n) noexcept;
+
+ private:
+  T* _slots = nullptr;
+  size_t _mask = 0;
+
+  // written by the producer
+  alignas(64) std::atomic<size_t> _tail{0};
+  size_t _head_cache = 0;
+
+  // written by the consumer
+  alignas(64) std::atomic<size_t> _head{0};
+  size_t _tail_cache = 0;
+};
+
+template <typename T, typename Alloc>
+spsc_ring<T, Alloc>::~spsc_ring() {
+  auto tail = _tail.load(std::memory_order_relaxed);
+  for (auto pos = _head.load(std::memory_order_relaxed); pos != tail; ++pos) {
+    alloc_traits::destroy(_alloc(), _slots + (pos & _mask));
+  }
+  alloc_traits::deallocate(_alloc(), _slots, _mask + 1);
+}
+
+template <typename T, typename Alloc>
+template <typename... Args>
+bool spsc_ring<T, Alloc>::try_emplace(Args&&... args) noexcept {
+  auto tail = _tail.load(std::memory_order_relaxed);
+  if (tail - _head_cache > _mask) {
+    _head_cache = _head.load(std::memory_order_acquire);
+    if (tail - _head_cache > _mask) return false;
+  }
+  alloc_traits::construct(_alloc(), _slots + (tail & _mask), std::forward<Args>(args)...);
+  _tail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T, typename Alloc>
+template <typename Iter>
+size_t spsc_ring<T, Alloc>::try_push_n(Iter first, size_t n) noexcept {
+  auto tail = _tail.load(std::memory_order_relaxed);
+  auto room = capacity() - (tail - _head_cache);
+  if (room < n) {
+    _head_cache = _head.load(std::memory_order_acquire);
+    room = capacity() - (tail - _head_cache);
+  }
+  if (n > room) n = room;
+  if (n == 0) return 0;
+
+  for (size_t i = 0; i < n; ++i, ++first) {
+    alloc_traits::construct(_alloc(), _slots + ((tail + i) & _mask), *first);
+  }
+  _tail.store(tail + n, std::memory_order_release);
+  return n;
+}
+
+template <typename T, typename Alloc>
+bool spsc_ring<T, Alloc>::try_pop(T& out) noexcept {
+  auto head = _head.load(std::memory_order_relaxed);
+  if (head == _tail_cache) {
+    _tail_cache = _tail.load(std::memory_order_acquire);
+    if (head == _tail_cache) return false;
+  }
+  auto slot = _slots + (head & _mask);
+  out = std::move(*slot);
+  alloc_traits::destroy(_alloc(), slot);
+  _head.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T, typename Alloc>
+template <typename OutIter>
+size_t spsc_ring<T, Alloc>::try_pop_n(OutIter out, size_t n) noexcept {
+  auto head = _head.load(std::memory_order_relaxed);
+  auto ready = _tail_cache - head;
+  if (ready < n) {
+    _tail_cache = _tail.load(std::memory_order_acquire);
+    ready = _tail_cache - head;
+  }
+  if (n > ready) n = ready;
+  if (n == 0) return 0;
+
+  for (size_t i = 0; i < n; ++i, ++out) {
+    auto slot = _slots + ((head + i) & _mask);
+    *out = std::move(*slot);
+    alloc_traits::destroy(_alloc(), slot);
+  }
+  _head.store(head + n, std::memory_order_release);
+  return n;
+}
+
+/* ------------------------------------------------------------------------- */
+
+// bounded lock-free queue for any number of producers and consumers. Every cell carries a
+// sequence number that says whose turn it is: position p is free for the producer that
+// claims p when the sequence is p, and holds an element for the consumer that claims p
+// when it is p + 1, the consumer hands it to the next lap with p + capacity. Claiming is
+// one compare-exchange on head or tail, cells are cache line aligned so neighbouring
+// positions used by different threads do not share a line. Elements from one producer
+// reach any one consumer in the order they were pushed
+template <typename T, typename Alloc = hf::allocator<T>>
+class mpmc_ring : private hf::alloc_holder<Alloc> {
+ public:
+  typedef T value_type;
+  typedef Alloc allocator_type;
+
+ private:
+  typedef hf::alloc_holder<Alloc> holder;
+  typedef hf::allocator_traits<Alloc> alloc_traits;
+
+  using holder::_alloc;
+
+  struct alignas(64) cell {
+    std::atomic<size_t> seq;
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    T* value() noexcept { return reinterpret_cast<T*>(storage); }
+  };
+
+ public:
+  // the capacity is rounded up to a power of two
+  explicit mpmc_ring(size_t capacity, const Alloc& alloc = Alloc()) noexcept;
+
+  mpmc_ring(const mpmc_ring&) = delete;
+
+  mpmc_ring& operator=(const mpmc_ring&) = delete;
+
+  ~mpmc_ring();
+
+ public:
+  size_t capacity() const noexcept { return _mask + 1; }
+
+  // a snapshot, exact only while no thread is active
+  size_t size() const noexcept {
+    auto head = _head.load(std::memory_order_acquire);
+    auto tail = _tail.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+
+  bool empty() const noexcept { return size() == 0; }
+
+  /* ------------------------------------------------------------------------- */
+
+  // false when the ring is full
+  template <typename... Args>
+  bool try_emplace(Args&&... args) noexcept;
+
+  bool try_push(const T& value) noexcept { return try_emplace(value); }
+
+  bool try_push(T&& value) noexcept { return try_emplace(std::move(value)); }
+
+  // waits until there is room
+  template <typename... Args>
+  void emplace(Args&&... args) noexcept {
+    for (unsigned spins = 0; !try_emplace(std::forward<Args>(args)...);) {
+      detail::ring_backoff(spins);
+    }
+  }
+
+  void push(const T& value) noexcept { emplace(value); }
+
+  void push(T&& value) noexcept { emplace(std::move(value)); }
+
+  // claims up to n consecutive free positions with one compare-exchange and constructs
+  // elements from first on into them, returns how many
+  template <typename Iter>
+  size_t try_push_n(Iter first, size_t n) noexcept;
+
+  /* ------------------------------------------------------------------------- */
+
+  // the oldest element is moved into out, false when the ring is empty
+  bool try_pop(T& out) noexcept;
+
+  // waits until there is an element
+  void pop(T& out) noexcept {
+    for (unsigned spins = 0; !try_pop(out);) detail::ring_backoff(spins);
+  }
+
+  // claims up to n consecutive filled positions with one compare-exchange and moves
+  // their elements to out, returns how many
+  template <typename OutIter>
+  size_t try_pop_n(OutIter out, size_t n) noexcept;
+
+ private:
+  static intptr_t diff(size_t a, size_t b) noexcept { return static_cast<intptr_t>(a - b); }
+
+  // the number of cells from pos on, up to n, whose sequence is pos + offset
+  size_t run_length(size_t pos, size_t n, size_t offset) const noexcept {
+    size_t k = 0;
+    while (k < n && _cells[(pos + k) & _mask].seq.load(std::memory_order_acquire) ==
+                        pos + k + offset) {
+      ++k;
+    }
+    return k;
+  }
+
+  cell* _cells = nullptr;
+  size_t _mask = 0;
+
+  alignas(64) std::atomic<size_t> _tail{0};
+
+  alignas(64) std::atomic<size_t> _head{0};
+};
+
+template <typename T, typename Alloc>
+mpmc_ring<T, Alloc>::mpmc_ring(size_t capacity, const Alloc& alloc) noexcept
+    : holder(alloc), _mask(detail::ring_capacity(capacity) - 1) {
+  // cells are over-aligned, which the element allocator does not promise
+  _cells = static_cast<cell*>(
+      ::operator new((_mask + 1) * sizeof(cell), std::align_val_t(alignof(cell))));
+  for (size_t i = 0; i <= _mask; ++i) {
+    ::new (static_cast<void*>(&_cells[i].seq)) std::atomic<size_t>(i);
+  }
+}
+
+template <typename T, typename Alloc>
+mpmc_ring<T, Alloc>::~mpmc_ring() {
+  auto tail = _tail.load(std::memory_order_relaxed);
+  for (auto pos = _head.load(std::memory_order_relaxed); pos != tail; ++pos) {
+    alloc_traits::destroy(_alloc(), _cells[pos & _mask].value());
+  }
+  ::operator delete(_cells, std::align_val_t(alignof(cell)));
+}
+
+template <typename T, typename Alloc>
+template <typename... Args>
+bool mpmc_ring<T, Alloc>::try_emplace(Args&&... args) noexcept {
+  auto pos = _tail.load(std::memory_order_relaxed);
+  cell* c;
+  for (;;) {
+    c = &_cells[pos & _mask];
+    auto d = diff(c->seq.load(std::memory_order_acquire), pos);
+    if (d == 0) {
+      if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    } else if (d < 0) {
+      return false;
+    } else {
+      pos = _tail.load(std::memory_order_relaxed);
+    }
+  }
+  alloc_traits::construct(_alloc(), c->value(), std::forward<Args>(args)...);
+  c->seq.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T, typename Alloc>
+template <typename Iter>
+size_t mpmc_ring<T, Alloc>::try_push_n(Iter first, size_t n) noexcept {
+  if (n == 0) return 0;
+  auto pos = _tail.load(std::memory_order_relaxed);
+  size_t k;
+  for (;;) {
+    k = run_length(pos, n, 0);
+    if (k != 0) {
+      if (_tail.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) break;
+    } else if (diff(_cells[pos & _mask].seq.load(std::memory_order_acquire), pos) < 0) {
+      return 0;
+    } else {
+      pos = _tail.load(std::memory_order_relaxed);
+    }
+  }
+
+  for (size_t i = 0; i < k; ++i, ++first) {
+    auto& c = _cells[(pos + i) & _mask];
+    alloc_traits::construct(_alloc(), c.value(), *first);
+    c.seq.store(pos + i + 1, std::memory_order_release);
+  }
+  return k;
+}
+
+template <typename T, typename Alloc>
+bool mpmc_ring<T, Alloc>::try_pop(T& out) noexcept {
+  auto pos = _head.load(std::memory_order_relaxed);
+  cell* c;
+  for (;;) {
+    c = &_cells[pos & _mask];
+    auto d = diff(c->seq.load(std::memory_order_acquire), pos + 1);
+    if (d == 0) {
+      if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    } else if (d < 0) {
+      return false;
+    } else {
+      pos = _head.load(std::memory_order_relaxed);
+    }
+  }
+  out = std::move(*c->value());
+  alloc_traits::destroy(_alloc(), c->value());
+  c->seq.store(pos + _mask + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T, typename Alloc>
+template <typename OutIter>
+size_t mpmc_ring<T, Alloc>::try_pop_n(OutIter out, size_t n) noexcept {
+  if (n == 0) return 0;
+  auto pos = _head.load(std::memory_order_relaxed);
+  size_t k;
+  for (;;) {
+    k = run_length(pos, n, 1);
+    if (k != 0) {
+      if (_head.compare_exchange_weak(pos, pos + k, std::memory_order_relaxed)) break;
+    } else if (diff(_cells[pos & _mask].seq.load(std::memory_order_acquire), pos + 1) < 0) {
+      return 0;
+    } else {
+      pos = _head.load(std::memory_order_relaxed);
+    }
+  }
+
+  for (size_t i = 0; i < k; ++i, ++out) {
+    auto& c = _cells[(pos + i) & _mask];
+    *out = std::move(*c.value());
+    alloc_traits::destroy(_alloc(), c.value());
+    c.seq.store(pos + i + _mask + 1, std::memory_order_release);
+  }
+  return k;
+}
+
+}  // namespace hf
@@ -0,0 +1,575 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HF_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__clang__) || defined(__GNUC__)
+#define HF_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#else
+#define HF_NO_SANITIZE_ADDRESS
+#endif
+
+// the 16/32 bit kernels stay out of line, inlined into a caller with a short fixed size array
+// their dead vector paths trip -Warray-bounds even though the dispatchers never reach them
+#if defined(__clang__) || defined(__GNUC__)
+#define HF_NOINLINE __attribute__((noinline))
+#else
+#define HF_NOINLINE
+#endif
+
+#if defined(HF_SIMD_X86)
+#define HF_TARGET_SSE2 __attribute__((target("sse2")))
+#define HF_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define HF_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define HF_TARGET_SSE2
+#define HF_TARGET_SSSE3
+#define HF_TARGET_AVX2
+#endif
+
+namespace hf {
+namespace simd {
+
+// runtime cpu feature detection, the answer is computed once per process
+inline bool has_sse2() noexcept {
+#if defined(HF_SIMD_X86) && defined(__SSE2__)
+  return true;
+#elif defined(HF_SIMD_X86)
+  static const bool supported = (__builtin_cpu_init(), __builtin_cpu_supports("sse2"));
+  return supported;
+#else
+  return false;
+#endif
+}
+
+inline bool has_ssse3() noexcept {
+#if defined(HF_SIMD_X86)
+  static const bool supported = (__builtin_cpu_init(), __builtin_cpu_supports("ssse3"));
+  return supported;
+#else
+  return false;
+#endif
+}
+
+inline bool has_avx2() noexcept {
+#if defined(HF_SIMD_X86)
+  static const bool supported = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+  return supported;
+#else
+  return false;
+#endif
+}
+
+inline unsigned ctz(uint32_t x) noexcept { return __builtin_ctz(x); }
+
+inline unsigned ctz64(uint64_t x) noexcept { return __builtin_ctzll(x); }
+
+inline unsigned clz(uint32_t x) noexcept { return __builtin_clz(x); }
+
+/* ------------------------------------------------------------------------- */
+
+// kernels over 16 and 32 bit code units, byte strings use the libc routines instead
+namespace detail {
+
+template <typename T>
+size_t length_scalar(const T* s) noexcept {
+  const T* p = s;
+  while (*p != T(0)) ++p;
+  return p - s;
+}
+
+template <typename T>
+size_t mismatch_scalar(const T* a, const T* b, size_t n) noexcept {
+  size_t i = 0;
+  while (i < n && a[i] == b[i]) ++i;
+  return i;
+}
+
+template <typename T>
+const T* find_scalar(const T* s, size_t n, T ch) noexcept {
+  for (; n != 0; --n, ++s) {
+    if (*s == ch) return s;
+  }
+  return nullptr;
+}
+
+template <typename T>
+void fill_scalar(T* dst, T ch, size_t n) noexcept {
+  while (n--) *dst++ = ch;
+}
+
+#if defined(HF_SIMD_X86)
+
+template <typename T>
+HF_TARGET_SSE2 inline __m128i cmpeq128(__m128i a, __m128i b) noexcept {
+  if constexpr (sizeof(T) == 2) {
+    return _mm_cmpeq_epi16(a, b);
+  } else {
+    return _mm_cmpeq_epi32(a, b);
+  }
+}
+
+template <typename T>
+HF_TARGET_SSE2 inline __m128i set1_128(T ch) noexcept {
+  if constexpr (sizeof(T) == 2) {
+    return _mm_set1_epi16(static_cast<short>(ch));
+  } else {
+    return _mm_set1_epi32(static_cast<int>(ch));
+  }
+}
+
+template <typename T>
+HF_TARGET_AVX2 inline __m256i cmpeq256(__m256i a, __m256i b) noexcept {
+  if constexpr (sizeof(T) == 2) {
+    return _mm256_cmpeq_epi16(a, b);
+  } else {
+    return _mm256_cmpeq_epi32(a, b);
+  }
+}
+
+template <typename T>
+HF_TARGET_AVX2 inline __m256i set1_256(T ch) noexcept {
+  if constexpr (sizeof(T) == 2) {
+    return _mm256_set1_epi16(static_cast<short>(ch));
+  } else {
+    return _mm256_set1_epi32(static_cast<int>(ch));
+  }
+}
+
+// aligned loads never cross a page boundary, so reading ahead of the terminator (and
+// behind the start inside the first block) is safe even though it is outside the string
+template <typename T>
+HF_TARGET_SSE2 HF_NOINLINE HF_NO_SANITIZE_ADDRESS size_t length_sse2(const T* s) noexcept {
+  auto off = reinterpret_cast<uintptr_t>(s) & 15;
+  auto p = reinterpret_cast<const __m128i*>(reinterpret_cast<const char*>(s) - off);
+  const __m128i zero = _mm_setzero_si128();
+
+  uint32_t mask = _mm_movemask_epi8(cmpeq128<T>(_mm_load_si128(p), zero));
+  mask = (mask >> off) << off;
+
+  while (mask == 0) {
+    mask = _mm_movemask_epi8(cmpeq128<T>(_mm_load_si128(++p), zero));
+  }
+
+  auto hit = reinterpret_cast<const char*>(p) + ctz(mask);
+  return (hit - reinterpret_cast<const char*>(s)) / sizeof(T);
+}
+
+template <typename T>
+HF_TARGET_AVX2 HF_NOINLINE HF_NO_SANITIZE_ADDRESS size_t length_avx2(const T* s) noexcept {
+  auto off = reinterpret_cast<uintptr_t>(s) & 31;
+  auto p = reinterpret_cast<const __m256i*>(reinterpret_cast<const char*>(s) - off);
+  const __m256i zero = _mm256_setzero_si256();
+
+  uint32_t mask = _mm256_movemask_epi8(cmpeq256<T>(_mm256_load_si256(p), zero));
+  mask = (mask >> off) << off;
+
+  while (mask == 0) {
+    mask = _mm256_movemask_epi8(cmpeq256<T>(_mm256_load_si256(++p), zero));
+  }
+
+  auto hit = reinterpret_cast<const char*>(p) + ctz(mask);
+  return (hit - reinterpret_cast<const char*>(s)) / sizeof(T);
+}
+
+template <typename T>
+HF_TARGET_SSE2 HF_NOINLINE size_t mismatch_sse2(const T* a, const T* b, size_t n) noexcept {
+  constexpr size_t step = 16 / sizeof(T);
+  size_t i = 0;
+
+  for (; i + step <= n; i += step) {
+    auto va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+    uint32_t mask = _mm_movemask_epi8(cmpeq128<T>(va, vb)) ^ 0xFFFF;
+    if (mask != 0) return i + ctz(mask) / sizeof(T);
+  }
+
+  return i + mismatch_scalar(a + i, b + i, n - i);
+}
+
+template <typename T>
+HF_TARGET_AVX2 HF_NOINLINE size_t mismatch_avx2(const T* a, const T* b, size_t n) noexcept {
+  constexpr size_t step = 32 / sizeof(T);
+  size_t i = 0;
+
+  for (; i + step <= n; i += step) {
+    auto va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+    auto vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+    uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(cmpeq256<T>(va, vb)));
+    if (mask != 0) return i + ctz(mask) / sizeof(T);
+  }
+
+  return i + mismatch_sse2(a + i, b + i, n - i);
+}
+
+template <typename T>
+HF_TARGET_SSE2 HF_NOINLINE const T* find_sse2(const T* s, size_t n, T ch) noexcept {
+  constexpr size_t step = 16 / sizeof(T);
+  const __m128i needle = set1_128(ch);
+  size_t i = 0;
+
+  for (; i + step <= n; i += step) {
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+    uint32_t mask = _mm_movemask_epi8(cmpeq128<T>(v, needle));
+    if (mask != 0) return s + i + ctz(mask) / sizeof(T);
+  }
+
+  return find_scalar(s + i, n - i, ch);
+}
+
+template <typename T>
+HF_TARGET_AVX2 HF_NOINLINE const T* find_avx2(const T* s, size_t n, T ch) noexcept {
+  constexpr size_t step = 32 / sizeof(T);
+  const __m256i needle = set1_256(ch);
+  size_t i = 0;
+
+  for (; i + step <= n; i += step) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    uint32_t mask = _mm256_movemask_epi8(cmpeq256<T>(v, needle));
+    if (mask != 0) return s + i + ctz(mask) / sizeof(T);
+  }
+
+  return find_sse2(s + i, n - i, ch);
+}
+
+template <typename T>
+HF_TARGET_SSE2 HF_NOINLINE void fill_sse2(T* dst, T ch, size_t n) noexcept {
+  constexpr size_t step = 16 / sizeof(T);
+  const __m128i v = set1_128(ch);
+  size_t i = 0;
+
+  for (; i + step <= n; i += step) _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+  fill_scalar(dst + i, ch, n - i);
+}
+
+template <typename T>
+HF_TARGET_AVX2 HF_NOINLINE void fill_avx2(T* dst, T ch, size_t n) noexcept {
+  constexpr size_t step = 32 / sizeof(T);
+  const __m256i v = set1_256(ch);
+  size_t i = 0;
+
+  for (; i + step <= n; i += step) _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+  fill_sse2(dst + i, ch, n - i);
+}
+
+#endif
+
+}  // namespace detail
+
+/* ------------------------------------------------------------------------- */
+
+// dispatchers, short inputs stay scalar because a vector setup would cost more than it saves
+
+template <typename T>
+size_t length(const T* s) noexcept {
+  static_assert(sizeof(T) == 2 || sizeof(T) == 4, "16 or 32 bit code units only");
+#if defined(HF_SIMD_X86)
+  if (has_avx2()) return detail::length_avx2(s);
+  if (has_sse2()) return detail::length_sse2(s);
+#endif
+  return detail::length_scalar(s);
+}
+
+// index of the first position where a and b differ, n if they are equal
+template <typename T>
+size_t mismatch(const T* a, const T* b, size_t n) noexcept {
+  static_assert(sizeof(T) == 2 || sizeof(T) == 4, "16 or 32 bit code units only");
+#if defined(HF_SIMD_X86)
+  if (n * sizeof(T) >= 32 && has_avx2()) return detail::mismatch_avx2(a, b, n);
+  if (n * sizeof(T) >= 16 && has_sse2()) return detail::mismatch_sse2(a, b, n);
+#endif
+  return detail::mismatch_scalar(a, b, n);
+}
+
+template <typename T>
+const T* find(const T* s, size_t n, T ch) noexcept {
+  static_assert(sizeof(T) == 2 || sizeof(T) == 4, "16 or 32 bit code units only");
+#if defined(HF_SIMD_X86)
+  if (n * sizeof(T) >= 32 && has_avx2()) return detail::find_avx2(s, n, ch);
+  if (n * sizeof(T) >= 16 && has_sse2()) return detail::find_sse2(s, n, ch);
+#endif
+  return detail::find_scalar(s, n, ch);
+}
+
+template <typename T>
+void fill(T* dst, T ch, size_t n) noexcept {
+  static_assert(sizeof(T) == 2 || sizeof(T) == 4, "16 or 32 bit code units only");
+#if defined(HF_SIMD_X86)
+  if (n * sizeof(T) >= 32 && has_avx2()) return detail::fill_avx2(dst, ch, n);
+  if (n * sizeof(T) >= 16 && has_sse2()) return detail::fill_sse2(dst, ch, n);
+#endif
+  detail::fill_scalar(dst, ch, n);
+}
+
+/* ------------------------------------------------------------------------- */
+
+// byte string search
+
+static constexpr size_t npos = static_cast<size_t>(-1);
+
+// membership table for a set of bytes, the nibble tables drive the pshufb lookup: a byte c
+// is in the set when lo_x[c & 15] has bit (c >> 4) & 7 set, x picked by the top bit of c
+struct byte_set {
+  alignas(16) uint8_t lo_a[16];
+  alignas(16) uint8_t lo_b[16];
+  bool table[256];
+
+  byte_set(const char* s, size_t n) noexcept {
+    std::memset(this, 0, sizeof(*this));
+    for (size_t i = 0; i < n; ++i) {
+      auto c = static_cast<uint8_t>(s[i]);
+      auto& row = c < 0x80 ? lo_a : lo_b;
+      row[c & 15] |= static_cast<uint8_t>(1 << ((c >> 4) & 7));
+      table[c] = true;
+    }
+  }
+
+  bool contains(char c) const noexcept { return table[static_cast<uint8_t>(c)]; }
+};
+
+namespace detail {
+
+inline size_t find_substr_scalar(const char* h, size_t n, const char* s, size_t m) noexcept {
+  if (m > n) return npos;
+
+  const char* cur = h;
+  const char* last = h + n - m;
+
+  while (cur <= last) {
+    cur = static_cast<const char*>(std::memchr(cur, s[0], last - cur + 1));
+    if (cur == nullptr) return npos;
+    if (std::memcmp(cur + 1, s + 1, m - 1) == 0) return cur - h;
+    ++cur;
+  }
+
+  return npos;
+}
+
+inline const char* rfind_byte_scalar(const char* h, size_t n, char c) noexcept {
+  while (n != 0) {
+    if (h[--n] == c) return h + n;
+  }
+  return nullptr;
+}
+
+inline size_t find_first_of_scalar(const char* h, size_t n, const byte_set& set) noexcept {
+  for (size_t i = 0; i < n; ++i) {
+    if (set.contains(h[i])) return i;
+  }
+  return npos;
+}
+
+inline size_t find_last_of_scalar(const char* h, size_t n, const byte_set& set) noexcept {
+  while (n != 0) {
+    if (set.contains(h[--n])) return n;
+  }
+  return npos;
+}
+
+#if defined(HF_SIMD_X86)
+
+// compare the first and the last byte of the needle at every position of a block at once and
+// only verify the candidates that pass both
+HF_TARGET_SSE2 inline size_t find_substr_sse2(const char* h, size_t n, const char* s,
+                                              size_t m) noexcept {
+  const __m128i first = _mm_set1_epi8(s[0]);
+  const __m128i last = _mm_set1_epi8(s[m - 1]);
+  size_t i = 0;
+
+  for (; i + m - 1 + 16 <= n; i += 16) {
+    auto bf = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i));
+    auto bl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i + m - 1));
+    uint32_t mask =
+        _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, bf), _mm_cmpeq_epi8(last, bl)));
+
+    while (mask != 0) {
+      auto bit = ctz(mask);
+      if (std::memcmp(h + i + bit + 1, s + 1, m - 2) == 0) return i + bit;
+      mask &= mask - 1;
+    }
+  }
+
+  auto r = find_substr_scalar(h + i, n - i, s, m);
+  return r == npos ? npos : i + r;
+}
+
+HF_TARGET_AVX2 inline size_t find_substr_avx2(const char* h, size_t n, const char* s,
+                                              size_t m) noexcept {
+  const __m256i first = _mm256_set1_epi8(s[0]);
+  const __m256i last = _mm256_set1_epi8(s[m - 1]);
+  size_t i = 0;
+
+  for (; i + m - 1 + 32 <= n; i += 32) {
+    auto bf = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i));
+    auto bl = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i + m - 1));
+    uint32_t mask = _mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(first, bf), _mm256_cmpeq_epi8(last, bl)));
+
+    while (mask != 0) {
+      auto bit = ctz(mask);
+      if (std::memcmp(h + i + bit + 1, s + 1, m - 2) == 0) return i + bit;
+      mask &= mask - 1;
+    }
+  }
+
+  auto r = find_substr_sse2(h + i, n - i, s, m);
+  return r == npos ? npos : i + r;
+}
+
+HF_TARGET_SSE2 inline const char* rfind_byte_sse2(const char* h, size_t n, char c) noexcept {
+  const __m128i needle = _mm_set1_epi8(c);
+
+  while (n >= 16) {
+    n -= 16;
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + n));
+    uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+    if (mask != 0) return h + n + 31 - clz(mask);
+  }
+
+  return rfind_byte_scalar(h, n, c);
+}
+
+HF_TARGET_AVX2 inline const char* rfind_byte_avx2(const char* h, size_t n, char c) noexcept {
+  const __m256i needle = _mm256_set1_epi8(c);
+
+  while (n >= 32) {
+    n -= 32;
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + n));
+    uint32_t mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, needle));
+    if (mask != 0) return h + n + 31 - clz(mask);
+  }
+
+  return rfind_byte_sse2(h, n, c);
+}
+
+HF_TARGET_SSSE3 inline uint32_t byte_set_mask_ssse3(__m128i v, const byte_set& set) noexcept {
+  const __m128i nibble = _mm_set1_epi8(0x0F);
+  const __m128i bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+  const __m128i lo_a = _mm_load_si128(reinterpret_cast<const __m128i*>(set.lo_a));
+  const __m128i lo_b = _mm_load_si128(reinterpret_cast<const __m128i*>(set.lo_b));
+
+  auto lo = _mm_and_si128(v, nibble);
+  auto hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+  auto high_half = _mm_cmplt_epi8(v, _mm_setzero_si128());
+  auto row = _mm_or_si128(_mm_andnot_si128(high_half, _mm_shuffle_epi8(lo_a, lo)),
+                          _mm_and_si128(high_half, _mm_shuffle_epi8(lo_b, lo)));
+  auto bit = _mm_shuffle_epi8(bits, hi);
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(row, bit), bit));
+}
+
+HF_TARGET_AVX2 inline uint32_t byte_set_mask_avx2(__m256i v, const byte_set& set) noexcept {
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  const __m256i bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64,
+                                        -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32,
+                                        64, -128);
+  const __m256i lo_a =
+      _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(set.lo_a)));
+  const __m256i lo_b =
+      _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(set.lo_b)));
+
+  auto lo = _mm256_and_si256(v, nibble);
+  auto hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+  auto row = _mm256_blendv_epi8(_mm256_shuffle_epi8(lo_a, lo), _mm256_shuffle_epi8(lo_b, lo), v);
+  auto bit = _mm256_shuffle_epi8(bits, hi);
+  return _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit));
+}
+
+HF_TARGET_SSSE3 inline size_t find_first_of_ssse3(const char* h, size_t n,
+                                                  const byte_set& set) noexcept {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    auto mask = byte_set_mask_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i)), set);
+    if (mask != 0) return i + ctz(mask);
+  }
+
+  auto r = find_first_of_scalar(h + i, n - i, set);
+  return r == npos ? npos : i + r;
+}
+
+HF_TARGET_AVX2 inline size_t find_first_of_avx2(const char* h, size_t n,
+                                                const byte_set& set) noexcept {
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i));
+    auto mask = byte_set_mask_avx2(v, set);
+    if (mask != 0) return i + ctz(mask);
+  }
+
+  auto r = find_first_of_ssse3(h + i, n - i, set);
+  return r == npos ? npos : i + r;
+}
+
+HF_TARGET_SSSE3 inline size_t find_last_of_ssse3(const char* h, size_t n,
+                                                 const byte_set& set) noexcept {
+  while (n >= 16) {
+    n -= 16;
+    auto mask = byte_set_mask_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(h + n)), set);
+    if (mask != 0) return n + 31 - clz(mask);
+  }
+
+  return find_last_of_scalar(h, n, set);
+}
+
+HF_TARGET_AVX2 inline size_t find_last_of_avx2(const char* h, size_t n,
+                                               const byte_set& set) noexcept {
+  while (n >= 32) {
+    n -= 32;
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + n));
+    auto mask = byte_set_mask_avx2(v, set);
+    if (mask != 0) return n + 31 - clz(mask);
+  }
+
+  return find_last_of_ssse3(h, n, set);
+}
+
+#endif
+
+}  // namespace detail
+
+// position of the first occurrence of s[0, m) in h[0, n), npos if there is none
+inline size_t find_substr(const char* h, size_t n, const char* s, size_t m) noexcept {
+  if (m == 0) return 0;
+  if (m > n) return npos;
+  if (m == 1) {
+    auto p = static_cast<const char*>(std::memchr(h, s[0], n));
+    return p == nullptr ? npos : p - h;
+  }
+#if defined(HF_SIMD_X86)
+  if (has_avx2()) return detail::find_substr_avx2(h, n, s, m);
+  if (has_sse2()) return detail::find_substr_sse2(h, n, s, m);
+#endif
+  return detail::find_substr_scalar(h, n, s, m);
+}
+
+inline const char* rfind_byte(const char* h, size_t n, char c) noexcept {
+#if defined(HF_SIMD_X86)
+  if (n >= 32 && has_avx2()) return detail::rfind_byte_avx2(h, n, c);
+  if (n >= 16 && has_sse2()) return detail::rfind_byte_sse2(h, n, c);
+#endif
+  return detail::rfind_byte_scalar(h, n, c);
+}
+
+inline size_t find_first_of(const char* h, size_t n, const byte_set& set) noexcept {
+#if defined(HF_SIMD_X86)
+  if (n >= 32 && has_avx2()) return detail::find_first_of_avx2(h, n, set);
+  if (n >= 16 && has_ssse3()) return detail::find_first_of_ssse3(h, n, set);
+#endif
+  return detail::find_first_of_scalar(h, n, set);
+}
+
+inline size_t find_last_of(const char* h, size_t n, const byte_set& set) noexcept {
+#if defined(HF_SIMD_X86)
+  if (n >= 32 && has_avx2()) return detail::find_last_of_avx2(h, n, set);
+  if (n >= 16 && has_ssse3()) return detail::find_last_of_ssse3(h, n, set);
+#endif
+  return detail::find_last_of_scalar(h, n, set);
+}
+
+}  // namespace simd
+}  // namespace hf
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+
+#include "allocator.hpp"
+#include "type_traits.hpp"
+#include "vector.hpp"
+
+namespace hf {
+
+namespace detail {
+
+// hands out the owning small_vector's inline buffer for requests that fit in it and
+// heap memory otherwise, vector only asks for more than the current capacity, so
+// the inline buffer is never requested while it is in use
+template <typename T, size_t N>
+class small_vector_allocator : public hf::allocator<T> {
+ public:
+  typedef T value_type;
+
+  explicit small_vector_allocator(T* buffer) noexcept : _buffer(buffer) {}
+
+  T* allocate(size_t n) noexcept {
+    return n <= N ? _buffer : hf::allocator<T>::allocate(n);
+  }
+
+  void deallocate(T* ptr, size_t n) noexcept {
+    if (ptr != _buffer) hf::allocator<T>::deallocate(ptr, n);
+  }
+
+  T* buffer() const noexcept { return _buffer; }
+
+ private:
+  T* _buffer;
+};
+
+template <typename T, size_t N>
+bool operator==(const small_vector_allocator<T, N>& lhs,
+                const small_vector_allocator<T, N>& rhs) noexcept {
+  return lhs.buffer() == rhs.buffer();
+}
+
+template <typename T, size_t N>
+bool operator!=(const small_vector_allocator<T, N>& lhs,
+                const small_vector_allocator<T, N>& rhs) noexcept {
+  return !(lhs == rhs);
+}
+
+}  // namespace detail
+
+// the allocator points into the object that owns it
+template <typename T, size_t N>
+struct is_trivially_relocatable<detail::small_vector_allocator<T, N>> : public false_type {};
+
+// vector that keeps up to N elements inline and spills to the heap past that, insertion,
+// erasure and growth are vector's own, only moves and swaps need to know where the
+// elements live
+template <typename T, size_t N, typename Growth = hf::growth_1_5x>
+class small_vector : private hf::vector<T, detail::small_vector_allocator<T, N>, Growth> {
+  static_assert(N > 0, "small_vector needs room for at least one inline element");
+
+  typedef hf::vector<T, detail::small_vector_allocator<T, N>, Growth> base;
+  typedef typename base::alloc_traits alloc_traits;
+
+ public:
+  using typename base::const_iterator;
+  using typename base::const_pointer;
+  using typename base::const_reference;
+  using typename base::iterator;
+  using typename base::pointer;
+  using typename base::reference;
+
+  static constexpr size_t INLINE_CAPACITY = N;
+
+ public:
+  small_vector() noexcept : base(detail::small_vector_allocator<T, N>(inline_data())) {
+    reset_inline();
+  }
+
+  explicit small_vector(size_t n) noexcept : small_vector() { base::resize(n); }
+
+  small_vector(const small_vector& rhs) noexcept : small_vector() {
+    this->range_assign(rhs.begin(), rhs.end());
+  }
+
+  small_vector(small_vector&& rhs) noexcept : small_vector() { move_from(rhs); }
+
+  small_vector(std::initializer_list<T> list) noexcept : small_vector() {
+    this->range_assign(list.begin(), list.end());
+  }
+
+  small_vector& operator=(const small_vector& rhs) noexcept {
+    if (this != &rhs) this->range_assign(rhs.begin(), rhs.end());
+    return *this;
+  }
+
+  small_vector& operator=(small_vector&& rhs) noexcept {
+    if (this != &rhs) move_from(rhs);
+    return *this;
+  }
+
+  ~small_vector() { base::clear(); }
+
+ public:
+  using base::begin;
+  using base::cbegin;
+  using base::cend;
+  using base::end;
+
+  using base::capacity;
+  using base::empty;
+  using base::max_size;
+  using base::size;
+
+  using base::operator[];
+  using base::back;
+  using base::data;
+  using base::front;
+
+  using base::clear;
+  using base::emplace;
+  using base::emplace_back;
+  using base::erase;
+  using base::insert;
+  using base::pop_back;
+  using base::push_back;
+  using base::reserve;
+  using base::resize;
+
+  bool is_inline() const noexcept { return this->_begin == inline_data(); }
+
+  void shrink_to_fit() noexcept;
+
+  void swap(small_vector& rhs) noexcept;
+
+ private:
+  T* inline_data() noexcept { return reinterpret_cast<T*>(_storage); }
+
+  const T* inline_data() const noexcept { return reinterpret_cast<const T*>(_storage); }
+
+  void reset_inline() noexcept {
+    this->_begin = this->_end = inline_data();
+    this->_cap = inline_data() + N;
+  }
+
+  void move_from(small_vector& rhs) noexcept;
+
+  alignas(T) unsigned char _storage[N * sizeof(T)];
+};
+
+// heap storage changes hands, inline elements have to be moved one by one
+template <typename T, size_t N, typename Growth>
+void small_vector<T, N, Growth>::move_from(small_vector& rhs) noexcept {
+  if (rhs.is_inline()) {
+    this->range_assign(std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+    rhs.clear();
+    return;
+  }
+
+  this->destroy_and_recover(this->_begin, this->_end, this->_cap - this->_begin);
+  this->_begin = rhs._begin;
+  this->_end = rhs._end;
+  this->_cap = rhs._cap;
+  rhs.reset_inline();
+}
+
+template <typename T, size_t N, typename Growth>
+void small_vector<T, N, Growth>::shrink_to_fit() noexcept {
+  if (is_inline()) return;
+  if (size() > N) return base::shrink_to_fit();
+
+  auto old_begin = this->_begin;
+  auto old_cap = capacity();
+
+  this->_end = this->relocate(this->_begin, this->_end, inline_data());
+  this->_begin = inline_data();
+  this->_cap = inline_data() + N;
+  alloc_traits::deallocate(this->_alloc(), old_begin, old_cap);
+}
+
+template <typename T, size_t N, typename Growth>
+void small_vector<T, N, Growth>::swap(small_vector& rhs) noexcept {
+  if (this == &rhs) return;
+
+  if (!is_inline() && !rhs.is_inline()) {
+    std::swap(this->_begin, rhs._begin);
+    std::swap(this->_end, rhs._end);
+    std::swap(this->_cap, rhs._cap);
+    return;
+  }
+
+  small_vector tmp(std::move(rhs));
+  rhs = std::move(*this);
+  *this = std::move(tmp);
+}
+
+}  // namespace hf
@@ -0,0 +1,700 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <type_traits>
+
+#include "allocator.hpp"
+#include "simd.hpp"
+#include "type_traits.hpp"
+#include "utils.hpp"
+#include "vector.hpp"
+
+// sorting for buffers of numbers. The quick mode is a quicksort whose partition passes
+// and small range sorting networks run in AVX2 registers, std::sort without AVX2. The
+// radix mode is a stable LSD radix sort over the key bytes. Unsigned and floating point
+// keys are mapped onto integers of the same width that order the same way, so the
+// kernels only know signed (quick) or unsigned (radix) integers. NaNs sort by their bit
+// pattern, below -inf or above +inf depending on their sign. Numbers wider than 8 bytes
+// (long double, __int128) go to std::sort in either mode
+
+namespace hf {
+
+enum class sort_mode {
+  quick,  // in place, not stable
+  radix,  // stable, needs a second buffer of the same size, one pass per varying key byte
+};
+
+namespace detail {
+
+template <size_t N>
+struct sort_uint;
+
+template <>
+struct sort_uint<1> {
+  typedef uint8_t type;
+};
+
+template <>
+struct sort_uint<2> {
+  typedef uint16_t type;
+};
+
+template <>
+struct sort_uint<4> {
+  typedef uint32_t type;
+};
+
+template <>
+struct sort_uint<8> {
+  typedef uint64_t type;
+};
+
+// unsigned integer of the same width whose order is the order of T
+template <typename T>
+typename sort_uint<sizeof(T)>::type sort_key(T x) noexcept {
+  typedef typename sort_uint<sizeof(T)>::type U;
+  constexpr U sign = U(1) << (8 * sizeof(T) - 1);
+  U u;
+  std::memcpy(&u, &x, sizeof(T));
+  if constexpr (std::is_floating_point<T>::value) {
+    return (u & sign) != 0 ? static_cast<U>(~u) : static_cast<U>(u | sign);
+  } else if constexpr (std::is_signed<T>::value) {
+    return static_cast<U>(u ^ sign);
+  } else {
+    return u;
+  }
+}
+
+template <typename T>
+T from_sort_key(typename sort_uint<sizeof(T)>::type u) noexcept {
+  typedef typename sort_uint<sizeof(T)>::type U;
+  constexpr U sign = U(1) << (8 * sizeof(T) - 1);
+  if constexpr (std::is_floating_point<T>::value) {
+    u = (u & sign) != 0 ? static_cast<U>(u ^ sign) : static_cast<U>(~u);
+  } else if constexpr (std::is_signed<T>::value) {
+    u = static_cast<U>(u ^ sign);
+  }
+  T x;
+  std::memcpy(&x, &u, sizeof(T));
+  return x;
+}
+
+/* ------------------------------------------------------------------------- */
+
+// LSD radix sort of elements that may be moved with memcpy, key(x) is an unsigned integer.
+// All byte histograms come from one pass over the input, bytes that are the same in every
+// key are skipped
+template <typename T, typename KeyOf>
+void radix_sort(T* a, size_t n, KeyOf key) noexcept {
+  static_assert(hf::is_trivially_relocatable<T>::value, "radix sort moves elements with memcpy");
+  typedef decltype(key(*a)) U;
+  constexpr size_t BYTES = sizeof(U);
+
+  size_t counts[BYTES][256] = {};
+  for (size_t i = 0; i < n; ++i) {
+    auto k = key(a[i]);
+    for (size_t b = 0; b < BYTES; ++b) ++counts[b][(k >> (8 * b)) & 0xFF];
+  }
+
+  auto buffer = hf::allocator<T>::allocate(n);
+  T* src = a;
+  T* dst = buffer;
+  for (size_t b = 0; b < BYTES; ++b) {
+    auto& count = counts[b];
+    if (count[(key(src[0]) >> (8 * b)) & 0xFF] == n) continue;
+
+    size_t offsets[256];
+    size_t sum = 0;
+    for (size_t d = 0; d < 256; ++d) {
+      offsets[d] = sum;
+      sum += count[d];
+    }
+    for (size_t i = 0; i < n; ++i) {
+      auto d = (key(src[i]) >> (8 * b)) & 0xFF;
+      std::memcpy(static_cast<void*>(dst + offsets[d]++), src + i, sizeof(T));
+    }
+    std::swap(src, dst);
+  }
+  if (src != a) std::memcpy(static_cast<void*>(a), src, n * sizeof(T));
+  hf::allocator<T>::deallocate(buffer, n);
+}
+
+/* ------------------------------------------------------------------------- */
+
+#if defined(HF_SIMD_X86)
+
+// the quicksort works on signed keys in place of the elements, these go through memcpy
+// because the memory still belongs to objects of the element type
+
+template <typename T>
+using sort_int = typename std::make_signed<typename sort_uint<sizeof(T)>::type>::type;
+
+template <typename T>
+sort_int<T> load_key(const T* p) noexcept {
+  sort_int<T> k;
+  std::memcpy(&k, p, sizeof(T));
+  return k;
+}
+
+template <typename T>
+void store_key(T* p, sort_int<T> k) noexcept {
+  std::memcpy(static_cast<void*>(p), &k, sizeof(T));
+}
+
+template <typename T>
+void swap_keys(T* a, T* b) noexcept {
+  auto x = load_key(a);
+  store_key(a, load_key(b));
+  store_key(b, x);
+}
+
+template <typename T>
+void to_sort_ints(T* a, size_t n) noexcept {
+  typedef typename sort_uint<sizeof(T)>::type U;
+  constexpr U sign = U(1) << (8 * sizeof(T) - 1);
+  if constexpr (!std::is_same<T, sort_int<T>>::value) {
+    for (size_t i = 0; i < n; ++i) {
+      auto u = static_cast<U>(sort_key(a[i]) ^ sign);
+      std::memcpy(static_cast<void*>(a + i), &u, sizeof(T));
+    }
+  }
+}
+
+template <typename T>
+void from_sort_ints(T* a, size_t n) noexcept {
+  typedef typename sort_uint<sizeof(T)>::type U;
+  constexpr U sign = U(1) << (8 * sizeof(T) - 1);
+  if constexpr (!std::is_same<T, sort_int<T>>::value) {
+    for (size_t i = 0; i < n; ++i) {
+      U u;
+      std::memcpy(&u, a + i, sizeof(T));
+      a[i] = from_sort_key<T>(static_cast<U>(u ^ sign));
+    }
+  }
+}
+
+// the quicksort's way out of bad pivots
+template <typename T>
+void heap_sort_keys(T* a, size_t n) noexcept {
+  auto sift_down = [a](size_t i, size_t size) {
+    for (;;) {
+      auto child = 2 * i + 1;
+      if (child >= size) return;
+      if (child + 1 < size && load_key(a + child) < load_key(a + child + 1)) ++child;
+      if (!(load_key(a + i) < load_key(a + child))) return;
+      swap_keys(a + i, a + child);
+      i = child;
+    }
+  };
+  for (size_t i = n / 2; i-- != 0;) sift_down(i, n);
+  for (size_t end = n - 1; end > 0; --end) {
+    swap_keys(a, a + end);
+    sift_down(0, end);
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+// permutevar8x32 indices that move the lanes with their bit clear in the mask to the
+// front and those with it set behind them, each group in order. LANES keys of 32 / LANES
+// bytes each
+template <int LANES>
+struct compress_table {
+  int32_t idx[1 << LANES][8];
+
+  constexpr compress_table() : idx() {
+    constexpr int PARTS = 8 / LANES;
+    for (int m = 0; m < (1 << LANES); ++m) {
+      int k = 0;
+      for (int bit = 0; bit < 2; ++bit) {
+        for (int lane = 0; lane < LANES; ++lane) {
+          if (((m >> lane) & 1) != bit) continue;
+          for (int part = 0; part < PARTS; ++part) idx[m][k++] = PARTS * lane + part;
+        }
+      }
+    }
+  }
+};
+
+inline constexpr compress_table<8> COMPRESS_32{};
+inline constexpr compress_table<4> COMPRESS_64{};
+
+// lane operations on 8 int32 or 4 int64 keys
+template <size_t N>
+struct sort_lanes;
+
+template <>
+struct sort_lanes<4> {
+  typedef int32_t key_type;
+  static constexpr size_t W = 8;
+
+  HF_TARGET_AVX2 static __m256i set1(int32_t x) noexcept { return _mm256_set1_epi32(x); }
+
+  HF_TARGET_AVX2 static __m256i min(__m256i a, __m256i b) noexcept {
+    return _mm256_min_epi32(a, b);
+  }
+
+  HF_TARGET_AVX2 static __m256i max(__m256i a, __m256i b) noexcept {
+    return _mm256_max_epi32(a, b);
+  }
+
+  // one bit per lane, set where v > pivot
+  HF_TARGET_AVX2 static unsigned greater(__m256i v, __m256i pivot) noexcept {
+    auto gt = _mm256_cmpgt_epi32(v, pivot);
+    return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(gt)));
+  }
+
+  HF_TARGET_AVX2 static __m256i compress(__m256i v, unsigned mask) noexcept {
+    auto idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(COMPRESS_32.idx[mask]));
+    return _mm256_permutevar8x32_epi32(v, idx);
+  }
+
+  // lane i takes lane i ^ X
+  template <int X>
+  HF_TARGET_AVX2 static __m256i permute_xor(__m256i v) noexcept {
+    if constexpr (X == 1) {
+      return _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+    } else if constexpr (X == 2) {
+      return _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    } else if constexpr (X == 3) {
+      return _mm256_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+    } else if constexpr (X == 4) {
+      return _mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 0, 3, 2));
+    } else {
+      return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0 ^ X, 1 ^ X, 2 ^ X, 3 ^ X, 4 ^ X,
+                                                               5 ^ X, 6 ^ X, 7 ^ X));
+    }
+  }
+
+  // blend mask of the lanes that get the larger key of an exchange with lane i ^ X
+  static constexpr int upper_lanes(int x) noexcept {
+    int high = 1;
+    while (high * 2 <= x) high *= 2;
+    int mask = 0;
+    for (int lane = 0; lane < 8; ++lane) {
+      if ((lane & high) != 0) mask |= 1 << lane;
+    }
+    return mask;
+  }
+};
+
+template <>
+struct sort_lanes<8> {
+  typedef int64_t key_type;
+  static constexpr size_t W = 4;
+
+  HF_TARGET_AVX2 static __m256i set1(int64_t x) noexcept { return _mm256_set1_epi64x(x); }
+
+  HF_TARGET_AVX2 static __m256i min(__m256i a, __m256i b) noexcept {
+    return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+  }
+
+  HF_TARGET_AVX2 static __m256i max(__m256i a, __m256i b) noexcept {
+    return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+  }
+
+  HF_TARGET_AVX2 static unsigned greater(__m256i v, __m256i pivot) noexcept {
+    auto gt = _mm256_cmpgt_epi64(v, pivot);
+    return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(gt)));
+  }
+
+  HF_TARGET_AVX2 static __m256i compress(__m256i v, unsigned mask) noexcept {
+    auto idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(COMPRESS_64.idx[mask]));
+    return _mm256_permutevar8x32_epi32(v, idx);
+  }
+
+  template <int X>
+  HF_TARGET_AVX2 static __m256i permute_xor(__m256i v) noexcept {
+    if constexpr (X == 1) {
+      return _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+    } else if constexpr (X == 2) {
+      return _mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 0, 3, 2));
+    } else {
+      static_assert(X == 3, "four lanes");
+      return _mm256_permute4x64_epi64(v, _MM_SHUFFLE(0, 1, 2, 3));
+    }
+  }
+
+  // a 64 bit lane is two bits of the 32 bit blend
+  static constexpr int upper_lanes(int x) noexcept {
+    int high = 1;
+    while (high * 2 <= x) high *= 2;
+    int mask = 0;
+    for (int lane = 0; lane < 4; ++lane) {
+      if ((lane & high) != 0) mask |= 3 << (2 * lane);
+    }
+    return mask;
+  }
+};
+
+/* ------------------------------------------------------------------------- */
+
+// sorting networks, bitonic in the form that only ever puts the smaller key in the lower
+// position: merging two sorted blocks compares each key with its mirror image in the other
+// block, then half cleaners of falling distance finish the merge
+
+// compare-exchange of every lane with lane i ^ X
+template <typename L, int X>
+HF_TARGET_AVX2 inline __m256i exchange(__m256i v) noexcept {
+  constexpr int UPPER = L::upper_lanes(X);
+  auto p = L::template permute_xor<X>(v);
+  return _mm256_blend_epi32(L::min(v, p), L::max(v, p), UPPER);
+}
+
+template <typename L>
+HF_TARGET_AVX2 inline __m256i reverse(__m256i v) noexcept {
+  return L::template permute_xor<static_cast<int>(L::W) - 1>(v);
+}
+
+template <typename L>
+HF_TARGET_AVX2 inline __m256i sort_register(__m256i v) noexcept {
+  v = exchange<L, 1>(v);
+  v = exchange<L, 3>(v);
+  v = exchange<L, 1>(v);
+  if constexpr (L::W == 8) {
+    v = exchange<L, 7>(v);
+    v = exchange<L, 2>(v);
+    v = exchange<L, 1>(v);
+  }
+  return v;
+}
+
+// the half cleaners inside a register that end every merge
+template <typename L>
+HF_TARGET_AVX2 inline __m256i clean_register(__m256i v) noexcept {
+  if constexpr (L::W == 8) v = exchange<L, 4>(v);
+  v = exchange<L, 2>(v);
+  return exchange<L, 1>(v);
+}
+
+template <typename L, size_t R>
+HF_TARGET_AVX2 inline void sort_registers(__m256i* r) noexcept {
+  for (size_t i = 0; i < R; ++i) r[i] = sort_register<L>(r[i]);
+
+  for (size_t block = 2; block <= R; block *= 2) {
+    for (size_t b = 0; b < R; b += block) {
+      for (size_t j = 0; j < block / 2; ++j) {
+        auto x = r[b + j];
+        auto y = reverse<L>(r[b + block - 1 - j]);
+        r[b + j] = L::min(x, y);
+        r[b + block - 1 - j] = reverse<L>(L::max(x, y));
+      }
+    }
+    for (size_t d = block / 4; d != 0; d /= 2) {
+      for (size_t b = 0; b < R; b += 2 * d) {
+        for (size_t j = b; j < b + d; ++j) {
+          auto x = r[j];
+          r[j] = L::min(x, r[j + d]);
+          r[j + d] = L::max(x, r[j + d]);
+        }
+      }
+    }
+    for (size_t i = 0; i < R; ++i) r[i] = clean_register<L>(r[i]);
+  }
+}
+
+template <typename L, size_t R>
+HF_TARGET_AVX2 inline void sort_buffer(typename L::key_type* buf) noexcept {
+  __m256i r[R];
+  for (size_t i = 0; i < R; ++i) {
+    r[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(buf + i * L::W));
+  }
+  sort_registers<L, R>(r);
+  for (size_t i = 0; i < R; ++i) {
+    _mm256_store_si256(reinterpret_cast<__m256i*>(buf + i * L::W), r[i]);
+  }
+}
+
+// up to 8 registers of keys, the unused lanes padded with the largest key
+template <typename T, typename L = sort_lanes<sizeof(T)>>
+HF_TARGET_AVX2 void small_sort_avx2(T* a, size_t n) noexcept {
+  typedef typename L::key_type K;
+  constexpr size_t W = L::W;
+  assert(n <= 8 * W);
+  if (n < 2) return;
+
+  alignas(32) K buf[8 * W];
+  std::memcpy(buf, a, n * sizeof(T));
+  auto regs = (n + W - 1) / W;
+  size_t padded = regs <= 1 ? 1 : regs <= 2 ? 2 : regs <= 4 ? 4 : 8;
+  for (size_t i = n; i < padded * W; ++i) buf[i] = std::numeric_limits<K>::max();
+
+  switch (padded) {
+    case 1:
+      sort_buffer<L, 1>(buf);
+      break;
+    case 2:
+      sort_buffer<L, 2>(buf);
+      break;
+    case 4:
+      sort_buffer<L, 4>(buf);
+      break;
+    default:
+      sort_buffer<L, 8>(buf);
+      break;
+  }
+  std::memcpy(static_cast<void*>(a), buf, n * sizeof(T));
+}
+
+/* ------------------------------------------------------------------------- */
+
+// one register of the partition, compressed so its keys <= pivot come first and stored at
+// both write positions, each side keeps the part that belongs there
+template <typename L>
+HF_TARGET_AVX2 inline void partition_register(__m256i v, __m256i pivot, typename L::key_type* keys,
+                                              size_t& store_left, size_t& store_right) noexcept {
+  auto mask = L::greater(v, pivot);
+  auto packed = L::compress(v, mask);
+  auto above = static_cast<size_t>(__builtin_popcount(mask));
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(keys + store_left), packed);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(keys + store_right), packed);
+  store_left += L::W - above;
+  store_right -= above;
+}
+
+// keys <= pivot to the front, > pivot to the back, returns where the back starts. Two
+// registers from the ends are read ahead, after that every register is read from the side
+// with less room between what was read and what was written, so the compressed stores to
+// both sides only ever overwrite keys that are already in registers. Also reports the
+// smallest and largest key seen, n >= 2 * W
+template <typename T, typename L = sort_lanes<sizeof(T)>>
+HF_TARGET_AVX2 size_t partition_avx2(T* a, size_t n, typename L::key_type pivot,
+                                     typename L::key_type& smallest,
+                                     typename L::key_type& biggest) noexcept {
+  typedef typename L::key_type K;
+  constexpr size_t W = L::W;
+
+  size_t left = 0;
+  size_t right = n;
+  smallest = std::numeric_limits<K>::max();
+  biggest = std::numeric_limits<K>::min();
+
+  // the odd keys one by one, leaving a multiple of W
+  for (size_t k = n % W; k != 0; --k) {
+    auto key = load_key(a + left);
+    smallest = std::min(smallest, key);
+    biggest = std::max(biggest, key);
+    if (key > pivot) {
+      swap_keys(a + left, a + --right);
+    } else {
+      ++left;
+    }
+  }
+
+  // the vector loads and stores may alias the elements, unlike plain key pointers
+  auto keys = reinterpret_cast<K*>(a);
+  auto pv = L::set1(pivot);
+  auto first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + left));
+  auto last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + right - W));
+  auto vmin = L::min(first, last);
+  auto vmax = L::max(first, last);
+
+  size_t store_left = left;
+  size_t store_right = right - W;
+  left += W;
+  right -= W;
+
+  while (left != right) {
+    __m256i v;
+    if (left - store_left <= store_right + W - right) {
+      v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + left));
+      left += W;
+    } else {
+      right -= W;
+      v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + right));
+    }
+    vmin = L::min(vmin, v);
+    vmax = L::max(vmax, v);
+    partition_register<L>(v, pv, keys, store_left, store_right);
+  }
+  partition_register<L>(first, pv, keys, store_left, store_right);
+  partition_register<L>(last, pv, keys, store_left, store_right);
+
+  alignas(32) K lanes[2][W];
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[0]), vmin);
+  _mm256_store_si256(reinterpret_cast<__m256i*>(lanes[1]), vmax);
+  for (size_t i = 0; i < W; ++i) {
+    smallest = std::min(smallest, lanes[0][i]);
+    biggest = std::max(biggest, lanes[1][i]);
+  }
+  return store_left;
+}
+
+// median of nine keys spread over the range
+template <typename T>
+sort_int<T> sort_pivot(const T* a, size_t n) noexcept {
+  sort_int<T> s[9];
+  for (size_t i = 0; i < 9; ++i) {
+    auto key = load_key(a + (2 * i + 1) * n / 18);
+    size_t j = i;
+    for (; j > 0 && s[j - 1] > key; --j) s[j] = s[j - 1];
+    s[j] = key;
+  }
+  return s[4];
+}
+
+template <typename T, typename L = sort_lanes<sizeof(T)>>
+HF_TARGET_AVX2 void quicksort_avx2(T* a, size_t n, int depth) noexcept {
+  typedef typename L::key_type K;
+  while (n > 8 * L::W) {
+    if (depth-- == 0) {
+      heap_sort_keys(a, n);
+      return;
+    }
+    auto pivot = sort_pivot(a, n);
+    K smallest, biggest;
+    auto bound = partition_avx2(a, n, pivot, smallest, biggest);
+    if (smallest == biggest) return;
+
+    if (bound == n) {
+      // the pivot is the largest key, the keys equal to it are already in place once
+      // they are split from the smaller ones
+      n = partition_avx2(a, n, pivot - 1, smallest, biggest);
+      continue;
+    }
+
+    // the smaller side recursively, the larger one in the loop
+    if (bound < n - bound) {
+      quicksort_avx2(a, bound, depth);
+      a += bound;
+      n -= bound;
+    } else {
+      quicksort_avx2(a + bound, n - bound, depth);
+      n = bound;
+    }
+  }
+  small_sort_avx2(a, n);
+}
+
+template <typename T>
+void sort_avx2(T* a, size_t n) noexcept {
+  int depth = 0;
+  for (auto m = n; m > 1; m >>= 1) depth += 2;
+  to_sort_ints(a, n);
+  quicksort_avx2(a, n, depth);
+  from_sort_ints(a, n);
+}
+
+#endif
+
+// key-value pairs of two 4 byte halves as one 64 bit key with the value in the low half,
+// packed into a temporary buffer for the 64 bit kernels
+template <typename K, typename V>
+constexpr bool PACKED_PAIR_SORT = sizeof(K) == 4 && sizeof(V) == 4 &&
+                                  sizeof(hf::pair<K, V>) == 8 &&
+                                  std::is_trivially_copyable<V>::value;
+
+}  // namespace detail
+
+/* ------------------------------------------------------------------------- */
+
+// numbers, see sort_mode
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value>::type sort(
+    T* first, T* last, sort_mode mode = sort_mode::quick) noexcept {
+  auto n = static_cast<size_t>(last - first);
+  if (n < 2) return;
+  // wider types such as long double have no integer key, both modes use std::sort for them
+  if constexpr (sizeof(T) <= 8) {
+    if (mode == sort_mode::radix) {
+      detail::radix_sort(first, n, [](T x) { return detail::sort_key(x); });
+      return;
+    }
+  }
+#if defined(HF_SIMD_X86)
+  if constexpr (sizeof(T) == 4 || sizeof(T) == 8) {
+    if (simd::has_avx2()) {
+      detail::sort_avx2(first, n);
+      return;
+    }
+  }
+#endif
+  std::sort(first, last);
+}
+
+// anything else
+template <typename Iter, typename Compare>
+void sort(Iter first, Iter last, Compare comp) noexcept {
+  std::sort(first, last, comp);
+}
+
+template <typename Iter>
+void sort(Iter first, Iter last) noexcept {
+  std::sort(first, last);
+}
+
+// the mode only matters for numbers
+template <typename T, typename Alloc, typename Growth>
+void sort(hf::vector<T, Alloc, Growth>& v, sort_mode mode = sort_mode::quick) noexcept {
+  if constexpr (std::is_arithmetic<T>::value) {
+    sort(v.data(), v.data() + v.size(), mode);
+  } else {
+    std::sort(v.begin(), v.end());
+  }
+}
+
+template <typename T, typename Alloc, typename Growth, typename Compare>
+void sort(hf::vector<T, Alloc, Growth>& v, Compare comp) noexcept {
+  std::sort(v.begin(), v.end(), comp);
+}
+
+/* ------------------------------------------------------------------------- */
+
+// orders pairs by their first member alone. Radix mode keeps pairs with equal keys in
+// their order, quick mode does not, and for 4 byte keys and values orders them by value
+template <typename K, typename V>
+void sort_by_key(hf::pair<K, V>* first, hf::pair<K, V>* last,
+                 sort_mode mode = sort_mode::quick) noexcept {
+  static_assert(std::is_arithmetic<K>::value, "sort_by_key needs numeric keys");
+  auto n = static_cast<size_t>(last - first);
+  if (n < 2) return;
+  auto by_key = [](const hf::pair<K, V>& a, const hf::pair<K, V>& b) { return a.first < b.first; };
+  if constexpr (sizeof(K) <= 8) {
+    if (mode == sort_mode::radix) {
+      detail::radix_sort(first, n,
+                         [](const hf::pair<K, V>& p) { return detail::sort_key(p.first); });
+      return;
+    }
+  } else if (mode == sort_mode::radix) {
+    // keys wider than 8 bytes have no radix key, radix mode still promises stability
+    std::stable_sort(first, last, by_key);
+    return;
+  }
+#if defined(HF_SIMD_X86)
+  if constexpr (detail::PACKED_PAIR_SORT<K, V>) {
+    if (simd::has_avx2()) {
+      auto packed = hf::allocator<int64_t>::allocate(n);
+      for (size_t i = 0; i < n; ++i) {
+        uint32_t value;
+        std::memcpy(&value, &first[i].second, 4);
+        auto key = uint64_t(detail::sort_key(first[i].first)) << 32 | value;
+        packed[i] = static_cast<int64_t>(key ^ (uint64_t(1) << 63));
+      }
+      detail::sort_avx2(packed, n);
+      for (size_t i = 0; i < n; ++i) {
+        auto key = static_cast<uint64_t>(packed[i]) ^ (uint64_t(1) << 63);
+        first[i].first = detail::from_sort_key<K>(static_cast<uint32_t>(key >> 32));
+        auto value = static_cast<uint32_t>(key);
+        std::memcpy(&first[i].second, &value, 4);
+      }
+      hf::allocator<int64_t>::deallocate(packed, n);
+      return;
+    }
+  }
+#endif
+  std::sort(first, last, by_key);
+}
+
+template <typename K, typename V, typename Alloc, typename Growth>
+void sort_by_key(hf::vector<hf::pair<K, V>, Alloc, Growth>& v,
+                 sort_mode mode = sort_mode::quick) noexcept {
+  sort_by_key(v.data(), v.data() + v.size(), mode);
+}
+
+}  // namespace hf
@@ -19,9 +19,12 @@ struct char_traits<char16_t>;
 template <>
 struct char_traits<char32_t>;
 
-template <typename CharType, typename CharTraits>
+template <typename CharType, typename CharTraits, typename Alloc, typename Growth>
 class basic_string;
 
+template <typename CharType, typename CharTraits>
+class basic_string_view;
+
 typedef basic_string<char> string;
 
 typedef basic_string<wchar_t> wstring;
@@ -30,4 +33,12 @@ typedef basic_string<char16_t> u16string;
 
 typedef basic_string<char32_t> u32string;
 
+typedef basic_string_view<char> string_view;
+
+typedef basic_string_view<wchar_t> wstring_view;
+
+typedef basic_string_view<char16_t> u16string_view;
+
+typedef basic_string_view<char32_t> u32string_view;
+
 }  // namespace hf
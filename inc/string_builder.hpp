@@ -0,0 +1,315 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HF_HAS_WRITEV 1
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "allocator.hpp"
+#include "basic_string.hpp"
+#include "charconv.hpp"
+#include "string_view.hpp"
+
+namespace hf {
+
+// append-only text assembled in a chain of chunks, nothing written is ever moved again,
+// so building n characters costs O(n) however it is split. The result is flattened
+// once by to_string() or written out chunk by chunk without flattening
+template <typename CharType, typename CharTraits = hf::char_traits<CharType>>
+class basic_string_builder {
+ public:
+  typedef CharType value_type;
+  typedef CharTraits char_traits;
+  typedef hf::basic_string_view<CharType, CharTraits> view_type;
+  typedef hf::basic_string<CharType, CharTraits> string_type;
+  typedef const CharType* const_pointer;
+
+  // chunks stay below the size at which malloc switches to mmap, which would fault in
+  // fresh pages for every chunk of every builder
+  static constexpr size_t CHUNK_SIZE = 16384 / sizeof(CharType);
+
+ public:
+  basic_string_builder() noexcept = default;
+
+  basic_string_builder(const basic_string_builder&) = delete;
+
+  basic_string_builder& operator=(const basic_string_builder&) = delete;
+
+  basic_string_builder(basic_string_builder&& rhs) noexcept
+      : _head(rhs._head), _tail(rhs._tail), _size(rhs._size) {
+    rhs._head = rhs._tail = nullptr;
+    rhs._size = 0;
+  }
+
+  basic_string_builder& operator=(basic_string_builder&& rhs) noexcept {
+    if (this != &rhs) {
+      release();
+      _head = rhs._head;
+      _tail = rhs._tail;
+      _size = rhs._size;
+      rhs._head = rhs._tail = nullptr;
+      rhs._size = 0;
+    }
+    return *this;
+  }
+
+  ~basic_string_builder() { release(); }
+
+ public:
+  bool empty() const noexcept { return _size == 0; }
+
+  size_t size() const noexcept { return _size; }
+
+  // makes room for n more characters in one piece, appends up to that size do not
+  // allocate, a good hint also keeps the number of chunks to write out low
+  void reserve_hint(size_t n) noexcept {
+    if (_tail == nullptr || _tail->cap - _tail->size < n) add_chunk(n);
+  }
+
+  /* ------------------------------------------------------------------------- */
+
+  basic_string_builder& append(value_type ch) noexcept {
+    if (_tail == nullptr || _tail->size == _tail->cap) add_chunk(1);
+    _tail->data()[_tail->size++] = ch;
+    ++_size;
+    return *this;
+  }
+
+  basic_string_builder& append(size_t count, value_type ch) noexcept;
+
+  basic_string_builder& append(const_pointer s) noexcept { return append(view_type(s)); }
+
+  basic_string_builder& append(const_pointer s, size_t count) noexcept {
+    return append(view_type(s, count));
+  }
+
+  basic_string_builder& append(view_type sv) noexcept;
+
+  // decimal, see hf::to_chars
+  template <typename T, typename = typename std::enable_if<std::is_integral<T>::value &&
+                                                           !std::is_same<T, value_type>::value &&
+                                                           !std::is_same<T, bool>::value>::type>
+  basic_string_builder& append(T value) noexcept {
+    return append_formatted(value);
+  }
+
+  // shortest representation that reads back to the same value
+  basic_string_builder& append(double value) noexcept { return append_formatted(value); }
+
+  basic_string_builder& append(float value) noexcept { return append_formatted(value); }
+
+  template <typename T>
+  basic_string_builder& operator<<(const T& value) noexcept {
+    return append(value);
+  }
+
+  /* ------------------------------------------------------------------------- */
+
+  // calls f(view_type) for every chunk in order
+  template <typename F>
+  void for_each_chunk(F&& f) const {
+    for (auto c = _head; c != nullptr; c = c->next) {
+      if (c->size != 0) f(view_type(c->data(), c->size));
+    }
+  }
+
+  // the whole text in one string, allocated once at the final size
+  string_type to_string() const noexcept;
+
+  // keeps the first chunk for reuse
+  void clear() noexcept;
+
+#ifdef HF_HAS_WRITEV
+  // writes everything to fd with writev, up to 64 chunks per call (fewer if IOV_MAX is
+  // lower) and resuming after short writes, false on error with errno set
+  bool write_to(int fd) const noexcept;
+#endif
+
+  friend std::ostream& operator<<(std::ostream& os, const basic_string_builder& sb) {
+    sb.for_each_chunk([&](view_type sv) { os << sv; });
+    return os;
+  }
+
+ private:
+  struct chunk {
+    chunk* next;
+    size_t size;
+    size_t cap;
+
+    CharType* data() noexcept { return reinterpret_cast<CharType*>(this + 1); }
+
+    const CharType* data() const noexcept { return reinterpret_cast<const CharType*>(this + 1); }
+  };
+
+  static_assert(sizeof(chunk) % alignof(CharType) == 0, "chunk header must align the chars");
+
+  void add_chunk(size_t n) noexcept;
+
+  template <typename T>
+  basic_string_builder& append_formatted(T value) noexcept;
+
+  void release() noexcept;
+
+  chunk* _head = nullptr;
+  chunk* _tail = nullptr;
+  size_t _size = 0;
+};
+
+template <typename CharType, typename CharTraits>
+basic_string_builder<CharType, CharTraits>& basic_string_builder<CharType, CharTraits>::append(
+    size_t count, value_type ch) noexcept {
+  while (count != 0) {
+    if (_tail == nullptr || _tail->size == _tail->cap) add_chunk(count);
+    auto n = _tail->cap - _tail->size < count ? _tail->cap - _tail->size : count;
+    char_traits::fill(_tail->data() + _tail->size, ch, n);
+    _tail->size += n;
+    _size += n;
+    count -= n;
+  }
+  return *this;
+}
+
+// fills the current chunk, whatever does not fit goes into one new chunk
+template <typename CharType, typename CharTraits>
+basic_string_builder<CharType, CharTraits>& basic_string_builder<CharType, CharTraits>::append(
+    view_type sv) noexcept {
+  auto s = sv.data();
+  auto count = sv.size();
+  while (count != 0) {
+    if (_tail == nullptr || _tail->size == _tail->cap) add_chunk(count);
+    auto n = _tail->cap - _tail->size < count ? _tail->cap - _tail->size : count;
+    char_traits::copy(_tail->data() + _tail->size, s, n);
+    _tail->size += n;
+    _size += n;
+    s += n;
+    count -= n;
+  }
+  return *this;
+}
+
+template <typename CharType, typename CharTraits>
+template <typename T>
+basic_string_builder<CharType, CharTraits>&
+basic_string_builder<CharType, CharTraits>::append_formatted(T value) noexcept {
+  char buf[32];
+  auto r = hf::to_chars(buf, buf + sizeof(buf), value);
+  auto n = static_cast<size_t>(r.ptr - buf);
+
+  if (_tail == nullptr || _tail->cap - _tail->size < n) add_chunk(n);
+  auto dst = _tail->data() + _tail->size;
+  for (size_t i = 0; i < n; ++i) dst[i] = static_cast<CharType>(buf[i]);
+  _tail->size += n;
+  _size += n;
+  return *this;
+}
+
+template <typename CharType, typename CharTraits>
+typename basic_string_builder<CharType, CharTraits>::string_type
+basic_string_builder<CharType, CharTraits>::to_string() const noexcept {
+  string_type s;
+  s.reserve(_size);
+  for_each_chunk([&](view_type sv) { s.append(sv); });
+  return s;
+}
+
+template <typename CharType, typename CharTraits>
+void basic_string_builder<CharType, CharTraits>::clear() noexcept {
+  if (_head == nullptr) return;
+  auto rest = _head->next;
+  _head->next = nullptr;
+  _head->size = 0;
+  _tail = _head;
+  _size = 0;
+  while (rest != nullptr) {
+    auto next = rest->next;
+    hf::allocator<unsigned char>::deallocate(reinterpret_cast<unsigned char*>(rest));
+    rest = next;
+  }
+}
+
+#ifdef HF_HAS_WRITEV
+template <typename CharType, typename CharTraits>
+bool basic_string_builder<CharType, CharTraits>::write_to(int fd) const noexcept {
+  iovec iov[IOV_MAX < 64 ? IOV_MAX : 64];
+  const size_t max_iov = sizeof(iov) / sizeof(iov[0]);
+
+  auto c = _head;
+  size_t offset = 0;  // bytes of c already written
+  for (;;) {
+    while (c != nullptr && c->size * sizeof(CharType) == offset) {
+      c = c->next;
+      offset = 0;
+    }
+    if (c == nullptr) break;
+
+    size_t n = 0;
+    for (auto p = c; p != nullptr && n < max_iov; p = p->next) {
+      auto skip = p == c ? offset : 0;
+      if (p->size * sizeof(CharType) == skip) continue;
+      iov[n].iov_base = const_cast<char*>(reinterpret_cast<const char*>(p->data()) + skip);
+      iov[n].iov_len = p->size * sizeof(CharType) - skip;
+      ++n;
+    }
+
+    auto written = ::writev(fd, iov, static_cast<int>(n));
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+
+    // whole chunks first, then the part of the next one
+    auto left = static_cast<size_t>(written);
+    while (left != 0 && left >= c->size * sizeof(CharType) - offset) {
+      left -= c->size * sizeof(CharType) - offset;
+      offset = 0;
+      c = c->next;
+    }
+    offset += left;
+  }
+  return true;
+}
+#endif
+
+// chunks are CHUNK_SIZE, or exactly n when a single append needs more
+template <typename CharType, typename CharTraits>
+void basic_string_builder<CharType, CharTraits>::add_chunk(size_t n) noexcept {
+  auto cap = n > CHUNK_SIZE ? n : CHUNK_SIZE;
+  auto c = reinterpret_cast<chunk*>(
+      hf::allocator<unsigned char>::allocate(sizeof(chunk) + cap * sizeof(CharType)));
+  c->next = nullptr;
+  c->size = 0;
+  c->cap = cap;
+
+  if (_tail == nullptr) {
+    _head = _tail = c;
+  } else {
+    _tail->next = c;
+    _tail = c;
+  }
+}
+
+template <typename CharType, typename CharTraits>
+void basic_string_builder<CharType, CharTraits>::release() noexcept {
+  for (auto c = _head; c != nullptr;) {
+    auto next = c->next;
+    hf::allocator<unsigned char>::deallocate(reinterpret_cast<unsigned char*>(c));
+    c = next;
+  }
+  _head = _tail = nullptr;
+  _size = 0;
+}
+
+typedef basic_string_builder<char> string_builder;
+typedef basic_string_builder<wchar_t> wstring_builder;
+typedef basic_string_builder<char16_t> u16string_builder;
+typedef basic_string_builder<char32_t> u32string_builder;
+
+}  // namespace hf
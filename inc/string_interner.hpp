@@ -0,0 +1,257 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "allocator.hpp"
+#include "arena.hpp"
+#include "basic_string.hpp"
+#include "hash.hpp"
+#include "simd.hpp"
+#include "string_view.hpp"
+
+namespace hf {
+
+// deduplicates strings into arena storage, each distinct string is stored once and named
+// by a 32-bit id, equal strings get equal ids and the view of an id stays valid for the
+// lifetime of the interner. Strings are spread over SHARDS shards by hash, each with its
+// own arena, id table and lock, lookups of strings already interned take no lock
+template <typename CharType, typename CharTraits = hf::char_traits<CharType>>
+class basic_string_interner {
+ public:
+  typedef hf::basic_string_view<CharType, CharTraits> view_type;
+  typedef uint32_t id_type;
+
+  static constexpr id_type npos = static_cast<id_type>(-1);
+
+  static constexpr size_t SHARD_BITS = 4;
+  static constexpr size_t SHARDS = size_t(1) << SHARD_BITS;
+
+  // the low SHARD_BITS of an id name the shard, the rest the index within it
+  static constexpr size_t MAX_PER_SHARD = (size_t(1) << (32 - SHARD_BITS)) - 1;
+
+ public:
+  basic_string_interner() noexcept = default;
+
+  basic_string_interner(const basic_string_interner&) = delete;
+
+  basic_string_interner& operator=(const basic_string_interner&) = delete;
+
+  ~basic_string_interner() = default;
+
+ public:
+  // the id of sv, interning a copy of it first if it is new
+  id_type intern(view_type sv) noexcept;
+
+  // the id of sv, or npos if it was never interned
+  id_type find(view_type sv) const noexcept;
+
+  view_type view(id_type id) const noexcept {
+    auto& s = _shards[id & (SHARDS - 1)];
+    auto& e = s.entry_at(id >> SHARD_BITS);
+    return view_type(e.data, e.size);
+  }
+
+  // interns sv and returns the stored copy, equal strings share one address
+  view_type intern_view(view_type sv) noexcept { return view(intern(sv)); }
+
+  size_t size() const noexcept;
+
+  // bytes of character storage, the id tables come on top
+  size_t bytes() const noexcept;
+
+ private:
+  struct entry {
+    const CharType* data;
+    size_t size;
+  };
+
+  // ids of a shard in chunks of BASE, 2 * BASE, 4 * BASE, ... entries, chunks never move
+  // so a reader can index them while the writer appends
+  static constexpr size_t BASE_BITS = 8;
+  static constexpr size_t BASE = size_t(1) << BASE_BITS;
+  static constexpr size_t CHUNKS = 32 - SHARD_BITS - BASE_BITS + 1;
+
+  // open addressing with linear probing and no erase, a slot holds the upper 32 bits of
+  // the hash and index + 1 of the entry, 0 is empty. Grown tables are retired instead
+  // of freed since readers may still probe them
+  struct table {
+    std::atomic<uint64_t>* slots;
+    size_t mask;
+    table* retired;
+  };
+
+  struct alignas(64) shard {
+    mutable std::mutex mutex;
+    std::atomic<table*> index{nullptr};
+    std::atomic<entry*> chunks[CHUNKS] = {};
+    std::atomic<size_t> count{0};
+    hf::arena storage;
+
+    shard() noexcept = default;
+
+    ~shard();
+
+    const entry& entry_at(size_t i) const noexcept {
+      auto c = 31 - simd::clz(static_cast<uint32_t>((i >> BASE_BITS) + 1));
+      auto first = ((size_t(1) << c) - 1) << BASE_BITS;
+      return chunks[c].load(std::memory_order_acquire)[i - first];
+    }
+
+    size_t probe(view_type sv, uint64_t hash) const noexcept;
+
+    size_t insert(view_type sv, uint64_t hash) noexcept;
+
+    void grow() noexcept;
+  };
+
+  static uint64_t hash_of(view_type sv) noexcept { return hf::hash<view_type>()(sv); }
+
+  shard _shards[SHARDS];
+};
+
+template <typename CharType, typename CharTraits>
+typename basic_string_interner<CharType, CharTraits>::id_type
+basic_string_interner<CharType, CharTraits>::intern(view_type sv) noexcept {
+  auto hash = hash_of(sv);
+  auto shard_id = hash >> (64 - SHARD_BITS);
+  auto& s = _shards[shard_id];
+
+  auto i = s.probe(sv, hash);
+  if (i == static_cast<size_t>(-1)) {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    i = s.probe(sv, hash);
+    if (i == static_cast<size_t>(-1)) i = s.insert(sv, hash);
+  }
+  return static_cast<id_type>((i << SHARD_BITS) | shard_id);
+}
+
+template <typename CharType, typename CharTraits>
+typename basic_string_interner<CharType, CharTraits>::id_type
+basic_string_interner<CharType, CharTraits>::find(view_type sv) const noexcept {
+  auto hash = hash_of(sv);
+  auto shard_id = hash >> (64 - SHARD_BITS);
+
+  auto i = _shards[shard_id].probe(sv, hash);
+  return i == static_cast<size_t>(-1) ? npos : static_cast<id_type>((i << SHARD_BITS) | shard_id);
+}
+
+template <typename CharType, typename CharTraits>
+size_t basic_string_interner<CharType, CharTraits>::size() const noexcept {
+  size_t n = 0;
+  for (auto& s : _shards) n += s.count.load(std::memory_order_relaxed);
+  return n;
+}
+
+template <typename CharType, typename CharTraits>
+size_t basic_string_interner<CharType, CharTraits>::bytes() const noexcept {
+  size_t n = 0;
+  for (auto& s : _shards) {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    n += s.storage.used();
+  }
+  return n;
+}
+
+/* ------------------------------------------------------------------------- */
+
+template <typename CharType, typename CharTraits>
+basic_string_interner<CharType, CharTraits>::shard::~shard() {
+  for (auto t = index.load(std::memory_order_relaxed); t != nullptr;) {
+    auto retired = t->retired;
+    hf::allocator<std::atomic<uint64_t>>::deallocate(t->slots, t->mask + 1);
+    hf::allocator<table>::deallocate(t);
+    t = retired;
+  }
+  for (size_t c = 0; c < CHUNKS; ++c) {
+    hf::allocator<entry>::deallocate(chunks[c].load(std::memory_order_relaxed), BASE << c);
+  }
+}
+
+// the index of the entry equal to sv, or -1, safe to run concurrently with one writer
+template <typename CharType, typename CharTraits>
+size_t basic_string_interner<CharType, CharTraits>::shard::probe(view_type sv,
+                                                                 uint64_t hash) const noexcept {
+  auto t = index.load(std::memory_order_acquire);
+  if (t == nullptr) return static_cast<size_t>(-1);
+
+  const auto tag = hash >> 32;
+  for (auto pos = hash & t->mask;; pos = (pos + 1) & t->mask) {
+    auto slot = t->slots[pos].load(std::memory_order_acquire);
+    if (slot == 0) return static_cast<size_t>(-1);
+    if ((slot >> 32) != tag) continue;
+
+    auto i = static_cast<size_t>(slot & 0xFFFFFFFF) - 1;
+    auto& e = entry_at(i);
+    if (e.size == sv.size() && CharTraits::compare(e.data, sv.data(), e.size) == 0) return i;
+  }
+}
+
+// called with the lock held and sv known to be missing
+template <typename CharType, typename CharTraits>
+size_t basic_string_interner<CharType, CharTraits>::shard::insert(view_type sv,
+                                                                  uint64_t hash) noexcept {
+  auto i = count.load(std::memory_order_relaxed);
+  assert(i < MAX_PER_SHARD);
+
+  // copy first, the entry and then the slot are published with release stores
+  auto data = static_cast<CharType*>(
+      storage.allocate((sv.size() + 1) * sizeof(CharType), alignof(CharType)));
+  if (sv.size() != 0) CharTraits::copy(data, sv.data(), sv.size());
+  data[sv.size()] = CharType();
+
+  auto c = 31 - simd::clz(static_cast<uint32_t>((i >> BASE_BITS) + 1));
+  auto first = ((size_t(1) << c) - 1) << BASE_BITS;
+  auto chunk = chunks[c].load(std::memory_order_relaxed);
+  if (chunk == nullptr) chunk = hf::allocator<entry>::allocate(BASE << c);
+  chunk[i - first] = entry{data, sv.size()};
+  chunks[c].store(chunk, std::memory_order_release);
+
+  auto t = index.load(std::memory_order_relaxed);
+  if (t == nullptr || (i + 1) * 2 > t->mask + 1) {
+    grow();
+    t = index.load(std::memory_order_relaxed);
+  }
+
+  auto pos = hash & t->mask;
+  while (t->slots[pos].load(std::memory_order_relaxed) != 0) pos = (pos + 1) & t->mask;
+  t->slots[pos].store(((hash >> 32) << 32) | (i + 1), std::memory_order_release);
+  count.store(i + 1, std::memory_order_relaxed);
+  return i;
+}
+
+// rehashes into a table twice the size, the old one stays readable until destruction
+template <typename CharType, typename CharTraits>
+void basic_string_interner<CharType, CharTraits>::shard::grow() noexcept {
+  auto old = index.load(std::memory_order_relaxed);
+  size_t cap = old == nullptr ? 64 : (old->mask + 1) * 2;
+
+  auto t = hf::allocator<table>::allocate();
+  t->slots = hf::allocator<std::atomic<uint64_t>>::allocate(cap);
+  t->mask = cap - 1;
+  t->retired = old;
+  for (size_t i = 0; i < cap; ++i) {
+    ::new (static_cast<void*>(t->slots + i)) std::atomic<uint64_t>(0);
+  }
+
+  if (old != nullptr) {
+    for (size_t i = 0; i <= old->mask; ++i) {
+      auto slot = old->slots[i].load(std::memory_order_relaxed);
+      if (slot == 0) continue;
+      auto& e = entry_at(static_cast<size_t>(slot & 0xFFFFFFFF) - 1);
+      auto pos = hash_of(view_type(e.data, e.size)) & t->mask;
+      while (t->slots[pos].load(std::memory_order_relaxed) != 0) pos = (pos + 1) & t->mask;
+      t->slots[pos].store(slot, std::memory_order_relaxed);
+    }
+  }
+  index.store(t, std::memory_order_release);
+}
+
+typedef basic_string_interner<char> string_interner;
+typedef basic_string_interner<wchar_t> wstring_interner;
+typedef basic_string_interner<char16_t> u16string_interner;
+typedef basic_string_interner<char32_t> u32string_interner;
+
+}  // namespace hf
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "simd.hpp"
+
+namespace hf {
+
+template <typename CharType>
+struct char_traits;
+
+namespace detail {
+
+// searches over [h, h + n) shared by the string types, they follow the std::basic_string
+// conventions for pos and return npos when nothing is found, byte strings with the
+// default traits take the vectorized paths in simd.hpp
+
+template <typename Traits>
+constexpr bool is_byte_traits() noexcept {
+  return std::is_same<Traits, hf::char_traits<char>>::value;
+}
+
+template <typename Traits, typename CharType>
+size_t str_find(const CharType* h, size_t n, CharType ch, size_t pos) noexcept {
+  if (pos >= n) return simd::npos;
+  auto r = Traits::find(h + pos, n - pos, ch);
+  return r == nullptr ? simd::npos : static_cast<size_t>(r - h);
+}
+
+template <typename Traits, typename CharType>
+size_t str_find(const CharType* h, size_t n, const CharType* s, size_t pos, size_t m) noexcept {
+  if (pos > n || m > n - pos) return simd::npos;
+  if (m == 0) return pos;
+
+  if constexpr (is_byte_traits<Traits>()) {
+    auto r = simd::find_substr(h + pos, n - pos, s, m);
+    return r == simd::npos ? simd::npos : pos + r;
+  } else {
+    const CharType* cur = h + pos;
+    const CharType* last = h + n - m;
+
+    while (cur <= last) {
+      cur = Traits::find(cur, last - cur + 1, s[0]);
+      if (cur == nullptr) return simd::npos;
+      if (Traits::compare(cur + 1, s + 1, m - 1) == 0) return cur - h;
+      ++cur;
+    }
+    return simd::npos;
+  }
+}
+
+template <typename Traits, typename CharType>
+size_t str_rfind(const CharType* h, size_t n, CharType ch, size_t pos) noexcept {
+  if (n == 0) return simd::npos;
+  size_t len = pos < n ? pos + 1 : n;
+
+  if constexpr (is_byte_traits<Traits>()) {
+    auto r = simd::rfind_byte(h, len, ch);
+    return r == nullptr ? simd::npos : static_cast<size_t>(r - h);
+  } else {
+    while (len != 0) {
+      if (h[--len] == ch) return len;
+    }
+    return simd::npos;
+  }
+}
+
+template <typename Traits, typename CharType>
+size_t str_rfind(const CharType* h, size_t n, const CharType* s, size_t pos, size_t m) noexcept {
+  if (m > n) return simd::npos;
+  size_t i = pos < n - m ? pos : n - m;
+  if (m == 0) return i;
+
+  // the last character of a candidate is located first, the rest is verified afterwards
+  for (;;) {
+    i = str_rfind<Traits>(h, i + m, s[m - 1], i + m - 1);
+    if (i == simd::npos || i < m - 1) return simd::npos;
+    i -= m - 1;
+    if (Traits::compare(h + i, s, m - 1) == 0) return i;
+    if (i == 0) return simd::npos;
+    --i;
+  }
+}
+
+template <typename Traits, typename CharType>
+size_t str_find_first_of(const CharType* h, size_t n, const CharType* s, size_t pos,
+                         size_t m) noexcept {
+  if (pos >= n || m == 0) return simd::npos;
+  if (m == 1) return str_find<Traits>(h, n, s[0], pos);
+
+  if constexpr (is_byte_traits<Traits>()) {
+    auto r = simd::find_first_of(h + pos, n - pos, simd::byte_set(s, m));
+    return r == simd::npos ? simd::npos : pos + r;
+  } else {
+    for (size_t i = pos; i < n; ++i) {
+      if (Traits::find(s, m, h[i]) != nullptr) return i;
+    }
+    return simd::npos;
+  }
+}
+
+template <typename Traits, typename CharType>
+size_t str_find_last_of(const CharType* h, size_t n, const CharType* s, size_t pos,
+                        size_t m) noexcept {
+  if (n == 0 || m == 0) return simd::npos;
+  if (m == 1) return str_rfind<Traits>(h, n, s[0], pos);
+  size_t len = pos < n ? pos + 1 : n;
+
+  if constexpr (is_byte_traits<Traits>()) {
+    return simd::find_last_of(h, len, simd::byte_set(s, m));
+  } else {
+    while (len != 0) {
+      if (Traits::find(s, m, h[--len]) != nullptr) return len;
+    }
+    return simd::npos;
+  }
+}
+
+}  // namespace detail
+}  // namespace hf
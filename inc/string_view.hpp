@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+
+#include "hash.hpp"
+#include "string_search.hpp"
+
+namespace hf {
+
+template <typename CharType>
+struct char_traits;
+
+// non-owning view over a contiguous character sequence, slicing and searching never allocate
+template <typename CharType, typename CharTraits = hf::char_traits<CharType>>
+class basic_string_view {
+ public:
+  typedef CharTraits char_traits;
+
+  typedef CharType value_type;
+
+  typedef const CharType* iterator;
+  typedef const CharType* const_iterator;
+  typedef const CharType* pointer;
+  typedef const CharType* const_pointer;
+  typedef const CharType& reference;
+  typedef const CharType& const_reference;
+
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+ private:
+  const_pointer _data;
+  size_t _size;
+
+ public:
+  constexpr basic_string_view() noexcept : _data(nullptr), _size(0) {}
+
+  basic_string_view(const_pointer str) noexcept : _data(str), _size(char_traits::length(str)) {}
+
+  constexpr basic_string_view(const_pointer str, size_t count) noexcept
+      : _data(str), _size(count) {}
+
+ public:
+  constexpr const_iterator begin() const noexcept { return _data; }
+
+  constexpr const_iterator end() const noexcept { return _data + _size; }
+
+  constexpr const_iterator cbegin() const noexcept { return _data; }
+
+  constexpr const_iterator cend() const noexcept { return _data + _size; }
+
+  /* ------------------------------------------------------------------------- */
+
+  constexpr bool empty() const noexcept { return _size == 0; }
+
+  constexpr size_t size() const noexcept { return _size; }
+
+  constexpr size_t length() const noexcept { return _size; }
+
+  /* ------------------------------------------------------------------------- */
+
+  const_reference operator[](size_t n) const noexcept {
+    assert(n < _size);
+    return *(_data + n);
+  }
+
+  const_reference front() const noexcept {
+    assert(!empty());
+    return *_data;
+  }
+
+  const_reference back() const noexcept {
+    assert(!empty());
+    return *(_data + _size - 1);
+  }
+
+  constexpr const_pointer data() const noexcept { return _data; }
+
+  /* ------------------------------------------------------------------------- */
+
+  void remove_prefix(size_t n) noexcept {
+    assert(n <= _size);
+    _data += n;
+    _size -= n;
+  }
+
+  void remove_suffix(size_t n) noexcept {
+    assert(n <= _size);
+    _size -= n;
+  }
+
+  // pos past the end is clamped to an empty view at the end
+  basic_string_view substr(size_t pos, size_t count = npos) const noexcept {
+    if (pos > _size) pos = _size;
+    return basic_string_view(_data + pos, count < _size - pos ? count : _size - pos);
+  }
+
+  int compare(basic_string_view rhs) const noexcept;
+
+  /* ------------------------------------------------------------------------- */
+
+  size_t find(value_type ch, size_t pos = 0) const noexcept {
+    return detail::str_find<char_traits>(_data, _size, ch, pos);
+  }
+
+  size_t find(basic_string_view sv, size_t pos = 0) const noexcept {
+    return detail::str_find<char_traits>(_data, _size, sv._data, pos, sv._size);
+  }
+
+  size_t rfind(value_type ch, size_t pos = npos) const noexcept {
+    return detail::str_rfind<char_traits>(_data, _size, ch, pos);
+  }
+
+  size_t rfind(basic_string_view sv, size_t pos = npos) const noexcept {
+    return detail::str_rfind<char_traits>(_data, _size, sv._data, pos, sv._size);
+  }
+
+  size_t find_first_of(value_type ch, size_t pos = 0) const noexcept { return find(ch, pos); }
+
+  size_t find_first_of(basic_string_view sv, size_t pos = 0) const noexcept {
+    return detail::str_find_first_of<char_traits>(_data, _size, sv._data, pos, sv._size);
+  }
+
+  size_t find_last_of(value_type ch, size_t pos = npos) const noexcept { return rfind(ch, pos); }
+
+  size_t find_last_of(basic_string_view sv, size_t pos = npos) const noexcept {
+    return detail::str_find_last_of<char_traits>(_data, _size, sv._data, pos, sv._size);
+  }
+
+  bool starts_with(value_type ch) const noexcept { return !empty() && front() == ch; }
+
+  bool starts_with(basic_string_view sv) const noexcept {
+    return sv._size <= _size && char_traits::compare(_data, sv._data, sv._size) == 0;
+  }
+
+  bool ends_with(value_type ch) const noexcept { return !empty() && back() == ch; }
+
+  bool ends_with(basic_string_view sv) const noexcept {
+    return sv._size <= _size &&
+           char_traits::compare(_data + _size - sv._size, sv._data, sv._size) == 0;
+  }
+
+  bool contains(value_type ch) const noexcept { return find(ch) != npos; }
+
+  bool contains(basic_string_view sv) const noexcept { return find(sv) != npos; }
+
+  /* ------------------------------------------------------------------------- */
+
+  // hidden friends, so a character pointer or a basic_string converts on either side
+  friend bool operator==(basic_string_view lhs, basic_string_view rhs) noexcept {
+    return lhs._size == rhs._size && char_traits::compare(lhs._data, rhs._data, lhs._size) == 0;
+  }
+
+  friend bool operator!=(basic_string_view lhs, basic_string_view rhs) noexcept {
+    return !(lhs == rhs);
+  }
+
+  friend bool operator<(basic_string_view lhs, basic_string_view rhs) noexcept {
+    return lhs.compare(rhs) < 0;
+  }
+
+  friend bool operator>(basic_string_view lhs, basic_string_view rhs) noexcept {
+    return lhs.compare(rhs) > 0;
+  }
+
+  friend bool operator<=(basic_string_view lhs, basic_string_view rhs) noexcept {
+    return lhs.compare(rhs) <= 0;
+  }
+
+  friend bool operator>=(basic_string_view lhs, basic_string_view rhs) noexcept {
+    return lhs.compare(rhs) >= 0;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, basic_string_view sv) {
+    if constexpr (sizeof(CharType) == 1) {
+      os.write(reinterpret_cast<const char*>(sv._data), static_cast<std::streamsize>(sv._size));
+    } else {
+      for (size_t i = 0; i < sv._size; ++i) os << *(sv._data + i);
+    }
+    return os;
+  }
+};
+
+template <typename CharType, typename CharTraits>
+int basic_string_view<CharType, CharTraits>::compare(basic_string_view rhs) const noexcept {
+  auto n = _size < rhs._size ? _size : rhs._size;
+  auto r = char_traits::compare(_data, rhs._data, n);
+  if (r != 0) return r;
+  return _size == rhs._size ? 0 : (_size < rhs._size ? -1 : 1);
+}
+
+}  // namespace hf
+
+namespace std {
+
+template <typename CharType, typename CharTraits>
+struct hash<hf::basic_string_view<CharType, CharTraits>> {
+  size_t operator()(hf::basic_string_view<CharType, CharTraits> sv) const noexcept {
+    return hf::hash<hf::basic_string_view<CharType, CharTraits>>()(sv);
+  }
+};
+
+}  // namespace std
@@ -0,0 +1,490 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include "allocator.hpp"
+#include "deque.hpp"
+#include "ring.hpp"
+#include "vector.hpp"
+
+namespace hf {
+
+namespace detail {
+
+// a unit of work in the pool, whoever hands it over keeps the storage alive until it ran
+struct pool_task {
+  void (*run)(pool_task*) noexcept;
+};
+
+/* ------------------------------------------------------------------------- */
+
+// Chase-Lev work stealing deque. The owning worker pushes and pops at the bottom without
+// contention, other workers steal the oldest task from the top with a compare-exchange,
+// only the last task is raced for. The slot array grows by doubling, replaced arrays are
+// kept until the deque dies because a thief may still be reading one
+class steal_deque {
+ public:
+  steal_deque() noexcept { _array.store(make_array(64), std::memory_order_relaxed); }
+
+  steal_deque(const steal_deque&) = delete;
+
+  steal_deque& operator=(const steal_deque&) = delete;
+
+  ~steal_deque() {
+    free_array(_array.load(std::memory_order_relaxed));
+    for (auto a : _retired) free_array(a);
+  }
+
+  // owner only
+  void push(pool_task* task) noexcept;
+
+  // owner only, the newest task or null
+  pool_task* pop() noexcept;
+
+  // any thread, the oldest task, null when empty or when another thread got it first
+  pool_task* steal() noexcept;
+
+  bool empty() const noexcept {
+    return _top.load(std::memory_order_seq_cst) >= _bottom.load(std::memory_order_seq_cst);
+  }
+
+ private:
+  struct array {
+    int64_t mask;
+    std::atomic<pool_task*>* slots;
+  };
+
+  static array* make_array(int64_t capacity) noexcept {
+    auto a = hf::allocator<array>::allocate(1);
+    a->mask = capacity - 1;
+    a->slots = hf::allocator<std::atomic<pool_task*>>::allocate(static_cast<size_t>(capacity));
+    for (int64_t i = 0; i < capacity; ++i) ::new (a->slots + i) std::atomic<pool_task*>(nullptr);
+    return a;
+  }
+
+  static void free_array(array* a) noexcept {
+    hf::allocator<std::atomic<pool_task*>>::deallocate(a->slots, static_cast<size_t>(a->mask + 1));
+    hf::allocator<array>::deallocate(a, 1);
+  }
+
+  array* grow(array* a, int64_t top, int64_t bottom) noexcept;
+
+  alignas(64) std::atomic<int64_t> _top{0};
+
+  alignas(64) std::atomic<int64_t> _bottom{0};
+  std::atomic<array*> _array{nullptr};
+  hf::vector<array*> _retired;
+};
+
+// the store to bottom is sequentially consistent so that it is ordered before the pool's
+// check for sleeping workers that follows it
+inline void steal_deque::push(pool_task* task) noexcept {
+  auto bottom = _bottom.load(std::memory_order_relaxed);
+  auto top = _top.load(std::memory_order_acquire);
+  auto a = _array.load(std::memory_order_relaxed);
+  if (bottom - top > a->mask) a = grow(a, top, bottom);
+  a->slots[bottom & a->mask].store(task, std::memory_order_relaxed);
+  _bottom.store(bottom + 1, std::memory_order_seq_cst);
+}
+
+inline pool_task* steal_deque::pop() noexcept {
+  auto bottom = _bottom.load(std::memory_order_relaxed) - 1;
+  auto a = _array.load(std::memory_order_relaxed);
+  _bottom.store(bottom, std::memory_order_seq_cst);
+  auto top = _top.load(std::memory_order_seq_cst);
+
+  if (top > bottom) {
+    _bottom.store(bottom + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  auto task = a->slots[bottom & a->mask].load(std::memory_order_relaxed);
+  if (top == bottom) {
+    // the last task, a thief may be taking it at the same time
+    if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      task = nullptr;
+    }
+    _bottom.store(bottom + 1, std::memory_order_relaxed);
+  }
+  return task;
+}
+
+inline pool_task* steal_deque::steal() noexcept {
+  auto top = _top.load(std::memory_order_seq_cst);
+  auto bottom = _bottom.load(std::memory_order_seq_cst);
+  if (top >= bottom) return nullptr;
+
+  auto a = _array.load(std::memory_order_acquire);
+  auto task = a->slots[top & a->mask].load(std::memory_order_relaxed);
+  if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  return task;
+}
+
+inline steal_deque::array* steal_deque::grow(array* a, int64_t top, int64_t bottom) noexcept {
+  auto bigger = make_array(2 * (a->mask + 1));
+  for (auto i = top; i != bottom; ++i) {
+    bigger->slots[i & bigger->mask].store(a->slots[i & a->mask].load(std::memory_order_relaxed),
+                                          std::memory_order_relaxed);
+  }
+  _retired.push_back(a);
+  _array.store(bigger, std::memory_order_release);
+  return bigger;
+}
+
+/* ------------------------------------------------------------------------- */
+
+// the second half of a fork, lives on the stack of the worker that forked it
+template <typename F>
+struct join_task : pool_task {
+  explicit join_task(F& f) noexcept : pool_task{&join_task::call}, f(f) {}
+
+  static void call(pool_task* t) noexcept {
+    auto self = static_cast<join_task*>(t);
+    self->f();
+    self->done.store(true, std::memory_order_release);
+  }
+
+  F& f;
+  std::atomic<bool> done{false};
+};
+
+// handed in from a thread outside the pool, which sleeps until it ran
+template <typename F>
+struct blocking_task : pool_task {
+  explicit blocking_task(F& f) noexcept : pool_task{&blocking_task::call}, f(f) {}
+
+  static void call(pool_task* t) noexcept {
+    auto self = static_cast<blocking_task*>(t);
+    self->f();
+    std::lock_guard<std::mutex> lock(self->mutex);
+    self->done = true;
+    self->cv.notify_one();
+  }
+
+  void wait() noexcept {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this] { return done; });
+  }
+
+  F& f;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+};
+
+}  // namespace detail
+
+/* ------------------------------------------------------------------------- */
+
+// fixed set of worker threads, each with its own work stealing deque. Work forked on a
+// worker goes to the bottom of its deque and is normally popped right back by the same
+// worker, idle workers steal from the top of a random victim, which takes the oldest and
+// so the biggest pieces of a recursive split. Threads outside the pool hand work in through
+// a locked queue. Workers spin briefly when they run out of work and then sleep until
+// something is pushed
+class thread_pool {
+ public:
+  // threads == 0 starts one worker per hardware thread
+  explicit thread_pool(size_t threads = 0) noexcept;
+
+  thread_pool(const thread_pool&) = delete;
+
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  // runs what was submitted, then stops the workers
+  ~thread_pool();
+
+  // the pool the parallel algorithms use unless given another one
+  static thread_pool& instance() noexcept {
+    static thread_pool pool;
+    return pool;
+  }
+
+ public:
+  size_t size() const noexcept { return _size; }
+
+  // true on the workers of this pool
+  bool is_worker() const noexcept { return current() != nullptr && current()->pool == this; }
+
+  // runs f on a worker and returns once it finished, inline when already on one
+  template <typename F>
+  void run(F&& f) noexcept;
+
+  // runs a and b and returns once both finished, b is offered to idle workers while the
+  // calling worker runs a. Outside the pool the pair is handed to a worker first
+  template <typename A, typename B>
+  void invoke(A&& a, B&& b) noexcept;
+
+  // runs f on some worker later, see wait
+  template <typename F>
+  void submit(F&& f) noexcept;
+
+  // returns once every submitted task ran, workers help with the work while they wait
+  void wait() noexcept;
+
+ private:
+  struct worker {
+    detail::steal_deque tasks;
+    thread_pool* pool;
+    uint64_t rng;
+    std::thread thread;
+  };
+
+  template <typename F>
+  struct detached_task : detail::pool_task {
+    template <typename G>
+    detached_task(G&& f, thread_pool* pool) noexcept
+        : pool_task{&detached_task::call}, f(std::forward<G>(f)), pool(pool) {}
+
+    static void call(pool_task* t) noexcept {
+      auto self = static_cast<detached_task*>(t);
+      auto pool = self->pool;
+      self->f();
+      self->~detached_task();
+      hf::allocator<detached_task>::deallocate(self, 1);
+      pool->finish_detached();
+    }
+
+    F f;
+    thread_pool* pool;
+  };
+
+  static worker*& current() noexcept {
+    static thread_local worker* cur = nullptr;
+    return cur;
+  }
+
+  void work(worker& w) noexcept;
+
+  detail::pool_task* find_task(worker& w) noexcept;
+
+  bool has_work() noexcept;
+
+  void sleep() noexcept;
+
+  // wakes one sleeping worker after a push, cheap when nobody sleeps
+  void notify() noexcept {
+    if (_sleepers.load(std::memory_order_seq_cst) != 0) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      ++_epoch;
+      _wake.notify_one();
+    }
+  }
+
+  void inject(detail::pool_task* task) noexcept {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _injected.push_back(task);
+    _has_injected.store(true, std::memory_order_seq_cst);
+    ++_epoch;
+    _wake.notify_one();
+  }
+
+  void finish_detached() noexcept {
+    if (_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _idle.notify_all();
+    }
+  }
+
+  worker* _workers = nullptr;
+  size_t _size = 0;
+
+  // guards everything below except the atomics
+  std::mutex _mutex;
+  std::condition_variable _wake;
+  std::condition_variable _idle;
+  hf::deque<detail::pool_task*> _injected;
+  uint64_t _epoch = 0;
+  bool _stop = false;
+
+  std::atomic<bool> _has_injected{false};
+  std::atomic<size_t> _sleepers{0};
+  std::atomic<size_t> _pending{0};
+};
+
+inline thread_pool::thread_pool(size_t threads) noexcept {
+  if (threads == 0) threads = std::thread::hardware_concurrency();
+  _size = threads != 0 ? threads : 1;
+
+  // the deques hold cache line aligned members
+  _workers = static_cast<worker*>(
+      ::operator new(_size * sizeof(worker), std::align_val_t(alignof(worker))));
+  for (size_t i = 0; i < _size; ++i) {
+    auto w = ::new (static_cast<void*>(_workers + i)) worker();
+    w->pool = this;
+    w->rng = 0x9e3779b97f4a7c15ull * (i + 1);
+  }
+  for (size_t i = 0; i < _size; ++i) {
+    _workers[i].thread = std::thread([this, i] { work(_workers[i]); });
+  }
+}
+
+inline thread_pool::~thread_pool() {
+  wait();
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+    _wake.notify_all();
+  }
+  for (size_t i = 0; i < _size; ++i) _workers[i].thread.join();
+  for (size_t i = 0; i < _size; ++i) _workers[i].~worker();
+  ::operator delete(_workers, std::align_val_t(alignof(worker)));
+}
+
+template <typename F>
+void thread_pool::run(F&& f) noexcept {
+  if (is_worker()) {
+    f();
+    return;
+  }
+  detail::blocking_task<F> task(f);
+  inject(&task);
+  task.wait();
+}
+
+template <typename A, typename B>
+void thread_pool::invoke(A&& a, B&& b) noexcept {
+  auto w = current();
+  if (w == nullptr || w->pool != this) {
+    run([&] { invoke(a, b); });
+    return;
+  }
+
+  detail::join_task<typename std::remove_reference<B>::type> right(b);
+  w->tasks.push(&right);
+  notify();
+  a();
+
+  // anything forked inside a was joined before it returned, but tasks a submitted sit above
+  // ours, they run here until our task comes back or the deque runs dry because a thief
+  // took it
+  detail::pool_task* task;
+  while ((task = w->tasks.pop()) != nullptr && task != &right) task->run(task);
+  if (task == &right) {
+    b();
+    return;
+  }
+  for (unsigned spins = 0; !right.done.load(std::memory_order_acquire);) {
+    if (auto t = find_task(*w)) {
+      t->run(t);
+      spins = 0;
+    } else {
+      detail::ring_backoff(spins);
+    }
+  }
+}
+
+template <typename F>
+void thread_pool::submit(F&& f) noexcept {
+  typedef detached_task<typename std::decay<F>::type> task_type;
+  auto task = hf::allocator<task_type>::allocate(1);
+  ::new (static_cast<void*>(task)) task_type(std::forward<F>(f), this);
+  _pending.fetch_add(1, std::memory_order_relaxed);
+
+  auto w = current();
+  if (w != nullptr && w->pool == this) {
+    w->tasks.push(task);
+    notify();
+  } else {
+    inject(task);
+  }
+}
+
+inline void thread_pool::wait() noexcept {
+  if (auto w = current(); w != nullptr && w->pool == this) {
+    for (unsigned spins = 0; _pending.load(std::memory_order_acquire) != 0;) {
+      if (auto t = find_task(*w)) {
+        t->run(t);
+        spins = 0;
+      } else {
+        detail::ring_backoff(spins);
+      }
+    }
+    return;
+  }
+  std::unique_lock<std::mutex> lock(_mutex);
+  _idle.wait(lock, [this] { return _pending.load(std::memory_order_acquire) == 0; });
+}
+
+/* ------------------------------------------------------------------------- */
+
+inline void thread_pool::work(worker& w) noexcept {
+  current() = &w;
+  for (unsigned spins = 0;;) {
+    if (auto t = find_task(w)) {
+      t->run(t);
+      spins = 0;
+      continue;
+    }
+    if (spins < 64) {
+      detail::ring_backoff(spins);
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_stop) break;
+    }
+    sleep();
+    spins = 0;
+  }
+  current() = nullptr;
+}
+
+// own deque first, then one round over the others from a random start, then the queue of
+// tasks from outside the pool
+inline detail::pool_task* thread_pool::find_task(worker& w) noexcept {
+  if (auto t = w.tasks.pop()) return t;
+
+  w.rng ^= w.rng << 13;
+  w.rng ^= w.rng >> 7;
+  w.rng ^= w.rng << 17;
+  auto start = static_cast<size_t>(w.rng % _size);
+  for (size_t i = 0; i < _size; ++i) {
+    auto& victim = _workers[(start + i) % _size];
+    if (&victim == &w) continue;
+    if (auto t = victim.tasks.steal()) return t;
+  }
+
+  if (_has_injected.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_injected.empty()) {
+      auto t = _injected.front();
+      _injected.pop_front();
+      _has_injected.store(!_injected.empty(), std::memory_order_relaxed);
+      return t;
+    }
+  }
+  return nullptr;
+}
+
+inline bool thread_pool::has_work() noexcept {
+  if (_has_injected.load(std::memory_order_seq_cst)) return true;
+  for (size_t i = 0; i < _size; ++i) {
+    if (!_workers[i].tasks.empty()) return true;
+  }
+  return false;
+}
+
+// announces itself as sleeping before the last look for work, a push either sees the
+// sleeper and wakes it or is seen by that look
+inline void thread_pool::sleep() noexcept {
+  std::unique_lock<std::mutex> lock(_mutex);
+  _sleepers.fetch_add(1, std::memory_order_seq_cst);
+  if (!_stop && !has_work()) {
+    auto epoch = _epoch;
+    _wake.wait(lock, [&] { return _stop || _epoch != epoch; });
+  }
+  _sleepers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+}  // namespace hf
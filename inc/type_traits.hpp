@@ -40,9 +40,36 @@ struct is_lvalue_reference<T&> : public true_type {};
 
 /* ------------------------------------------------------------------------- */
 
+// a type is trivially relocatable when moving it to a new address and dropping the
+// source without running its destructor is the same as a move followed by a destroy,
+// containers may then relocate such elements with memcpy/memmove
+template <typename T>
+struct is_trivially_relocatable
+    : public integral_constant<bool, std::is_trivially_copyable<T>::value> {};
+
+/* ------------------------------------------------------------------------- */
+
 template <typename T1, typename T2>
 struct pair;
 
+template <typename T1, typename T2>
+struct is_trivially_relocatable<hf::pair<T1, T2>>
+    : public integral_constant<bool, is_trivially_relocatable<T1>::value &&
+                                         is_trivially_relocatable<T2>::value> {};
+
+namespace detail {
+
+// hashers and comparators that accept any key type, enables heterogeneous lookups
+template <typename T, typename = void>
+struct is_transparent : public false_type {};
+
+template <typename T>
+struct is_transparent<T, std::void_t<typename T::is_transparent>> : public true_type {};
+
+}  // namespace detail
+
+/* ------------------------------------------------------------------------- */
+
 template <typename T>
 struct is_pair : hf::false_type {};
 
@@ -0,0 +1,811 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "simd.hpp"
+#include "string.hpp"
+
+namespace hf {
+namespace utf {
+
+// validation, length and conversion kernels between UTF-8, UTF-16 and UTF-32. The convert
+// functions expect valid input and an output sized by the matching length function, the
+// append_utf* functions below put the three steps together for hf strings
+namespace detail {
+
+inline uint64_t load8(const unsigned char* p) noexcept {
+  uint64_t v;
+  std::memcpy(&v, p, 8);
+  return v;
+}
+
+constexpr uint64_t HIGH_BITS = 0x8080808080808080ull;
+
+// one code point of valid input, advancing s past it
+inline char32_t decode_utf8(const unsigned char*& s) noexcept {
+  unsigned c = *s++;
+  if (c < 0x80) return c;
+  if (c < 0xE0) {
+    char32_t r = ((c & 0x1F) << 6) | (s[0] & 0x3F);
+    s += 1;
+    return r;
+  }
+  if (c < 0xF0) {
+    char32_t r = ((c & 0x0F) << 12) | ((s[0] & 0x3F) << 6) | (s[1] & 0x3F);
+    s += 2;
+    return r;
+  }
+  char32_t r = ((c & 0x07) << 18) | ((s[0] & 0x3F) << 12) | ((s[1] & 0x3F) << 6) | (s[2] & 0x3F);
+  s += 3;
+  return r;
+}
+
+inline char32_t decode_utf16(const char16_t*& s) noexcept {
+  char32_t c = *s++;
+  if ((c & 0xFC00) != 0xD800) return c;
+  return 0x10000 + ((c - 0xD800) << 10) + (*s++ - 0xDC00);
+}
+
+inline char* encode_utf8(char32_t c, char* out) noexcept {
+  if (c < 0x80) {
+    *out++ = static_cast<char>(c);
+  } else if (c < 0x800) {
+    *out++ = static_cast<char>(0xC0 | (c >> 6));
+    *out++ = static_cast<char>(0x80 | (c & 0x3F));
+  } else if (c < 0x10000) {
+    *out++ = static_cast<char>(0xE0 | (c >> 12));
+    *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+    *out++ = static_cast<char>(0x80 | (c & 0x3F));
+  } else {
+    *out++ = static_cast<char>(0xF0 | (c >> 18));
+    *out++ = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+    *out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+    *out++ = static_cast<char>(0x80 | (c & 0x3F));
+  }
+  return out;
+}
+
+inline char16_t* encode_utf16(char32_t c, char16_t* out) noexcept {
+  if (c < 0x10000) {
+    *out++ = static_cast<char16_t>(c);
+  } else {
+    c -= 0x10000;
+    *out++ = static_cast<char16_t>(0xD800 + (c >> 10));
+    *out++ = static_cast<char16_t>(0xDC00 + (c & 0x3FF));
+  }
+  return out;
+}
+
+/* ------------------------------------------------------------------------- */
+
+// the sequence at s[0, n), n > 0, its length if it is valid UTF-8 or 0
+inline size_t utf8_sequence(const unsigned char* s, size_t n) noexcept {
+  unsigned c = s[0];
+  if (c < 0x80) return 1;
+
+  size_t len;
+  char32_t cp, min;
+  if ((c & 0xE0) == 0xC0) {
+    len = 2, cp = c & 0x1F, min = 0x80;
+  } else if ((c & 0xF0) == 0xE0) {
+    len = 3, cp = c & 0x0F, min = 0x800;
+  } else if ((c & 0xF8) == 0xF0) {
+    len = 4, cp = c & 0x07, min = 0x10000;
+  } else {
+    return 0;
+  }
+  if (n < len) return 0;
+
+  for (size_t k = 1; k < len; ++k) {
+    if ((s[k] & 0xC0) != 0x80) return 0;
+    cp = (cp << 6) | (s[k] & 0x3F);
+  }
+  // overlong forms, surrogates and values past the last plane
+  if (cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) return 0;
+  return len;
+}
+
+inline bool validate_utf8_scalar(const char* str, size_t n) noexcept {
+  auto s = reinterpret_cast<const unsigned char*>(str);
+  size_t i = 0;
+  while (i < n) {
+    if (n - i >= 8 && (load8(s + i) & HIGH_BITS) == 0) {
+      i += 8;
+      continue;
+    }
+    auto len = utf8_sequence(s + i, n - i);
+    if (len == 0) return false;
+    i += len;
+  }
+  return true;
+}
+
+// a high surrogate must be followed by a low one, a low one must follow a high one
+inline bool validate_utf16_scalar(const char16_t* s, size_t n) noexcept {
+  for (size_t i = 0; i < n; ++i) {
+    auto c = s[i];
+    if ((c & 0xF800) != 0xD800) continue;
+    if (c >= 0xDC00 || i + 1 == n || (s[i + 1] & 0xFC00) != 0xDC00) return false;
+    ++i;
+  }
+  return true;
+}
+
+inline bool validate_utf32_scalar(const char32_t* s, size_t n) noexcept {
+  for (size_t i = 0; i < n; ++i) {
+    if (s[i] > 0x10FFFF || (s[i] >= 0xD800 && s[i] <= 0xDFFF)) return false;
+  }
+  return true;
+}
+
+/* ------------------------------------------------------------------------- */
+
+// a UTF-8 code point starts at every byte that is not a continuation, 4-byte ones need
+// two UTF-16 units
+inline size_t utf16_length_from_utf8_scalar(const char* str, size_t n) noexcept {
+  auto s = reinterpret_cast<const unsigned char*>(str);
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i) count += ((s[i] & 0xC0) != 0x80) + (s[i] >= 0xF0);
+  return count;
+}
+
+inline size_t utf32_length_from_utf8_scalar(const char* str, size_t n) noexcept {
+  auto s = reinterpret_cast<const unsigned char*>(str);
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i) count += (s[i] & 0xC0) != 0x80;
+  return count;
+}
+
+// each half of a surrogate pair accounts for two of the four bytes
+inline size_t utf8_length_from_utf16_scalar(const char16_t* s, size_t n) noexcept {
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i) {
+    auto c = s[i];
+    count += 1 + (c >= 0x80) + (c >= 0x800) - ((c & 0xF800) == 0xD800);
+  }
+  return count;
+}
+
+inline size_t utf32_length_from_utf16_scalar(const char16_t* s, size_t n) noexcept {
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i) count += (s[i] & 0xFC00) != 0xDC00;
+  return count;
+}
+
+inline size_t utf8_length_from_utf32_scalar(const char32_t* s, size_t n) noexcept {
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i) count += 1 + (s[i] >= 0x80) + (s[i] >= 0x800) + (s[i] >= 0x10000);
+  return count;
+}
+
+inline size_t utf16_length_from_utf32_scalar(const char32_t* s, size_t n) noexcept {
+  size_t count = 0;
+  for (size_t i = 0; i < n; ++i) count += 1 + (s[i] >= 0x10000);
+  return count;
+}
+
+/* ------------------------------------------------------------------------- */
+
+inline size_t utf8_to_utf16_scalar(const char* str, size_t n, char16_t* out) noexcept {
+  auto s = reinterpret_cast<const unsigned char*>(str);
+  auto end = s + n;
+  auto o = out;
+  while (s != end) {
+    if (end - s >= 8 && (load8(s) & HIGH_BITS) == 0) {
+      for (int k = 0; k < 8; ++k) *o++ = s[k];
+      s += 8;
+      continue;
+    }
+    o = encode_utf16(decode_utf8(s), o);
+  }
+  return static_cast<size_t>(o - out);
+}
+
+inline size_t utf8_to_utf32_scalar(const char* str, size_t n, char32_t* out) noexcept {
+  auto s = reinterpret_cast<const unsigned char*>(str);
+  auto end = s + n;
+  auto o = out;
+  while (s != end) {
+    if (end - s >= 8 && (load8(s) & HIGH_BITS) == 0) {
+      for (int k = 0; k < 8; ++k) *o++ = s[k];
+      s += 8;
+      continue;
+    }
+    *o++ = decode_utf8(s);
+  }
+  return static_cast<size_t>(o - out);
+}
+
+inline size_t utf16_to_utf8_scalar(const char16_t* s, size_t n, char* out) noexcept {
+  auto end = s + n;
+  auto o = out;
+  while (s != end) o = encode_utf8(decode_utf16(s), o);
+  return static_cast<size_t>(o - out);
+}
+
+inline size_t utf16_to_utf32_scalar(const char16_t* s, size_t n, char32_t* out) noexcept {
+  auto end = s + n;
+  auto o = out;
+  while (s != end) *o++ = decode_utf16(s);
+  return static_cast<size_t>(o - out);
+}
+
+inline size_t utf32_to_utf8_scalar(const char32_t* s, size_t n, char* out) noexcept {
+  auto o = out;
+  for (size_t i = 0; i < n; ++i) o = encode_utf8(s[i], o);
+  return static_cast<size_t>(o - out);
+}
+
+inline size_t utf32_to_utf16_scalar(const char32_t* s, size_t n, char16_t* out) noexcept {
+  auto o = out;
+  for (size_t i = 0; i < n; ++i) o = encode_utf16(s[i], o);
+  return static_cast<size_t>(o - out);
+}
+
+#if defined(HF_SIMD_X86)
+
+// UTF-8 validation after Keiser and Lemire, "Validating UTF-8 in less than one instruction
+// per byte". Three nibble lookups classify every pair of adjacent bytes into error kinds,
+// a set bit that survives the and of all three is an error, except that two continuation
+// bytes are expected exactly where the byte two or three back starts a long sequence
+constexpr uint8_t TOO_SHORT = 1 << 0;       // lead not followed by a continuation
+constexpr uint8_t TOO_LONG = 1 << 1;        // continuation after ASCII
+constexpr uint8_t OVERLONG_3 = 1 << 2;      // 11100000 100_____
+constexpr uint8_t TOO_LARGE = 1 << 3;       // past U+10FFFF
+constexpr uint8_t SURROGATE = 1 << 4;       // 11101101 101_____
+constexpr uint8_t OVERLONG_2 = 1 << 5;      // 1100000_ 10______
+constexpr uint8_t TOO_LARGE_1000 = 1 << 6;  // past U+10FFFF with a 1000____ second byte
+constexpr uint8_t OVERLONG_4 = 1 << 6;      // 11110000 1000____
+constexpr uint8_t TWO_CONTS = 1 << 7;       // 10______ 10______
+constexpr uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+template <int N>
+HF_TARGET_AVX2 inline __m256i prev_bytes(__m256i input, __m256i prev_input) noexcept {
+  return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev_input, input, 0x21), 16 - N);
+}
+
+HF_TARGET_AVX2 inline __m256i utf8_errors(__m256i input, __m256i prev_input) noexcept {
+  const __m256i byte_1_high_table = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+      TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TWO_CONTS,
+      TWO_CONTS, TWO_CONTS, TWO_CONTS, TOO_SHORT | OVERLONG_2, TOO_SHORT,
+      TOO_SHORT | OVERLONG_3 | SURROGATE, TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4));
+  const __m256i byte_1_low_table = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+      CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, CARRY | OVERLONG_2, CARRY, CARRY,
+      CARRY | TOO_LARGE, CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+      CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+      CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+      CARRY | TOO_LARGE | TOO_LARGE_1000, CARRY | TOO_LARGE | TOO_LARGE_1000,
+      CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE, CARRY | TOO_LARGE | TOO_LARGE_1000,
+      CARRY | TOO_LARGE | TOO_LARGE_1000));
+  const __m256i byte_2_high_table = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+      TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+      TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+      TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+      TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+      TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+      TOO_SHORT));
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+  auto prev1 = prev_bytes<1>(input, prev_input);
+  auto byte_1_high =
+      _mm256_shuffle_epi8(byte_1_high_table, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+  auto byte_1_low = _mm256_shuffle_epi8(byte_1_low_table, _mm256_and_si256(prev1, nibble));
+  auto byte_2_high =
+      _mm256_shuffle_epi8(byte_2_high_table, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble));
+  auto special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+  // the top bit is set where the byte two back starts a 3 or 4 byte sequence or the byte
+  // three back starts a 4 byte one
+  auto third = _mm256_subs_epu8(prev_bytes<2>(input, prev_input), _mm256_set1_epi8(0xE0 - 0x80));
+  auto fourth = _mm256_subs_epu8(prev_bytes<3>(input, prev_input), _mm256_set1_epi8(0xF0 - 0x80));
+  auto must_be_cont = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(0x80));
+  return _mm256_xor_si256(must_be_cont, special);
+}
+
+// non-zero if the block ends inside a sequence, which the next block has to finish
+HF_TARGET_AVX2 inline __m256i utf8_incomplete(__m256i input) noexcept {
+  const __m256i max_value = _mm256_setr_epi8(
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1),
+      static_cast<char>(0xC0 - 1));
+  return _mm256_subs_epu8(input, max_value);
+}
+
+// the last partial block is run through the same steps from a buffer padded with ASCII
+HF_TARGET_AVX2 inline bool validate_utf8_avx2(const char* s, size_t n) noexcept {
+  __m256i error = _mm256_setzero_si256();
+  __m256i prev_input = _mm256_setzero_si256();
+  __m256i prev_incomplete = _mm256_setzero_si256();
+
+  auto step = [&](__m256i input) HF_TARGET_AVX2 {
+    if (_mm256_movemask_epi8(input) == 0) {
+      error = _mm256_or_si256(error, prev_incomplete);
+      prev_incomplete = _mm256_setzero_si256();
+    } else {
+      error = _mm256_or_si256(error, utf8_errors(input, prev_input));
+      prev_incomplete = utf8_incomplete(input);
+    }
+    prev_input = input;
+  };
+
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) step(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i)));
+  if (i != n) {
+    alignas(32) char tail[32] = {};
+    std::memcpy(tail, s + i, n - i);
+    step(_mm256_load_si256(reinterpret_cast<const __m256i*>(tail)));
+  }
+  error = _mm256_or_si256(error, prev_incomplete);
+  return _mm256_testz_si256(error, error) != 0;
+}
+
+// every high surrogate must be followed by a low one and nothing else may precede a low
+// one, so the low mask equals the high mask moved up one unit, with the carry from the
+// last unit of the block before
+HF_TARGET_AVX2 inline bool validate_utf16_avx2(const char16_t* s, size_t n) noexcept {
+  const __m256i mask = _mm256_set1_epi16(static_cast<short>(0xFC00));
+  const __m256i high = _mm256_set1_epi16(static_cast<short>(0xD800));
+  const __m256i low = _mm256_set1_epi16(static_cast<short>(0xDC00));
+  uint32_t carry = 0;
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    auto v = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i)), mask);
+    uint32_t highs = _mm256_movemask_epi8(_mm256_cmpeq_epi16(v, high));
+    uint32_t lows = _mm256_movemask_epi8(_mm256_cmpeq_epi16(v, low));
+    if (((highs << 2) | carry) != lows) return false;
+    carry = highs >> 30;
+  }
+  if (carry != 0) {
+    if (i == n || (s[i] & 0xFC00) != 0xDC00) return false;
+    ++i;
+  }
+  return validate_utf16_scalar(s + i, n - i);
+}
+
+// surrogates are the values v with v - 0xD800 <= 0x7FF unsigned
+HF_TARGET_AVX2 inline bool validate_utf32_avx2(const char32_t* s, size_t n) noexcept {
+  const __m256i base = _mm256_set1_epi32(0xD800);
+  const __m256i span = _mm256_set1_epi32(0x7FF);
+  __m256i max = _mm256_setzero_si256();
+  __m256i surrogates = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    auto t = _mm256_sub_epi32(v, base);
+    max = _mm256_max_epu32(max, v);
+    surrogates = _mm256_or_si256(surrogates, _mm256_cmpeq_epi32(_mm256_min_epu32(t, span), t));
+  }
+  const __m256i limit = _mm256_set1_epi32(0x10FFFF);
+  auto in_range = _mm256_cmpeq_epi32(_mm256_max_epu32(max, limit), limit);
+  return _mm256_movemask_epi8(in_range) == -1 && _mm256_testz_si256(surrogates, surrogates) &&
+         validate_utf32_scalar(s + i, n - i);
+}
+
+/* ------------------------------------------------------------------------- */
+
+HF_TARGET_AVX2 inline uint32_t popcount(uint32_t x) noexcept { return __builtin_popcount(x); }
+
+HF_TARGET_AVX2 inline size_t utf16_length_from_utf8_avx2(const char* s, size_t n) noexcept {
+  const __m256i cont = _mm256_set1_epi8(-65);  // 0xBF, continuations are at most that signed
+  const __m256i four = _mm256_set1_epi8(static_cast<char>(0xF0));
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    auto starts = _mm256_movemask_epi8(_mm256_cmpgt_epi8(v, cont));
+    auto longs = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(v, four), v));
+    count += popcount(starts) + popcount(longs);
+  }
+  return count + utf16_length_from_utf8_scalar(s + i, n - i);
+}
+
+HF_TARGET_AVX2 inline size_t utf32_length_from_utf8_avx2(const char* s, size_t n) noexcept {
+  const __m256i cont = _mm256_set1_epi8(-65);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    count += popcount(_mm256_movemask_epi8(_mm256_cmpgt_epi8(v, cont)));
+  }
+  return count + utf32_length_from_utf8_scalar(s + i, n - i);
+}
+
+// movemask gives two bits per 16-bit unit, hence the halving
+HF_TARGET_AVX2 inline size_t utf8_length_from_utf16_avx2(const char16_t* s, size_t n) noexcept {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i above_7f = _mm256_set1_epi16(static_cast<short>(0xFF80));
+  const __m256i above_7ff = _mm256_set1_epi16(static_cast<short>(0xF800));
+  const __m256i surrogate = _mm256_set1_epi16(static_cast<short>(0xD800));
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    auto one = _mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(v, above_7f), zero));
+    auto high = _mm256_and_si256(v, above_7ff);
+    auto two = _mm256_movemask_epi8(_mm256_cmpeq_epi16(high, zero));
+    auto pair = _mm256_movemask_epi8(_mm256_cmpeq_epi16(high, surrogate));
+    count += 48 - (popcount(one) + popcount(two) + popcount(pair)) / 2;
+  }
+  return count + utf8_length_from_utf16_scalar(s + i, n - i);
+}
+
+HF_TARGET_AVX2 inline size_t utf32_length_from_utf16_avx2(const char16_t* s, size_t n) noexcept {
+  const __m256i mask = _mm256_set1_epi16(static_cast<short>(0xFC00));
+  const __m256i low = _mm256_set1_epi16(static_cast<short>(0xDC00));
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    auto lows = _mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(v, mask), low));
+    count += 16 - popcount(lows) / 2;
+  }
+  return count + utf32_length_from_utf16_scalar(s + i, n - i);
+}
+
+// valid code points fit in 21 bits, so the signed compares are exact
+HF_TARGET_AVX2 inline size_t utf8_length_from_utf32_avx2(const char32_t* s, size_t n) noexcept {
+  const __m256i b1 = _mm256_set1_epi32(0x7F);
+  const __m256i b2 = _mm256_set1_epi32(0x7FF);
+  const __m256i b3 = _mm256_set1_epi32(0xFFFF);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    auto extra = popcount(_mm256_movemask_epi8(_mm256_cmpgt_epi32(v, b1))) +
+                 popcount(_mm256_movemask_epi8(_mm256_cmpgt_epi32(v, b2))) +
+                 popcount(_mm256_movemask_epi8(_mm256_cmpgt_epi32(v, b3)));
+    count += 8 + extra / 4;
+  }
+  return count + utf8_length_from_utf32_scalar(s + i, n - i);
+}
+
+HF_TARGET_AVX2 inline size_t utf16_length_from_utf32_avx2(const char32_t* s, size_t n) noexcept {
+  const __m256i bmp = _mm256_set1_epi32(0xFFFF);
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    count += 8 + popcount(_mm256_movemask_epi8(_mm256_cmpgt_epi32(v, bmp))) / 4;
+  }
+  return count + utf16_length_from_utf32_scalar(s + i, n - i);
+}
+
+/* ------------------------------------------------------------------------- */
+
+// blocks that are ASCII, or free of surrogates between the two UTF forms, are widened or
+// narrowed in registers, any other block is converted code point by code point to its end
+HF_TARGET_AVX2 inline size_t utf8_to_utf16_avx2(const char* str, size_t n,
+                                                char16_t* out) noexcept {
+  auto s = reinterpret_cast<const unsigned char*>(str);
+  auto end = s + n;
+  auto o = out;
+  while (end - s >= 32) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    if (_mm256_movemask_epi8(v) == 0) {
+      auto lo = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v));
+      auto hi = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(o), lo);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(o + 16), hi);
+      s += 32;
+      o += 32;
+    } else {
+      for (auto block_end = s + 32; s < block_end;) o = encode_utf16(decode_utf8(s), o);
+    }
+  }
+  while (s != end) o = encode_utf16(decode_utf8(s), o);
+  return static_cast<size_t>(o - out);
+}
+
+HF_TARGET_AVX2 inline size_t utf8_to_utf32_avx2(const char* str, size_t n,
+                                                char32_t* out) noexcept {
+  auto s = reinterpret_cast<const unsigned char*>(str);
+  auto end = s + n;
+  auto o = out;
+  while (end - s >= 16) {
+    auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s));
+    if (_mm_movemask_epi8(v) == 0) {
+      auto lo = _mm256_cvtepu8_epi32(v);
+      auto hi = _mm256_cvtepu8_epi32(_mm_srli_si128(v, 8));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(o), lo);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(o + 8), hi);
+      s += 16;
+      o += 16;
+    } else {
+      for (auto block_end = s + 16; s < block_end;) *o++ = decode_utf8(s);
+    }
+  }
+  while (s != end) *o++ = decode_utf8(s);
+  return static_cast<size_t>(o - out);
+}
+
+// packing of four basic plane code points, each encoded into the low one to three bytes of
+// a 32-bit lane, into consecutive bytes. The key has bit k set if lane k takes two or more
+// bytes and bit k + 4 if it takes three
+struct utf8_pack_table {
+  uint8_t shuffle[256][16];
+  uint8_t length[256];
+
+  constexpr utf8_pack_table() noexcept : shuffle(), length() {
+    for (int key = 0; key < 256; ++key) {
+      int out = 0;
+      for (int k = 0; k < 4; ++k) {
+        int len = 1 + ((key >> k) & 1) + ((key >> (k + 4)) & 1);
+        for (int b = 0; b < len; ++b) shuffle[key][out++] = static_cast<uint8_t>(4 * k + b);
+      }
+      length[key] = static_cast<uint8_t>(out);
+      for (; out < 16; ++out) shuffle[key][out] = 0x80;
+    }
+  }
+};
+
+inline constexpr utf8_pack_table UTF8_PACK{};
+
+// eight units without surrogates, the stores are 16 bytes wide whatever the length
+HF_TARGET_AVX2 inline char* utf8_pack_bmp(__m128i units, char* o) noexcept {
+  const __m256i low6 = _mm256_set1_epi32(0x3F);
+  const __m256i cont = _mm256_set1_epi32(0x80);
+  auto c = _mm256_cvtepu16_epi32(units);
+
+  auto last = _mm256_or_si256(cont, _mm256_and_si256(c, low6));
+  auto mid = _mm256_or_si256(cont, _mm256_and_si256(_mm256_srli_epi32(c, 6), low6));
+  auto two = _mm256_or_si256(_mm256_or_si256(_mm256_set1_epi32(0xC0), _mm256_srli_epi32(c, 6)),
+                             _mm256_slli_epi32(last, 8));
+  auto three = _mm256_or_si256(
+      _mm256_or_si256(_mm256_set1_epi32(0xE0), _mm256_srli_epi32(c, 12)),
+      _mm256_or_si256(_mm256_slli_epi32(mid, 8), _mm256_slli_epi32(last, 16)));
+
+  auto multi = _mm256_cmpgt_epi32(c, _mm256_set1_epi32(0x7F));
+  auto wide = _mm256_cmpgt_epi32(c, _mm256_set1_epi32(0x7FF));
+  auto bytes = _mm256_blendv_epi8(_mm256_blendv_epi8(c, two, multi), three, wide);
+
+  unsigned m = _mm256_movemask_ps(_mm256_castsi256_ps(multi));
+  unsigned w = _mm256_movemask_ps(_mm256_castsi256_ps(wide));
+  unsigned key_lo = (m & 0x0F) | ((w & 0x0F) << 4);
+  unsigned key_hi = (m >> 4) | (w & 0xF0);
+
+  auto table = reinterpret_cast<const __m128i*>(UTF8_PACK.shuffle);
+  auto lo = _mm_shuffle_epi8(_mm256_castsi256_si128(bytes), _mm_loadu_si128(table + key_lo));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(o), lo);
+  o += UTF8_PACK.length[key_lo];
+  auto hi = _mm_shuffle_epi8(_mm256_extracti128_si256(bytes, 1), _mm_loadu_si128(table + key_hi));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(o), hi);
+  return o + UTF8_PACK.length[key_hi];
+}
+
+// every unit makes at least one byte, so with 16 units still to come a 16 byte store stays
+// inside the output, hence the 32 unit margin of the block loop
+HF_TARGET_AVX2 inline size_t utf16_to_utf8_avx2(const char16_t* s, size_t n, char* out) noexcept {
+  const __m256i non_ascii = _mm256_set1_epi16(static_cast<short>(0xFF80));
+  const __m256i mask = _mm256_set1_epi16(static_cast<short>(0xF800));
+  const __m256i surrogate = _mm256_set1_epi16(static_cast<short>(0xD800));
+  auto end = s + n;
+  auto o = out;
+  while (end - s >= 32) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    if (_mm256_testz_si256(v, non_ascii)) {
+      auto bytes = _mm_packus_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(o), bytes);
+      o += 16;
+    } else if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(v, mask), surrogate)) ==
+               0) {
+      o = utf8_pack_bmp(_mm256_castsi256_si128(v), o);
+      o = utf8_pack_bmp(_mm256_extracti128_si256(v, 1), o);
+    } else {
+      // a pair may straddle the block end, the loop then stops one unit into the next block
+      auto block_end = s + 16;
+      while (s < block_end) o = encode_utf8(decode_utf16(s), o);
+      continue;
+    }
+    s += 16;
+  }
+  while (s != end) o = encode_utf8(decode_utf16(s), o);
+  return static_cast<size_t>(o - out);
+}
+
+HF_TARGET_AVX2 inline size_t utf16_to_utf32_avx2(const char16_t* s, size_t n,
+                                                 char32_t* out) noexcept {
+  const __m256i mask = _mm256_set1_epi16(static_cast<short>(0xF800));
+  const __m256i surrogate = _mm256_set1_epi16(static_cast<short>(0xD800));
+  auto end = s + n;
+  auto o = out;
+  while (end - s >= 16) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(v, mask), surrogate)) == 0) {
+      auto lo = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(v));
+      auto hi = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(v, 1));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(o), lo);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(o + 8), hi);
+      s += 16;
+      o += 16;
+    } else {
+      for (auto block_end = s + 16; s < block_end;) *o++ = decode_utf16(s);
+    }
+  }
+  while (s != end) *o++ = decode_utf16(s);
+  return static_cast<size_t>(o - out);
+}
+
+HF_TARGET_AVX2 inline size_t utf32_to_utf8_avx2(const char32_t* s, size_t n, char* out) noexcept {
+  const __m256i non_ascii = _mm256_set1_epi32(~0x7F);
+  auto o = out;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    if (_mm256_testz_si256(v, non_ascii)) {
+      auto words = _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(o), _mm_packus_epi16(words, words));
+      o += 8;
+    } else {
+      for (size_t k = 0; k < 8; ++k) o = encode_utf8(s[i + k], o);
+    }
+  }
+  for (; i < n; ++i) o = encode_utf8(s[i], o);
+  return static_cast<size_t>(o - out);
+}
+
+HF_TARGET_AVX2 inline size_t utf32_to_utf16_avx2(const char32_t* s, size_t n,
+                                                 char16_t* out) noexcept {
+  const __m256i non_bmp = _mm256_set1_epi32(~0xFFFF);
+  auto o = out;
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+    if (_mm256_testz_si256(v, non_bmp)) {
+      auto words = _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(o), words);
+      o += 8;
+    } else {
+      for (size_t k = 0; k < 8; ++k) o = encode_utf16(s[i + k], o);
+    }
+  }
+  for (; i < n; ++i) o = encode_utf16(s[i], o);
+  return static_cast<size_t>(o - out);
+}
+
+#endif
+
+}  // namespace detail
+
+/* ------------------------------------------------------------------------- */
+
+// dispatchers, short inputs stay scalar like the simd.hpp ones
+
+#if defined(HF_SIMD_X86)
+#define HF_UTF_DISPATCH(name, min_units, ...)                                      \
+  if (n >= (min_units) && simd::has_avx2()) return detail::name##_avx2(__VA_ARGS__); \
+  return detail::name##_scalar(__VA_ARGS__)
+#else
+#define HF_UTF_DISPATCH(name, min_units, ...) return detail::name##_scalar(__VA_ARGS__)
+#endif
+
+inline bool validate_utf8(const char* s, size_t n) noexcept {
+  HF_UTF_DISPATCH(validate_utf8, 32, s, n);
+}
+
+inline bool validate_utf16(const char16_t* s, size_t n) noexcept {
+  HF_UTF_DISPATCH(validate_utf16, 16, s, n);
+}
+
+inline bool validate_utf32(const char32_t* s, size_t n) noexcept {
+  HF_UTF_DISPATCH(validate_utf32, 8, s, n);
+}
+
+// the length of valid input once converted, in code units of the target form
+inline size_t utf16_length_from_utf8(const char* s, size_t n) noexcept {
+  HF_UTF_DISPATCH(utf16_length_from_utf8, 32, s, n);
+}
+
+inline size_t utf32_length_from_utf8(const char* s, size_t n) noexcept {
+  HF_UTF_DISPATCH(utf32_length_from_utf8, 32, s, n);
+}
+
+inline size_t utf8_length_from_utf16(const char16_t* s, size_t n) noexcept {
+  HF_UTF_DISPATCH(utf8_length_from_utf16, 16, s, n);
+}
+
+inline size_t utf32_length_from_utf16(const char16_t* s, size_t n) noexcept {
+  HF_UTF_DISPATCH(utf32_length_from_utf16, 16, s, n);
+}
+
+inline size_t utf8_length_from_utf32(const char32_t* s, size_t n) noexcept {
+  HF_UTF_DISPATCH(utf8_length_from_utf32, 8, s, n);
+}
+
+inline size_t utf16_length_from_utf32(const char32_t* s, size_t n) noexcept {
+  HF_UTF_DISPATCH(utf16_length_from_utf32, 8, s, n);
+}
+
+// converts valid input into out, which has room for the length above, returns that length
+inline size_t convert_utf8_to_utf16(const char* s, size_t n, char16_t* out) noexcept {
+  HF_UTF_DISPATCH(utf8_to_utf16, 32, s, n, out);
+}
+
+inline size_t convert_utf8_to_utf32(const char* s, size_t n, char32_t* out) noexcept {
+  HF_UTF_DISPATCH(utf8_to_utf32, 16, s, n, out);
+}
+
+inline size_t convert_utf16_to_utf8(const char16_t* s, size_t n, char* out) noexcept {
+  HF_UTF_DISPATCH(utf16_to_utf8, 16, s, n, out);
+}
+
+inline size_t convert_utf16_to_utf32(const char16_t* s, size_t n, char32_t* out) noexcept {
+  HF_UTF_DISPATCH(utf16_to_utf32, 16, s, n, out);
+}
+
+inline size_t convert_utf32_to_utf8(const char32_t* s, size_t n, char* out) noexcept {
+  HF_UTF_DISPATCH(utf32_to_utf8, 8, s, n, out);
+}
+
+inline size_t convert_utf32_to_utf16(const char32_t* s, size_t n, char16_t* out) noexcept {
+  HF_UTF_DISPATCH(utf32_to_utf16, 8, s, n, out);
+}
+
+#undef HF_UTF_DISPATCH
+
+namespace detail {
+
+// validates, sizes the output exactly and converts straight into the string's buffer
+template <typename From, typename To, typename CharTraits, typename Alloc, typename Growth>
+bool append_converted(basic_string<To, CharTraits, Alloc, Growth>& out, const From* s, size_t n,
+                      bool (*validate)(const From*, size_t) noexcept,
+                      size_t (*length)(const From*, size_t) noexcept,
+                      size_t (*convert)(const From*, size_t, To*) noexcept) noexcept {
+  if (!validate(s, n)) return false;
+
+  auto old_size = out.size();
+  out.resize_and_overwrite(old_size + length(s, n), [&](To* buf, size_t) noexcept {
+    return old_size + convert(s, n, buf + old_size);
+  });
+  return true;
+}
+
+}  // namespace detail
+}  // namespace utf
+
+/* ------------------------------------------------------------------------- */
+
+// append in, converted, to out, false and out untouched if in is not well formed
+
+template <typename CharTraits, typename Alloc, typename Growth>
+bool append_utf8(basic_string<char, CharTraits, Alloc, Growth>& out, u16string_view in) noexcept {
+  return utf::detail::append_converted(out, in.data(), in.size(), utf::validate_utf16,
+                                       utf::utf8_length_from_utf16, utf::convert_utf16_to_utf8);
+}
+
+template <typename CharTraits, typename Alloc, typename Growth>
+bool append_utf8(basic_string<char, CharTraits, Alloc, Growth>& out, u32string_view in) noexcept {
+  return utf::detail::append_converted(out, in.data(), in.size(), utf::validate_utf32,
+                                       utf::utf8_length_from_utf32, utf::convert_utf32_to_utf8);
+}
+
+template <typename CharTraits, typename Alloc, typename Growth>
+bool append_utf16(basic_string<char16_t, CharTraits, Alloc, Growth>& out,
+                  string_view in) noexcept {
+  return utf::detail::append_converted(out, in.data(), in.size(), utf::validate_utf8,
+                                       utf::utf16_length_from_utf8, utf::convert_utf8_to_utf16);
+}
+
+template <typename CharTraits, typename Alloc, typename Growth>
+bool append_utf16(basic_string<char16_t, CharTraits, Alloc, Growth>& out,
+                  u32string_view in) noexcept {
+  return utf::detail::append_converted(out, in.data(), in.size(), utf::validate_utf32,
+                                       utf::utf16_length_from_utf32, utf::convert_utf32_to_utf16);
+}
+
+template <typename CharTraits, typename Alloc, typename Growth>
+bool append_utf32(basic_string<char32_t, CharTraits, Alloc, Growth>& out,
+                  string_view in) noexcept {
+  return utf::detail::append_converted(out, in.data(), in.size(), utf::validate_utf8,
+                                       utf::utf32_length_from_utf8, utf::convert_utf8_to_utf32);
+}
+
+template <typename CharTraits, typename Alloc, typename Growth>
+bool append_utf32(basic_string<char32_t, CharTraits, Alloc, Growth>& out,
+                  u16string_view in) noexcept {
+  return utf::detail::append_converted(out, in.data(), in.size(), utf::validate_utf16,
+                                       utf::utf32_length_from_utf16, utf::convert_utf16_to_utf32);
+}
+
+}  // namespace hf
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstddef>
+#include <tuple>
+#include <utility>
 
 #include "type_traits.hpp"
 
@@ -130,6 +132,11 @@ struct pair {
   explicit constexpr pair(pair<U1, U2>&& other)
       : first(hf::forward<U1>(other.first)), second(hf::forward<U2>(other.second)) {}
 
+  // members constructed in place from the two argument tuples
+  template <typename... Args1, typename... Args2>
+  pair(std::piecewise_construct_t, std::tuple<Args1...> a, std::tuple<Args2...> b)
+      : pair(a, b, std::index_sequence_for<Args1...>(), std::index_sequence_for<Args2...>()) {}
+
   // copy assign for this pair
   pair& operator=(const pair& rhs) {
     if (this != &rhs) {
@@ -172,6 +179,11 @@ struct pair {
       hf::swap(second, rhs.second);
     }
   }
+
+ private:
+  template <typename Tuple1, typename Tuple2, size_t... I1, size_t... I2>
+  pair(Tuple1& a, Tuple2& b, std::index_sequence<I1...>, std::index_sequence<I2...>)
+      : first(std::get<I1>(hf::move(a))...), second(std::get<I2>(hf::move(b))...) {}
 };
 
 template <typename T1, typename T2>
@@ -1,11 +1,17 @@
 #pragma once
 
+#include <cstring>
+#include <utility>
+
 #include "allocator.hpp"
+#include "container_stats.hpp"
+#include "growth_policy.hpp"
+#include "type_traits.hpp"
 
 namespace hf {
 
-template <typename T>
-class vector {
+template <typename T, typename Alloc = hf::allocator<T>, typename Growth = hf::growth_1_5x>
+class vector : private hf::alloc_holder<Alloc> {
  public:
   typedef T* iterator;
   typedef const T* const_iterator;
@@ -14,27 +20,48 @@ class vector {
   typedef T& reference;
   typedef const T& const_reference;
 
-  typedef hf::allocator<T> Alloc;
+  typedef Alloc allocator_type;
+
+ protected:
+  typedef hf::alloc_holder<Alloc> holder;
+  typedef hf::allocator_traits<Alloc> alloc_traits;
+
+  using holder::_alloc;
 
- private:
   iterator _begin;
   iterator _end;
   iterator _cap;
 
-  static constexpr size_t _INIT_SIZE = 16;
-
  public:
   vector() noexcept { _init(); };
 
-  explicit vector(size_t n) noexcept { fill_init(n); };
+  explicit vector(const Alloc& alloc) noexcept : holder(alloc) { _init(); }
+
+  explicit vector(size_t n, const Alloc& alloc = Alloc()) noexcept : holder(alloc) {
+    fill_init(n);
+  };
+
+  vector(const vector& rhs)
+      : holder(alloc_traits::select_on_container_copy_construction(rhs._alloc())) {
+    range_init(rhs._begin, rhs._end);
+  }
 
-  vector(const vector& rhs) { range_init(rhs._begin, rhs._end); }
+  vector(const vector& rhs, const Alloc& alloc) : holder(alloc) {
+    range_init(rhs._begin, rhs._end);
+  }
 
-  vector(vector&& rhs) noexcept : _begin(rhs._begin), _end(rhs._end), _cap(rhs._cap) {
+  vector(vector&& rhs) noexcept
+      : holder(std::move(rhs._alloc())), _begin(rhs._begin), _end(rhs._end), _cap(rhs._cap) {
     rhs._begin = rhs._end = rhs._cap = nullptr;
   }
 
-  vector(std::initializer_list<T> list) { range_init(list.begin(), list.end()); }
+  vector(std::initializer_list<T> list, const Alloc& alloc = Alloc()) : holder(alloc) {
+    range_init(list.begin(), list.end());
+  }
+
+  vector& operator=(const vector& rhs);
+
+  vector& operator=(vector&& rhs) noexcept;
 
   ~vector() {
     destroy_and_recover(_begin, _end, _cap - _begin);
@@ -54,6 +81,8 @@ class vector {
 
   const_iterator cend() const noexcept { return _end; }
 
+  allocator_type get_allocator() const noexcept { return _alloc(); }
+
   /* ------------------------------------------------------------------------- */
 
   size_t size() const noexcept { return static_cast<size_t>(_end - _begin); }
@@ -84,11 +113,23 @@ class vector {
 
   /* ------------------------------------------------------------------------- */
 
-  void push_back(const_reference value) noexcept;
+  template <typename... Args>
+  reference emplace_back(Args&&... args) noexcept;
+
+  template <typename... Args>
+  iterator emplace(const_iterator pos, Args&&... args) noexcept;
+
+  void push_back(const_reference value) noexcept { emplace_back(value); }
+
+  void push_back(T&& value) noexcept { emplace_back(std::move(value)); }
 
   void pop_back() noexcept;
 
-  iterator insert(const_iterator pos, const_reference value) noexcept;
+  iterator insert(const_iterator pos, const_reference value) noexcept {
+    return emplace(pos, value);
+  }
+
+  iterator insert(const_iterator pos, T&& value) noexcept { return emplace(pos, std::move(value)); }
 
   iterator insert(const_iterator pos, size_t n, const_reference value) noexcept {
     assert(pos >= begin() && pos <= end());
@@ -107,7 +148,15 @@ class vector {
 
   void swap(vector& rhs) noexcept;
 
- private:
+  void reserve(size_t n) noexcept {
+    if (n > capacity()) reallocate(n);
+  }
+
+  void shrink_to_fit() noexcept {
+    if (capacity() > size()) reallocate(size());
+  }
+
+ protected:
   void _init() noexcept;
 
   void fill_init(size_t n) noexcept;
@@ -119,76 +168,158 @@ class vector {
   template <typename Iter>
   void range_init(Iter first, Iter last) noexcept;
 
-  const size_t get_new_cap(size_t add_size) const noexcept;
+  template <typename Iter>
+  void range_assign(Iter first, Iter last) noexcept;
 
-  void reallocate_insert(iterator pos, const_reference value) noexcept;
+  size_t get_new_cap(size_t add_size) const noexcept;
+
+  void reallocate(size_t new_cap) noexcept;
+
+  void note_reallocation(size_t new_cap) noexcept;
+
+  template <typename... Args>
+  void reallocate_emplace(iterator pos, Args&&... args) noexcept;
+
+  iterator relocate(iterator first, iterator last, iterator result) noexcept;
 
   void destroy_and_recover(iterator first, iterator last, size_t n) noexcept;
 };
 
 /* ------------------------------------------------------------------------- */
 
-template <typename T>
-void vector<T>::push_back(const_reference value) noexcept {
-  if (_end != _cap) {
-    Alloc::construct(_end++, value);
-  } else {
-    reallocate_insert(_end, value);
+template <typename T, typename Alloc, typename Growth>
+vector<T, Alloc, Growth>& vector<T, Alloc, Growth>::operator=(const vector& rhs) {
+  if (this != &rhs) {
+    if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+      if (!alloc_traits::equal(_alloc(), rhs._alloc())) {
+        destroy_and_recover(_begin, _end, _cap - _begin);
+        _begin = _end = _cap = nullptr;
+      }
+      _alloc() = rhs._alloc();
+    }
+    range_assign(rhs._begin, rhs._end);
   }
+  return *this;
 }
 
-template <typename T>
-void vector<T>::pop_back() noexcept {
-  if (empty()) return;
-  Alloc::destroy(_end - 1);
-  _end--;
+template <typename T, typename Alloc, typename Growth>
+vector<T, Alloc, Growth>& vector<T, Alloc, Growth>::operator=(vector&& rhs) noexcept {
+  if (this != &rhs) {
+    // storage can only be stolen if it can be released with our allocator afterwards
+    if constexpr (!alloc_traits::propagate_on_container_move_assignment::value) {
+      if (!alloc_traits::equal(_alloc(), rhs._alloc())) {
+        range_assign(std::make_move_iterator(rhs._begin), std::make_move_iterator(rhs._end));
+        rhs.clear();
+        return *this;
+      }
+    }
+
+    destroy_and_recover(_begin, _end, _cap - _begin);
+    if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+      _alloc() = std::move(rhs._alloc());
+    }
+    _begin = rhs._begin;
+    _end = rhs._end;
+    _cap = rhs._cap;
+    rhs._begin = rhs._end = rhs._cap = nullptr;
+  }
+  return *this;
+}
+
+template <typename T, typename Alloc, typename Growth>
+template <typename... Args>
+typename vector<T, Alloc, Growth>::reference vector<T, Alloc, Growth>::emplace_back(
+    Args&&... args) noexcept {
+  if (_end != _cap) {
+    alloc_traits::construct(_alloc(), _end++, std::forward<Args>(args)...);
+  } else {
+    reallocate_emplace(_end, std::forward<Args>(args)...);
+  }
+  return back();
 }
 
-template <typename T>
-typename vector<T>::iterator vector<T>::insert(const_iterator pos, const_reference value) noexcept {
+template <typename T, typename Alloc, typename Growth>
+template <typename... Args>
+typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::emplace(
+    const_iterator pos, Args&&... args) noexcept {
   assert(pos >= begin() && pos <= end());
 
   iterator xpos = _begin + (pos - begin());
   size_t n = pos - _begin;
 
   if (_end != _cap && xpos == _end) {
-    Alloc::construct(_end, value);
+    alloc_traits::construct(_alloc(), _end, std::forward<Args>(args)...);
     ++_end;
   } else if (_end != _cap) {
-    auto copy_value = value;
-    std::move(xpos, _end, xpos + 1);
-    Alloc::construct(xpos, copy_value);
+    // args may refer to an element that is about to be shifted
+    T value(std::forward<Args>(args)...);
+    stats::on_move<vector>(_end - xpos);
+    if constexpr (hf::is_trivially_relocatable<T>::value) {
+      std::memmove(static_cast<void*>(xpos + 1), static_cast<const void*>(xpos),
+                   (_end - xpos) * sizeof(T));
+      alloc_traits::construct(_alloc(), xpos, std::move(value));
+    } else {
+      alloc_traits::construct(_alloc(), _end, std::move(*(_end - 1)));
+      std::move_backward(xpos, _end - 1, _end);
+      *xpos = std::move(value);
+    }
     ++_end;
   } else {
-    reallocate_insert(xpos, value);
+    reallocate_emplace(xpos, std::forward<Args>(args)...);
   }
 
   return _begin + n;
 }
 
-template <typename T>
-typename vector<T>::iterator vector<T>::erase(const_iterator pos) noexcept {
+template <typename T, typename Alloc, typename Growth>
+void vector<T, Alloc, Growth>::pop_back() noexcept {
+  if (empty()) return;
+  alloc_traits::destroy(_alloc(), _end - 1);
+  _end--;
+}
+
+template <typename T, typename Alloc, typename Growth>
+typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::erase(
+    const_iterator pos) noexcept {
   assert(pos >= begin() && pos < end());
 
   iterator xpos = _begin + (pos - begin());
-  std::move(xpos + 1, _end, xpos);
-  Alloc::destroy(_end-- - 1);
+  stats::on_move<vector>(_end - xpos - 1);
+  if constexpr (hf::is_trivially_relocatable<T>::value) {
+    alloc_traits::destroy(_alloc(), xpos);
+    std::memmove(static_cast<void*>(xpos), static_cast<const void*>(xpos + 1),
+                 (_end - xpos - 1) * sizeof(T));
+    --_end;
+  } else {
+    std::move(xpos + 1, _end, xpos);
+    alloc_traits::destroy(_alloc(), _end-- - 1);
+  }
   return xpos;
 }
 
-template <typename T>
-typename vector<T>::iterator vector<T>::erase(const_iterator first, const_iterator last) noexcept {
+template <typename T, typename Alloc, typename Growth>
+typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::erase(
+    const_iterator first, const_iterator last) noexcept {
   assert(first >= begin() && last <= end() && first <= last);
+  // an empty range would move every element after it onto itself
+  if (first == last) return _begin + (first - begin());
 
   auto n = first - _begin;
   iterator r = _begin + (first - begin());
-  Alloc::destroy(std::move(r + (last - first), _end, r), _end);
+  stats::on_move<vector>(_end - last);
+  if constexpr (hf::is_trivially_relocatable<T>::value) {
+    alloc_traits::destroy(_alloc(), r, r + (last - first));
+    std::memmove(static_cast<void*>(r), static_cast<const void*>(r + (last - first)),
+                 (_end - r - (last - first)) * sizeof(T));
+  } else {
+    alloc_traits::destroy(_alloc(), std::move(r + (last - first), _end, r), _end);
+  }
   _end = _end - (last - first);
   return _begin + n;
 }
 
-template <typename T>
-void vector<T>::resize(size_t new_size, const_reference value) noexcept {
+template <typename T, typename Alloc, typename Growth>
+void vector<T, Alloc, Growth>::resize(size_t new_size, const_reference value) noexcept {
   auto old_size = size();
 
   if (new_size < old_size) {
@@ -198,9 +329,14 @@ void vector<T>::resize(size_t new_size, const_reference value) noexcept {
   }
 }
 
-template <typename T>
-void vector<T>::swap(vector<T>& rhs) noexcept {
+template <typename T, typename Alloc, typename Growth>
+void vector<T, Alloc, Growth>::swap(vector<T, Alloc, Growth>& rhs) noexcept {
   if (this != &rhs) {
+    if constexpr (alloc_traits::propagate_on_container_swap::value) {
+      std::swap(_alloc(), rhs._alloc());
+    } else {
+      assert(alloc_traits::equal(_alloc(), rhs._alloc()));
+    }
     std::swap(_begin, rhs._begin);
     std::swap(_end, rhs._end);
     std::swap(_cap, rhs._cap);
@@ -209,52 +345,56 @@ void vector<T>::swap(vector<T>& rhs) noexcept {
 
 /* ------------------------------------------------------------------------- */
 
-template <typename T>
-void vector<T>::_init() noexcept {
-  _begin = Alloc::allocate(_INIT_SIZE);
-  _end = _begin;
-  _cap = _begin + _INIT_SIZE;
+template <typename T, typename Alloc, typename Growth>
+void vector<T, Alloc, Growth>::_init() noexcept {
+  _begin = _end = _cap = nullptr;
 }
 
-template <typename T>
-void vector<T>::fill_init(size_t n) noexcept {
-  size_t init_size = std::max(_INIT_SIZE, n);
-  init_space(n, init_size);
+template <typename T, typename Alloc, typename Growth>
+void vector<T, Alloc, Growth>::fill_init(size_t n) noexcept {
+  init_space(n, n);
   std::uninitialized_fill_n(_begin, n, T());
 }
 
-template <typename T>
-typename vector<T>::iterator vector<T>::fill_insert(iterator pos, size_t n,
-                                                    const_reference value) noexcept {
+template <typename T, typename Alloc, typename Growth>
+typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::fill_insert(
+    iterator pos, size_t n, const_reference value) noexcept {
   if (n <= 0) return pos;
 
   auto x = pos - _begin;
   auto copy_value = value;
 
   if (static_cast<size_t>(_cap - _end) >= n) {
-    auto after_elems = _end - pos;
+    auto after_elems = static_cast<size_t>(_end - pos);
     auto old_end = _end;
+    stats::on_move<vector>(after_elems);
 
-    if (after_elems > n) {
-      std::move(_end - n, _end, _end);
+    if constexpr (hf::is_trivially_relocatable<T>::value) {
+      std::memmove(static_cast<void*>(pos + n), static_cast<const void*>(pos),
+                   after_elems * sizeof(T));
+      std::uninitialized_fill_n(pos, n, copy_value);
+      _end += n;
+    } else if (after_elems > n) {
+      std::uninitialized_move(_end - n, _end, _end);
       _end += n;
       std::move_backward(pos, old_end - n, old_end);
-      std::uninitialized_fill_n(pos, n, copy_value);
+      std::fill_n(pos, n, copy_value);
     } else {
       _end = std::uninitialized_fill_n(_end, n - after_elems, copy_value);
-      _end = std::move(pos, old_end, _end);
-      std::uninitialized_fill_n(pos, after_elems, copy_value);
+      _end = std::uninitialized_move(pos, old_end, _end);
+      std::fill_n(pos, after_elems, copy_value);
     }
   } else {
     const auto new_size = get_new_cap(n);
-    auto new_begin = Alloc::allocate(new_size);
+    note_reallocation(new_size);
+    auto new_begin = alloc_traits::allocate(_alloc(), new_size);
     auto new_end = new_begin;
 
-    new_end = std::uninitialized_move(_begin, pos, new_begin);
+    new_end = relocate(_begin, pos, new_begin);
     new_end = std::uninitialized_fill_n(new_end, n, copy_value);
-    new_end = std::uninitialized_move(pos, _end, new_end);
+    new_end = relocate(pos, _end, new_end);
 
-    Alloc::deallocate(_begin, _cap - _begin);
+    if (_begin != nullptr) alloc_traits::deallocate(_alloc(), _begin, _cap - _begin);
     _begin = new_begin;
     _end = new_end;
     _cap = _begin + new_size;
@@ -263,57 +403,130 @@ typename vector<T>::iterator vector<T>::fill_insert(iterator pos, size_t n,
   return _begin + x;
 }
 
-template <typename T>
-void vector<T>::init_space(size_t len, size_t cap) noexcept {
-  _begin = Alloc::allocate(cap);
+template <typename T, typename Alloc, typename Growth>
+void vector<T, Alloc, Growth>::init_space(size_t len, size_t cap) noexcept {
+  // nothing is allocated for an empty vector, the first insertion does that
+  _begin = cap == 0 ? nullptr : alloc_traits::allocate(_alloc(), cap);
+  if (cap != 0) stats::on_allocate<vector>(cap * sizeof(T));
   _end = _begin + len;
   _cap = _begin + cap;
 }
 
-template <typename T>
+template <typename T, typename Alloc, typename Growth>
 template <typename Iter>
-void vector<T>::range_init(Iter first, Iter last) noexcept {
+void vector<T, Alloc, Growth>::range_init(Iter first, Iter last) noexcept {
   size_t len = std::distance(first, last);
-  size_t init_size = std::max(len, _INIT_SIZE);
 
-  init_space(len, init_size);
+  init_space(len, len);
+  std::uninitialized_copy(first, last, _begin);
+}
 
-  auto cur = _begin;
-  while (cur != _end) *cur++ = *first++;
+template <typename T, typename Alloc, typename Growth>
+template <typename Iter>
+void vector<T, Alloc, Growth>::range_assign(Iter first, Iter last) noexcept {
+  size_t len = std::distance(first, last);
+
+  if (len > capacity()) {
+    destroy_and_recover(_begin, _end, _cap - _begin);
+    init_space(len, len);
+    std::uninitialized_copy(first, last, _begin);
+  } else if (len > size()) {
+    auto mid = first;
+    std::advance(mid, size());
+    std::copy(first, mid, _begin);
+    _end = std::uninitialized_copy(mid, last, _end);
+  } else {
+    auto new_end = std::copy(first, last, _begin);
+    alloc_traits::destroy(_alloc(), new_end, _end);
+    _end = new_end;
+  }
 }
 
-template <typename T>
-void vector<T>::reallocate_insert(iterator pos, const_reference value) noexcept {
+template <typename T, typename Alloc, typename Growth>
+template <typename... Args>
+void vector<T, Alloc, Growth>::reallocate_emplace(iterator pos, Args&&... args) noexcept {
   const auto new_size = get_new_cap(1);
-  auto new_begin = Alloc::allocate(new_size);
-  auto copy_value = value;
-  auto new_end = std::uninitialized_move(_begin, pos, new_begin);
-  Alloc::construct(new_end++, copy_value);
-  new_end = std::uninitialized_move(pos, _end, new_end);
+  note_reallocation(new_size);
+  auto new_begin = alloc_traits::allocate(_alloc(), new_size);
+  auto new_pos = new_begin + (pos - _begin);
+
+  // construct the new element first, args may refer to an element of the old buffer
+  alloc_traits::construct(_alloc(), new_pos, std::forward<Args>(args)...);
+  relocate(_begin, pos, new_begin);
+  auto new_end = relocate(pos, _end, new_pos + 1);
 
-  destroy_and_recover(_begin, _end, _end - _begin);
+  if (_begin != nullptr) alloc_traits::deallocate(_alloc(), _begin, _cap - _begin);
   _begin = new_begin;
   _end = new_end;
   _cap = new_begin + new_size;
 }
 
-template <typename T>
-void vector<T>::destroy_and_recover(iterator first, iterator last, size_t n) noexcept {
-  Alloc::destroy(first, last);
-  Alloc::deallocate(first);
+// move [first, last) into the raw memory at result and end the lifetime of the source
+template <typename T, typename Alloc, typename Growth>
+typename vector<T, Alloc, Growth>::iterator vector<T, Alloc, Growth>::relocate(
+    iterator first, iterator last, iterator result) noexcept {
+  if constexpr (hf::is_trivially_relocatable<T>::value) {
+    if (first != last) {
+      std::memcpy(static_cast<void*>(result), static_cast<const void*>(first),
+                  (last - first) * sizeof(T));
+    }
+    return result + (last - first);
+  } else {
+    for (; first != last; ++first, ++result) {
+      alloc_traits::construct(_alloc(), result, std::move_if_noexcept(*first));
+      alloc_traits::destroy(_alloc(), first);
+    }
+    return result;
+  }
 }
 
-template <typename T>
-const size_t vector<T>::get_new_cap(size_t add_size) const noexcept {
-  const auto old_size = capacity();
+template <typename T, typename Alloc, typename Growth>
+void vector<T, Alloc, Growth>::destroy_and_recover(iterator first, iterator last,
+                                                   size_t n) noexcept {
+  if (first == nullptr) return;
+  stats::on_release<vector>((n - (last - first)) * sizeof(T));
+  alloc_traits::destroy(_alloc(), first, last);
+  alloc_traits::deallocate(_alloc(), first, n);
+}
 
-  if (old_size > max_size() - (old_size >> 1)) {
-    return old_size + add_size > max_size() - _INIT_SIZE ? old_size + add_size
-                                                         : old_size + add_size + _INIT_SIZE;
-  }
+template <typename T, typename Alloc, typename Growth>
+size_t vector<T, Alloc, Growth>::get_new_cap(size_t add_size) const noexcept {
+  assert(size() <= max_size() - add_size);
+  return Growth::next(capacity(), size() + add_size, max_size(), sizeof(T));
+}
+
+// moves the elements into a buffer of exactly new_cap, an empty vector ends up unallocated
+template <typename T, typename Alloc, typename Growth>
+void vector<T, Alloc, Growth>::reallocate(size_t new_cap) noexcept {
+  assert(new_cap >= size());
+  note_reallocation(new_cap);
 
-  return old_size == 0 ? std::max(add_size, _INIT_SIZE)
-                       : std::max(old_size + (old_size >> 1), old_size + add_size);
+  auto new_begin = new_cap == 0 ? nullptr : alloc_traits::allocate(_alloc(), new_cap);
+  auto new_end = relocate(_begin, _end, new_begin);
+
+  if (_begin != nullptr) alloc_traits::deallocate(_alloc(), _begin, _cap - _begin);
+  _begin = new_begin;
+  _end = new_end;
+  _cap = new_begin + new_cap;
 }
 
+// a buffer of new_cap elements is about to replace the current one
+template <typename T, typename Alloc, typename Growth>
+void vector<T, Alloc, Growth>::note_reallocation(size_t new_cap) noexcept {
+  if constexpr (stats::enabled) {
+    if (_begin != nullptr) stats::on_release<vector>((_cap - _end) * sizeof(T));
+    if (new_cap == 0) return;
+
+    if (_begin == nullptr) {
+      stats::on_allocate<vector>(new_cap * sizeof(T));
+    } else {
+      stats::on_reallocate<vector>(new_cap * sizeof(T), size());
+    }
+  }
+}
+
+template <typename T, typename Alloc, typename Growth>
+struct is_trivially_relocatable<vector<T, Alloc, Growth>> : public is_trivially_relocatable<Alloc> {
+};
+
 }  // namespace hf
@@ -0,0 +1,239 @@
+#include <utility>
+#include <vector>
+
+#include "deque.hpp"
+#include "memory_resource.hpp"
+#include "string.hpp"
+#include "test_util.hpp"
+#include "tracking_allocator.hpp"
+#include "vector.hpp"
+
+namespace {
+
+template <typename T, bool POCCA, bool POCMA, bool POCS>
+using alloc = hf_test::tracking_allocator<T, POCCA, POCMA, POCS>;
+
+template <typename Alloc>
+using string_with = hf::basic_string<char, hf::char_traits<char>, Alloc>;
+
+template <typename T, typename Alloc>
+void add(hf::vector<T, Alloc>& c, int x) {
+  c.push_back(static_cast<T>(x));
+}
+
+template <typename T, typename Alloc>
+void add(hf::deque<T, Alloc>& c, int x) {
+  c.push_back(static_cast<T>(x));
+}
+
+template <typename Alloc>
+void add(string_with<Alloc>& c, int x) {
+  c.append(1, static_cast<char>(x));
+}
+
+// small values, so they fit a char
+std::vector<int> make_model(size_t n, int first) {
+  std::vector<int> model;
+  for (size_t i = 0; i < n; ++i) model.push_back((first + static_cast<int>(i)) % 100 + 1);
+  return model;
+}
+
+template <typename C>
+C make(const std::vector<int>& model, const typename C::allocator_type& a) {
+  C c(a);
+  for (int x : model) add(c, x);
+  return c;
+}
+
+template <typename C>
+bool same(const C& c, const std::vector<int>& model) {
+  if (static_cast<size_t>(c.end() - c.begin()) != model.size()) return false;
+  size_t i = 0;
+  for (auto& x : c) {
+    if (static_cast<int>(x) != model[i++]) return false;
+  }
+  return true;
+}
+
+template <typename C>
+int id_of(const C& c) {
+  return c.get_allocator().id;
+}
+
+// every block went back to the allocator that handed it out, tracking_allocator checks
+// that on each deallocation and counts what is still out per id
+bool all_returned() { return hf_test::outstanding(1) == 0 && hf_test::outstanding(2) == 0; }
+
+// copy construction, copy and move assignment and swap between containers on allocators
+// 1 and 2, which compare unequal, and for move and swap without propagation also between
+// two equal ones. Container takes the allocator, T is its value type
+template <template <typename> class Container, typename T, bool POCCA, bool POCMA, bool POCS>
+void check_propagation(size_t n) {
+  typedef Container<alloc<T, POCCA, POCMA, POCS>> C;
+  typedef typename C::allocator_type A;
+  auto ma = make_model(n, 0);
+  auto mb = make_model(n / 2 + 3, 50);
+
+  {
+    auto x = make<C>(ma, A(1));
+    C copy(x);
+    HF_CHECK(id_of(copy) == 1 && same(copy, ma));
+  }
+  HF_CHECK(all_returned());
+
+  {
+    auto x = make<C>(ma, A(1));
+    auto y = make<C>(mb, A(2));
+    y = x;
+    HF_CHECK(same(y, ma) && same(x, ma));
+    HF_CHECK(id_of(y) == (POCCA ? 1 : 2) && id_of(x) == 1);
+    // whatever y allocated with 2 before has gone back to 2 by now
+    if (POCCA) HF_CHECK(hf_test::outstanding(2) == 0);
+    add(y, 7);  // y keeps growing with the allocator it ended up with
+  }
+  HF_CHECK(all_returned());
+
+  {
+    auto x = make<C>(ma, A(1));
+    auto y = make<C>(mb, A(2));
+    y = std::move(x);
+    HF_CHECK(same(y, ma));
+    HF_CHECK(id_of(y) == (POCMA ? 1 : 2));
+    // without propagation nothing of x can be stolen, y copied it into its own memory
+    if (!POCMA) HF_CHECK(x.begin() == x.end());
+    if (POCMA) HF_CHECK(hf_test::outstanding(2) == 0);
+    add(y, 7);
+    add(x, 7);  // the moved-from container is usable
+  }
+  HF_CHECK(all_returned());
+
+  {
+    auto x = make<C>(ma, A(1));
+    auto y = make<C>(mb, A(1));
+    y = std::move(x);
+    HF_CHECK(same(y, ma) && id_of(y) == 1);
+  }
+  HF_CHECK(all_returned());
+
+  {
+    // swapping unequal allocators that do not propagate is undefined, only equal ones then
+    auto x = make<C>(ma, A(1));
+    auto y = make<C>(mb, A(POCS ? 2 : 1));
+    x.swap(y);
+    HF_CHECK(same(x, mb) && same(y, ma));
+    HF_CHECK(id_of(x) == (POCS ? 2 : 1) && id_of(y) == 1);
+    add(x, 7);
+    add(y, 7);
+  }
+  HF_CHECK(all_returned());
+}
+
+template <typename A>
+using vector_of_int = hf::vector<int, A>;
+
+template <typename A>
+using deque_of_int = hf::deque<int, A>;
+
+template <template <typename> class Container, typename T>
+void check_all_traits(size_t n) {
+  check_propagation<Container, T, false, false, false>(n);
+  check_propagation<Container, T, true, false, false>(n);
+  check_propagation<Container, T, false, true, false>(n);
+  check_propagation<Container, T, false, false, true>(n);
+  check_propagation<Container, T, true, true, true>(n);
+}
+
+// hands a copied container allocator 2 instead of its own
+template <typename T>
+struct fresh_on_copy : hf_test::tracking_allocator<T> {
+  explicit fresh_on_copy(int id = 0) noexcept : hf_test::tracking_allocator<T>(id) {}
+
+  fresh_on_copy select_on_container_copy_construction() const noexcept {
+    return fresh_on_copy(2);
+  }
+};
+
+template <typename C>
+void check_select_on_copy(size_t n) {
+  typedef typename C::allocator_type A;
+  auto model = make_model(n, 0);
+  {
+    auto x = make<C>(model, A(1));
+    C copy(x);
+    HF_CHECK(id_of(copy) == 2 && same(copy, model));
+    add(copy, 7);
+  }
+  HF_CHECK(all_returned());
+}
+
+// the resources a polymorphic container allocates from, the arena one is told apart from
+// the heap by address
+template <typename C>
+void check_polymorphic(size_t n) {
+  typedef typename C::allocator_type A;
+  auto model = make_model(n, 0);
+
+  char buffer[1 << 16];
+  hf::arena a(buffer, sizeof(buffer));
+  hf::arena_resource arena_res(a);
+  auto in_arena = [&](const C& c) {
+    auto p = reinterpret_cast<const char*>(&*c.begin());
+    return p >= buffer && p < buffer + sizeof(buffer);
+  };
+
+  auto x = make<C>(model, A(&arena_res));
+  HF_CHECK(same(x, model) && in_arena(x));
+
+  // copies go to the default resource, like std::pmr
+  C copy(x);
+  HF_CHECK(copy.get_allocator().resource() == hf::get_default_resource());
+  HF_CHECK(same(copy, model) && !in_arena(copy));
+
+  auto old = hf::set_default_resource(&arena_res);
+  C arena_copy(copy);
+  HF_CHECK(arena_copy.get_allocator().resource() == &arena_res && in_arena(arena_copy));
+  hf::set_default_resource(old);
+
+  // nothing propagates, the target keeps its resource and copies the elements over
+  auto y = make<C>(make_model(n / 2 + 3, 50), A(hf::pool_resource()));
+  y = x;
+  HF_CHECK(same(y, model) && y.get_allocator().resource() == hf::pool_resource());
+  auto z = make<C>(make_model(3, 9), A(hf::new_delete_resource()));
+  z = std::move(x);
+  HF_CHECK(same(z, model) && !in_arena(z));
+  HF_CHECK(z.get_allocator().resource() == hf::new_delete_resource());
+
+  // two arena_resources over the same arena are equal, so storage moves over as it is
+  hf::arena_resource same_arena(a);
+  auto w = make<C>(model, A(&arena_res));
+  auto first = &*w.begin();
+  C v{A(&same_arena)};
+  v = std::move(w);
+  HF_CHECK(same(v, model) && &*v.begin() == first);
+}
+
+}  // namespace
+
+HF_TEST(allocator, vector_propagation) {
+  check_all_traits<vector_of_int, int>(100);
+  check_select_on_copy<hf::vector<int, fresh_on_copy<int>>>(100);
+}
+
+// short strings stay inline, long ones are on the heap
+HF_TEST(allocator, string_propagation) {
+  check_all_traits<string_with, char>(5);
+  check_all_traits<string_with, char>(100);
+  check_select_on_copy<string_with<fresh_on_copy<char>>>(100);
+}
+
+// a few blocks per deque, the map is not allocated through Alloc
+HF_TEST(allocator, deque_propagation) {
+  check_all_traits<deque_of_int, int>(3000);
+  check_select_on_copy<hf::deque<int, fresh_on_copy<int>>>(3000);
+}
+
+HF_TEST(allocator, polymorphic) {
+  check_polymorphic<hf::vector<int, hf::polymorphic_allocator<int>>>(100);
+  check_polymorphic<string_with<hf::polymorphic_allocator<char>>>(100);
+  check_polymorphic<hf::deque<int, hf::polymorphic_allocator<int>>>(3000);
+}
@@ -0,0 +1,146 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "arena.hpp"
+#include "string.hpp"
+#include "test_util.hpp"
+#include "vector.hpp"
+
+namespace {
+
+bool inside(const void* p, const char* buffer, size_t size) {
+  auto c = static_cast<const char*>(p);
+  return c >= buffer && c < buffer + size;
+}
+
+bool aligned(const void* p, size_t align) {
+  return reinterpret_cast<uintptr_t>(p) % align == 0;
+}
+
+// a fixed mix of sizes and alignments, one per slot of out, every block is written to
+// its end so overlaps and blocks running past their chunk show up under the sanitizers
+void fill(hf::arena& a, std::vector<void*>& out) {
+  static const size_t aligns[] = {1, 8, 16, 64};
+  for (size_t i = 0; i < out.size(); ++i) {
+    auto bytes = 1 + i * 37 % 300;
+    auto align = aligns[i % 4];
+    auto p = a.allocate(bytes, align);
+    HF_CHECK(p != nullptr && aligned(p, align));
+    std::memset(p, static_cast<int>(i), bytes);
+    out[i] = p;
+  }
+}
+
+}  // namespace
+
+// the caller's buffer is used first, without touching the heap, then blocks are chained
+// past it
+HF_TEST(arena, stack_buffer_first) {
+  alignas(16) char buffer[4096];
+  hf::arena a(buffer, sizeof(buffer));
+
+  auto before = hf_test::allocations();
+  size_t used = 0;
+  for (int i = 0; i < 30; ++i) {
+    auto p = a.allocate(100);
+    HF_CHECK(inside(p, buffer, sizeof(buffer)));
+    used += 100;
+  }
+  HF_CHECK(a.used() == used);
+  HF_CHECK(hf_test::allocations() == before);
+
+  // more than the buffer has left, the first heap block
+  auto p = a.allocate(2000);
+  HF_CHECK(!inside(p, buffer, sizeof(buffer)));
+  HF_CHECK(hf_test::allocations() == before + 1);
+  std::memset(p, 1, 2000);
+
+  // larger than a whole block gets a block of its own size
+  auto big = a.allocate(3 * hf::arena::MAX_BLOCK_SIZE, 64);
+  HF_CHECK(aligned(big, 64));
+  std::memset(big, 2, 3 * hf::arena::MAX_BLOCK_SIZE);
+  HF_CHECK(hf_test::allocations() == before + 2);
+
+  // release frees the heap blocks and keeps the buffer for what comes next
+  a.release();
+  HF_CHECK(a.used() == 0);
+  HF_CHECK(inside(a.allocate(100), buffer, sizeof(buffer)));
+
+  // a buffer too small for the block header is not used at all
+  char tiny[8];
+  hf::arena b(tiny, sizeof(tiny));
+  HF_CHECK(!inside(b.allocate(1), tiny, sizeof(tiny)));
+}
+
+// reset only rewinds to the first block, the chain is kept and handed out again in the
+// same order, so the same requests land at the same addresses without any allocation
+HF_TEST(arena, reset_reuses_blocks) {
+  alignas(16) char buffer[1024];
+  hf::arena heap_only;
+  hf::arena buffered(buffer, sizeof(buffer));
+  for (hf::arena* arena : {&heap_only, &buffered}) {
+    auto& a = *arena;
+    std::vector<void*> first(5000);
+    std::vector<void*> again(5000);
+    fill(a, first);
+    auto used = a.used();
+    HF_CHECK(used > 4 * hf::arena::BLOCK_SIZE);
+
+    for (int round = 0; round < 3; ++round) {
+      auto before = hf_test::allocations();
+      a.reset();
+      HF_CHECK(a.used() == 0);
+      fill(a, again);
+      HF_CHECK(hf_test::allocations() == before);
+      HF_CHECK(again == first);
+      HF_CHECK(a.used() == used);
+    }
+
+    // asking for more than was ever used goes past the kept chain
+    auto before = hf_test::allocations();
+    a.allocate(hf::arena::MAX_BLOCK_SIZE);
+    HF_CHECK(hf_test::allocations() == before + 1);
+  }
+}
+
+// containers on arena_alloc take their memory from the arena of the scope, deallocation
+// is a no-op and the next reset hands the same memory to the next round
+HF_TEST(arena, containers_on_arena_alloc) {
+  alignas(16) char buffer[1 << 16];
+  hf::arena a(buffer, sizeof(buffer));
+  hf::arena_scope scope(a);
+
+  typedef hf::vector<int, hf::arena_alloc<int>> int_vector;
+  typedef hf::basic_string<char, hf::char_traits<char>, hf::arena_alloc<char>> arena_string;
+
+  const int* last_data = nullptr;
+  for (int round = 0; round < 4; ++round) {
+    auto before = hf_test::allocations();
+    {
+      int_vector v;
+      for (int i = 0; i < 1000; ++i) v.push_back(i * 3);
+      v.insert(v.begin() + 10, 5, -1);
+      v.erase(v.begin(), v.begin() + 3);
+      HF_CHECK(v.size() == 1002 && v[0] == 9 && v[7] == -1 && v[12] == 30);
+      HF_CHECK(inside(v.data(), buffer, sizeof(buffer)));
+      HF_CHECK(v.get_allocator().get_arena() == &a);
+      if (round > 0) HF_CHECK(v.data() == last_data);
+      last_data = v.data();
+
+      arena_string s("short");
+      for (int i = 0; i < 200; ++i) s.append(1, static_cast<char>('a' + i % 26));
+      HF_CHECK(s.size() == 205 && s.c_str()[205] == '\0');
+      HF_CHECK(std::memcmp(s.data(), "shortabc", 8) == 0 && s[30] == 'z');
+      HF_CHECK(inside(s.data(), buffer, sizeof(buffer)));
+
+      arena_string copy(s);
+      HF_CHECK(copy == s && copy.data() != s.data());
+      int_vector moved(std::move(v));
+      HF_CHECK(moved.size() == 1002 && v.empty());
+    }
+    HF_CHECK(hf_test::allocations() == before);
+    HF_CHECK(a.used() > 4000);
+    a.reset();
+  }
+}
@@ -0,0 +1,261 @@
+#include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "btree_map.hpp"
+#include "btree_set.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+template <typename T>
+const T& key_of(const T& key) {
+  return key;
+}
+
+template <typename K, typename V>
+const K& key_of(const hf::pair<const K, V>& kv) {
+  return kv.first;
+}
+
+template <typename K, typename V>
+const K& key_of(const std::pair<const K, V>& kv) {
+  return kv.first;
+}
+
+template <typename T>
+bool same_value(const T& a, const T& b) {
+  return a == b;
+}
+
+template <typename K, typename V>
+bool same_value(const hf::pair<const K, V>& a, const std::pair<const K, V>& b) {
+  return a.first == b.first && a.second == b.second;
+}
+
+// same values in the same order, walked forwards from begin() and backwards from end()
+template <typename Tree, typename Model>
+void check_same(const Tree& tree, const Model& model) {
+  HF_CHECK(tree.size() == model.size());
+  HF_CHECK(tree.empty() == model.empty());
+
+  auto it = tree.begin();
+  for (auto& value : model) {
+    if (it == tree.end()) break;
+    HF_CHECK(same_value(*it, value));
+    ++it;
+  }
+  HF_CHECK(it == tree.end());
+
+  it = tree.end();
+  for (auto m = model.rbegin(); m != model.rend(); ++m) {
+    if (it == tree.begin()) break;
+    --it;
+    HF_CHECK(same_value(*it, *m));
+  }
+  HF_CHECK(it == tree.begin());
+}
+
+// the iterator a bound returned and the model's agree on the position
+template <typename Tree, typename Model>
+void check_bound(const Tree& tree, typename Tree::const_iterator it, const Model& model,
+                 typename Model::const_iterator m) {
+  HF_CHECK((it == tree.end()) == (m == model.end()));
+  if (it != tree.end() && m != model.end()) HF_CHECK(key_of(*it) == key_of(*m));
+}
+
+template <typename Tree, typename Model>
+void check_bounds(const Tree& tree, const Model& model, const typename Tree::key_type& key) {
+  check_bound(tree, tree.lower_bound(key), model, model.lower_bound(key));
+  check_bound(tree, tree.upper_bound(key), model, model.upper_bound(key));
+  check_bound(tree, tree.find(key), model, model.find(key));
+  HF_CHECK(tree.contains(key) == (model.count(key) != 0));
+}
+
+// random mix against std::map, the key range decides how full the tree gets and so how
+// often nodes split, borrow and merge
+void check_map(int key_range, int rounds) {
+  auto& gen = hf_test::rng();
+  hf::btree_map<int, int> tree;
+  std::map<int, int> model;
+
+  for (int round = 0; round < rounds; ++round) {
+    int key = static_cast<int>(gen() % static_cast<uint32_t>(key_range)) - key_range / 2;
+    int value = static_cast<int>(gen() % 1000);
+
+    switch (gen() % 8) {
+      case 0:
+      case 1: {
+        auto r = tree.insert(hf::pair<const int, int>(key, value));
+        auto m = model.insert({key, value});
+        HF_CHECK(r.second == m.second && r.first->second == m.first->second);
+        break;
+      }
+      case 2:
+        tree[key] += value;
+        model[key] += value;
+        break;
+      case 3:
+      case 4:
+        HF_CHECK(tree.erase(key) == model.erase(key));
+        break;
+      case 5: {
+        auto it = tree.lower_bound(key);
+        auto m = model.lower_bound(key);
+        if (it != tree.end() && m != model.end()) {
+          HF_CHECK(it->first == m->first);
+          tree.erase(it);
+          model.erase(m);
+        }
+        break;
+      }
+      case 6:
+        check_bounds(tree, model, key);
+        break;
+      default:
+        if (gen() % 128 == 0) {
+          check_same(tree, model);
+
+          auto bit = 1 << (gen() % 4);
+          auto pred = [bit](const auto& kv) { return (kv.second & bit) != 0; };
+          size_t expect = 0;
+          for (auto m = model.begin(); m != model.end();) {
+            if (pred(*m)) {
+              m = model.erase(m);
+              ++expect;
+            } else {
+              ++m;
+            }
+          }
+          HF_CHECK(hf::erase_if(tree, pred) == expect);
+          check_same(tree, model);
+
+          hf::btree_map<int, int> copy(tree);
+          hf::btree_map<int, int> moved(std::move(copy));
+          HF_CHECK(copy.empty());
+          check_same(moved, model);
+          copy = moved;
+          tree = std::move(copy);
+          check_same(tree, model);
+        }
+        break;
+    }
+  }
+  check_same(tree, model);
+  for (int key = -key_range / 2 - 1; key <= key_range / 2 + 1; ++key) {
+    check_bounds(tree, model, key);
+  }
+}
+
+// insert and erase of keys drawn by next_key, with bounds probed on keys around them
+template <typename Key, typename NextKey>
+void check_set(NextKey next_key, int rounds) {
+  auto& gen = hf_test::rng();
+  hf::btree_set<Key> tree;
+  std::set<Key> model;
+
+  for (int round = 0; round < rounds; ++round) {
+    Key key = next_key();
+    switch (gen() % 4) {
+      case 0:
+      case 1:
+        HF_CHECK(tree.insert(key).second == model.insert(key).second);
+        break;
+      case 2:
+        HF_CHECK(tree.erase(key) == model.erase(key));
+        break;
+      default:
+        check_bounds(tree, model, key);
+        check_bounds(tree, model, static_cast<Key>(key + 1));
+        check_bounds(tree, model, static_cast<Key>(key - 1));
+        break;
+    }
+  }
+  check_same(tree, model);
+  for (auto key : model) {
+    check_bounds(tree, model, key);
+    check_bounds(tree, model, static_cast<Key>(key + 1));
+  }
+}
+
+}  // namespace
+
+HF_TEST(btree, map_random_ops) {
+  check_map(40, 20000);
+  check_map(4000, 200000);
+}
+
+// unsigned keys on both sides of the sign bit, the AVX2 search flips that bit to compare
+// them as signed, a missing bias puts every key >= 2^63 before the small ones
+HF_TEST(btree, set_unsigned_high_keys) {
+  auto& gen = hf_test::rng();
+  auto wide = [&] {
+    auto low = static_cast<uint64_t>(gen() % 3000);
+    switch (gen() % 4) {
+      case 0:
+        return low;
+      case 1:
+        return (uint64_t(1) << 63) + low;
+      case 2:
+        return ~low;
+      default:
+        return (uint64_t(1) << 63) - 1 - low;
+    }
+  };
+  check_set<uint64_t>(wide, 100000);
+
+  auto narrow = [&] {
+    auto low = static_cast<uint32_t>(gen() % 3000);
+    return gen() % 2 == 0 ? low : (uint32_t(1) << 31) + low;
+  };
+  check_set<uint32_t>(narrow, 100000);
+
+  auto negative = [&] { return static_cast<int64_t>(gen() % 6000) - 3000; };
+  check_set<int64_t>(negative, 50000);
+}
+
+// sizes around one full leaf, a full leaf plus one and a full two level tree, where the
+// bulk build changes shape
+HF_TEST(btree, assign_sorted) {
+  typedef hf::btree_set<uint64_t> tree_type;
+  constexpr size_t N = tree_type::NODE_SLOTS;
+
+  std::vector<size_t> sizes = {0, 1, 2, 1000};
+  for (size_t n : {N, 2 * N + 1, (N + 1) * (N + 1), (N + 1) * (N + 1) * 3}) {
+    for (size_t d = 0; d < 5; ++d) sizes.push_back(n + d - 1);
+  }
+
+  auto& gen = hf_test::rng();
+  for (size_t n : sizes) {
+    std::vector<uint64_t> sorted(n);
+    for (size_t i = 0; i < n; ++i) sorted[i] = (uint64_t(1) << 62) + i * 3;
+
+    tree_type tree;
+    tree.insert(uint64_t(7));  // replaced by the assignment
+    tree.assign_sorted(sorted.begin(), sorted.end());
+    std::set<uint64_t> model(sorted.begin(), sorted.end());
+    check_same(tree, model);
+
+    // the packed tree still takes inserts and erases
+    for (size_t i = 0; i < 200; ++i) {
+      auto key = (uint64_t(1) << 62) + gen() % (3 * n + 10);
+      if (gen() % 2 == 0) {
+        HF_CHECK(tree.insert(key).second == model.insert(key).second);
+      } else {
+        HF_CHECK(tree.erase(key) == model.erase(key));
+      }
+      check_bounds(tree, model, key);
+    }
+    check_same(tree, model);
+  }
+
+  hf::btree_map<int, int> map;
+  std::vector<hf::pair<int, int>> pairs;
+  for (int i = 0; i < 1000; ++i) pairs.push_back(hf::pair<int, int>(i * 2, i));
+  map.assign_sorted(pairs.begin(), pairs.end());
+  HF_CHECK(map.size() == 1000);
+  for (int i = 0; i < 1000; ++i) HF_CHECK(map.at(i * 2) == i);
+  HF_CHECK(!map.contains(1));
+}
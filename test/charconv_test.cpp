@@ -0,0 +1,206 @@
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "charconv.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+template <typename T>
+bool same(T a, T b) {
+  return a == b;
+}
+
+// bit for bit, so -0.0 differs from 0.0 and any nan matches any other
+bool same(double a, double b) {
+  return std::isnan(a) ? std::isnan(b) : std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+uint64_t random_bits() {
+  auto& gen = hf_test::rng();
+  auto x = (static_cast<uint64_t>(gen()) << 32) | gen();
+  // every bit length shows up, not just values near the top of the range
+  return x >> (gen() % 64);
+}
+
+// hf::to_chars writes what std::to_chars writes, and reports a buffer one short of the
+// output as too small the same way, for single digits that is an empty buffer
+template <typename T>
+void check_to_chars(T value) {
+  char expect[64];
+  auto e = std::to_chars(expect, expect + sizeof(expect), value);
+  HF_CHECK(e.ec == std::errc());
+  auto len = static_cast<size_t>(e.ptr - expect);
+
+  char buf[64];
+  auto r = hf::to_chars(buf, buf + sizeof(buf), value);
+  HF_CHECK(r.ec == std::errc());
+  HF_CHECK(static_cast<size_t>(r.ptr - buf) == len && std::memcmp(buf, expect, len) == 0);
+
+  auto small = hf::to_chars(buf, buf + len - 1, value);
+  HF_CHECK(small.ec == std::errc::value_too_large && small.ptr == buf + len - 1);
+}
+
+// the same stop position, error and value as std::from_chars, the value stays untouched
+// on error
+template <typename T>
+void check_from_chars(const std::string& s) {
+  const char* first = s.data();
+  const char* last = s.data() + s.size();
+
+  T expect = T(42);
+  auto e = std::from_chars(first, last, expect);
+  T value = T(42);
+  auto r = hf::from_chars(first, last, value);
+
+  HF_CHECK(r.ec == e.ec);
+  HF_CHECK(r.ptr == e.ptr);
+  HF_CHECK(same(value, expect));
+}
+
+// digits with an optional sign, leading zeros, too many digits and trailing junk
+std::string random_number_text() {
+  auto& gen = hf_test::rng();
+  std::string s;
+  switch (gen() % 8) {
+    case 0:
+      s += '-';
+      break;
+    case 1:
+      s += '+';
+      break;
+    case 2:
+      s += "00";
+      break;
+    default:
+      break;
+  }
+  auto digits = gen() % 24;
+  for (size_t i = 0; i < digits; ++i) s += static_cast<char>('0' + gen() % 10);
+  if (gen() % 4 == 0) s += " x-9"[gen() % 4];
+  return s;
+}
+
+template <typename T>
+void check_integers() {
+  typedef std::numeric_limits<T> limits;
+  std::vector<T> edges = {T(0), T(1), T(9), T(10), T(99), T(100), limits::max(), limits::min(),
+                          T(limits::max() - 1), T(limits::min() + 1)};
+  if (std::is_signed<T>::value) edges.push_back(T(-1));
+  for (auto v : edges) {
+    check_to_chars(v);
+    check_from_chars<T>(std::to_string(v));
+  }
+
+  for (int round = 0; round < 20000; ++round) {
+    auto v = static_cast<T>(random_bits());
+    check_to_chars(v);
+
+    char buf[32];
+    auto r = hf::to_chars(buf, buf + sizeof(buf), v);
+    check_from_chars<T>(std::string(buf, r.ptr));
+    check_from_chars<T>(random_number_text());
+  }
+
+  // one past either end of the range
+  check_from_chars<T>(std::to_string(static_cast<unsigned long long>(limits::max())) + "0");
+  if (std::is_signed<T>::value) {
+    check_from_chars<T>(std::to_string(static_cast<long long>(limits::min())) + "0");
+  }
+}
+
+}  // namespace
+
+HF_TEST(charconv, integers) {
+  check_integers<int8_t>();
+  check_integers<uint8_t>();
+  check_integers<int16_t>();
+  check_integers<uint16_t>();
+  check_integers<int32_t>();
+  check_integers<uint32_t>();
+  check_integers<int64_t>();
+  check_integers<uint64_t>();
+}
+
+HF_TEST(charconv, integer_edges) {
+  char buf[32];
+  auto r = hf::to_chars(buf, buf + sizeof(buf), INT64_MIN);
+  HF_CHECK(std::string(buf, r.ptr) == "-9223372036854775808");
+  r = hf::to_chars(buf, buf + sizeof(buf), UINT64_MAX);
+  HF_CHECK(std::string(buf, r.ptr) == "18446744073709551615");
+
+  // room for the sign only
+  r = hf::to_chars(buf, buf + 1, int64_t(-5));
+  HF_CHECK(r.ec == std::errc::value_too_large && r.ptr == buf + 1);
+
+  check_from_chars<int64_t>("-9223372036854775808");
+  check_from_chars<int64_t>("-9223372036854775809");
+  check_from_chars<int64_t>("9223372036854775808");
+  check_from_chars<uint64_t>("18446744073709551615");
+  check_from_chars<uint64_t>("18446744073709551616");
+  check_from_chars<uint64_t>("99999999999999999999999");
+
+  // a sign is not part of an unsigned number, a lone '-' is no number at all
+  for (const char* s : {"-", "-1", "-0", "+1", "", " 1"}) {
+    check_from_chars<uint64_t>(s);
+    check_from_chars<uint32_t>(s);
+    check_from_chars<int64_t>(s);
+  }
+
+  uint64_t u = 7;
+  auto p = hf::from_chars(buf, buf, u);
+  HF_CHECK(p.ec == std::errc::invalid_argument && p.ptr == buf && u == 7);
+  const char minus_one[] = "-1";
+  p = hf::from_chars(minus_one, minus_one + 2, u);
+  HF_CHECK(p.ec == std::errc::invalid_argument && p.ptr == minus_one && u == 7);
+}
+
+// every whole number the integer shortcut takes prints as std::to_chars prints it, the
+// values just outside it take the general path
+HF_TEST(charconv, double_whole_numbers) {
+  for (int i = -100005; i <= 100005; ++i) check_to_chars(static_cast<double>(i));
+  for (double d : {-0.0, 0.0, 0.5, -0.5, 99999.5, -99999.5, 1e5, 1e15, 1e16, 1e17, 1e21, 1e22,
+                   123456789.0, 4294967296.0, -2147483648.0, 1e-7, 5e-324, 1.7976931348623157e308,
+                   std::numeric_limits<double>::infinity(),
+                   -std::numeric_limits<double>::infinity()}) {
+    check_to_chars(d);
+  }
+
+  char buf[32];
+  auto r = hf::to_chars(buf, buf + sizeof(buf), -0.0);
+  HF_CHECK(std::string(buf, r.ptr) == "-0");
+}
+
+// any bit pattern prints as std::to_chars prints it and reads back to the same bits
+HF_TEST(charconv, double_bit_patterns) {
+  auto& gen = hf_test::rng();
+  for (int round = 0; round < 100000; ++round) {
+    auto bits = (static_cast<uint64_t>(gen()) << 32) | gen();
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    if (std::isnan(d)) continue;
+    check_to_chars(d);
+
+    char buf[32];
+    auto r = hf::to_chars(buf, buf + sizeof(buf), d);
+    double back = 0;
+    auto p = hf::from_chars(buf, r.ptr, back);
+    HF_CHECK(p.ec == std::errc() && p.ptr == r.ptr);
+    HF_CHECK(same(back, d));
+
+    float f;
+    auto fbits = static_cast<uint32_t>(bits);
+    std::memcpy(&f, &fbits, sizeof(f));
+    if (!std::isnan(f)) check_to_chars(f);
+  }
+
+  for (const char* s : {"1e400", "-1e400", "1e-400", "nan", "inf", "-inf", "1.5e", "e5", "-",
+                        ".5", "5.", "0x1p3", "  1"}) {
+    check_from_chars<double>(s);
+  }
+}
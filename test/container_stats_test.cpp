@@ -0,0 +1,229 @@
+#include <cctype>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "container_stats.hpp"
+#include "test_util.hpp"
+#include "vector.hpp"
+
+static_assert(hf::stats::enabled, "hf_stats_test is built with HF_CONTAINER_STATS");
+
+namespace {
+
+typedef hf::vector<int> int_vector;
+
+hf::stats::snapshot counters() { return hf::stats::of<int_vector>().get(); }
+
+// a strict reader for the subset of JSON dump_json writes, objects, arrays, strings and
+// unsigned numbers. Each container object becomes a map of its fields, numbers kept as
+// their text, and any deviation from the grammar makes ok false
+class json_reader {
+ public:
+  explicit json_reader(std::string text) : _s(std::move(text)) {}
+
+  std::vector<std::map<std::string, std::string>> containers() {
+    std::vector<std::map<std::string, std::string>> out;
+    expect('{');
+    if (string() != "containers") ok = false;
+    expect(':');
+    expect('[');
+    if (!peek(']')) {
+      do {
+        out.push_back(object());
+      } while (ok && accept(','));
+    }
+    expect(']');
+    expect('}');
+    skip_space();
+    if (_pos != _s.size()) ok = false;
+    return out;
+  }
+
+  bool ok = true;
+
+ private:
+  std::map<std::string, std::string> object() {
+    std::map<std::string, std::string> fields;
+    expect('{');
+    do {
+      auto key = string();
+      expect(':');
+      auto value = peek('"') ? string() : number();
+      if (!fields.emplace(key, value).second) ok = false;
+    } while (ok && accept(','));
+    expect('}');
+    return fields;
+  }
+
+  std::string string() {
+    std::string r;
+    expect('"');
+    while (ok && _pos < _s.size() && _s[_pos] != '"') {
+      auto c = _s[_pos++];
+      if (static_cast<unsigned char>(c) < 0x20) ok = false;
+      if (c == '\\') {
+        if (_pos == _s.size() || (_s[_pos] != '"' && _s[_pos] != '\\')) ok = false;
+        if (ok) c = _s[_pos++];
+      }
+      r += c;
+    }
+    if (_pos == _s.size()) ok = false;
+    ++_pos;
+    return r;
+  }
+
+  std::string number() {
+    skip_space();
+    auto first = _pos;
+    while (_pos < _s.size() && std::isdigit(static_cast<unsigned char>(_s[_pos]))) ++_pos;
+    if (_pos == first || (_s[first] == '0' && _pos - first > 1)) ok = false;
+    return _s.substr(first, _pos - first);
+  }
+
+  void skip_space() {
+    while (_pos < _s.size() && std::isspace(static_cast<unsigned char>(_s[_pos]))) ++_pos;
+  }
+
+  bool peek(char c) {
+    skip_space();
+    return _pos < _s.size() && _s[_pos] == c;
+  }
+
+  bool accept(char c) {
+    if (!peek(c)) return false;
+    ++_pos;
+    return true;
+  }
+
+  void expect(char c) {
+    if (!accept(c)) ok = false;
+  }
+
+  std::string _s;
+  size_t _pos = 0;
+};
+
+}  // namespace
+
+// a reserved buffer filled to the brim, one element more and a few shifts, every step
+// with the counts it has to leave behind
+HF_TEST(container_stats, vector_known_sequence) {
+  hf::stats::reset();
+  {
+    int_vector v;
+    v.reserve(8);
+    for (int i = 0; i < 8; ++i) v.push_back(i);
+    auto s = counters();
+    HF_CHECK(s.allocations == 1 && s.bytes == 8 * sizeof(int));
+    HF_CHECK(s.reallocations == 0 && s.moves == 0 && s.wasted_bytes == 0);
+
+    // full, the ninth element moves the eight into a new buffer
+    v.push_back(8);
+    auto cap = v.capacity();
+    s = counters();
+    HF_CHECK(cap > 9);
+    HF_CHECK(s.allocations == 2 && s.bytes == (8 + cap) * sizeof(int));
+    HF_CHECK(s.reallocations == 1 && s.moves == 8 && s.wasted_bytes == 0);
+
+    // in place, everything after the position shifts by one
+    v.insert(v.begin() + 2, 100);
+    v.erase(v.begin());
+    s = counters();
+    HF_CHECK(v.capacity() == cap && s.allocations == 2 && s.reallocations == 1);
+    HF_CHECK(s.moves == 8 + 7 + 9);
+  }
+  // the unused tail of the last buffer is counted when it goes
+  auto s = counters();
+  HF_CHECK(s.wasted_bytes == (s.bytes / sizeof(int) - 8 - 9) * sizeof(int));
+}
+
+// growth from empty by push_back alone, the counters follow every capacity change
+HF_TEST(container_stats, vector_push_growth) {
+  hf::stats::reset();
+  size_t allocations = 0;
+  size_t bytes = 0;
+  size_t moves = 0;
+  size_t cap = 0;
+  {
+    int_vector v;
+    for (int i = 0; i < 10000; ++i) {
+      auto old_size = v.size();
+      v.push_back(i);
+      if (v.capacity() == cap) continue;
+      ++allocations;
+      bytes += v.capacity() * sizeof(int);
+      moves += old_size;
+      cap = v.capacity();
+    }
+    auto s = counters();
+    HF_CHECK(allocations > 10 && s.allocations == allocations);
+    HF_CHECK(s.reallocations == allocations - 1);
+    HF_CHECK(s.bytes == bytes && s.moves == moves && s.wasted_bytes == 0);
+  }
+  HF_CHECK(counters().wasted_bytes == (cap - 10000) * sizeof(int));
+
+  hf::stats::reset();
+  auto s = counters();
+  HF_CHECK(s.allocations == 0 && s.bytes == 0 && s.reallocations == 0 && s.moves == 0);
+}
+
+// every registered container shows up as one well formed object whose numbers match
+// its counters, names that need escaping included
+HF_TEST(container_stats, dump_json_well_formed) {
+  // registered entries live for the rest of the process
+  static auto odd = new hf::stats::entry("odd \"quoted\" \\ name");
+  odd->add_allocation(3);
+
+  hf::stats::reset();
+  {
+    int_vector v;
+    for (int i = 0; i < 100; ++i) v.push_back(i);
+  }
+  odd->add_moves(5);
+
+  std::ostringstream os;
+  hf::stats::dump_json(os);
+  json_reader reader(os.str());
+  auto containers = reader.containers();
+  HF_CHECK(reader.ok);
+
+  size_t registered = 0;
+  hf::stats::for_each([&](const hf::stats::entry&) { ++registered; });
+  HF_CHECK(containers.size() == registered);
+
+  const char* fields[] = {"type", "allocations", "bytes", "reallocations", "wasted_bytes",
+                          "moves"};
+  bool found_vector = false;
+  bool found_odd = false;
+  for (auto& c : containers) {
+    HF_CHECK(c.size() == 6);
+    for (auto f : fields) HF_CHECK(c.count(f) == 1);
+
+    const hf::stats::entry* e = nullptr;
+    hf::stats::for_each([&](const hf::stats::entry& x) {
+      if (x.name() == c["type"]) e = &x;
+    });
+    HF_CHECK(e != nullptr);
+    if (e == nullptr) continue;
+    auto s = e->get();
+    HF_CHECK(c["allocations"] == std::to_string(s.allocations));
+    HF_CHECK(c["bytes"] == std::to_string(s.bytes));
+    HF_CHECK(c["reallocations"] == std::to_string(s.reallocations));
+    HF_CHECK(c["wasted_bytes"] == std::to_string(s.wasted_bytes));
+    HF_CHECK(c["moves"] == std::to_string(s.moves));
+
+    if (e == &hf::stats::of<int_vector>()) found_vector = s.allocations > 0;
+    if (e == odd) found_odd = s.moves == 5 && c["type"] == "odd \"quoted\" \\ name";
+  }
+  HF_CHECK(found_vector && found_odd);
+
+  // nothing registered yet would still be valid, and a broken document is caught
+  json_reader empty("{\"containers\": []}\n");
+  HF_CHECK(empty.containers().empty() && empty.ok);
+  json_reader broken("{\"containers\": [{\"type\": \"a\", \"moves\": 1,}]}\n");
+  broken.containers();
+  HF_CHECK(!broken.ok);
+}
@@ -0,0 +1,200 @@
+#include <cstdint>
+#include <deque>
+#include <utility>
+
+#include "deque.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+// large enough for blocks of 16, so short runs already cross block boundaries, and
+// counted so every element constructed is destroyed exactly once
+struct wide {
+  static long long live;
+
+  uint64_t value;
+  uint64_t pad[39];
+
+  wide(uint64_t v = 0) noexcept : value(v) { ++live; }
+  wide(const wide& rhs) noexcept : value(rhs.value) { ++live; }
+  wide& operator=(const wide& rhs) noexcept = default;
+  ~wide() { --live; }
+};
+
+long long wide::live = 0;
+
+uint64_t value_of(uint64_t x) { return x; }
+
+uint64_t value_of(const wide& x) { return x.value; }
+
+template <typename Deque>
+void check_same(const Deque& d, const std::deque<uint64_t>& model) {
+  HF_CHECK(d.size() == model.size());
+  HF_CHECK(d.empty() == model.empty());
+  if (d.size() != model.size()) return;
+
+  size_t i = 0;
+  for (auto& x : d) HF_CHECK(value_of(x) == model[i++]);
+  for (i = 0; i < model.size(); ++i) HF_CHECK(value_of(d[i]) == model[i]);
+  if (!model.empty()) {
+    HF_CHECK(value_of(d.front()) == model.front());
+    HF_CHECK(value_of(d.back()) == model.back());
+  }
+}
+
+// jumps between random positions, forwards and backwards over any number of blocks
+template <typename Deque>
+void check_iterators(const Deque& d, const std::deque<uint64_t>& model) {
+  auto& gen = hf_test::rng();
+  auto n = static_cast<ptrdiff_t>(d.size());
+  HF_CHECK(d.end() - d.begin() == n);
+
+  for (int round = 0; round < 200 && n != 0; ++round) {
+    auto i = static_cast<ptrdiff_t>(gen() % static_cast<uint32_t>(n));
+    auto j = static_cast<ptrdiff_t>(gen() % static_cast<uint32_t>(n + 1));
+
+    auto a = d.begin() + i;
+    auto b = d.end() - (n - j);
+    HF_CHECK(value_of(*a) == model[static_cast<size_t>(i)]);
+    HF_CHECK(b - a == j - i);
+    HF_CHECK(a - b == i - j);
+    HF_CHECK((a < b) == (i < j) && (a == b) == (i == j) && (a >= b) == (i >= j));
+
+    auto c = a;
+    c += j - i;
+    HF_CHECK(c == b);
+    c -= j - i;
+    HF_CHECK(c == a);
+    if (j < n) HF_CHECK(value_of(a[j - i]) == model[static_cast<size_t>(j)]);
+    if (i > 0) {
+      auto p = a;
+      --p;
+      HF_CHECK(value_of(*p) == model[static_cast<size_t>(i - 1)]);
+    }
+  }
+}
+
+template <typename T>
+void check_random_ops(int rounds) {
+  auto& gen = hf_test::rng();
+  hf::deque<T> d;
+  std::deque<uint64_t> model;
+
+  for (int round = 0; round < rounds; ++round) {
+    auto v = static_cast<uint64_t>(gen());
+    switch (gen() % 12) {
+      case 0:
+      case 1:
+        d.push_back(T(v));
+        model.push_back(v);
+        break;
+      case 2:
+      case 3:
+        d.emplace_front(v);
+        model.push_front(v);
+        break;
+      case 4:
+        if (!model.empty()) {
+          d.pop_back();
+          model.pop_back();
+        }
+        break;
+      case 5:
+        if (!model.empty()) {
+          d.pop_front();
+          model.pop_front();
+        }
+        break;
+      case 6:
+        if (!model.empty()) {
+          auto i = gen() % model.size();
+          d[i] = T(v);
+          model[i] = v;
+        }
+        break;
+      case 7:
+        if (gen() % 16 == 0) {
+          auto n = gen() % 300;
+          d.resize(n, T(v));
+          model.resize(n, v);
+        }
+        break;
+      case 8:
+        if (gen() % 64 == 0) {
+          d.clear();
+          model.clear();
+        }
+        break;
+      default:
+        if (gen() % 32 == 0) {
+          check_same(d, model);
+          check_iterators(d, model);
+
+          hf::deque<T> copy(d);
+          check_same(copy, model);
+          hf::deque<T> moved(std::move(copy));
+          HF_CHECK(copy.empty());
+          check_same(moved, model);
+
+          hf::deque<T> assigned;
+          assigned.push_back(T(1));
+          assigned = moved;
+          check_same(assigned, model);
+          moved = std::move(assigned);
+          check_same(moved, model);
+          d.swap(moved);
+          check_same(d, model);
+        }
+        break;
+    }
+  }
+  check_same(d, model);
+  check_iterators(d, model);
+}
+
+}  // namespace
+
+HF_TEST(deque, random_ops) {
+  check_random_ops<uint64_t>(50000);
+  check_random_ops<wide>(50000);
+  HF_CHECK(wide::live == 0);
+}
+
+// a queue that keeps its length walks through the map, reserve_map then recenters the
+// block pointers. One that slowly grows fills the map and makes it double. Both at the
+// back and, mirrored, at the front
+HF_TEST(deque, long_fifo) {
+  for (bool grow : {false, true}) {
+    for (bool forward : {true, false}) {
+      hf::deque<wide> d;
+      std::deque<uint64_t> model;
+      uint64_t next = 0;
+
+      for (int round = 0; round < 20000; ++round) {
+        if (forward) {
+          d.push_back(wide(next));
+          model.push_back(next);
+        } else {
+          d.push_front(wide(next));
+          model.push_front(next);
+        }
+        ++next;
+
+        if (model.size() > 100 && (!grow || round % 2 == 0)) {
+          if (forward) {
+            HF_CHECK(d.front().value == model.front());
+            d.pop_front();
+            model.pop_front();
+          } else {
+            HF_CHECK(d.back().value == model.back());
+            d.pop_back();
+            model.pop_back();
+          }
+        }
+      }
+      check_same(d, model);
+      check_iterators(d, model);
+    }
+  }
+  HF_CHECK(wide::live == 0);
+}
@@ -0,0 +1,191 @@
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "flat_hash_map.hpp"
+#include "flat_hash_set.hpp"
+#include "string.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+// uses the key as its own hash and is marked avalanching so the table does not mix it,
+// the keys then decide their home slots directly
+struct identity_hash {
+  typedef void is_avalanching;
+
+  size_t operator()(uint64_t x) const noexcept { return static_cast<size_t>(x); }
+};
+
+typedef std::unordered_map<uint64_t, uint64_t> model_map;
+
+template <typename Map>
+void check_same(const Map& map, const model_map& model) {
+  HF_CHECK(map.size() == model.size());
+  HF_CHECK(map.empty() == model.empty());
+
+  size_t walked = 0;
+  for (auto& kv : map) {
+    auto it = model.find(kv.first);
+    HF_CHECK(it != model.end() && it->second == kv.second);
+    ++walked;
+  }
+  HF_CHECK(walked == model.size());
+
+  for (auto& kv : model) {
+    auto it = map.find(kv.first);
+    HF_CHECK(it != map.end() && it->second == kv.second);
+  }
+}
+
+// random mix of every way in and out of the map, key_of picks the key for a draw so the
+// same sequence runs over spread and clustered keys
+template <typename Map, typename KeyOf>
+void check_against_model(KeyOf key_of, uint32_t key_range, int rounds) {
+  auto& gen = hf_test::rng();
+  Map map;
+  model_map model;
+
+  for (int round = 0; round < rounds; ++round) {
+    auto key = key_of(gen() % key_range);
+    auto value = static_cast<uint64_t>(gen());
+
+    switch (gen() % 10) {
+      case 0:
+      case 1: {
+        auto r = map.insert(typename Map::value_type(key, value));
+        auto m = model.insert({key, value});
+        HF_CHECK(r.second == m.second);
+        HF_CHECK(r.first->first == key && r.first->second == m.first->second);
+        break;
+      }
+      case 2: {
+        auto r = map.try_emplace(key, value);
+        auto m = model.try_emplace(key, value);
+        HF_CHECK(r.second == m.second && r.first->second == m.first->second);
+        break;
+      }
+      case 3:
+        map[key] += value;
+        model[key] += value;
+        break;
+      case 4:
+      case 5:
+        HF_CHECK(map.erase(key) == model.erase(key));
+        break;
+      case 6: {
+        auto it = map.find(key);
+        HF_CHECK((it != map.end()) == (model.count(key) != 0));
+        if (it != map.end()) {
+          map.erase(it);
+          model.erase(key);
+        }
+        break;
+      }
+      case 7:
+        HF_CHECK(map.contains(key) == (model.count(key) != 0));
+        HF_CHECK(map.count(key) == model.count(key));
+        break;
+      case 8:
+        if (gen() % 64 == 0) {
+          auto bit = uint64_t(1) << (gen() % 8);
+          auto pred = [bit](const auto& kv) { return (kv.second & bit) != 0; };
+          size_t expect = 0;
+          for (auto it = model.begin(); it != model.end();) {
+            if (pred(*it)) {
+              it = model.erase(it);
+              ++expect;
+            } else {
+              ++it;
+            }
+          }
+          HF_CHECK(hf::erase_if(map, pred) == expect);
+        }
+        break;
+      default:
+        if (gen() % 256 == 0) {
+          check_same(map, model);
+
+          Map copy(map);
+          check_same(copy, model);
+          Map moved(std::move(copy));
+          check_same(moved, model);
+          HF_CHECK(copy.empty());
+
+          Map assigned;
+          assigned[key] = 1;
+          assigned = moved;
+          check_same(assigned, model);
+          moved.clear();
+          HF_CHECK(moved.empty() && moved.find(key) == moved.end());
+          map = std::move(assigned);
+        }
+        break;
+    }
+  }
+  check_same(map, model);
+
+  map.clear();
+  model.clear();
+  check_same(map, model);
+}
+
+}  // namespace
+
+HF_TEST(flat_hash_map, random_ops) {
+  auto spread = [](uint32_t k) { return uint64_t(k) * 0x9E3779B97F4A7C15ull; };
+  check_against_model<hf::flat_hash_map<uint64_t, uint64_t>>(spread, 50, 20000);
+  check_against_model<hf::flat_hash_map<uint64_t, uint64_t>>(spread, 5000, 100000);
+}
+
+// with the key as hash every k << 12 has the same control byte and the homes fall on a
+// few slots, so the probe runs are long and compare keys all the way
+HF_TEST(flat_hash_map, clustered_keys) {
+  auto shifted = [](uint32_t k) { return uint64_t(k) << 12; };
+  check_against_model<hf::flat_hash_map<uint64_t, uint64_t, identity_hash>>(shifted, 3000,
+                                                                             100000);
+}
+
+// the complement puts the homes on the last slot of the table and just below it, the
+// runs wrap into the front through the mirrored control bytes and erase shifts entries
+// back across the wrap
+HF_TEST(flat_hash_map, clustered_keys_wrap) {
+  auto tail = [](uint32_t k) { return ~(uint64_t(k) << 12); };
+  check_against_model<hf::flat_hash_map<uint64_t, uint64_t, identity_hash>>(tail, 3000,
+                                                                             100000);
+}
+
+HF_TEST(flat_hash_map, string_view_lookup) {
+  auto& gen = hf_test::rng();
+  hf::flat_hash_set<hf::string> set;
+  std::unordered_set<std::string> model;
+
+  for (int round = 0; round < 20000; ++round) {
+    // lengths on both sides of the short string capacity
+    std::string key(gen() % 40, 'a');
+    for (auto& c : key) c = static_cast<char>('a' + gen() % 3);
+    hf::string_view view(key.data(), key.size());
+
+    switch (gen() % 4) {
+      case 0:
+        HF_CHECK(set.insert(hf::string(key.data(), key.size())).second ==
+                 model.insert(key).second);
+        break;
+      case 1:
+        HF_CHECK(set.erase(view) == model.erase(key));
+        break;
+      default: {
+        auto it = set.find(view);
+        HF_CHECK((it != set.end()) == (model.count(key) != 0));
+        if (it != set.end()) HF_CHECK(hf::string_view(it->data(), it->size()) == view);
+        HF_CHECK(set.contains(view) == (model.count(key) != 0));
+        break;
+      }
+    }
+  }
+
+  HF_CHECK(set.size() == model.size());
+  for (auto& key : model) HF_CHECK(set.contains(hf::string_view(key.data(), key.size())));
+}
@@ -0,0 +1,102 @@
+#include <cstring>
+#include <functional>
+#include <string>
+#include <unordered_set>
+
+#include "hashed_string.hpp"
+#include "string.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+// lengths 0 to 200 take the short read of up to 16 bytes, the 16 byte loop and the
+// three lane loop over 48 byte blocks, with every tail length after each
+constexpr size_t MAX_LENGTH = 200;
+
+template <typename CharType>
+std::basic_string<CharType> random_text(size_t n) {
+  auto& gen = hf_test::rng();
+  std::basic_string<CharType> s(n, CharType());
+  for (auto& c : s) c = static_cast<CharType>(gen());
+  return s;
+}
+
+// a string, its view, a hashed string built either way and the hashers of all of them
+// agree on one value
+template <typename CharType>
+void check_same_hash(const std::basic_string<CharType>& text) {
+  typedef hf::basic_string<CharType> string_type;
+  typedef typename string_type::view_type view_type;
+  typedef hf::basic_hashed_string<CharType> hashed_type;
+
+  view_type sv(text.data(), text.size());
+  string_type str(sv);
+  auto expect = hf::hash<view_type>()(sv);
+
+  HF_CHECK(hf::hash<string_type>()(str) == expect);
+  HF_CHECK(hf::hash<view_type>()(view_type(str)) == expect);
+
+  hashed_type from_view(sv);
+  hashed_type from_string(str);
+  HF_CHECK(from_view.hash() == expect && from_string.hash() == expect);
+  HF_CHECK(hf::hash<hashed_type>()(from_view) == expect);
+  HF_CHECK(hf::hash<hashed_type>()(sv) == expect);
+  HF_CHECK(std::hash<hashed_type>()(from_view) == expect);
+
+  // the cached value travels with copies and moves
+  hashed_type copy(from_view);
+  hashed_type moved(std::move(from_string));
+  HF_CHECK(copy.hash() == expect && moved.hash() == expect);
+  HF_CHECK(copy == moved && view_type(copy) == sv);
+}
+
+}  // namespace
+
+HF_TEST(hash, string_matches_view) {
+  for (size_t n = 0; n <= MAX_LENGTH; ++n) {
+    for (int round = 0; round < 20; ++round) {
+      check_same_hash(random_text<char>(n));
+      check_same_hash(random_text<char16_t>(n));
+    }
+  }
+  check_same_hash(std::string());
+
+  // released strings are empty and carry the hash of the empty string again
+  hf::hashed_string hs(hf::string_view("a key that is long enough for the heap"));
+  auto s = hs.release();
+  HF_CHECK(hs.empty() && hs.hash() == hf::hashed_string().hash());
+  HF_CHECK(hs.hash() == hf::hash<hf::string_view>()(hf::string_view()));
+  HF_CHECK(hf::hash<hf::string>()(s) == hf::hash<hf::string_view>()(s));
+}
+
+// a view anywhere inside a larger buffer hashes by its own bytes only, whatever sits
+// around it and however it is aligned
+HF_TEST(hash, depends_only_on_the_bytes) {
+  auto& gen = hf_test::rng();
+  char buffer[MAX_LENGTH + 32];
+  for (size_t n = 0; n <= MAX_LENGTH; ++n) {
+    auto text = random_text<char>(n);
+    auto expect = hf::hash<hf::string_view>()(hf::string_view(text.data(), n));
+
+    for (size_t offset = 0; offset < 16; ++offset) {
+      for (auto& c : buffer) c = static_cast<char>(gen());
+      std::memcpy(buffer + offset, text.data(), n);
+      HF_CHECK(hf::hash<hf::string_view>()(hf::string_view(buffer + offset, n)) == expect);
+    }
+
+    // any single changed byte changes the hash
+    if (n != 0) {
+      auto changed = text;
+      changed[gen() % n] ^= static_cast<char>(1 + gen() % 255);
+      HF_CHECK(hf::hash<hf::string_view>()(hf::string_view(changed.data(), n)) != expect);
+    }
+  }
+
+  // the length is part of the hash, runs of zero bytes all differ
+  std::unordered_set<size_t> seen;
+  std::string zeros(MAX_LENGTH, '\0');
+  for (size_t n = 0; n <= MAX_LENGTH; ++n) {
+    seen.insert(hf::hash<hf::string_view>()(hf::string_view(zeros.data(), n)));
+  }
+  HF_CHECK(seen.size() == MAX_LENGTH + 1);
+}
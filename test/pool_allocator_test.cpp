@@ -0,0 +1,43 @@
+#include <cstdint>
+#include <thread>
+
+#include "pool_allocator.hpp"
+#include "ring.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+struct node {
+  node* next;
+  uint64_t payload[3];
+};
+
+}  // namespace
+
+// blocks allocated on this thread and freed on another must come back through the depot,
+// so a long pipeline carves only a bounded number of slabs
+HF_TEST(pool_allocator, cross_thread_frees_are_reused) {
+  constexpr size_t BLOCKS = 1 << 20;
+  hf::spsc_ring<node*> queue(1024);
+
+  std::thread consumer([&] {
+    for (node* p;;) {
+      queue.pop(p);
+      if (p == nullptr) break;
+      hf::pool_allocator<node>::deallocate(p, 1);
+    }
+  });
+
+  auto before = hf_test::allocations();
+  for (size_t i = 0; i < BLOCKS; ++i) {
+    auto p = hf::pool_allocator<node>::allocate(1);
+    p->payload[0] = i;
+    queue.push(p);
+  }
+  queue.push(nullptr);
+  consumer.join();
+
+  // one slab holds about 2000 nodes, without reuse this would be over 500
+  auto slabs = hf_test::allocations() - before;
+  HF_CHECK(slabs <= 8);
+}
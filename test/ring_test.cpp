@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "ring.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+constexpr uint64_t PER_PRODUCER = 1 << 14;
+constexpr size_t BATCH = 16;
+
+// producers push (producer << 32 | sequence), odd ones one at a time and even ones in
+// batches. Every consumer checks that the elements of each producer arrive in the order
+// they were pushed, and afterwards every element must have been seen exactly once
+void run_mpmc(size_t producers, size_t consumers) {
+  hf::mpmc_ring<uint64_t> queue(256);
+  std::atomic<uint64_t> popped{0};
+  std::atomic<bool> misordered{false};
+  std::vector<std::atomic<uint8_t>> seen(producers * PER_PRODUCER);
+  std::vector<std::thread> threads;
+
+  for (size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      uint64_t in[BATCH];
+      for (uint64_t i = 0; i < PER_PRODUCER;) {
+        if (p % 2 != 0) {
+          queue.push(p << 32 | i++);
+          continue;
+        }
+        auto n = std::min<uint64_t>(BATCH, PER_PRODUCER - i);
+        for (uint64_t j = 0; j < n; ++j) in[j] = p << 32 | (i + j);
+        auto pushed = queue.try_push_n(in, n);
+        if (pushed == 0) std::this_thread::yield();
+        i += pushed;
+      }
+    });
+  }
+
+  for (size_t c = 0; c < consumers; ++c) {
+    threads.emplace_back([&] {
+      std::vector<int64_t> last(producers, -1);
+      uint64_t out[BATCH];
+      while (popped.load(std::memory_order_relaxed) < producers * PER_PRODUCER) {
+        auto n = queue.try_pop_n(out, BATCH);
+        if (n == 0) {
+          std::this_thread::yield();
+          continue;
+        }
+        for (size_t j = 0; j < n; ++j) {
+          auto p = out[j] >> 32;
+          auto i = static_cast<int64_t>(out[j] & 0xffffffff);
+          if (p >= producers || i >= static_cast<int64_t>(PER_PRODUCER) || i <= last[p]) {
+            misordered = true;
+            continue;
+          }
+          last[p] = i;
+          seen[p * PER_PRODUCER + i].fetch_add(1, std::memory_order_relaxed);
+        }
+        popped.fetch_add(n, std::memory_order_relaxed);
+      }
+    });
+  }
+
+  for (auto& t : threads) t.join();
+
+  HF_CHECK(!misordered);
+  HF_CHECK(popped == producers * PER_PRODUCER);
+  HF_CHECK(std::all_of(seen.begin(), seen.end(), [](auto& s) { return s.load() == 1; }));
+}
+
+}  // namespace
+
+HF_TEST(ring, spsc_in_order) {
+  hf::spsc_ring<uint64_t> queue(64);
+  std::thread producer([&] {
+    uint64_t in[BATCH];
+    for (uint64_t i = 0; i < PER_PRODUCER * 4;) {
+      if (i % 3 == 0) {
+        queue.push(i++);
+        continue;
+      }
+      auto n = std::min<uint64_t>(BATCH, PER_PRODUCER * 4 - i);
+      for (uint64_t j = 0; j < n; ++j) in[j] = i + j;
+      i += queue.try_push_n(in, n);
+    }
+  });
+
+  bool in_order = true;
+  uint64_t next = 0;
+  uint64_t out[BATCH];
+  while (next < PER_PRODUCER * 4) {
+    if (next % 2 == 0) {
+      queue.pop(out[0]);
+      in_order &= out[0] == next++;
+      continue;
+    }
+    auto n = queue.try_pop_n(out, BATCH);
+    for (size_t j = 0; j < n; ++j) in_order &= out[j] == next++;
+  }
+  producer.join();
+
+  HF_CHECK(in_order);
+  HF_CHECK(!queue.try_pop(out[0]));
+}
+
+HF_TEST(ring, mpmc_one_to_one) { run_mpmc(1, 1); }
+
+HF_TEST(ring, mpmc_balanced) {
+  for (size_t n : {2, 4, 8}) run_mpmc(n, n);
+}
+
+HF_TEST(ring, mpmc_fan_in) { run_mpmc(15, 1); }
+
+HF_TEST(ring, mpmc_fan_out) { run_mpmc(1, 15); }
@@ -0,0 +1,126 @@
+#include <cstdint>
+#include <vector>
+
+#include "simd.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+using namespace hf::simd;
+
+constexpr size_t MAX_LEN = 300;
+constexpr int ROUNDS = 2000;
+
+// a buffer with room to start the data at any offset inside a 32 byte vector
+template <typename T>
+struct fuzz_buffer {
+  std::vector<T> storage = std::vector<T>(MAX_LEN + 64);
+  T* data = nullptr;
+  size_t n = 0;
+
+  void randomize(T alphabet) {
+    auto& gen = hf_test::rng();
+    data = storage.data() + gen() % (32 / sizeof(T));
+    n = gen() % (MAX_LEN + 1);
+    for (auto& c : storage) c = static_cast<T>(1 + gen() % alphabet);
+  }
+};
+
+template <typename T>
+void check_length() {
+  fuzz_buffer<T> b;
+  for (int r = 0; r < ROUNDS; ++r) {
+    b.randomize(T(100));
+    b.data[b.n] = T(0);
+    auto expect = detail::length_scalar(b.data);
+    HF_CHECK(expect == b.n);
+    HF_CHECK(length(b.data) == expect);
+#if defined(HF_SIMD_X86)
+    if (has_sse2()) HF_CHECK(detail::length_sse2(b.data) == expect);
+    if (has_avx2()) HF_CHECK(detail::length_avx2(b.data) == expect);
+#endif
+  }
+}
+
+template <typename T>
+void check_mismatch() {
+  fuzz_buffer<T> a;
+  fuzz_buffer<T> b;
+  auto& gen = hf_test::rng();
+
+  for (int r = 0; r < ROUNDS; ++r) {
+    a.randomize(T(4));
+    b.data = b.storage.data() + gen() % (32 / sizeof(T));
+    for (size_t i = 0; i < a.n; ++i) b.data[i] = a.data[i];
+    // most rounds plant a single difference, the rest compare equal ranges
+    if (a.n != 0 && gen() % 4 != 0) b.data[gen() % a.n] = T(0xFFFF);
+
+    auto expect = detail::mismatch_scalar(a.data, b.data, a.n);
+    HF_CHECK(mismatch(a.data, b.data, a.n) == expect);
+#if defined(HF_SIMD_X86)
+    if (has_sse2()) HF_CHECK(detail::mismatch_sse2(a.data, b.data, a.n) == expect);
+    if (has_avx2()) HF_CHECK(detail::mismatch_avx2(a.data, b.data, a.n) == expect);
+#endif
+  }
+}
+
+template <typename T>
+void check_find() {
+  fuzz_buffer<T> b;
+  for (int r = 0; r < ROUNDS; ++r) {
+    // a large alphabet leaves many buffers without the needle at all
+    b.randomize(r % 2 == 0 ? T(8) : T(400));
+    auto ch = static_cast<T>(1 + hf_test::rng()() % 8);
+
+    auto expect = detail::find_scalar(b.data, b.n, ch);
+    HF_CHECK(find(b.data, b.n, ch) == expect);
+#if defined(HF_SIMD_X86)
+    if (has_sse2()) HF_CHECK(detail::find_sse2(b.data, b.n, ch) == expect);
+    if (has_avx2()) HF_CHECK(detail::find_avx2(b.data, b.n, ch) == expect);
+#endif
+  }
+}
+
+// every kernel must write exactly n units and leave the guard past the end alone
+template <typename T>
+void check_fill_with(void (*kernel)(T*, T, size_t)) {
+  fuzz_buffer<T> b;
+  for (int r = 0; r < ROUNDS; ++r) {
+    b.randomize(T(100));
+    auto ch = static_cast<T>(hf_test::rng()());
+    auto guard = b.data[b.n];
+    kernel(b.data, ch, b.n);
+
+    bool filled = true;
+    for (size_t i = 0; i < b.n; ++i) filled &= b.data[i] == ch;
+    HF_CHECK(filled);
+    HF_CHECK(b.data[b.n] == guard);
+  }
+}
+
+template <typename T>
+void check_fill() {
+  check_fill_with<T>(&fill<T>);
+#if defined(HF_SIMD_X86)
+  if (has_sse2()) check_fill_with<T>(&detail::fill_sse2<T>);
+  if (has_avx2()) check_fill_with<T>(&detail::fill_avx2<T>);
+#endif
+}
+
+}  // namespace
+
+HF_TEST(simd, length_char16) { check_length<char16_t>(); }
+
+HF_TEST(simd, length_char32) { check_length<char32_t>(); }
+
+HF_TEST(simd, mismatch_char16) { check_mismatch<char16_t>(); }
+
+HF_TEST(simd, mismatch_char32) { check_mismatch<char32_t>(); }
+
+HF_TEST(simd, find_char16) { check_find<char16_t>(); }
+
+HF_TEST(simd, find_char32) { check_find<char32_t>(); }
+
+HF_TEST(simd, fill_char16) { check_fill<char16_t>(); }
+
+HF_TEST(simd, fill_char32) { check_fill<char32_t>(); }
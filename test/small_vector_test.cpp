@@ -0,0 +1,194 @@
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "small_vector.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+// keeps a pointer to itself, so an element that was copied bytewise instead of being
+// constructed in its new place is caught, and counts live objects
+struct pinned {
+  static long long live;
+
+  int value;
+  const pinned* self;
+
+  pinned(int v = 0) noexcept : value(v), self(this) { ++live; }
+  pinned(const pinned& rhs) noexcept : value(rhs.value), self(this) { ++live; }
+  pinned& operator=(const pinned& rhs) noexcept {
+    value = rhs.value;
+    return *this;
+  }
+  ~pinned() { --live; }
+
+  bool intact() const noexcept { return self == this; }
+};
+
+long long pinned::live = 0;
+
+int value_of(int x) { return x; }
+
+int value_of(const pinned& x) { return x.value; }
+
+bool intact(int) { return true; }
+
+bool intact(const pinned& x) { return x.intact(); }
+
+template <typename Vec>
+void check_same(const Vec& v, const std::vector<int>& model) {
+  HF_CHECK(v.size() == model.size());
+  HF_CHECK(v.is_inline() == (v.capacity() == Vec::INLINE_CAPACITY));
+  if (v.size() != model.size()) return;
+  for (size_t i = 0; i < model.size(); ++i) {
+    HF_CHECK(value_of(v[i]) == model[i]);
+    HF_CHECK(intact(v[i]));
+  }
+}
+
+template <typename T, size_t N>
+hf::small_vector<T, N> make(size_t n, int first) {
+  hf::small_vector<T, N> v;
+  for (size_t i = 0; i < n; ++i) v.emplace_back(first + static_cast<int>(i));
+  return v;
+}
+
+std::vector<int> make_model(size_t n, int first) {
+  std::vector<int> model;
+  for (size_t i = 0; i < n; ++i) model.push_back(first + static_cast<int>(i));
+  return model;
+}
+
+// everything that keeps the size at or below N stays in the inline buffer
+template <typename T, size_t N>
+void check_no_heap_up_to_n() {
+  auto before = hf_test::allocations();
+  {
+    hf::small_vector<T, N> v;
+    for (size_t i = 0; i < N; ++i) v.push_back(T(static_cast<int>(i)));
+    v.reserve(N);
+    v.erase(v.begin());
+    v.emplace(v.begin(), -1);
+    v.pop_back();
+    v.insert(v.begin() + 1, T(7));
+    v.resize(N);
+
+    hf::small_vector<T, N> copy(v);
+    hf::small_vector<T, N> moved(std::move(copy));
+    hf::small_vector<T, N> assigned;
+    assigned = moved;
+    assigned = std::move(moved);
+    assigned.swap(v);
+    v.shrink_to_fit();
+    HF_CHECK(v.is_inline() && assigned.is_inline() && v.size() == N);
+  }
+  HF_CHECK(hf_test::allocations() == before);
+
+  // one element past the inline buffer goes to the heap, so the counter is live
+  hf::small_vector<T, N> v;
+  for (size_t i = 0; i < N; ++i) v.emplace_back(static_cast<int>(i));
+  before = hf_test::allocations();
+  v.emplace_back(-1);
+  HF_CHECK(hf_test::allocations() == before + 1);
+  HF_CHECK(!v.is_inline() && v.size() == N + 1);
+}
+
+// growing past N moves the elements to the heap, shrink_to_fit brings them back once
+// they fit again
+template <typename T, size_t N>
+void check_spill_and_return() {
+  for (size_t n = 0; n <= 3 * N; ++n) {
+    auto v = make<T, N>(n, 100);
+    auto model = make_model(n, 100);
+    check_same(v, model);
+    HF_CHECK(v.is_inline() == (n <= N));
+
+    // insert at the front so the spill has to place the old elements after the new one
+    v.insert(v.begin(), T(-5));
+    model.insert(model.begin(), -5);
+    check_same(v, model);
+
+    while (v.size() > N / 2) {
+      v.pop_back();
+      model.pop_back();
+    }
+    v.shrink_to_fit();
+    HF_CHECK(v.is_inline());
+    check_same(v, model);
+  }
+
+  // still too big for the buffer, the heap block is only trimmed
+  auto v = make<T, N>(3 * N, 1);
+  v.reserve(10 * N);
+  v.shrink_to_fit();
+  HF_CHECK(!v.is_inline() && v.capacity() == 3 * N);
+  check_same(v, make_model(3 * N, 1));
+}
+
+// every pairing of inline and heap states through move construction, move assignment
+// and swap
+template <typename T, size_t N>
+void check_moves_and_swaps() {
+  const size_t sizes[] = {0, 1, N, N + 1, 4 * N};
+  for (size_t a : sizes) {
+    for (size_t b : sizes) {
+      auto ma = make_model(a, 1000);
+      auto mb = make_model(b, 2000);
+
+      {
+        auto x = make<T, N>(a, 1000);
+        hf::small_vector<T, N> y(std::move(x));
+        check_same(y, ma);
+        HF_CHECK(x.empty() && x.is_inline());
+        x.push_back(T(1));  // the moved-from vector is usable
+        HF_CHECK(x.size() == 1 && value_of(x[0]) == 1);
+      }
+      {
+        auto x = make<T, N>(a, 1000);
+        auto y = make<T, N>(b, 2000);
+        y = std::move(x);
+        check_same(y, ma);
+        HF_CHECK(x.empty() && x.is_inline());
+      }
+      {
+        auto x = make<T, N>(a, 1000);
+        auto y = make<T, N>(b, 2000);
+        x.swap(y);
+        check_same(x, mb);
+        check_same(y, ma);
+        y.swap(x);
+        check_same(x, ma);
+        check_same(y, mb);
+      }
+      {
+        auto x = make<T, N>(a, 1000);
+        auto y = make<T, N>(b, 2000);
+        y = x;
+        check_same(y, ma);
+        check_same(x, ma);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+HF_TEST(small_vector, no_heap_up_to_n) {
+  check_no_heap_up_to_n<int, 8>();
+  check_no_heap_up_to_n<pinned, 5>();
+  HF_CHECK(pinned::live == 0);
+}
+
+HF_TEST(small_vector, spill_and_return) {
+  check_spill_and_return<int, 8>();
+  check_spill_and_return<pinned, 5>();
+  check_spill_and_return<uint64_t, 1>();
+  HF_CHECK(pinned::live == 0);
+}
+
+HF_TEST(small_vector, moves_and_swaps) {
+  check_moves_and_swaps<int, 8>();
+  check_moves_and_swaps<pinned, 5>();
+  HF_CHECK(pinned::live == 0);
+}
@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "sort.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+template <typename T>
+hf::vector<T> random_values(size_t n) {
+  auto& gen = hf_test::rng();
+  hf::vector<T> v;
+  for (size_t i = 0; i < n; ++i) {
+    auto x = static_cast<int64_t>(gen() % 2000) - 1000;
+    v.push_back(static_cast<T>(x) / static_cast<T>(gen() % 2 == 0 ? 1 : 7));
+  }
+  return v;
+}
+
+// both modes must agree with std::sort, including numbers without an integer key
+template <typename T>
+void check_sort() {
+  for (size_t n : {0, 1, 2, 17, 100, 1000, 5000}) {
+    for (auto mode : {hf::sort_mode::quick, hf::sort_mode::radix}) {
+      auto v = random_values<T>(n);
+      std::vector<T> expect(v.begin(), v.end());
+      std::sort(expect.begin(), expect.end());
+
+      hf::sort(v, mode);
+      HF_CHECK(std::equal(v.begin(), v.end(), expect.begin(), expect.end()));
+    }
+  }
+}
+
+}  // namespace
+
+HF_TEST(sort, int32) { check_sort<int32_t>(); }
+
+HF_TEST(sort, uint64) { check_sort<uint64_t>(); }
+
+HF_TEST(sort, float) { check_sort<float>(); }
+
+HF_TEST(sort, double) { check_sort<double>(); }
+
+HF_TEST(sort, long_double) { check_sort<long double>(); }
+
+#if defined(__SIZEOF_INT128__)
+HF_TEST(sort, int128) { check_sort<__int128>(); }
+#endif
+
+// radix mode keeps equal keys in their order, also when the key is too wide for a radix pass
+HF_TEST(sort, by_key_stable_wide_key) {
+  hf::vector<hf::pair<long double, int>> v;
+  for (int i = 0; i < 1000; ++i) v.push_back(hf::pair<long double, int>(i % 7, i));
+
+  hf::sort_by_key(v, hf::sort_mode::radix);
+  bool ordered = true;
+  for (size_t i = 1; i < v.size(); ++i) {
+    ordered &= v[i - 1].first < v[i].first ||
+               (v[i - 1].first == v[i].first && v[i - 1].second < v[i].second);
+  }
+  HF_CHECK(ordered);
+}
@@ -0,0 +1,130 @@
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <charconv>
+#include <string>
+#include <thread>
+
+#include "string_builder.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+// appends the same random mix of pieces to a builder and to a std::string, sizes span
+// single characters up to pieces larger than a chunk
+void build(hf::string_builder& sb, std::string& expect, size_t pieces) {
+  auto& gen = hf_test::rng();
+  for (size_t i = 0; i < pieces; ++i) {
+    switch (gen() % 6) {
+      case 0: {
+        auto c = static_cast<char>('a' + gen() % 26);
+        sb.append(c);
+        expect += c;
+        break;
+      }
+      case 1: {
+        auto n = gen() % 3 == 0 ? gen() % (3 * hf::string_builder::CHUNK_SIZE) : gen() % 100;
+        sb.append(n, 'x');
+        expect.append(n, 'x');
+        break;
+      }
+      case 2: {
+        std::string piece(gen() % 5000, 'p');
+        for (auto& c : piece) c = static_cast<char>('A' + gen() % 26);
+        sb.append(piece.data(), piece.size());
+        expect += piece;
+        break;
+      }
+      case 3: {
+        auto v = static_cast<int64_t>(gen()) * (gen() % 2 == 0 ? 1 : -77);
+        sb << v;
+        expect += std::to_string(v);
+        break;
+      }
+      case 4: {
+        double d = static_cast<double>(gen()) / 1000.0;
+        char buf[32];
+        auto r = std::to_chars(buf, buf + sizeof(buf), d);
+        sb << d;
+        expect.append(buf, r.ptr);
+        break;
+      }
+      default:
+        sb.append("literal ");
+        expect += "literal ";
+        break;
+    }
+  }
+}
+
+extern "C" void ignore_signal(int) {}
+
+}  // namespace
+
+HF_TEST(string_builder, matches_std_string) {
+  for (size_t pieces : {0, 1, 10, 200, 2000}) {
+    hf::string_builder sb;
+    std::string expect;
+    build(sb, expect, pieces);
+
+    HF_CHECK(sb.size() == expect.size());
+    auto s = sb.to_string();
+    HF_CHECK(std::string(s.data(), s.size()) == expect);
+
+    std::string chunks;
+    sb.for_each_chunk([&](hf::string_builder::view_type v) { chunks.append(v.data(), v.size()); });
+    HF_CHECK(chunks == expect);
+
+    // clear keeps one chunk and the builder is usable again
+    sb.clear();
+    HF_CHECK(sb.empty());
+    sb.append("again");
+    HF_CHECK(sb.to_string() == hf::string_builder::string_type("again"));
+
+    hf::string_builder moved(std::move(sb));
+    HF_CHECK(sb.empty() && moved.size() == 5);
+  }
+}
+
+// the reader interrupts the blocked writer after every few reads, writev then returns
+// what it wrote so far and write_to has to continue from the middle of a chunk. Well over
+// 64 chunks also makes write_to go round its iovec batches several times
+HF_TEST(string_builder, write_to_resumes_short_writes) {
+  hf::string_builder sb;
+  std::string expect;
+  build(sb, expect, 1500);
+  HF_CHECK(expect.size() > 64 * hf::string_builder::CHUNK_SIZE);
+
+  struct sigaction sa = {};
+  struct sigaction old = {};
+  sa.sa_handler = ignore_signal;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags = 0;  // no SA_RESTART, the interrupted writev has to return
+  sigaction(SIGUSR1, &sa, &old);
+
+  int fds[2];
+  HF_CHECK(::pipe(fds) == 0);
+  auto writer = pthread_self();
+
+  std::string got;
+  std::thread reader([&] {
+    char buf[4096];
+    for (unsigned reads = 0;; ++reads) {
+      auto n = ::read(fds[0], buf, sizeof(buf));
+      if (n <= 0) break;
+      got.append(buf, static_cast<size_t>(n));
+      if (reads % 4 == 0) pthread_kill(writer, SIGUSR1);
+    }
+  });
+
+  bool ok = sb.write_to(fds[1]);
+  ::close(fds[1]);
+  reader.join();
+  ::close(fds[0]);
+  sigaction(SIGUSR1, &old, nullptr);
+
+  HF_CHECK(ok);
+  HF_CHECK(got.size() == expect.size());
+  HF_CHECK(got == expect);
+}
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "string_interner.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+typedef hf::string_interner::id_type id_type;
+typedef hf::string_interner::view_type view_type;
+
+view_type view_of(const std::string& s) { return view_type(s.data(), s.size()); }
+
+bool same(view_type v, const std::string& s) {
+  return v.size() == s.size() && std::equal(v.data(), v.data() + v.size(), s.data());
+}
+
+// distinct keys of very different lengths, from empty to a few hundred characters
+std::vector<std::string> make_keys(const char* prefix, size_t n) {
+  std::vector<std::string> keys;
+  keys.reserve(n + 1);
+  keys.push_back(std::string());
+  for (size_t i = 0; i < n; ++i) {
+    auto key = prefix + std::to_string(i);
+    if (i % 97 == 0) key.append(i % 300, 'x');
+    keys.push_back(std::move(key));
+  }
+  return keys;
+}
+
+}  // namespace
+
+// well past the first id chunk and table of every shard, so chunks are added and tables
+// grow and retire many times
+HF_TEST(string_interner, round_trip) {
+  hf::string_interner interner;
+  auto keys = make_keys("key-", 150000);
+
+  std::vector<id_type> ids;
+  ids.reserve(keys.size());
+  for (auto& key : keys) {
+    HF_CHECK(interner.find(view_of(key)) == hf::string_interner::npos);
+    ids.push_back(interner.intern(view_of(key)));
+  }
+  HF_CHECK(interner.size() == keys.size());
+  HF_CHECK(std::unordered_set<id_type>(ids.begin(), ids.end()).size() == keys.size());
+
+  for (size_t i = 0; i < keys.size(); ++i) {
+    HF_CHECK(interner.intern(view_of(keys[i])) == ids[i]);
+    HF_CHECK(interner.find(view_of(keys[i])) == ids[i]);
+    HF_CHECK(same(interner.view(ids[i]), keys[i]));
+  }
+  HF_CHECK(interner.size() == keys.size());
+
+  // a fresh copy of a key maps to the stored one
+  for (size_t i = 0; i < keys.size(); i += 1000) {
+    std::string copy = keys[i];
+    auto stored = interner.intern_view(view_of(copy));
+    HF_CHECK(stored.data() == interner.view(ids[i]).data());
+    HF_CHECK(stored.data() != copy.data());
+  }
+
+  for (auto& key : make_keys("missing-", 20000)) {
+    if (key.empty()) continue;
+    HF_CHECK(interner.find(view_of(key)) == hf::string_interner::npos);
+  }
+  // prefixes and extensions of interned keys are other strings
+  HF_CHECK(interner.find(view_type("key-1000", 7)) == interner.find(view_of(keys[101])));
+  HF_CHECK(interner.find(view_type("key-1000000", 11)) == hf::string_interner::npos);
+  HF_CHECK(interner.size() == keys.size());
+}
+
+// every thread interns an overlapping window of the keys in its own order while the
+// others insert into the same shards, all of them have to agree on every id
+HF_TEST(string_interner, concurrent_overlapping) {
+  constexpr size_t THREADS = 4;
+  constexpr size_t PER_THREAD = 40000;
+
+  hf::string_interner interner;
+  auto keys = make_keys("shared-", PER_THREAD / 2 * (THREADS + 1) - 1);
+
+  std::vector<std::vector<id_type>> ids(THREADS, std::vector<id_type>(keys.size(), 0));
+  std::vector<size_t> lookups_failed(THREADS, 0);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < THREADS; ++t) {
+    threads.emplace_back([&, t] {
+      std::vector<size_t> order(PER_THREAD);
+      for (size_t i = 0; i < PER_THREAD; ++i) order[i] = t * PER_THREAD / 2 + i;
+      std::mt19937 gen(static_cast<unsigned>(t));
+      std::shuffle(order.begin(), order.end(), gen);
+
+      for (auto i : order) {
+        auto id = interner.intern(view_of(keys[i]));
+        ids[t][i] = id;
+        // lock free lookups while other threads keep growing the shards
+        if (interner.find(view_of(keys[i])) != id) ++lookups_failed[t];
+        if (!same(interner.view(id), keys[i])) ++lookups_failed[t];
+      }
+    });
+  }
+  for (auto& th : threads) th.join();
+
+  for (size_t t = 0; t < THREADS; ++t) HF_CHECK(lookups_failed[t] == 0);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto expect = interner.find(view_of(keys[i]));
+    HF_CHECK(expect != hf::string_interner::npos);
+    for (size_t t = 0; t < THREADS; ++t) {
+      auto first = t * PER_THREAD / 2;
+      if (i >= first && i < first + PER_THREAD) HF_CHECK(ids[t][i] == expect);
+    }
+  }
+  HF_CHECK(interner.size() == keys.size());
+}
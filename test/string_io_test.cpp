@@ -0,0 +1,144 @@
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "string.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+bool same(const hf::string& s, const std::string& expect) {
+  return s.size() == expect.size() && std::memcmp(s.data(), expect.data(), s.size()) == 0 &&
+         s.c_str()[s.size()] == '\0';
+}
+
+void write_all(int fd, const std::string& s) {
+  HF_CHECK(::write(fd, s.data(), s.size()) == static_cast<ssize_t>(s.size()));
+}
+
+void ignore_signal(int) {}
+
+}  // namespace
+
+// op sees the old contents in place, whatever it writes up to the size it returns is kept
+HF_TEST(string_io, resize_and_overwrite) {
+  auto& gen = hf_test::rng();
+  for (int round = 0; round < 3000; ++round) {
+    std::string expect(gen() % 60, 'a');
+    for (auto& c : expect) c = static_cast<char>('a' + gen() % 26);
+    hf::string s(expect.data(), expect.size());
+
+    auto n = static_cast<size_t>(gen() % 100);
+    auto keep = static_cast<size_t>(gen() % (n + 1));
+    auto old_size = expect.size();
+    s.resize_and_overwrite(n, [&](char* p, size_t count) {
+      HF_CHECK(count == n);
+      HF_CHECK(std::memcmp(p, expect.data(), old_size < n ? old_size : n) == 0);
+      for (size_t i = old_size; i < keep; ++i) p[i] = static_cast<char>('0' + i % 10);
+      return keep;
+    });
+
+    expect.resize(keep);
+    for (size_t i = old_size; i < keep; ++i) expect[i] = static_cast<char>('0' + i % 10);
+    HF_CHECK(same(s, expect));
+    HF_CHECK(s.capacity() >= keep);
+  }
+}
+
+// read_from appends after what the string holds, a short pipe gives a partial read, the
+// closed pipe gives 0 at end of file and a bad descriptor -1, neither changes the string
+HF_TEST(string_io, read_from) {
+  int fds[2];
+  HF_CHECK(::pipe(fds) == 0);
+
+  hf::string s("head:");
+  std::string expect = "head:";
+
+  write_all(fds[1], "0123456789");
+  HF_CHECK(s.read_from(fds[0], 4) == 4);
+  expect += "0123";
+  HF_CHECK(same(s, expect));
+
+  // asks for more than the pipe holds
+  HF_CHECK(s.read_from(fds[0], 100) == 6);
+  expect += "456789";
+  HF_CHECK(same(s, expect));
+
+  // from the inline buffer into a heap buffer and on
+  std::string big(5000, 'x');
+  for (size_t i = 0; i < big.size(); ++i) big[i] = static_cast<char>('A' + i % 23);
+  write_all(fds[1], big);
+  size_t got = 0;
+  while (got < big.size()) {
+    auto r = s.read_from(fds[0], 777);
+    HF_CHECK(r > 0);
+    if (r <= 0) break;
+    got += static_cast<size_t>(r);
+  }
+  expect += big;
+  HF_CHECK(same(s, expect));
+
+  ::close(fds[1]);
+  HF_CHECK(s.read_from(fds[0], 64) == 0);
+  HF_CHECK(same(s, expect));
+  ::close(fds[0]);
+
+  errno = 0;
+  HF_CHECK(s.read_from(-1, 64) == -1 && errno == EBADF);
+  HF_CHECK(same(s, expect));
+
+  hf::string empty;
+  HF_CHECK(::pipe(fds) == 0);
+  ::close(fds[1]);
+  HF_CHECK(empty.read_from(fds[0], 64) == 0);
+  HF_CHECK(empty.empty() && empty.c_str()[0] == '\0');
+  ::close(fds[0]);
+}
+
+// the reader interrupts the blocked writer after every few reads, write then returns
+// the part it got through and write_to has to carry on from there
+HF_TEST(string_io, write_to_resumes_short_writes) {
+  std::string expect(1 << 20, 'x');
+  for (size_t i = 0; i < expect.size(); ++i) expect[i] = static_cast<char>('a' + i * 7 % 26);
+  hf::string s(expect.data(), expect.size());
+
+  struct sigaction sa = {};
+  struct sigaction old = {};
+  sa.sa_handler = ignore_signal;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags = 0;  // no SA_RESTART, the interrupted write has to return
+  sigaction(SIGUSR1, &sa, &old);
+
+  int fds[2];
+  HF_CHECK(::pipe(fds) == 0);
+  auto writer = pthread_self();
+
+  std::string got;
+  std::thread reader([&] {
+    char buf[4096];
+    for (unsigned reads = 0;; ++reads) {
+      auto n = ::read(fds[0], buf, sizeof(buf));
+      if (n <= 0) break;
+      got.append(buf, static_cast<size_t>(n));
+      if (reads % 4 == 0) pthread_kill(writer, SIGUSR1);
+    }
+  });
+
+  bool ok = s.write_to(fds[1]);
+  ::close(fds[1]);
+  reader.join();
+  ::close(fds[0]);
+  sigaction(SIGUSR1, &old, nullptr);
+
+  HF_CHECK(ok);
+  HF_CHECK(got == expect);
+
+  errno = 0;
+  HF_CHECK(!s.write_to(-1) && errno == EBADF);
+  HF_CHECK(hf::string().write_to(-1));  // nothing to write, nothing fails
+}
@@ -0,0 +1,103 @@
+#include <string>
+
+#include "string.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+constexpr int ROUNDS = 3000;
+
+// a small alphabet gives many partial matches, sets may hold bytes above 0x7f for char
+template <typename CharType>
+std::basic_string<CharType> random_text(size_t n) {
+  auto& gen = hf_test::rng();
+  std::basic_string<CharType> s(n, CharType());
+  for (auto& c : s) {
+    auto r = gen() % 8;
+    c = r < 7 ? static_cast<CharType>('a' + r) : static_cast<CharType>(0xe9);
+  }
+  return s;
+}
+
+// positions before, at, just past and far past the end, and npos
+size_t random_pos(size_t n) {
+  auto& gen = hf_test::rng();
+  switch (gen() % 5) {
+    case 0: return n;
+    case 1: return n + 1 + gen() % 4;
+    case 2: return std::basic_string<char>::npos;
+    default: return gen() % (n + 1);
+  }
+}
+
+template <typename CharType>
+bool std_starts_with(const std::basic_string<CharType>& s, const std::basic_string<CharType>& p) {
+  return s.size() >= p.size() && s.compare(0, p.size(), p) == 0;
+}
+
+template <typename CharType>
+bool std_ends_with(const std::basic_string<CharType>& s, const std::basic_string<CharType>& p) {
+  return s.size() >= p.size() && s.compare(s.size() - p.size(), p.size(), p) == 0;
+}
+
+template <typename CharType>
+void check_search() {
+  typedef std::basic_string<CharType> std_string;
+  typedef hf::basic_string<CharType> hf_string;
+  typedef hf::basic_string_view<CharType> hf_view;
+  auto& gen = hf_test::rng();
+
+  for (int r = 0; r < ROUNDS; ++r) {
+    const auto text = random_text<CharType>(gen() % 300);
+    const hf_string s(text.data(), text.size());
+    const hf_view v(text.data(), text.size());
+
+    // needles are mostly cut from the text so they occur, the rest are random
+    std_string needle;
+    if (!text.empty() && gen() % 3 != 0) {
+      auto at = gen() % text.size();
+      needle = text.substr(at, gen() % 6);
+    } else {
+      needle = random_text<CharType>(gen() % 6);
+    }
+    const auto* np = needle.data();
+    const auto nn = needle.size();
+    const auto ch = needle.empty() ? CharType('a') : needle[0];
+    const auto pos = random_pos(text.size());
+
+    HF_CHECK(s.find(ch, pos) == text.find(ch, pos));
+    HF_CHECK(s.find(np, pos, nn) == text.find(np, pos, nn));
+    HF_CHECK(s.rfind(ch, pos) == text.rfind(ch, pos));
+    HF_CHECK(s.rfind(np, pos, nn) == text.rfind(np, pos, nn));
+    HF_CHECK(s.find_first_of(np, pos, nn) == text.find_first_of(np, pos, nn));
+    HF_CHECK(s.find_last_of(np, pos, nn) == text.find_last_of(np, pos, nn));
+    HF_CHECK(s.find_first_of(ch, pos) == text.find_first_of(ch, pos));
+    HF_CHECK(s.find_last_of(ch, pos) == text.find_last_of(ch, pos));
+
+    const hf_view nv(np, nn);
+    HF_CHECK(v.find(ch, pos) == text.find(ch, pos));
+    HF_CHECK(v.find(nv, pos) == text.find(np, pos, nn));
+    HF_CHECK(v.rfind(ch, pos) == text.rfind(ch, pos));
+    HF_CHECK(v.rfind(nv, pos) == text.rfind(np, pos, nn));
+    HF_CHECK(v.find_first_of(nv, pos) == text.find_first_of(np, pos, nn));
+    HF_CHECK(v.find_last_of(nv, pos) == text.find_last_of(np, pos, nn));
+
+    HF_CHECK(s.starts_with(nv) == std_starts_with(text, needle));
+    HF_CHECK(s.ends_with(nv) == std_ends_with(text, needle));
+    HF_CHECK(v.starts_with(nv) == std_starts_with(text, needle));
+    HF_CHECK(v.ends_with(nv) == std_ends_with(text, needle));
+    HF_CHECK(s.starts_with(ch) == (!text.empty() && text.front() == ch));
+    HF_CHECK(s.ends_with(ch) == (!text.empty() && text.back() == ch));
+    HF_CHECK(s.contains(nv) == (text.find(needle) != std_string::npos));
+  }
+}
+
+}  // namespace
+
+HF_TEST(string_search, char) { check_search<char>(); }
+
+HF_TEST(string_search, wchar) { check_search<wchar_t>(); }
+
+HF_TEST(string_search, char16) { check_search<char16_t>(); }
+
+HF_TEST(string_search, char32) { check_search<char32_t>(); }
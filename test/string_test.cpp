@@ -0,0 +1,72 @@
+#include <string>
+
+#include "string.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+// the inline buffer spans the whole object minus the slot holding the spare count
+template <typename Str>
+constexpr size_t short_capacity() {
+  return sizeof(Str) / sizeof(typename Str::value_type) - 1;
+}
+
+template <typename CharType>
+std::basic_string<CharType> text(size_t n) {
+  std::basic_string<CharType> s(n, CharType());
+  for (size_t i = 0; i < n; ++i) s[i] = static_cast<CharType>('a' + i % 26);
+  return s;
+}
+
+template <typename Str>
+void check_short_strings_stay_inline() {
+  typedef typename Str::value_type char_type;
+  constexpr size_t cap = short_capacity<Str>();
+
+  for (size_t n = 0; n <= cap; ++n) {
+    const auto src = text<char_type>(n);
+    auto before = hf_test::allocations();
+    {
+      Str s(src.data(), n);
+      Str copy(s);
+      Str moved(std::move(copy));
+      Str assigned;
+      assigned = s;
+
+      Str appended;
+      for (size_t i = 0; i < n; ++i) appended.append(src.data() + i, 1);
+
+      HF_CHECK(s.size() == n);
+      HF_CHECK(moved.size() == n);
+      HF_CHECK(assigned.size() == n);
+      HF_CHECK(appended.size() == n);
+      HF_CHECK(Str::char_traits::compare(appended.data(), src.data(), n) == 0);
+      HF_CHECK(appended.c_str()[n] == char_type());
+    }
+    HF_CHECK(hf_test::allocations() == before);
+  }
+
+  // one unit past the inline buffer must go to the heap, so the counter is live
+  const auto src = text<char_type>(cap + 1);
+  auto before = hf_test::allocations();
+  Str s(src.data(), cap + 1);
+  HF_CHECK(hf_test::allocations() == before + 1);
+  HF_CHECK(s.size() == cap + 1);
+}
+
+}  // namespace
+
+HF_TEST(string, short_char_no_alloc) {
+  static_assert(short_capacity<hf::string>() == 23, "23 chars fit inline");
+  check_short_strings_stay_inline<hf::string>();
+}
+
+HF_TEST(string, short_wchar_no_alloc) { check_short_strings_stay_inline<hf::wstring>(); }
+
+HF_TEST(string, short_char16_no_alloc) {
+  check_short_strings_stay_inline<hf::basic_string<char16_t>>();
+}
+
+HF_TEST(string, short_char32_no_alloc) {
+  check_short_strings_stay_inline<hf::basic_string<char32_t>>();
+}
@@ -0,0 +1,124 @@
+#include "test_util.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct test_case {
+  std::string name;
+  hf_test::test_fn fn;
+};
+
+std::vector<test_case>& registry() {
+  static std::vector<test_case> tests;
+  return tests;
+}
+
+std::atomic<size_t> g_allocations{0};
+std::atomic<size_t> g_failures{0};
+
+}  // namespace
+
+int hf_test::add_test(const char* suite, const char* name, test_fn fn) noexcept {
+  registry().push_back({std::string(suite) + "." + name, fn});
+  return 0;
+}
+
+void hf_test::fail(const char* file, int line, const char* expr) noexcept {
+  // cap the output, a broken kernel under a fuzz loop fails thousands of times
+  if (g_failures.fetch_add(1, std::memory_order_relaxed) < 20) {
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+  }
+}
+
+size_t hf_test::allocations() noexcept { return g_allocations.load(std::memory_order_relaxed); }
+
+namespace {
+
+void* counted_alloc(size_t n, size_t align) noexcept {
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (n == 0) n = 1;
+  if (align <= alignof(std::max_align_t)) return std::malloc(n);
+  return std::aligned_alloc(align, (n + align - 1) / align * align);
+}
+
+}  // namespace
+
+// every form of new and delete goes through malloc and free, so whatever pair the library
+// picks, aligned or nothrow, the memory is released by the allocator that made it
+void* operator new(size_t n) {
+  if (void* p = counted_alloc(n, 0)) return p;
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t n) { return ::operator new(n); }
+
+void* operator new(size_t n, const std::nothrow_t&) noexcept { return counted_alloc(n, 0); }
+
+void* operator new[](size_t n, const std::nothrow_t&) noexcept { return counted_alloc(n, 0); }
+
+void* operator new(size_t n, std::align_val_t al) {
+  if (void* p = counted_alloc(n, static_cast<size_t>(al))) return p;
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t n, std::align_val_t al) { return ::operator new(n, al); }
+
+void* operator new(size_t n, std::align_val_t al, const std::nothrow_t&) noexcept {
+  return counted_alloc(n, static_cast<size_t>(al));
+}
+
+void* operator new[](size_t n, std::align_val_t al, const std::nothrow_t&) noexcept {
+  return counted_alloc(n, static_cast<size_t>(al));
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete[](void* p) noexcept { std::free(p); }
+
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+  std::free(p);
+}
+
+int main(int argc, char** argv) {
+  const char* filter = argc > 1 ? argv[1] : "";
+  size_t run = 0;
+
+  for (auto& t : registry()) {
+    if (t.name.compare(0, std::strlen(filter), filter) != 0) continue;
+    auto before = g_failures.load();
+    t.fn();
+    std::printf("%s %s\n", g_failures.load() == before ? "[ ok ]" : "[fail]", t.name.c_str());
+    ++run;
+  }
+
+  if (run == 0) {
+    std::fprintf(stderr, "no test matches '%s'\n", filter);
+    return 1;
+  }
+  return g_failures.load() == 0 ? 0 : 1;
+}
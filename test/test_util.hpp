@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <random>
+
+namespace hf_test {
+
+typedef void (*test_fn)();
+
+// registers a test under "suite.name", main runs every test whose name starts with argv[1]
+int add_test(const char* suite, const char* name, test_fn fn) noexcept;
+
+// records a failed check, the test keeps going so one run reports every mismatch
+void fail(const char* file, int line, const char* expr) noexcept;
+
+// number of global operator new calls so far, every form of new is counted by the
+// replacements in test_util.cpp
+size_t allocations() noexcept;
+
+// the same seed on every run so a failure reproduces
+inline std::mt19937& rng() {
+  static std::mt19937 gen(12345);
+  return gen;
+}
+
+}  // namespace hf_test
+
+#define HF_TEST(suite, name)                                         \
+  static void hf_test_##suite##_##name();                            \
+  static const int hf_test_reg_##suite##_##name =                    \
+      ::hf_test::add_test(#suite, #name, &hf_test_##suite##_##name); \
+  static void hf_test_##suite##_##name()
+
+#define HF_CHECK(expr)                                       \
+  do {                                                       \
+    if (!(expr)) ::hf_test::fail(__FILE__, __LINE__, #expr); \
+  } while (0)
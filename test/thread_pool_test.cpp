@@ -0,0 +1,60 @@
+#include <atomic>
+
+#include "test_util.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+// a submits detached work while b is still on the deque beneath it, invoke has to run that
+// work or leave it to the pool on the way back to b, never drop it
+void submit_inside_fork(size_t threads) {
+  std::atomic<int> ran{0};
+  {
+    hf::thread_pool pool(threads);
+    pool.run([&] {
+      pool.invoke([&] { pool.submit([&] { ++ran; }); }, [&] { ++ran; });
+    });
+    pool.wait();
+    HF_CHECK(ran == 2);
+
+    // nested forks below the submit, and more than one detached task above b
+    pool.run([&] {
+      pool.invoke(
+          [&] {
+            for (int i = 0; i < 8; ++i) pool.submit([&] { ++ran; });
+            pool.invoke([&] { ++ran; }, [&] { pool.submit([&] { ++ran; }); });
+          },
+          [&] { ++ran; });
+    });
+    pool.wait();
+    HF_CHECK(ran == 2 + 11);
+  }
+  HF_CHECK(ran == 2 + 11);
+}
+
+}  // namespace
+
+HF_TEST(thread_pool, submit_inside_fork_one_worker) { submit_inside_fork(1); }
+
+HF_TEST(thread_pool, submit_inside_fork_four_workers) { submit_inside_fork(4); }
+
+HF_TEST(thread_pool, recursive_invoke) {
+  hf::thread_pool pool(4);
+  std::atomic<size_t> leaves{0};
+
+  struct split {
+    hf::thread_pool& pool;
+    std::atomic<size_t>& leaves;
+
+    void operator()(unsigned depth) const {
+      if (depth == 0) {
+        ++leaves;
+        return;
+      }
+      pool.invoke([&] { (*this)(depth - 1); }, [&] { (*this)(depth - 1); });
+    }
+  };
+
+  pool.run([&] { split{pool, leaves}(12); });
+  HF_CHECK(leaves == 4096);
+}
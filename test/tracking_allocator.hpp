@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <type_traits>
+
+#include "test_util.hpp"
+
+namespace hf_test {
+
+// bytes handed out and not yet returned, per allocator id
+inline long long& outstanding(int id) noexcept {
+  static long long bytes[16] = {};
+  return bytes[id & 15];
+}
+
+// a stateful allocator tagged with an id, two of them are equal when their ids are. Every
+// block records the id that allocated it and deallocate checks the contract the containers
+// have to keep: no null or empty deallocation, and memory only goes back to an equal
+// allocator with the size it was allocated with. The three flags set the propagation traits
+template <typename T, bool POCCA = false, bool POCMA = false, bool POCS = false>
+struct tracking_allocator {
+  typedef T value_type;
+  typedef std::integral_constant<bool, POCCA> propagate_on_container_copy_assignment;
+  typedef std::integral_constant<bool, POCMA> propagate_on_container_move_assignment;
+  typedef std::integral_constant<bool, POCS> propagate_on_container_swap;
+
+  explicit tracking_allocator(int id = 0) noexcept : id(id) {}
+
+  T* allocate(size_t n) noexcept {
+    HF_CHECK(n != 0);
+    auto header = static_cast<size_t*>(std::malloc(n * sizeof(T) + 16));
+    header[0] = static_cast<size_t>(id);
+    header[1] = n;
+    outstanding(id) += static_cast<long long>(n * sizeof(T));
+    return reinterpret_cast<T*>(header + 2);
+  }
+
+  void deallocate(T* p, size_t n) noexcept {
+    HF_CHECK(p != nullptr);
+    HF_CHECK(n != 0);
+    if (p == nullptr) return;
+    auto header = reinterpret_cast<size_t*>(p) - 2;
+    HF_CHECK(header[0] == static_cast<size_t>(id));
+    HF_CHECK(header[1] == n);
+    outstanding(static_cast<int>(header[0])) -= static_cast<long long>(header[1] * sizeof(T));
+    std::free(header);
+  }
+
+  bool operator==(const tracking_allocator& rhs) const noexcept { return id == rhs.id; }
+
+  bool operator!=(const tracking_allocator& rhs) const noexcept { return id != rhs.id; }
+
+  int id;
+};
+
+}  // namespace hf_test
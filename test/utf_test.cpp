@@ -0,0 +1,265 @@
+#include <cstdint>
+#include <vector>
+
+#include "test_util.hpp"
+#include "utf.hpp"
+
+namespace {
+
+using namespace hf::utf;
+
+constexpr int ROUNDS = 3000;
+
+/* ------------------------------------------------------------------------- */
+
+// reference codec, written straight from the Unicode definitions and sharing nothing with
+// utf.hpp: shortest form only, no surrogate code points, nothing above U+10FFFF
+
+bool is_scalar_value(uint32_t c) { return c <= 0x10FFFF && (c < 0xD800 || c > 0xDFFF); }
+
+bool ref_decode_utf8(const std::vector<char>& in, std::vector<char32_t>& out) {
+  out.clear();
+  size_t i = 0;
+  while (i < in.size()) {
+    uint32_t b = static_cast<unsigned char>(in[i]);
+    size_t len = b < 0x80           ? 1
+                 : (b >> 5) == 0x6  ? 2
+                 : (b >> 4) == 0xE  ? 3
+                 : (b >> 3) == 0x1E ? 4
+                                    : 0;
+    if (len == 0 || i + len > in.size()) return false;
+
+    uint32_t c = len == 1 ? b : b & (0x7F >> len);
+    for (size_t k = 1; k < len; ++k) {
+      uint32_t t = static_cast<unsigned char>(in[i + k]);
+      if ((t & 0xC0) != 0x80) return false;
+      c = (c << 6) | (t & 0x3F);
+    }
+
+    static const uint32_t min_value[] = {0, 0, 0x80, 0x800, 0x10000};
+    if (c < min_value[len] || !is_scalar_value(c)) return false;
+    out.push_back(static_cast<char32_t>(c));
+    i += len;
+  }
+  return true;
+}
+
+bool ref_decode_utf16(const std::vector<char16_t>& in, std::vector<char32_t>& out) {
+  out.clear();
+  for (size_t i = 0; i < in.size(); ++i) {
+    uint32_t u = in[i];
+    if (u >= 0xDC00 && u <= 0xDFFF) return false;
+    if (u >= 0xD800 && u <= 0xDBFF) {
+      if (i + 1 == in.size()) return false;
+      uint32_t l = in[++i];
+      if (l < 0xDC00 || l > 0xDFFF) return false;
+      u = 0x10000 + ((u - 0xD800) << 10) + (l - 0xDC00);
+    }
+    out.push_back(static_cast<char32_t>(u));
+  }
+  return true;
+}
+
+bool ref_decode_utf32(const std::vector<char32_t>& in, std::vector<char32_t>& out) {
+  out.clear();
+  for (auto c : in) {
+    if (!is_scalar_value(c)) return false;
+    out.push_back(c);
+  }
+  return true;
+}
+
+std::vector<char> ref_encode_utf8(const std::vector<char32_t>& cps) {
+  std::vector<char> out;
+  for (uint32_t c : cps) {
+    if (c < 0x80) {
+      out.push_back(static_cast<char>(c));
+    } else if (c < 0x800) {
+      out.push_back(static_cast<char>(0xC0 | (c >> 6)));
+      out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    } else if (c < 0x10000) {
+      out.push_back(static_cast<char>(0xE0 | (c >> 12)));
+      out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    } else {
+      out.push_back(static_cast<char>(0xF0 | (c >> 18)));
+      out.push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    }
+  }
+  return out;
+}
+
+std::vector<char16_t> ref_encode_utf16(const std::vector<char32_t>& cps) {
+  std::vector<char16_t> out;
+  for (uint32_t c : cps) {
+    if (c < 0x10000) {
+      out.push_back(static_cast<char16_t>(c));
+    } else {
+      out.push_back(static_cast<char16_t>(0xD800 + ((c - 0x10000) >> 10)));
+      out.push_back(static_cast<char16_t>(0xDC00 + ((c - 0x10000) & 0x3FF)));
+    }
+  }
+  return out;
+}
+
+/* ------------------------------------------------------------------------- */
+
+// code points drawn mostly from runs of one width class, so the vector kernels see both
+// their pure ASCII / basic plane fast paths and mixed blocks
+std::vector<char32_t> random_code_points() {
+  auto& gen = hf_test::rng();
+  std::vector<char32_t> cps(gen() % 400);
+  uint32_t cls = 0;
+
+  for (auto& c : cps) {
+    if (gen() % 16 == 0) cls = gen() % 5;
+    switch (cls) {
+      case 0: c = gen() % 0x80; break;
+      case 1: c = 0x80 + gen() % (0x800 - 0x80); break;
+      case 2: c = 0x800 + gen() % (0xD800 - 0x800); break;
+      case 3: c = 0xE000 + gen() % (0x10000 - 0xE000); break;
+      default: c = 0x10000 + gen() % (0x110000 - 0x10000); break;
+    }
+  }
+  return cps;
+}
+
+// interesting unit values for corruption: continuation and lead bytes, overlong and out of
+// range leads, lone surrogates and values just past the last code point
+template <typename T>
+T nasty_unit() {
+  auto& gen = hf_test::rng();
+  if constexpr (sizeof(T) == 1) {
+    static const uint8_t bytes[] = {0x80, 0xBF, 0xC0, 0xC1, 0xC2, 0xDF, 0xE0, 0xED,
+                                    0xEF, 0xF0, 0xF4, 0xF5, 0xF8, 0xFF, 0x00, 0x7F};
+    return static_cast<T>(bytes[gen() % sizeof(bytes)]);
+  } else if constexpr (sizeof(T) == 2) {
+    static const uint16_t units[] = {0xD800, 0xDBFF, 0xDC00, 0xDFFF, 0xD7FF, 0xE000, 0x0000};
+    return static_cast<T>(units[gen() % (sizeof(units) / sizeof(units[0]))]);
+  } else {
+    static const uint32_t units[] = {0xD800, 0xDFFF, 0x110000, 0x10FFFF, 0xFFFFFFFF, 0x80000000};
+    return static_cast<T>(units[gen() % (sizeof(units) / sizeof(units[0]))]);
+  }
+}
+
+// half of the inputs stay well formed, the rest get a few units overwritten, inserted or
+// dropped, or lose their tail so a sequence is cut short
+template <typename T>
+void mutate(std::vector<T>& v) {
+  auto& gen = hf_test::rng();
+  if (gen() % 2 == 0) return;
+
+  for (int k = 1 + gen() % 3; k > 0; --k) {
+    size_t at = v.empty() ? 0 : gen() % v.size();
+    switch (gen() % 4) {
+      case 0:
+        if (!v.empty()) v[at] = nasty_unit<T>();
+        break;
+      case 1: v.insert(v.begin() + at, nasty_unit<T>()); break;
+      case 2:
+        if (!v.empty()) v.erase(v.begin() + at);
+        break;
+      default:
+        if (!v.empty()) v.resize(at);
+        break;
+    }
+  }
+}
+
+// runs one converter into a buffer sized exactly as the reference says, with guard units
+// behind it that must survive
+template <typename From, typename To>
+void check_convert(const std::vector<From>& in, const std::vector<To>& expect,
+                   size_t (*length)(const From*, size_t) noexcept,
+                   size_t (*convert)(const From*, size_t, To*) noexcept) {
+  HF_CHECK(length(in.data(), in.size()) == expect.size());
+
+  constexpr size_t guard = 64;
+  std::vector<To> out(expect.size() + guard, To(0x5A));
+  HF_CHECK(convert(in.data(), in.size(), out.data()) == expect.size());
+
+  bool same = true;
+  for (size_t i = 0; i < expect.size(); ++i) same &= out[i] == expect[i];
+  for (size_t i = expect.size(); i < out.size(); ++i) same &= out[i] == To(0x5A);
+  HF_CHECK(same);
+}
+
+}  // namespace
+
+HF_TEST(utf, from_utf8) {
+  std::vector<char32_t> cps;
+  for (int r = 0; r < ROUNDS; ++r) {
+    auto in = ref_encode_utf8(random_code_points());
+    mutate(in);
+    bool valid = ref_decode_utf8(in, cps);
+
+    HF_CHECK(validate_utf8(in.data(), in.size()) == valid);
+    HF_CHECK(detail::validate_utf8_scalar(in.data(), in.size()) == valid);
+    if (!valid) continue;
+
+    auto u16 = ref_encode_utf16(cps);
+    check_convert<char, char16_t>(in, u16, utf16_length_from_utf8, convert_utf8_to_utf16);
+    check_convert<char, char16_t>(in, u16, detail::utf16_length_from_utf8_scalar,
+                                  detail::utf8_to_utf16_scalar);
+    check_convert<char, char32_t>(in, cps, utf32_length_from_utf8, convert_utf8_to_utf32);
+    check_convert<char, char32_t>(in, cps, detail::utf32_length_from_utf8_scalar,
+                                  detail::utf8_to_utf32_scalar);
+  }
+}
+
+HF_TEST(utf, from_utf16) {
+  std::vector<char32_t> cps;
+  for (int r = 0; r < ROUNDS; ++r) {
+    auto in = ref_encode_utf16(random_code_points());
+    mutate(in);
+    bool valid = ref_decode_utf16(in, cps);
+
+    HF_CHECK(validate_utf16(in.data(), in.size()) == valid);
+    HF_CHECK(detail::validate_utf16_scalar(in.data(), in.size()) == valid);
+    if (!valid) continue;
+
+    auto u8 = ref_encode_utf8(cps);
+    check_convert<char16_t, char>(in, u8, utf8_length_from_utf16, convert_utf16_to_utf8);
+    check_convert<char16_t, char>(in, u8, detail::utf8_length_from_utf16_scalar,
+                                  detail::utf16_to_utf8_scalar);
+    check_convert<char16_t, char32_t>(in, cps, utf32_length_from_utf16, convert_utf16_to_utf32);
+    check_convert<char16_t, char32_t>(in, cps, detail::utf32_length_from_utf16_scalar,
+                                      detail::utf16_to_utf32_scalar);
+  }
+}
+
+HF_TEST(utf, from_utf32) {
+  std::vector<char32_t> cps;
+  for (int r = 0; r < ROUNDS; ++r) {
+    auto in = random_code_points();
+    mutate(in);
+    bool valid = ref_decode_utf32(in, cps);
+
+    HF_CHECK(validate_utf32(in.data(), in.size()) == valid);
+    HF_CHECK(detail::validate_utf32_scalar(in.data(), in.size()) == valid);
+    if (!valid) continue;
+
+    auto u8 = ref_encode_utf8(cps);
+    auto u16 = ref_encode_utf16(cps);
+    check_convert<char32_t, char>(in, u8, utf8_length_from_utf32, convert_utf32_to_utf8);
+    check_convert<char32_t, char>(in, u8, detail::utf8_length_from_utf32_scalar,
+                                  detail::utf32_to_utf8_scalar);
+    check_convert<char32_t, char16_t>(in, u16, utf16_length_from_utf32, convert_utf32_to_utf16);
+    check_convert<char32_t, char16_t>(in, u16, detail::utf16_length_from_utf32_scalar,
+                                      detail::utf32_to_utf16_scalar);
+  }
+}
+
+// the string level entry points leave the target untouched on malformed input
+HF_TEST(utf, append_rejects_malformed) {
+  const char bad[] = {'a', 'b', static_cast<char>(0xC0), static_cast<char>(0x80)};
+  const hf::basic_string<char16_t> keep(u"keep", 4);
+  auto out = keep;
+  HF_CHECK(!hf::append_utf16(out, hf::string_view(bad, sizeof(bad))));
+  HF_CHECK(out.size() == 4 && out == keep);
+
+  HF_CHECK(hf::append_utf16(out, hf::string_view("\xC3\xA9", 2)));
+  HF_CHECK(out.size() == 5 && out[4] == u'é');
+}
@@ -0,0 +1,249 @@
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "test_util.hpp"
+#include "tracking_allocator.hpp"
+#include "vector.hpp"
+
+namespace {
+
+typedef hf_test::tracking_allocator<int> strict_alloc;
+
+// keeps a pointer to itself, so it is not trivially relocatable and an element that was
+// moved bytewise instead of being constructed in its new place is caught. Moving from it
+// leaves -1 behind and live counts the objects that exist
+struct tracked {
+  static long long live;
+
+  int value;
+  const tracked* self;
+
+  tracked(int v = 0) noexcept : value(v), self(this) { ++live; }
+  tracked(const tracked& rhs) noexcept : value(rhs.value), self(this) { ++live; }
+  tracked(tracked&& rhs) noexcept : value(rhs.value), self(this) {
+    rhs.value = -1;
+    ++live;
+  }
+  tracked& operator=(const tracked& rhs) noexcept {
+    value = rhs.value;
+    return *this;
+  }
+  tracked& operator=(tracked&& rhs) noexcept {
+    value = rhs.value;
+    rhs.value = -1;
+    return *this;
+  }
+  ~tracked() { --live; }
+
+  bool intact() const noexcept { return self == this; }
+};
+
+long long tracked::live = 0;
+
+// the same without copies
+struct move_only : tracked {
+  move_only(int v = 0) noexcept : tracked(v) {}
+  move_only(const move_only&) = delete;
+  move_only(move_only&&) noexcept = default;
+  move_only& operator=(const move_only&) = delete;
+  move_only& operator=(move_only&&) noexcept = default;
+};
+
+int value_of(int x) { return x; }
+
+int value_of(const tracked& x) { return x.value; }
+
+int value_of(const std::string& x) { return std::stoi(x.substr(x.find(':') + 1)); }
+
+bool intact(int) { return true; }
+
+bool intact(const tracked& x) { return x.intact(); }
+
+bool intact(const std::string&) { return true; }
+
+// a string past any small string buffer, so a copy made from a freed buffer shows up
+template <typename T>
+T make_value(int v) {
+  if constexpr (std::is_same<T, std::string>::value) {
+    return std::string(40, 'x') + ":" + std::to_string(v);
+  } else {
+    return T(v);
+  }
+}
+
+template <typename Vec>
+void check_same(const Vec& v, const std::vector<int>& model) {
+  HF_CHECK(v.size() == model.size());
+  if (v.size() != model.size()) return;
+  for (size_t i = 0; i < model.size(); ++i) {
+    HF_CHECK(value_of(v[i]) == model[i]);
+    HF_CHECK(intact(v[i]));
+  }
+}
+
+// inserts anywhere through every path, shifting in place or into a new buffer. With Copy
+// the inserted value is often an element of the vector itself
+template <typename T, bool Copy>
+void check_random_inserts(int rounds) {
+  auto& gen = hf_test::rng();
+  hf::vector<T> v;
+  std::vector<int> model;
+
+  for (int round = 0; round < rounds; ++round) {
+    auto x = static_cast<int>(gen() % 100000);
+    auto i = model.empty() ? 0 : gen() % (model.size() + 1);
+    auto k = model.empty() ? 0 : gen() % model.size();
+    switch (gen() % 8) {
+      case 0:
+        v.emplace_back(x);
+        model.push_back(x);
+        break;
+      case 1:
+        v.emplace(v.begin() + i, x);
+        model.insert(model.begin() + i, x);
+        break;
+      case 2:
+        v.insert(v.begin() + i, T(x));
+        model.insert(model.begin() + i, x);
+        break;
+      case 3:
+        if constexpr (Copy) {
+          if (!model.empty()) {
+            auto n = gen() % 12;
+            v.insert(v.begin() + i, n, v[k]);
+            model.insert(model.begin() + i, n, model[k]);
+          }
+        }
+        break;
+      case 4:
+        if constexpr (Copy) {
+          if (!model.empty()) {
+            v.insert(v.begin() + i, v[k]);
+            model.insert(model.begin() + i, model[k]);
+          }
+        }
+        break;
+      case 5:
+        if (!model.empty()) {
+          v.erase(v.begin() + k);
+          model.erase(model.begin() + k);
+        }
+        break;
+      case 6:
+        if (model.size() > 200) {
+          v.erase(v.begin() + k / 2, v.begin() + k);
+          model.erase(model.begin() + k / 2, model.begin() + k);
+        }
+        break;
+      default:
+        if (gen() % 16 == 0) {
+          check_same(v, model);
+          HF_CHECK(tracked::live == static_cast<long long>(model.size()));
+          hf::vector<T> moved(std::move(v));
+          v = std::move(moved);
+        }
+        break;
+    }
+  }
+  check_same(v, model);
+}
+
+// v is full, the next element needs a new buffer while its argument still points into
+// the old one
+template <typename T>
+hf::vector<T> make_full(size_t n) {
+  hf::vector<T> v;
+  v.reserve(n);
+  for (size_t i = 0; i < n; ++i) v.push_back(make_value<T>(static_cast<int>(i)));
+  HF_CHECK(v.size() == v.capacity());
+  return v;
+}
+
+template <typename T>
+void check_aliasing_arguments() {
+  for (size_t n : {1, 2, 7}) {
+    auto v = make_full<T>(n);
+    v.emplace_back(v[0]);
+    HF_CHECK(value_of(v.back()) == 0 && value_of(v[0]) == 0);
+
+    v = make_full<T>(n);
+    v.push_back(v[n - 1]);
+    HF_CHECK(value_of(v.back()) == static_cast<int>(n - 1));
+
+    v = make_full<T>(n);
+    v.emplace(v.begin(), v[n - 1]);
+    HF_CHECK(value_of(v.front()) == static_cast<int>(n - 1) && v.size() == n + 1);
+    HF_CHECK(value_of(v.back()) == static_cast<int>(n - 1));
+
+    v = make_full<T>(n);
+    v.insert(v.begin(), 3, v[n / 2]);
+    HF_CHECK(v.size() == n + 3);
+    for (size_t i = 0; i < 3; ++i) HF_CHECK(value_of(v[i]) == static_cast<int>(n / 2));
+
+    // room to spare, the element shifted to make room is the argument
+    v = make_full<T>(n);
+    v.reserve(2 * n + 2);
+    v.emplace(v.begin(), v[0]);
+    HF_CHECK(value_of(v[0]) == 0 && value_of(v[1]) == 0);
+    v.insert(v.begin() + 1, v.back());
+    HF_CHECK(value_of(v[1]) == static_cast<int>(n - 1));
+
+    std::vector<int> model;
+    for (auto& x : v) model.push_back(value_of(x));
+    check_same(v, model);
+  }
+}
+
+}  // namespace
+
+// an empty vector owns no buffer, growing it must not hand a null pointer back
+HF_TEST(vector, first_allocation_frees_nothing) {
+  {
+    hf::vector<int, strict_alloc> v(strict_alloc(1));
+    v.push_back(7);
+    HF_CHECK(v.size() == 1 && v[0] == 7);
+  }
+  {
+    hf::vector<int, strict_alloc> v(strict_alloc(1));
+    v.emplace(v.begin(), 7);
+    HF_CHECK(v.size() == 1 && v[0] == 7);
+  }
+  {
+    hf::vector<int, strict_alloc> v(strict_alloc(1));
+    v.insert(v.begin(), 3, 5);
+    HF_CHECK(v.size() == 3 && v[0] == 5 && v[2] == 5);
+  }
+  HF_CHECK(hf_test::outstanding(1) == 0);
+}
+
+// elements that can only be moved go through the same paths as copyable ones
+HF_TEST(vector, move_only_elements) {
+  check_random_inserts<move_only, false>(20000);
+  {
+    hf::vector<move_only> v;
+    for (int i = 0; i < 10; ++i) v.emplace_back(i);
+    move_only m(42);
+    v.push_back(std::move(m));
+    HF_CHECK(m.value == -1 && v.back().value == 42);
+    v.insert(v.begin() + 3, move_only(7));
+    HF_CHECK(v[3].value == 7 && v[4].value == 3 && v.size() == 12);
+  }
+  HF_CHECK(tracked::live == 0);
+}
+
+// an argument that refers into the vector stays valid until the new element is built,
+// whether the buffer is replaced or the elements shift under it
+HF_TEST(vector, emplace_aliasing_arguments) {
+  check_aliasing_arguments<int>();
+  check_aliasing_arguments<std::string>();
+  check_aliasing_arguments<tracked>();
+  HF_CHECK(tracked::live == 0);
+}
+
+// a type that is not trivially relocatable is shifted by move construction and
+// assignment instead of memmove, inserted values may be elements of the vector
+HF_TEST(vector, insert_shifts_non_relocatable) {
+  check_random_inserts<tracked, true>(20000);
+  HF_CHECK(tracked::live == 0);
+}